@@ -0,0 +1,268 @@
+/**
+ * @file
+ *
+ * @brief Counts heap allocations made by valijson for each supported parser
+ *        adapter, broken down by phase.
+ *
+ * Global operator new and operator delete are replaced so that every heap
+ * allocation made by the process is counted. For each adapter, the schema
+ * and documents are first parsed by the JSON library (which is not counted),
+ * then allocations are counted separately for the following phases:
+ *
+ *  - parsing the schema using SchemaParser
+ *  - constructing a Validator
+ *  - validating a valid document, without ValidationResults
+ *  - validating an invalid document, with ValidationResults
+ *  - the same two validations, using a ValidationSession that is reused
+ *    across iterations
+ *
+ * Each phase is repeated several times, and the average number of
+ * allocations and bytes allocated per iteration is reported.
+ *
+ * Usage: allocation_benchmark [<schema> <valid document> <invalid document>]
+ *
+ * Defaults to the documents in benchmarks/data, relative to a build directory
+ * that is a sibling of the benchmarks directory.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <valijson/adapters/json11_adapter.hpp>
+#include <valijson/adapters/json_tape_adapter.hpp>
+#include <valijson/adapters/jsoncpp_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/adapters/picojson_adapter.hpp>
+#include <valijson/adapters/rapidjson_adapter.hpp>
+#include <valijson/adapters/yaml_cpp_adapter.hpp>
+#include <valijson/utils/json11_utils.hpp>
+#include <valijson/utils/json_tape_utils.hpp>
+#include <valijson/utils/jsoncpp_utils.hpp>
+#include <valijson/utils/nlohmann_json_utils.hpp>
+#include <valijson/utils/picojson_utils.hpp>
+#include <valijson/utils/rapidjson_utils.hpp>
+#include <valijson/utils/yaml_cpp_utils.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_session.hpp>
+#include <valijson/validator.hpp>
+
+#define BENCHMARK_DATA_DIR "../benchmarks/data/"
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationSession;
+using valijson::Validator;
+using valijson::adapters::AdapterTraits;
+using valijson::adapters::Json11Adapter;
+using valijson::adapters::JsonTapeAdapter;
+using valijson::adapters::JsonCppAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::adapters::PicoJsonAdapter;
+using valijson::adapters::RapidJsonAdapter;
+using valijson::adapters::YamlCppAdapter;
+
+namespace {
+
+const unsigned int kIterations = 100;
+
+/// Running totals, updated by the replacement allocation functions
+uint64_t allocationCount = 0;
+uint64_t allocationBytes = 0;
+
+struct Allocations
+{
+    uint64_t count;
+    uint64_t bytes;
+};
+
+/**
+ * @brief  Return the average number of allocations made by each call to fn
+ */
+template<typename Function>
+Allocations countAllocations(Function fn)
+{
+    // Warm up, so that one-time allocations such as static initialisation
+    // are not attributed to the phase
+    fn();
+
+    const uint64_t count = allocationCount;
+    const uint64_t bytes = allocationBytes;
+
+    for (unsigned int i = 0; i < kIterations; i++) {
+        fn();
+    }
+
+    return Allocations{(allocationCount - count) / kIterations, (allocationBytes - bytes) / kIterations};
+}
+
+void printRow(const char *adapter, const char *phase, const Allocations &allocations)
+{
+    std::printf("%-10s  %-32s  %12llu  %12llu\n", adapter, phase,
+            static_cast<unsigned long long>(allocations.count),
+            static_cast<unsigned long long>(allocations.bytes));
+}
+
+template<typename AdapterType>
+bool benchmarkAdapter(const char *name, const std::string &schemaPath, const std::string &validPath,
+        const std::string &invalidPath)
+{
+    typedef typename AdapterTraits<AdapterType>::DocumentType DocumentType;
+
+    // Select the overload by exact type, since some document types can be
+    // implicitly converted to others (e.g. YAML::Node to nlohmann::json)
+    bool (*loadDocument)(const std::string &, DocumentType &) = valijson::utils::loadDocument;
+
+    DocumentType schemaDocument;
+    DocumentType validDocument;
+    DocumentType invalidDocument;
+    if (!loadDocument(schemaPath, schemaDocument) ||
+        !loadDocument(validPath, validDocument) ||
+        !loadDocument(invalidPath, invalidDocument)) {
+        return false;
+    }
+
+    const AdapterType schemaAdapter(schemaDocument);
+    const AdapterType validAdapter(validDocument);
+    const AdapterType invalidAdapter(invalidDocument);
+
+    printRow(name, "parse schema", countAllocations([&]() {
+        Schema schema;
+        SchemaParser parser;
+        parser.populateSchema(schemaAdapter, schema);
+    }));
+
+    // Adapters for formats such as YAML do not distinguish between strings and
+    // other scalar types
+    const Validator::TypeCheckingMode mode = validAdapter.hasStrictTypes() ?
+            Validator::kStrongTypes : Validator::kWeakTypes;
+
+    printRow(name, "construct validator", countAllocations([mode]() {
+        Validator validator(mode);
+        (void) validator;
+    }));
+
+    Schema schema;
+    SchemaParser parser;
+    parser.populateSchema(schemaAdapter, schema);
+
+    bool expected = true;
+
+    printRow(name, "validate valid document", countAllocations([&]() {
+        Validator validator(mode);
+        expected &= validator.validate(schema, validAdapter, nullptr);
+    }));
+
+    printRow(name, "validate invalid with results", countAllocations([&]() {
+        Validator validator(mode);
+        ValidationResults results;
+        expected &= !validator.validate(schema, invalidAdapter, &results);
+    }));
+
+    ValidationSession validSession(Validator(mode), false);
+    printRow(name, "session: validate valid document", countAllocations([&]() {
+        expected &= validSession.validate(schema, validAdapter);
+    }));
+
+    ValidationSession invalidSession{Validator(mode)};
+    printRow(name, "session: validate invalid", countAllocations([&]() {
+        expected &= !invalidSession.validate(schema, invalidAdapter);
+    }));
+
+    if (!expected) {
+        std::cerr << name << ": documents did not produce the expected validation results" << std::endl;
+    }
+
+    return expected;
+}
+
+}  // namespace
+
+// GCC warns when the replacement operator delete is inlined into code that
+// allocated using operator new, since it does not know that the two match
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void * operator new(std::size_t size)
+{
+    allocationCount++;
+    allocationBytes += size;
+    if (void *ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+
+#if VALIJSON_USE_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    allocationCount++;
+    allocationBytes += size;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 1 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " [<schema> <valid document> <invalid document>]" << std::endl;
+        return 1;
+    }
+
+    const std::string schemaPath = argc == 4 ? argv[1] : BENCHMARK_DATA_DIR "schema.json";
+    const std::string validPath = argc == 4 ? argv[2] : BENCHMARK_DATA_DIR "valid.json";
+    const std::string invalidPath = argc == 4 ? argv[3] : BENCHMARK_DATA_DIR "invalid.json";
+
+    std::printf("%-10s  %-32s  %12s  %12s\n", "adapter", "phase", "allocations", "bytes");
+
+    bool ok = true;
+    ok &= benchmarkAdapter<Json11Adapter>("json11", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<JsonTapeAdapter>("json tape", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<JsonCppAdapter>("jsoncpp", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<NlohmannJsonAdapter>("nlohmann", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<PicoJsonAdapter>("picojson", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<RapidJsonAdapter>("rapidjson", schemaPath, validPath, invalidPath);
+    ok &= benchmarkAdapter<YamlCppAdapter>("yaml-cpp", schemaPath, validPath, invalidPath);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/**
+ * @file
+ *
+ * @brief Microbenchmarks for individual constraints, parameterised by input
+ *        size, using the nlohmann, rapidjson and JsonTape adapters.
+ *
+ * Each benchmark generates a schema and a document for a given size. For
+ * constraints that apply to scalars, such as 'type' or 'minimum', the size is
+ * the number of array items that the constraint is applied to (via 'items'),
+ * so the 'items' baseline should be subtracted to isolate the constraint. For
+ * other constraints, the size is the length of a string, the number of object
+ * properties, the number of array items, or the number of enum values.
+ *
+ * Documents are parsed and schemas are populated before timing starts. The
+ * same Validator is reused for every iteration, so that its regular
+ * expression cache is warm.
+ *
+ * Usage: constraint_benchmark [<filter>]
+ *
+ * Only benchmarks whose names contain the filter string are run.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include <valijson/adapters/json_tape_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/adapters/rapidjson_adapter.hpp>
+#include <valijson/json_tape.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::JsonTape;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::Validator;
+using valijson::adapters::JsonTapeAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::adapters::RapidJsonAdapter;
+
+using json = nlohmann::json;
+
+namespace {
+
+/// Sizes that each benchmark is run with
+const unsigned int kSizes[] = { 1, 64, 4096 };
+
+/// Minimum time spent timing each benchmark, after warming up
+const std::chrono::milliseconds kMinimumDuration(50);
+
+/**
+ * @brief  Schema and valid document for a benchmark
+ */
+struct Input
+{
+    json schema;
+    json document;
+};
+
+struct Benchmark
+{
+    const char *name;
+    std::function<Input (unsigned int size)> generate;
+};
+
+json integers(unsigned int size)
+{
+    json array = json::array();
+    for (unsigned int i = 0; i < size; i++) {
+        array.push_back(i * 3);
+    }
+
+    return array;
+}
+
+json integerProperties(unsigned int size)
+{
+    json object = json::object();
+    for (unsigned int i = 0; i < size; i++) {
+        object["p" + std::to_string(i)] = i;
+    }
+
+    return object;
+}
+
+/**
+ * @brief  Benchmark a scalar constraint by applying it to each item in an
+ *         array of integers
+ */
+Benchmark eachInteger(const char *name, const char *constraint)
+{
+    const std::string itemSchema(constraint);
+    return Benchmark{name, [itemSchema](unsigned int size) {
+        return Input{json{{"items", json::parse(itemSchema)}}, integers(size)};
+    }};
+}
+
+const std::vector<Benchmark> & benchmarks()
+{
+    static const std::vector<Benchmark> all = {
+        eachInteger("items", "{}"),
+        eachInteger("type", R"({"type": "integer"})"),
+        eachInteger("minimum/maximum", R"({"minimum": 0, "maximum": 1000000})"),
+        eachInteger("multipleOf", R"({"multipleOf": 3})"),
+        eachInteger("allOf", R"({"allOf": [{"type": "integer"}, {"minimum": 0}]})"),
+        eachInteger("anyOf", R"({"anyOf": [{"type": "string"}, {"type": "null"}, {"type": "integer"}]})"),
+        eachInteger("oneOf", R"({"oneOf": [{"type": "string"}, {"type": "null"}, {"type": "integer"}]})"),
+        eachInteger("not", R"({"not": {"type": "string"}})"),
+        eachInteger("if/then/else", R"({"if": {"minimum": 100}, "then": {"multipleOf": 3}, "else": {}})"),
+        { "enum", [](unsigned int size) {
+            json values = json::array();
+            for (unsigned int i = 0; i < size; i++) {
+                values.push_back("value" + std::to_string(i));
+            }
+            return Input{json{{"enum", values}}, values.back()};
+        }},
+        { "const", [](unsigned int size) {
+            return Input{json{{"const", integerProperties(size)}}, integerProperties(size)};
+        }},
+        { "minLength/maxLength", [](unsigned int size) {
+            return Input{json{{"minLength", 1}, {"maxLength", size}}, std::string(size, 'x')};
+        }},
+        { "pattern", [](unsigned int size) {
+            return Input{json{{"pattern", "^[a-z]+$"}}, std::string(size, 'x')};
+        }},
+        { "format", [](unsigned int size) {
+            json items = json::array();
+            for (unsigned int i = 0; i < size; i++) {
+                items.push_back("2024-02-29T12:34:56.789Z");
+            }
+            return Input{json{{"items", {{"format", "date-time"}}}}, items};
+        }},
+        { "properties", [](unsigned int size) {
+            json properties = json::object();
+            for (unsigned int i = 0; i < size; i++) {
+                properties["p" + std::to_string(i)] = json{{"type", "integer"}};
+            }
+            return Input{json{{"properties", properties}}, integerProperties(size)};
+        }},
+        { "patternProperties", [](unsigned int size) {
+            return Input{json{{"patternProperties", {{"^p", {{"type", "integer"}}}}}}, integerProperties(size)};
+        }},
+        { "additionalProperties", [](unsigned int size) {
+            return Input{json{{"additionalProperties", {{"type", "integer"}}}}, integerProperties(size)};
+        }},
+        { "propertyNames", [](unsigned int size) {
+            return Input{json{{"propertyNames", {{"maxLength", 8}}}}, integerProperties(size)};
+        }},
+        { "required", [](unsigned int size) {
+            json required = json::array();
+            for (unsigned int i = 0; i < size; i++) {
+                required.push_back("p" + std::to_string(i));
+            }
+            return Input{json{{"required", required}}, integerProperties(size)};
+        }},
+        { "dependencies", [](unsigned int size) {
+            json dependencies = json::object();
+            for (unsigned int i = 1; i < size; i++) {
+                dependencies["p" + std::to_string(i)] = json::array({"p" + std::to_string(i - 1)});
+            }
+            return Input{json{{"dependencies", dependencies}}, integerProperties(size)};
+        }},
+        { "items (tuple)", [](unsigned int size) {
+            json items = json::array();
+            for (unsigned int i = 0; i < size; i++) {
+                items.push_back(json{{"type", "integer"}});
+            }
+            return Input{json{{"items", items}}, integers(size)};
+        }},
+        { "contains", [](unsigned int size) {
+            return Input{json{{"contains", {{"const", (size - 1) * 3}}}}, integers(size)};
+        }},
+        { "uniqueItems", [](unsigned int size) {
+            return Input{json{{"uniqueItems", true}}, integers(size)};
+        }}
+    };
+
+    return all;
+}
+
+/**
+ * @brief  Time validation of a document, returning the average number of
+ *         nanoseconds per validation
+ */
+template<typename AdapterType>
+double timeValidation(const Schema &schema, const AdapterType &document, bool &valid)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Validator validator;
+    valid = validator.validate(schema, document, nullptr);
+
+    unsigned long iterations = 0;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point now = start;
+    do {
+        valid &= validator.validate(schema, document, nullptr);
+        iterations++;
+        now = Clock::now();
+    } while (now - start < kMinimumDuration);
+
+    return std::chrono::duration<double, std::nano>(now - start).count() / iterations;
+}
+
+void printRow(const char *adapter, const char *name, unsigned int size, double nanoseconds, bool valid)
+{
+    std::printf("%-10s  %-22s  %6u  %14.1f  %12.2f%s\n", adapter, name, size, nanoseconds, nanoseconds / size,
+            valid ? "" : "  (invalid)");
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        std::fprintf(stderr, "Usage: %s [<filter>]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string filter = argc == 2 ? argv[1] : "";
+
+    std::printf("%-10s  %-22s  %6s  %14s  %12s\n", "adapter", "benchmark", "size", "ns/op", "ns/size");
+
+    bool ok = true;
+    for (const Benchmark &benchmark : benchmarks()) {
+        if (std::string(benchmark.name).find(filter) == std::string::npos) {
+            continue;
+        }
+
+        for (const unsigned int size : kSizes) {
+            const Input input = benchmark.generate(size);
+            const std::string schemaText = input.schema.dump();
+            const std::string documentText = input.document.dump();
+
+            const json nlohmannSchema = json::parse(schemaText);
+            const json nlohmannDocument = json::parse(documentText);
+
+            rapidjson::Document rapidjsonDocument;
+            rapidjsonDocument.Parse(documentText.c_str());
+
+            JsonTape tapeDocument;
+            tapeDocument.parse(documentText.data(), documentText.size());
+
+            Schema schema;
+            SchemaParser parser;
+            parser.populateSchema(NlohmannJsonAdapter(nlohmannSchema), schema);
+
+            bool valid = false;
+            double nanoseconds = timeValidation(schema, NlohmannJsonAdapter(nlohmannDocument), valid);
+            printRow("nlohmann", benchmark.name, size, nanoseconds, valid);
+            ok &= valid;
+
+            nanoseconds = timeValidation(schema, RapidJsonAdapter(rapidjsonDocument), valid);
+            printRow("rapidjson", benchmark.name, size, nanoseconds, valid);
+            ok &= valid;
+
+            nanoseconds = timeValidation(schema, JsonTapeAdapter(tapeDocument), valid);
+            printRow("json tape", benchmark.name, size, nanoseconds, valid);
+            ok &= valid;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,758 @@
+/**
+ * @file
+ *
+ * @brief   Adapter implementation for MessagePack and CBOR documents.
+ *
+ * Include this file in your program to enable support for validating
+ * MessagePack and CBOR documents directly, without decoding them into a DOM.
+ * See binary_document.hpp for details.
+ *
+ * This file defines the following template classes (not in this order):
+ *  - GenericBinaryAdapter
+ *  - GenericBinaryArray
+ *  - GenericBinaryArrayValueIterator
+ *  - GenericBinaryFrozenValue
+ *  - GenericBinaryObject
+ *  - GenericBinaryObjectMember
+ *  - GenericBinaryObjectMemberIterator
+ *  - GenericBinaryValue
+ *
+ * These are instantiated for each format, as MsgPackAdapter and CborAdapter.
+ *
+ * Due to the dependencies that exist between these classes, the ordering of
+ * class declarations and definitions may be a bit confusing. The best place to
+ * start is GenericBinaryAdapter. This class definition is actually very small,
+ * since most of the functionality is inherited from the BasicAdapter class.
+ * Most of the classes in this file are provided as template arguments to the
+ * inherited BasicAdapter class.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string>
+
+#include <valijson/internal/adapter.hpp>
+#include <valijson/internal/basic_adapter.hpp>
+#include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
+#include <valijson/binary_document.hpp>
+#include <valijson/exceptions.hpp>
+
+namespace valijson {
+namespace adapters {
+
+template<class Format>
+class GenericBinaryAdapter;
+
+template<class Format>
+class GenericBinaryArrayValueIterator;
+
+template<class Format>
+class GenericBinaryObjectMemberIterator;
+
+/// Container for a property name and an associated binary value
+template<class Format>
+class GenericBinaryObjectMember :
+        public std::pair<std::string, GenericBinaryAdapter<Format>>
+{
+private:
+    typedef std::pair<std::string, GenericBinaryAdapter<Format>> Super;
+
+public:
+    GenericBinaryObjectMember(
+            const std::string &name,
+            const GenericBinaryAdapter<Format> &value)
+      : Super(name, value) { }
+};
+
+namespace detail {
+
+/// Return a reference to a document containing an empty map or array
+template<class Format>
+const BinaryDocument<Format> & emptyBinaryDocument(bool array)
+{
+    static const BinaryDocument<Format> emptyArray = []() {
+        BinaryDocument<Format> document;
+        const unsigned char bytes[] = { Format::kEmptyArray };
+        document.parse(std::string(reinterpret_cast<const char *>(bytes), 1));
+        return document;
+    }();
+
+    static const BinaryDocument<Format> emptyMap = []() {
+        BinaryDocument<Format> document;
+        const unsigned char bytes[] = { Format::kEmptyMap };
+        document.parse(std::string(reinterpret_cast<const char *>(bytes), 1));
+        return document;
+    }();
+
+    return array ? emptyArray : emptyMap;
+}
+
+}  // namespace detail
+
+/**
+ * @brief  Light weight wrapper for an array in a binary document.
+ *
+ * An instance of this class contains a pointer to a document and the offset
+ * of an array, so there is very little overhead associated with copy
+ * construction and passing by value.
+ */
+template<class Format>
+class GenericBinaryArray
+{
+public:
+
+    typedef GenericBinaryArrayValueIterator<Format> const_iterator;
+    typedef GenericBinaryArrayValueIterator<Format> iterator;
+
+    /// Construct a GenericBinaryArray referencing an empty array.
+    GenericBinaryArray()
+      : m_document(&detail::emptyBinaryDocument<Format>(true)),
+        m_offset(0) { }
+
+    /**
+     * @brief   Construct a GenericBinaryArray referencing a value in a
+     *          document.
+     *
+     * @param   document  document containing the array
+     * @param   offset    offset of the array
+     *
+     * Note that this constructor will throw an exception if the value is not
+     * an array.
+     */
+    GenericBinaryArray(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(&document),
+        m_offset(offset)
+    {
+        if (document.header(offset).kind != BinaryHeader::kArray) {
+            throwRuntimeError("Value is not an array.");
+        }
+    }
+
+    /// Return an iterator for the first element of the array.
+    iterator begin() const;
+
+    /// Return an iterator for one-past the last element of the array.
+    iterator end() const;
+
+    /// Return the number of elements in the array
+    size_t size() const
+    {
+        return m_document->containerSize(m_offset);
+    }
+
+private:
+
+    /// Document containing the array
+    const BinaryDocument<Format> *m_document;
+
+    /// Offset of the array
+    size_t m_offset;
+};
+
+/**
+ * @brief  Light weight wrapper for a map in a binary document.
+ *
+ * An instance of this class contains a pointer to a document and the offset
+ * of a map, so there is very little overhead associated with copy
+ * construction and passing by value.
+ */
+template<class Format>
+class GenericBinaryObject
+{
+public:
+
+    typedef GenericBinaryObjectMemberIterator<Format> const_iterator;
+    typedef GenericBinaryObjectMemberIterator<Format> iterator;
+
+    /// Construct a GenericBinaryObject referencing an empty object singleton.
+    GenericBinaryObject()
+      : m_document(&detail::emptyBinaryDocument<Format>(false)),
+        m_offset(0) { }
+
+    /**
+     * @brief   Construct a GenericBinaryObject referencing a value in a
+     *          document.
+     *
+     * @param   document  document containing the map
+     * @param   offset    offset of the map
+     *
+     * Note that this constructor will throw an exception if the value is not
+     * a map.
+     */
+    GenericBinaryObject(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(&document),
+        m_offset(offset)
+    {
+        if (document.header(offset).kind != BinaryHeader::kObject) {
+            throwRuntimeError("Value is not an object.");
+        }
+    }
+
+    /// Return an iterator for the first object member
+    iterator begin() const;
+
+    /// Return an iterator for one-past the last object member
+    iterator end() const;
+
+    /**
+     * @brief   Return an iterator for the object member with the specified
+     *          property name.
+     *
+     * Keys are compared in place, without being copied. If an object member
+     * with the specified name does not exist, the iterator returned will be
+     * the same as the iterator returned by the end() function.
+     *
+     * @param   propertyName  property name to search for
+     */
+    iterator find(const std::string &propertyName) const;
+
+    /// Returns the number of members belonging to this object.
+    size_t size() const
+    {
+        return m_document->containerSize(m_offset);
+    }
+
+private:
+
+    /// Document containing the map
+    const BinaryDocument<Format> *m_document;
+
+    /// Offset of the map
+    size_t m_offset;
+};
+
+/**
+ * @brief   Stores an independent copy of a value in a binary document.
+ *
+ * The encoded bytes of the value are copied into a new document, so that the
+ * copy does not depend on the original bytes.
+ *
+ * @see FrozenValue
+ */
+template<class Format>
+class GenericBinaryFrozenValue: public FrozenValue
+{
+public:
+
+    /**
+     * @brief  Make a copy of a value in a binary document
+     *
+     * @param  document  document containing the value to be copied
+     * @param  offset    offset of the value
+     */
+    GenericBinaryFrozenValue(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(document.copyValue(offset)) { }
+
+    FrozenValue * clone() const override
+    {
+        return new GenericBinaryFrozenValue(m_document, 0);
+    }
+
+    bool equalTo(const Adapter &other, bool strict) const override;
+
+    uint64_t hash() const override;
+
+private:
+
+    /// Self-contained document, with the stored value at offset zero
+    BinaryDocument<Format> m_document;
+};
+
+/**
+ * @brief   Light weight wrapper for a value in a binary document.
+ *
+ * This class is passed as an argument to the BasicAdapter template class,
+ * and is used to provide access to a value in a binary document. Scalar values
+ * are decoded each time they are read, and strings are read in place.
+ *
+ * The functions that need to be provided by this class are defined implicitly
+ * by the implementation of the BasicAdapter template class.
+ *
+ * @see BasicAdapter
+ */
+template<class Format>
+class GenericBinaryValue
+{
+public:
+
+    /// Construct a wrapper for the empty object singleton
+    GenericBinaryValue()
+      : m_document(&detail::emptyBinaryDocument<Format>(false)),
+        m_offset(0),
+        m_header(m_document->header(0)) { }
+
+    /// Construct a wrapper for the root value of a document
+    GenericBinaryValue(const BinaryDocument<Format> &document)
+      : m_document(&document),
+        m_offset(0)
+    {
+        if (!document.isValid()) {
+            throwRuntimeError("Binary document is not valid.");
+        }
+
+        m_header = document.header(0);
+    }
+
+    /// Construct a wrapper for a value at a specific offset in a document
+    GenericBinaryValue(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(&document),
+        m_offset(offset),
+        m_header(document.header(offset)) { }
+
+    /**
+     * @brief   Create a new GenericBinaryFrozenValue instance that contains
+     *          the value referenced by this GenericBinaryValue instance.
+     *
+     * @returns pointer to a new GenericBinaryFrozenValue instance, belonging
+     *          to the caller.
+     */
+    FrozenValue * freeze() const
+    {
+        return new GenericBinaryFrozenValue<Format>(*m_document, m_offset);
+    }
+
+    opt::optional<GenericBinaryArray<Format>> getArrayOptional() const
+    {
+        if (isArray()) {
+            return opt::make_optional(GenericBinaryArray<Format>(*m_document, m_offset));
+        }
+
+        return {};
+    }
+
+    bool getArraySize(size_t &result) const
+    {
+        if (isArray()) {
+            result = m_document->containerSize(m_offset);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getBool(bool &result) const
+    {
+        if (isBool()) {
+            result = m_header.kind == BinaryHeader::kTrue;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getDouble(double &result) const
+    {
+        if (isDouble()) {
+            result = m_header.number;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getInteger(int64_t &result) const
+    {
+        if (isInteger()) {
+            result = m_header.integer;
+            return true;
+        }
+
+        return false;
+    }
+
+    opt::optional<GenericBinaryObject<Format>> getObjectOptional() const
+    {
+        if (isObject()) {
+            return opt::make_optional(GenericBinaryObject<Format>(*m_document, m_offset));
+        }
+
+        return {};
+    }
+
+    bool getObjectSize(size_t &result) const
+    {
+        if (isObject()) {
+            result = m_document->containerSize(m_offset);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getString(std::string &result) const
+    {
+        if (isString()) {
+            result.assign(m_document->stringData(m_header), static_cast<size_t>(m_header.length));
+            return true;
+        }
+
+        return false;
+    }
+
+    static bool hasStrictTypes()
+    {
+        return true;
+    }
+
+    bool isArray() const
+    {
+        return m_header.kind == BinaryHeader::kArray;
+    }
+
+    bool isBool() const
+    {
+        return m_header.kind == BinaryHeader::kTrue || m_header.kind == BinaryHeader::kFalse;
+    }
+
+    bool isDouble() const
+    {
+        return m_header.kind == BinaryHeader::kDouble;
+    }
+
+    bool isInteger() const
+    {
+        return m_header.kind == BinaryHeader::kInteger;
+    }
+
+    bool isNull() const
+    {
+        return m_header.kind == BinaryHeader::kNull;
+    }
+
+    bool isNumber() const
+    {
+        return isInteger() || isDouble();
+    }
+
+    bool isObject() const
+    {
+        return m_header.kind == BinaryHeader::kObject;
+    }
+
+    bool isString() const
+    {
+        return m_header.kind == BinaryHeader::kString;
+    }
+
+private:
+
+    /// Document containing the value
+    const BinaryDocument<Format> *m_document;
+
+    /// Offset of the value
+    size_t m_offset;
+
+    /// Decoded header of the value
+    BinaryHeader m_header;
+};
+
+/**
+ * @brief   An implementation of the Adapter interface supporting MessagePack
+ *          and CBOR documents.
+ *
+ * This class is defined in terms of the BasicAdapter template class, which
+ * helps to ensure that all of the Adapter implementations behave consistently.
+ *
+ * @see Adapter
+ * @see BasicAdapter
+ */
+template<class Format>
+class GenericBinaryAdapter:
+    public BasicAdapter<GenericBinaryAdapter<Format>,
+                        GenericBinaryArray<Format>,
+                        GenericBinaryObjectMember<Format>,
+                        GenericBinaryObject<Format>,
+                        GenericBinaryValue<Format>>
+{
+private:
+    typedef BasicAdapter<GenericBinaryAdapter<Format>,
+                         GenericBinaryArray<Format>,
+                         GenericBinaryObjectMember<Format>,
+                         GenericBinaryObject<Format>,
+                         GenericBinaryValue<Format>> Super;
+
+public:
+
+    /// Construct a GenericBinaryAdapter that contains an empty object
+    GenericBinaryAdapter()
+      : Super() { }
+
+    /// Construct a GenericBinaryAdapter for the root value of a document
+    GenericBinaryAdapter(const BinaryDocument<Format> &document)
+      : Super(GenericBinaryValue<Format>(document)) { }
+
+    /// Construct a GenericBinaryAdapter for the value at an offset
+    GenericBinaryAdapter(const BinaryDocument<Format> &document, size_t offset)
+      : Super(GenericBinaryValue<Format>(document, offset)) { }
+};
+
+/**
+ * @brief   Class for iterating over values held in an array.
+ *
+ * This class provides an array iterator that dereferences as an instance of
+ * GenericBinaryAdapter representing a value stored in the array. Moving to the
+ * next element skips over any descendants of the current element using the
+ * document's index.
+ *
+ * @see GenericBinaryArray
+ */
+template<class Format>
+class GenericBinaryArrayValueIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = GenericBinaryAdapter<Format>;
+    using difference_type = GenericBinaryAdapter<Format>;
+    using pointer = GenericBinaryAdapter<Format>*;
+    using reference = GenericBinaryAdapter<Format>&;
+
+    /**
+     * @brief   Construct a new GenericBinaryArrayValueIterator.
+     *
+     * @param   document  document containing the array
+     * @param   offset    offset of the current element, or of the end of the
+     *                    array's elements for the end iterator
+     */
+    GenericBinaryArrayValueIterator(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(&document),
+        m_offset(offset) { }
+
+    /// Returns a GenericBinaryAdapter that contains the value of the current
+    /// element.
+    GenericBinaryAdapter<Format> operator*() const
+    {
+        return GenericBinaryAdapter<Format>(*m_document, m_offset);
+    }
+
+    DerefProxy<GenericBinaryAdapter<Format>> operator->() const
+    {
+        return DerefProxy<GenericBinaryAdapter<Format>>(**this);
+    }
+
+    bool operator==(const GenericBinaryArrayValueIterator &other) const
+    {
+        return m_offset == other.m_offset;
+    }
+
+    bool operator!=(const GenericBinaryArrayValueIterator &other) const
+    {
+        return !(m_offset == other.m_offset);
+    }
+
+    const GenericBinaryArrayValueIterator& operator++()
+    {
+        m_offset = m_document->next(m_offset);
+
+        return *this;
+    }
+
+    GenericBinaryArrayValueIterator operator++(int)
+    {
+        GenericBinaryArrayValueIterator iterator_pre(*m_document, m_offset);
+        ++(*this);
+        return iterator_pre;
+    }
+
+    void advance(std::ptrdiff_t n)
+    {
+        for (; n > 0; n--) {
+            ++(*this);
+        }
+    }
+
+private:
+
+    /// Document containing the array
+    const BinaryDocument<Format> *m_document;
+
+    /// Offset of the current element
+    size_t m_offset;
+};
+
+/**
+ * @brief   Class for iterating over the members belonging to a map.
+ *
+ * This class provides an iterator that dereferences as an instance of
+ * GenericBinaryObjectMember representing one of the members of the map.
+ *
+ * @see GenericBinaryObject
+ * @see GenericBinaryObjectMember
+ */
+template<class Format>
+class GenericBinaryObjectMemberIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = GenericBinaryObjectMember<Format>;
+    using difference_type = GenericBinaryObjectMember<Format>;
+    using pointer = GenericBinaryObjectMember<Format>*;
+    using reference = GenericBinaryObjectMember<Format>&;
+
+    /**
+     * @brief   Construct a new GenericBinaryObjectMemberIterator.
+     *
+     * @param   document  document containing the map
+     * @param   offset    offset of the current member's key, or of the end of
+     *                    the map's members for the end iterator
+     */
+    GenericBinaryObjectMemberIterator(const BinaryDocument<Format> &document, size_t offset)
+      : m_document(&document),
+        m_offset(offset) { }
+
+    /**
+     * @brief   Returns a GenericBinaryObjectMember that contains the key and
+     *          value belonging to the object member identified by the
+     *          iterator.
+     */
+    GenericBinaryObjectMember<Format> operator*() const
+    {
+        const BinaryHeader key = m_document->header(m_offset);
+        return GenericBinaryObjectMember<Format>(
+                std::string(m_document->stringData(key), static_cast<size_t>(key.length)),
+                GenericBinaryAdapter<Format>(*m_document, valueOffset(key)));
+    }
+
+    DerefProxy<GenericBinaryObjectMember<Format>> operator->() const
+    {
+        return DerefProxy<GenericBinaryObjectMember<Format>>(**this);
+    }
+
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        const BinaryHeader name = m_document->header(m_offset);
+        return ObjectMemberKey(m_document->stringData(name), static_cast<size_t>(name.length));
+    }
+
+    /// Returns an Adapter for the value of the current member
+    GenericBinaryAdapter<Format> value() const
+    {
+        return GenericBinaryAdapter<Format>(*m_document, valueOffset(m_document->header(m_offset)));
+    }
+
+    bool operator==(const GenericBinaryObjectMemberIterator &other) const
+    {
+        return m_offset == other.m_offset;
+    }
+
+    bool operator!=(const GenericBinaryObjectMemberIterator &other) const
+    {
+        return !(m_offset == other.m_offset);
+    }
+
+    const GenericBinaryObjectMemberIterator& operator++()
+    {
+        m_offset = m_document->next(valueOffset(m_document->header(m_offset)));
+
+        return *this;
+    }
+
+    GenericBinaryObjectMemberIterator operator++(int)
+    {
+        GenericBinaryObjectMemberIterator iterator_pre(*m_document, m_offset);
+        ++(*this);
+        return iterator_pre;
+    }
+
+private:
+
+    /// Return the offset of the value that follows a key
+    static size_t valueOffset(const BinaryHeader &key)
+    {
+        return key.payload + static_cast<size_t>(key.length);
+    }
+
+    /// Document containing the map
+    const BinaryDocument<Format> *m_document;
+
+    /// Offset of the current member's key
+    size_t m_offset;
+};
+
+template<class Format>
+inline bool GenericBinaryFrozenValue<Format>::equalTo(const Adapter &other, bool strict) const
+{
+    return GenericBinaryAdapter<Format>(m_document).equalTo(other, strict);
+}
+
+template<class Format>
+inline uint64_t GenericBinaryFrozenValue<Format>::hash() const
+{
+    return GenericBinaryAdapter<Format>(m_document).hash();
+}
+
+template<class Format>
+inline typename GenericBinaryArray<Format>::iterator GenericBinaryArray<Format>::begin() const
+{
+    return iterator(*m_document, m_document->header(m_offset).payload);
+}
+
+template<class Format>
+inline typename GenericBinaryArray<Format>::iterator GenericBinaryArray<Format>::end() const
+{
+    return iterator(*m_document, m_document->childrenEnd(m_offset));
+}
+
+template<class Format>
+inline typename GenericBinaryObject<Format>::iterator GenericBinaryObject<Format>::begin() const
+{
+    return iterator(*m_document, m_document->header(m_offset).payload);
+}
+
+template<class Format>
+inline typename GenericBinaryObject<Format>::iterator GenericBinaryObject<Format>::end() const
+{
+    return iterator(*m_document, m_document->childrenEnd(m_offset));
+}
+
+template<class Format>
+inline typename GenericBinaryObject<Format>::iterator
+        GenericBinaryObject<Format>::find(const std::string &propertyName) const
+{
+    const size_t last = m_document->childrenEnd(m_offset);
+    size_t offset = m_document->header(m_offset).payload;
+    while (offset < last) {
+        const BinaryHeader key = m_document->header(offset);
+        const size_t valueOffset = key.payload + static_cast<size_t>(key.length);
+        if (key.length == propertyName.size() &&
+                std::memcmp(m_document->stringData(key), propertyName.data(), propertyName.size()) == 0) {
+            return iterator(*m_document, offset);
+        }
+
+        offset = m_document->next(valueOffset);
+    }
+
+    return end();
+}
+
+typedef GenericBinaryAdapter<MsgPackFormat> MsgPackAdapter;
+typedef GenericBinaryAdapter<CborFormat> CborAdapter;
+
+/// Specialisation of the AdapterTraits template struct for MsgPackAdapter
+template<>
+struct AdapterTraits<valijson::adapters::MsgPackAdapter>
+{
+    typedef MsgPackDocument DocumentType;
+
+    static std::string adapterName()
+    {
+        return "MsgPackAdapter";
+    }
+};
+
+/// Specialisation of the AdapterTraits template struct for CborAdapter
+template<>
+struct AdapterTraits<valijson::adapters::CborAdapter>
+{
+    typedef CborDocument DocumentType;
+
+    static std::string adapterName()
+    {
+        return "CborAdapter";
+    }
+};
+
+}  // namespace adapters
+}  // namespace valijson
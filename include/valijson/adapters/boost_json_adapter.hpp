@@ -32,6 +32,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 
 namespace valijson {
 namespace adapters {
@@ -239,6 +240,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored Boost.JSON value
@@ -629,6 +632,18 @@ public:
         return DerefProxy<BoostJsonObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->key().data(), m_itr->key().size());
+    }
+
+    /// Returns an Adapter for the value of the current member
+    BoostJsonAdapter value() const
+    {
+        return BoostJsonAdapter(m_itr->value());
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -694,6 +709,11 @@ inline bool BoostJsonFrozenValue::equalTo(const Adapter &other, bool strict) con
     return BoostJsonAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t BoostJsonFrozenValue::hash() const
+{
+    return BoostJsonAdapter(m_value).hash();
+}
+
 inline BoostJsonArrayValueIterator BoostJsonArray::begin() const
 {
     return m_value.cbegin();
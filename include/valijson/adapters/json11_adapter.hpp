@@ -31,6 +31,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -193,6 +194,18 @@ public:
         return m_value.object_items().size();
     }
 
+    /**
+     * @brief   Members are iterated in sorted order, with unique names
+     *
+     * Json11 stores object members in a std::map.
+     *
+     * @see ObjectMembersSorted
+     */
+    static bool hasSortedMembers()
+    {
+        return true;
+    }
+
 private:
 
     /**
@@ -238,6 +251,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored Json11 value
@@ -616,6 +631,18 @@ public:
         return DerefProxy<Json11ObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->first);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    Json11Adapter value() const
+    {
+        return Json11Adapter(m_itr->second);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -681,6 +708,11 @@ inline bool Json11FrozenValue::equalTo(const Adapter &other, bool strict) const
     return Json11Adapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t Json11FrozenValue::hash() const
+{
+    return Json11Adapter(m_value).hash();
+}
+
 inline Json11ArrayValueIterator Json11Array::begin() const
 {
     return m_value.array_items().begin();
@@ -0,0 +1,690 @@
+/**
+ * @file
+ *
+ * @brief   Adapter implementation for valijson's own JsonTape parser.
+ *
+ * Include this file in your program to enable support for JsonTape, a
+ * read-only JSON representation that is built over the original text. See
+ * json_tape.hpp for details.
+ *
+ * This file defines the following classes (not in this order):
+ *  - JsonTapeAdapter
+ *  - JsonTapeArray
+ *  - JsonTapeArrayValueIterator
+ *  - JsonTapeFrozenValue
+ *  - JsonTapeObject
+ *  - JsonTapeObjectMember
+ *  - JsonTapeObjectMemberIterator
+ *  - JsonTapeValue
+ *
+ * Due to the dependencies that exist between these classes, the ordering of
+ * class declarations and definitions may be a bit confusing. The best place to
+ * start is JsonTapeAdapter. This class definition is actually very small,
+ * since most of the functionality is inherited from the BasicAdapter class.
+ * Most of the classes in this file are provided as template arguments to the
+ * inherited BasicAdapter class.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <valijson/internal/adapter.hpp>
+#include <valijson/internal/basic_adapter.hpp>
+#include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
+#include <valijson/exceptions.hpp>
+#include <valijson/json_tape.hpp>
+
+namespace valijson {
+namespace adapters {
+
+class JsonTapeAdapter;
+class JsonTapeArrayValueIterator;
+class JsonTapeObjectMemberIterator;
+
+typedef std::pair<std::string, JsonTapeAdapter> JsonTapeObjectMember;
+
+namespace detail {
+
+/// Return a reference to a JsonTape containing an empty object
+inline const JsonTape & emptyObjectTape()
+{
+    static const JsonTape tape = []() {
+        JsonTape t;
+        t.parse(std::string("{}"));
+        return t;
+    }();
+
+    return tape;
+}
+
+/// Return a reference to a JsonTape containing an empty array
+inline const JsonTape & emptyArrayTape()
+{
+    static const JsonTape tape = []() {
+        JsonTape t;
+        t.parse(std::string("[]"));
+        return t;
+    }();
+
+    return tape;
+}
+
+}  // namespace detail
+
+/**
+ * @brief  Light weight wrapper for a JsonTape array value.
+ *
+ * An instance of this class contains a pointer to a tape and the index of an
+ * array entry, so there is very little overhead associated with copy
+ * construction and passing by value.
+ */
+class JsonTapeArray
+{
+public:
+
+    typedef JsonTapeArrayValueIterator const_iterator;
+    typedef JsonTapeArrayValueIterator iterator;
+
+    /// Construct a JsonTapeArray referencing an empty array.
+    JsonTapeArray()
+      : m_tape(&detail::emptyArrayTape()),
+        m_index(0) { }
+
+    /**
+     * @brief   Construct a JsonTapeArray referencing an entry in a tape.
+     *
+     * @param   tape   tape containing the array
+     * @param   index  index of the array entry
+     *
+     * Note that this constructor will throw an exception if the entry is not
+     * an array.
+     */
+    JsonTapeArray(const JsonTape &tape, uint32_t index)
+      : m_tape(&tape),
+        m_index(index)
+    {
+        if (tape.entry(index).type != JsonTape::kArray) {
+            throwRuntimeError("Value is not an array.");
+        }
+    }
+
+    /// Return an iterator for the first element of the array.
+    JsonTapeArrayValueIterator begin() const;
+
+    /// Return an iterator for one-past the last element of the array.
+    JsonTapeArrayValueIterator end() const;
+
+    /// Return the number of elements in the array
+    size_t size() const
+    {
+        return m_tape->entry(m_index).size;
+    }
+
+private:
+
+    /// Tape containing the array
+    const JsonTape *m_tape;
+
+    /// Index of the array entry
+    uint32_t m_index;
+};
+
+/**
+ * @brief  Light weight wrapper for a JsonTape object.
+ *
+ * An instance of this class contains a pointer to a tape and the index of an
+ * object entry, so there is very little overhead associated with copy
+ * construction and passing by value.
+ */
+class JsonTapeObject
+{
+public:
+
+    typedef JsonTapeObjectMemberIterator const_iterator;
+    typedef JsonTapeObjectMemberIterator iterator;
+
+    /// Construct a JsonTapeObject referencing an empty object singleton.
+    JsonTapeObject()
+      : m_tape(&detail::emptyObjectTape()),
+        m_index(0) { }
+
+    /**
+     * @brief   Construct a JsonTapeObject referencing an entry in a tape.
+     *
+     * @param   tape   tape containing the object
+     * @param   index  index of the object entry
+     *
+     * Note that this constructor will throw an exception if the entry is not
+     * an object.
+     */
+    JsonTapeObject(const JsonTape &tape, uint32_t index)
+      : m_tape(&tape),
+        m_index(index)
+    {
+        if (tape.entry(index).type != JsonTape::kObject) {
+            throwRuntimeError("Value is not an object.");
+        }
+    }
+
+    /// Return an iterator for the first object member
+    JsonTapeObjectMemberIterator begin() const;
+
+    /// Return an iterator for one-past the last object member
+    JsonTapeObjectMemberIterator end() const;
+
+    /**
+     * @brief   Return an iterator for the object member with the specified
+     *          property name.
+     *
+     * Keys are compared by hash before their lengths and contents are
+     * compared. If an object member with the specified name does not exist,
+     * the iterator returned will be the same as the iterator returned by the
+     * end() function.
+     *
+     * @param   propertyName  property name to search for
+     */
+    JsonTapeObjectMemberIterator find(const std::string &propertyName) const;
+
+    /// Returns the number of members belonging to this object.
+    size_t size() const
+    {
+        return m_tape->entry(m_index).size;
+    }
+
+private:
+
+    /// Tape containing the object
+    const JsonTape *m_tape;
+
+    /// Index of the object entry
+    uint32_t m_index;
+};
+
+/**
+ * @brief   Stores an independent copy of a JsonTape value.
+ *
+ * The value and its descendants are copied into a new tape, along with any
+ * strings that they reference, so that the copy does not depend on the
+ * original text.
+ *
+ * @see FrozenValue
+ */
+class JsonTapeFrozenValue: public FrozenValue
+{
+public:
+
+    /**
+     * @brief  Make a copy of a JsonTape value
+     *
+     * @param  tape   tape containing the value to be copied
+     * @param  index  index of the value
+     */
+    JsonTapeFrozenValue(const JsonTape &tape, uint32_t index)
+      : m_tape(tape.copyValue(index)) { }
+
+    FrozenValue * clone() const override
+    {
+        return new JsonTapeFrozenValue(m_tape, 0);
+    }
+
+    bool equalTo(const Adapter &other, bool strict) const override;
+
+    uint64_t hash() const override;
+
+private:
+
+    /// Self-contained tape, with the stored value at index zero
+    JsonTape m_tape;
+};
+
+/**
+ * @brief   Light weight wrapper for a JsonTape value.
+ *
+ * This class is passed as an argument to the BasicAdapter template class,
+ * and is used to provide access to a JsonTape value. This class is
+ * responsible for the mechanics of actually reading a JsonTape value, whereas
+ * the BasicAdapter class is responsible for the semantics of type comparisons
+ * and conversions.
+ *
+ * The functions that need to be provided by this class are defined implicitly
+ * by the implementation of the BasicAdapter template class.
+ *
+ * @see BasicAdapter
+ */
+class JsonTapeValue
+{
+public:
+
+    /// Construct a wrapper for the empty object singleton
+    JsonTapeValue()
+      : m_tape(&detail::emptyObjectTape()),
+        m_index(0) { }
+
+    /// Construct a wrapper for the root value of a tape
+    JsonTapeValue(const JsonTape &tape)
+      : m_tape(&tape),
+        m_index(0)
+    {
+        if (!tape.isValid()) {
+            throwRuntimeError("JsonTape does not contain a document.");
+        }
+    }
+
+    /// Construct a wrapper for a specific entry in a tape
+    JsonTapeValue(const JsonTape &tape, uint32_t index)
+      : m_tape(&tape),
+        m_index(index) { }
+
+    /**
+     * @brief   Create a new JsonTapeFrozenValue instance that contains the
+     *          value referenced by this JsonTapeValue instance.
+     *
+     * @returns pointer to a new JsonTapeFrozenValue instance, belonging to the
+     *          caller.
+     */
+    FrozenValue * freeze() const
+    {
+        return new JsonTapeFrozenValue(*m_tape, m_index);
+    }
+
+    opt::optional<JsonTapeArray> getArrayOptional() const
+    {
+        if (isArray()) {
+            return opt::make_optional(JsonTapeArray(*m_tape, m_index));
+        }
+
+        return {};
+    }
+
+    bool getArraySize(size_t &result) const
+    {
+        if (isArray()) {
+            result = entry().size;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getBool(bool &result) const
+    {
+        if (isBool()) {
+            result = entry().type == JsonTape::kTrue;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getDouble(double &result) const
+    {
+        if (isDouble()) {
+            result = entry().number;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getInteger(int64_t &result) const
+    {
+        if (isInteger()) {
+            result = entry().integer;
+            return true;
+        }
+
+        return false;
+    }
+
+    opt::optional<JsonTapeObject> getObjectOptional() const
+    {
+        if (isObject()) {
+            return opt::make_optional(JsonTapeObject(*m_tape, m_index));
+        }
+
+        return {};
+    }
+
+    bool getObjectSize(size_t &result) const
+    {
+        if (isObject()) {
+            result = entry().size;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getString(std::string &result) const
+    {
+        if (isString()) {
+            const JsonTape::Entry &e = entry();
+            result.assign(m_tape->stringData(e), e.size);
+            return true;
+        }
+
+        return false;
+    }
+
+    static bool hasStrictTypes()
+    {
+        return true;
+    }
+
+    bool isArray() const
+    {
+        return entry().type == JsonTape::kArray;
+    }
+
+    bool isBool() const
+    {
+        return entry().type == JsonTape::kTrue || entry().type == JsonTape::kFalse;
+    }
+
+    bool isDouble() const
+    {
+        return entry().type == JsonTape::kDouble;
+    }
+
+    bool isInteger() const
+    {
+        return entry().type == JsonTape::kInteger;
+    }
+
+    bool isNull() const
+    {
+        return entry().type == JsonTape::kNull;
+    }
+
+    bool isNumber() const
+    {
+        return isInteger() || isDouble();
+    }
+
+    bool isObject() const
+    {
+        return entry().type == JsonTape::kObject;
+    }
+
+    bool isString() const
+    {
+        return entry().type == JsonTape::kString;
+    }
+
+private:
+
+    const JsonTape::Entry & entry() const
+    {
+        return m_tape->entry(m_index);
+    }
+
+    /// Tape containing the value
+    const JsonTape *m_tape;
+
+    /// Index of the value's entry
+    uint32_t m_index;
+};
+
+/**
+ * @brief   An implementation of the Adapter interface supporting JsonTape.
+ *
+ * This class is defined in terms of the BasicAdapter template class, which
+ * helps to ensure that all of the Adapter implementations behave consistently.
+ *
+ * @see Adapter
+ * @see BasicAdapter
+ */
+class JsonTapeAdapter:
+    public BasicAdapter<JsonTapeAdapter,
+                        JsonTapeArray,
+                        JsonTapeObjectMember,
+                        JsonTapeObject,
+                        JsonTapeValue>
+{
+public:
+
+    /// Construct a JsonTapeAdapter that contains an empty object
+    JsonTapeAdapter()
+      : BasicAdapter() { }
+
+    /// Construct a JsonTapeAdapter for the root value of a tape
+    JsonTapeAdapter(const JsonTape &tape)
+      : BasicAdapter(JsonTapeValue(tape)) { }
+
+    /// Construct a JsonTapeAdapter for a specific entry in a tape
+    JsonTapeAdapter(const JsonTape &tape, uint32_t index)
+      : BasicAdapter(JsonTapeValue(tape, index)) { }
+};
+
+/**
+ * @brief   Class for iterating over values held in a JSON array.
+ *
+ * This class provides a JSON array iterator that dereferences as an instance of
+ * JsonTapeAdapter representing a value stored in the array. Moving to the next
+ * element skips over any descendants of the current element in constant time.
+ *
+ * @see JsonTapeArray
+ */
+class JsonTapeArrayValueIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = JsonTapeAdapter;
+    using difference_type = JsonTapeAdapter;
+    using pointer = JsonTapeAdapter*;
+    using reference = JsonTapeAdapter&;
+
+    /**
+     * @brief   Construct a new JsonTapeArrayValueIterator.
+     *
+     * @param   tape   tape containing the array
+     * @param   index  index of the current element, or of the first entry
+     *                 after the array for the end iterator
+     */
+    JsonTapeArrayValueIterator(const JsonTape &tape, uint32_t index)
+      : m_tape(&tape),
+        m_index(index) { }
+
+    /// Returns a JsonTapeAdapter that contains the value of the current
+    /// element.
+    JsonTapeAdapter operator*() const
+    {
+        return JsonTapeAdapter(*m_tape, m_index);
+    }
+
+    DerefProxy<JsonTapeAdapter> operator->() const
+    {
+        return DerefProxy<JsonTapeAdapter>(**this);
+    }
+
+    bool operator==(const JsonTapeArrayValueIterator &other) const
+    {
+        return m_index == other.m_index;
+    }
+
+    bool operator!=(const JsonTapeArrayValueIterator &other) const
+    {
+        return !(m_index == other.m_index);
+    }
+
+    const JsonTapeArrayValueIterator& operator++()
+    {
+        m_index = m_tape->next(m_index);
+
+        return *this;
+    }
+
+    JsonTapeArrayValueIterator operator++(int)
+    {
+        JsonTapeArrayValueIterator iterator_pre(*m_tape, m_index);
+        ++(*this);
+        return iterator_pre;
+    }
+
+    void advance(std::ptrdiff_t n)
+    {
+        for (; n > 0; n--) {
+            ++(*this);
+        }
+    }
+
+private:
+
+    /// Tape containing the array
+    const JsonTape *m_tape;
+
+    /// Index of the current element
+    uint32_t m_index;
+};
+
+/**
+ * @brief   Class for iterating over the members belonging to a JSON object.
+ *
+ * This class provides a JSON object iterator that dereferences as an instance
+ * of JsonTapeObjectMember representing one of the members of the object.
+ *
+ * @see JsonTapeObject
+ * @see JsonTapeObjectMember
+ */
+class JsonTapeObjectMemberIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = JsonTapeObjectMember;
+    using difference_type = JsonTapeObjectMember;
+    using pointer = JsonTapeObjectMember*;
+    using reference = JsonTapeObjectMember&;
+
+    /**
+     * @brief   Construct a new JsonTapeObjectMemberIterator.
+     *
+     * @param   tape   tape containing the object
+     * @param   index  index of the current member's key, or of the first entry
+     *                 after the object for the end iterator
+     */
+    JsonTapeObjectMemberIterator(const JsonTape &tape, uint32_t index)
+      : m_tape(&tape),
+        m_index(index) { }
+
+    /**
+     * @brief   Returns a JsonTapeObjectMember that contains the key and value
+     *          belonging to the object member identified by the iterator.
+     */
+    JsonTapeObjectMember operator*() const
+    {
+        const JsonTape::Entry &key = m_tape->entry(m_index);
+        return JsonTapeObjectMember(std::string(m_tape->stringData(key), key.size),
+                JsonTapeAdapter(*m_tape, m_index + 1));
+    }
+
+    DerefProxy<JsonTapeObjectMember> operator->() const
+    {
+        return DerefProxy<JsonTapeObjectMember>(**this);
+    }
+
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        const JsonTape::Entry &name = m_tape->entry(m_index);
+        return ObjectMemberKey(m_tape->stringData(name), name.size);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    JsonTapeAdapter value() const
+    {
+        return JsonTapeAdapter(*m_tape, m_index + 1);
+    }
+
+    bool operator==(const JsonTapeObjectMemberIterator &other) const
+    {
+        return m_index == other.m_index;
+    }
+
+    bool operator!=(const JsonTapeObjectMemberIterator &other) const
+    {
+        return !(m_index == other.m_index);
+    }
+
+    const JsonTapeObjectMemberIterator& operator++()
+    {
+        m_index = m_tape->next(m_index + 1);
+
+        return *this;
+    }
+
+    JsonTapeObjectMemberIterator operator++(int)
+    {
+        JsonTapeObjectMemberIterator iterator_pre(*m_tape, m_index);
+        ++(*this);
+        return iterator_pre;
+    }
+
+private:
+
+    /// Tape containing the object
+    const JsonTape *m_tape;
+
+    /// Index of the current member's key
+    uint32_t m_index;
+};
+
+/// Specialisation of the AdapterTraits template struct for JsonTapeAdapter.
+template<>
+struct AdapterTraits<valijson::adapters::JsonTapeAdapter>
+{
+    typedef JsonTape DocumentType;
+
+    static std::string adapterName()
+    {
+        return "JsonTapeAdapter";
+    }
+};
+
+inline bool JsonTapeFrozenValue::equalTo(const Adapter &other, bool strict) const
+{
+    return JsonTapeAdapter(m_tape, 0).equalTo(other, strict);
+}
+
+inline uint64_t JsonTapeFrozenValue::hash() const
+{
+    return JsonTapeAdapter(m_tape, 0).hash();
+}
+
+inline JsonTapeArrayValueIterator JsonTapeArray::begin() const
+{
+    return JsonTapeArrayValueIterator(*m_tape, m_index + 1);
+}
+
+inline JsonTapeArrayValueIterator JsonTapeArray::end() const
+{
+    return JsonTapeArrayValueIterator(*m_tape, m_tape->next(m_index));
+}
+
+inline JsonTapeObjectMemberIterator JsonTapeObject::begin() const
+{
+    return JsonTapeObjectMemberIterator(*m_tape, m_index + 1);
+}
+
+inline JsonTapeObjectMemberIterator JsonTapeObject::end() const
+{
+    return JsonTapeObjectMemberIterator(*m_tape, m_tape->next(m_index));
+}
+
+inline JsonTapeObjectMemberIterator JsonTapeObject::find(
+    const std::string &propertyName) const
+{
+    const uint32_t hash = JsonTape::hashString(propertyName.data(), propertyName.size());
+    const uint32_t last = m_tape->next(m_index);
+    for (uint32_t key = m_index + 1; key < last; key = m_tape->next(key + 1)) {
+        if (m_tape->stringEquals(key, propertyName.data(), propertyName.size(), hash)) {
+            return JsonTapeObjectMemberIterator(*m_tape, key);
+        }
+    }
+
+    return end();
+}
+
+}  // namespace adapters
+}  // namespace valijson
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <iterator>
@@ -34,6 +35,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -181,6 +183,16 @@ public:
     /**
      * @brief   Return an iterator for a member/property with the given name
      *
+     * The member is found using JsonCpp's map lookup, and the iterator keeps
+     * a copy of propertyName, so the string may be destroyed once find() has
+     * returned.
+     *
+     * JsonCpp cannot convert the result of a lookup into one of its own
+     * iterators, so incrementing or decrementing the iterator returned by
+     * this function first scans the object to locate the member. Validation
+     * only compares and dereferences these iterators, so it never pays for
+     * the scan.
+     *
      * @param   propertyName   Property name
      *
      * @returns a valid iterator if found, or an invalid iterator if not found
@@ -193,6 +205,18 @@ public:
         return m_value.size();
     }
 
+    /**
+     * @brief   Members are iterated in sorted order, with unique names
+     *
+     * JsonCpp stores object members in a std::map.
+     *
+     * @see ObjectMembersSorted
+     */
+    static bool hasSortedMembers()
+    {
+        return true;
+    }
+
 private:
 
     /// Return a reference to an empty JsonCpp object
@@ -234,6 +258,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored JsonCpp value
@@ -604,7 +630,31 @@ public:
      * @param   itr  JsonCpp iterator to store
      */
     JsonCppObjectMemberIterator(const Json::ValueConstIterator &itr)
-      : m_itr(itr) { }
+      : m_itr(itr),
+        m_found(nullptr) { }
+
+    /**
+     * @brief   Construct an iterator for a member that has been found using a
+     *          map lookup, rather than by iterating over the object.
+     *
+     * JsonCpp does not provide a way to convert the result of a map lookup to
+     * an iterator, so the iterator stores the member directly. If it is moved
+     * to another member, the underlying JsonCpp iterator is located first.
+     *
+     * The name is copied, because the string passed to JsonCppObject::find()
+     * is often a temporary that does not outlive the iterator.
+     *
+     * @param   name   name of the member
+     * @param   value  value of the member
+     * @param   begin  iterator for the first member of the object
+     * @param   end    iterator for one-past the last member of the object
+     */
+    JsonCppObjectMemberIterator(const std::string &name, const Json::Value &value,
+            const Json::ValueConstIterator &begin, const Json::ValueConstIterator &end)
+      : m_itr(end),
+        m_begin(begin),
+        m_found(&value),
+        m_name(name) { }
 
     /**
      * @brief   Returns a JsonCppObjectMember that contains the key and value
@@ -612,7 +662,11 @@ public:
      */
     JsonCppObjectMember operator*() const
     {
-        return JsonCppObjectMember(m_itr.key().asString(), *m_itr);
+        if (m_found) {
+            return JsonCppObjectMember(m_name, *m_found);
+        }
+
+        return JsonCppObjectMember(m_itr.name(), *m_itr);
     }
 
     DerefProxy<JsonCppObjectMember> operator->() const
@@ -620,6 +674,24 @@ public:
         return DerefProxy<JsonCppObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        if (m_found) {
+            return ObjectMemberKey(m_name.data(), m_name.size());
+        }
+
+        const char *nameEnd = nullptr;
+        const char *nameBegin = m_itr.memberName(&nameEnd);
+        return ObjectMemberKey(nameBegin, static_cast<size_t>(nameEnd - nameBegin));
+    }
+
+    /// Returns an Adapter for the value of the current member
+    JsonCppAdapter value() const
+    {
+        return JsonCppAdapter(m_found ? *m_found : *m_itr);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -633,16 +705,26 @@ public:
      */
     bool operator==(const JsonCppObjectMemberIterator &rhs) const
     {
+        if (m_found && rhs.m_found) {
+            return m_found == rhs.m_found;
+        } else if (m_found) {
+            // m_itr holds the end iterator for the object
+            return rhs.m_itr != m_itr && &*rhs.m_itr == m_found;
+        } else if (rhs.m_found) {
+            return rhs == *this;
+        }
+
         return m_itr == rhs.m_itr;
     }
 
     bool operator!=(const JsonCppObjectMemberIterator &rhs) const
     {
-        return !(m_itr == rhs.m_itr);
+        return !(*this == rhs);
     }
 
     const JsonCppObjectMemberIterator& operator++()
     {
+        locate();
         m_itr++;
 
         return *this;
@@ -650,13 +732,14 @@ public:
 
     JsonCppObjectMemberIterator operator++(int)
     {
-        JsonCppObjectMemberIterator iterator_pre(m_itr);
+        JsonCppObjectMemberIterator iterator_pre(*this);
         ++(*this);
         return iterator_pre;
     }
 
     JsonCppObjectMemberIterator operator--()
     {
+        locate();
         m_itr--;
 
         return *this;
@@ -664,8 +747,41 @@ public:
 
 private:
 
-    /// Internal copy of the original JsonCpp iterator
+    /// Convert an iterator for a found member to an underlying JsonCpp
+    /// iterator, by comparing the names of members without copying them.
+    /// This is a linear scan, and is only needed when the iterator is moved.
+    void locate()
+    {
+        if (!m_found) {
+            return;
+        }
+
+        const Json::ValueConstIterator end = m_itr;
+        for (m_itr = m_begin; m_itr != end; ++m_itr) {
+            const char *nameEnd = nullptr;
+            const char *nameBegin = m_itr.memberName(&nameEnd);
+            if (static_cast<size_t>(nameEnd - nameBegin) == m_name.size() &&
+                    std::equal(nameBegin, nameEnd, m_name.begin())) {
+                break;
+            }
+        }
+
+        m_found = nullptr;
+        m_name.clear();
+    }
+
+    /// Internal copy of the original JsonCpp iterator, or the end iterator
+    /// for an iterator that stores a found member
     Json::ValueConstIterator m_itr;
+
+    /// Iterator for the first member of the object, used by locate()
+    Json::ValueConstIterator m_begin;
+
+    /// Value of a member found using a map lookup, or nullptr
+    const Json::Value *m_found;
+
+    /// Name of a member found using a map lookup
+    std::string m_name;
 };
 
 /// Specialisation of the AdapterTraits template struct for JsonCppAdapter.
@@ -685,6 +801,11 @@ inline bool JsonCppFrozenValue::equalTo(const Adapter &other, bool strict) const
     return JsonCppAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t JsonCppFrozenValue::hash() const
+{
+    return JsonCppAdapter(m_value).hash();
+}
+
 inline JsonCppArrayValueIterator JsonCppArray::begin() const
 {
     return m_value.begin();
@@ -708,13 +829,11 @@ inline JsonCppObjectMemberIterator JsonCppObject::end() const
 inline JsonCppObjectMemberIterator JsonCppObject::find(
     const std::string &propertyName) const
 {
-    if (m_value.isMember(propertyName)) {
-        Json::ValueConstIterator itr;
-        for (itr = m_value.begin(); itr != m_value.end(); ++itr) {
-            if (itr.key() == propertyName) {
-                return itr;
-            }
-        }
+    const char *nameBegin = propertyName.data();
+    const char *nameEnd = nameBegin + propertyName.size();
+    const Json::Value *value = m_value.find(nameBegin, nameEnd);
+    if (value) {
+        return JsonCppObjectMemberIterator(propertyName, *value, m_value.begin(), m_value.end());
     }
 
     return m_value.end();
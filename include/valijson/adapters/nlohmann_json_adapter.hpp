@@ -31,6 +31,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 #include <utility>
 
@@ -178,6 +179,18 @@ template <class ValueType> class NlohmannJsonObjectMemberIterator
         return DerefProxy<ValueType>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr.key());
+    }
+
+    /// Returns an Adapter for the value of the current member
+    typename ValueType::second_type value() const
+    {
+        return typename ValueType::second_type(m_itr.value());
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -384,6 +397,18 @@ public:
         return m_value.size();
     }
 
+    /**
+     * @brief   Members are iterated in sorted order, with unique names
+     *
+     * nlohmann::json stores object members in a std::map.
+     *
+     * @see ObjectMembersSorted
+     */
+    static bool hasSortedMembers()
+    {
+        return true;
+    }
+
 private:
 
     /**
@@ -430,6 +455,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored NlohmannJson value
@@ -700,6 +727,11 @@ inline bool NlohmannJsonFrozenValue::equalTo(const Adapter &other, bool strict)
     return NlohmannJsonAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t NlohmannJsonFrozenValue::hash() const
+{
+    return NlohmannJsonAdapter(m_value).hash();
+}
+
 
 inline NlohmannJsonObjectMemberIterator<NlohmannJsonObjectMember>
 NlohmannJsonObject::begin() const
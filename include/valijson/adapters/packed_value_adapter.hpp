@@ -0,0 +1,697 @@
+/**
+ * @file
+ *
+ * @brief   Adapter implementation for values held by a PackedValueStore.
+ *
+ * A PackedValueStore holds compact, adapter-independent copies of JSON values.
+ * It is used to store the values of 'const' and 'enum' constraints, and is
+ * described in more detail in internal/packed_value_store.hpp.
+ *
+ * This file defines the following classes (not in this order):
+ *  - PackedAdapter
+ *  - PackedArray
+ *  - PackedArrayValueIterator
+ *  - PackedFrozenValue
+ *  - PackedObject
+ *  - PackedObjectMember
+ *  - PackedObjectMemberIterator
+ *  - PackedValue
+ *
+ * Due to the dependencies that exist between these classes, the ordering of
+ * class declarations and definitions may be a bit confusing. The best place to
+ * start is PackedAdapter. This class definition is actually very small,
+ * since most of the functionality is inherited from the BasicAdapter class.
+ * Most of the classes in this file are provided as template arguments to the
+ * inherited BasicAdapter class.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <valijson/internal/adapter.hpp>
+#include <valijson/internal/basic_adapter.hpp>
+#include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
+#include <valijson/internal/packed_value_store.hpp>
+#include <valijson/exceptions.hpp>
+
+namespace valijson {
+namespace adapters {
+
+class PackedAdapter;
+class PackedArrayValueIterator;
+class PackedObjectMemberIterator;
+
+typedef std::pair<std::string, PackedAdapter> PackedObjectMember;
+
+/**
+ * @brief  Light weight wrapper for an array in a PackedValueStore.
+ *
+ * An instance of this class contains a pointer to a store and the index of an
+ * array node, so there is very little overhead associated with copy
+ * construction and passing by value.
+ */
+class PackedArray
+{
+public:
+
+    typedef PackedArrayValueIterator const_iterator;
+    typedef PackedArrayValueIterator iterator;
+
+    /// Construct a PackedArray referencing an empty array.
+    PackedArray()
+      : m_store(&PackedValueStore::emptyValues()),
+        m_index(1) { }
+
+    /**
+     * @brief   Construct a PackedArray referencing a node in a store.
+     *
+     * @param   store  store containing the array
+     * @param   index  index of the array node
+     *
+     * Note that this constructor will throw an exception if the node is not
+     * an array.
+     */
+    PackedArray(const PackedValueStore &store, uint32_t index)
+      : m_store(&store),
+        m_index(index)
+    {
+        if (store.node(index).type != PackedValueStore::kArray) {
+            throwRuntimeError("Value is not an array.");
+        }
+    }
+
+    /// Return an iterator for the first element of the array.
+    PackedArrayValueIterator begin() const;
+
+    /// Return an iterator for one-past the last element of the array.
+    PackedArrayValueIterator end() const;
+
+    /// Return the number of elements in the array
+    size_t size() const
+    {
+        return m_store->node(m_index).size;
+    }
+
+private:
+
+    /// Store containing the array
+    const PackedValueStore *m_store;
+
+    /// Index of the array node
+    uint32_t m_index;
+};
+
+/**
+ * @brief  Light weight wrapper for an object in a PackedValueStore.
+ *
+ * An instance of this class contains a pointer to a store and the index of an
+ * object node, so there is very little overhead associated with copy
+ * construction and passing by value. Members are iterated in order of
+ * property name.
+ */
+class PackedObject
+{
+public:
+
+    typedef PackedObjectMemberIterator const_iterator;
+    typedef PackedObjectMemberIterator iterator;
+
+    /// Construct a PackedObject referencing an empty object singleton.
+    PackedObject()
+      : m_store(&PackedValueStore::emptyValues()),
+        m_index(0) { }
+
+    /**
+     * @brief   Construct a PackedObject referencing a node in a store.
+     *
+     * @param   store  store containing the object
+     * @param   index  index of the object node
+     *
+     * Note that this constructor will throw an exception if the node is not
+     * an object.
+     */
+    PackedObject(const PackedValueStore &store, uint32_t index)
+      : m_store(&store),
+        m_index(index)
+    {
+        if (store.node(index).type != PackedValueStore::kObject) {
+            throwRuntimeError("Value is not an object.");
+        }
+    }
+
+    /// Return an iterator for the first object member
+    PackedObjectMemberIterator begin() const;
+
+    /// Return an iterator for one-past the last object member
+    PackedObjectMemberIterator end() const;
+
+    /**
+     * @brief   Return an iterator for the object member with the specified
+     *          property name.
+     *
+     * Property names are sorted, so this performs a binary search. If an
+     * object member with the specified name does not exist, the iterator
+     * returned will be the same as the iterator returned by the end()
+     * function.
+     *
+     * @param   propertyName  property name to search for
+     */
+    PackedObjectMemberIterator find(const std::string &propertyName) const;
+
+    /// Returns the number of members belonging to this object.
+    size_t size() const
+    {
+        return m_store->node(m_index).size;
+    }
+
+private:
+
+    /// Store containing the object
+    const PackedValueStore *m_store;
+
+    /// Index of the object node
+    uint32_t m_index;
+};
+
+/**
+ * @brief   Stores a compact, adapter-independent copy of a JSON value.
+ *
+ * A PackedFrozenValue either owns a PackedValueStore that contains just its
+ * own value, or refers to a value in a store that is owned by something else,
+ * such as an EnumConstraint. The structural hash of the value is computed
+ * once, when the value is stored.
+ *
+ * @see FrozenValue
+ * @see PackedValueStore
+ */
+class PackedFrozenValue: public FrozenValue
+{
+public:
+
+    /**
+     * @brief  Make a compact copy of the value held by an Adapter
+     *
+     * @param  source  Adapter containing the value to be copied
+     */
+    explicit PackedFrozenValue(const Adapter &source);
+
+    /**
+     * @brief  Refer to a value in a store, without copying it
+     *
+     * @param  store  store containing the value, which must outlive this
+     *                object
+     * @param  index  index of the value's root node
+     * @param  hash   structural hash of the value
+     */
+    PackedFrozenValue(const PackedValueStore &store, uint32_t index, uint64_t hash)
+      : m_store(&store),
+        m_index(index),
+        m_hash(hash) { }
+
+    /**
+     * @brief  Clone the stored value
+     *
+     * Clones of a value that owns its store share that store, since it can
+     * no longer be modified. Values in stores owned by something else are
+     * copied.
+     */
+    FrozenValue * clone() const override;
+
+    bool equalTo(const Adapter &other, bool strict) const override;
+
+    uint64_t hash() const override
+    {
+        return m_hash;
+    }
+
+private:
+
+    PackedFrozenValue(std::shared_ptr<const PackedValueStore> store, uint32_t index, uint64_t hash)
+      : m_owned(std::move(store)),
+        m_store(m_owned.get()),
+        m_index(index),
+        m_hash(hash) { }
+
+    /// Store that belongs to this value and its clones, if any
+    std::shared_ptr<const PackedValueStore> m_owned;
+
+    /// Store containing the value
+    const PackedValueStore *m_store;
+
+    /// Index of the value's root node
+    uint32_t m_index;
+
+    /// Structural hash of the value
+    uint64_t m_hash;
+};
+
+/**
+ * @brief   Light weight wrapper for a value in a PackedValueStore.
+ *
+ * This class is passed as an argument to the BasicAdapter template class,
+ * and is used to provide access to a packed value. This class is responsible
+ * for the mechanics of actually reading a packed value, whereas the
+ * BasicAdapter class is responsible for the semantics of type comparisons
+ * and conversions.
+ *
+ * The functions that need to be provided by this class are defined implicitly
+ * by the implementation of the BasicAdapter template class.
+ *
+ * @see BasicAdapter
+ */
+class PackedValue
+{
+public:
+
+    /// Construct a wrapper for the empty object singleton
+    PackedValue()
+      : m_store(&PackedValueStore::emptyValues()),
+        m_index(0) { }
+
+    /// Construct a wrapper for a specific node in a store
+    PackedValue(const PackedValueStore &store, uint32_t index)
+      : m_store(&store),
+        m_index(index) { }
+
+    /**
+     * @brief   Create a new PackedFrozenValue instance that contains a copy of
+     *          the value referenced by this PackedValue instance.
+     *
+     * @returns pointer to a new PackedFrozenValue instance, belonging to the
+     *          caller.
+     */
+    FrozenValue * freeze() const;
+
+    opt::optional<PackedArray> getArrayOptional() const
+    {
+        if (isArray()) {
+            return opt::make_optional(PackedArray(*m_store, m_index));
+        }
+
+        return {};
+    }
+
+    bool getArraySize(size_t &result) const
+    {
+        if (isArray()) {
+            result = node().size;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getBool(bool &result) const
+    {
+        if (isBool()) {
+            result = node().type == PackedValueStore::kTrue;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getDouble(double &result) const
+    {
+        if (isDouble()) {
+            result = node().number;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getInteger(int64_t &result) const
+    {
+        if (isInteger()) {
+            result = node().integer;
+            return true;
+        }
+
+        return false;
+    }
+
+    opt::optional<PackedObject> getObjectOptional() const
+    {
+        if (isObject()) {
+            return opt::make_optional(PackedObject(*m_store, m_index));
+        }
+
+        return {};
+    }
+
+    bool getObjectSize(size_t &result) const
+    {
+        if (isObject()) {
+            result = node().size;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool getString(std::string &result) const
+    {
+        if (isString()) {
+            const PackedValueStore::Node &n = node();
+            result.assign(m_store->stringData(n), n.size);
+            return true;
+        }
+
+        return false;
+    }
+
+    static bool hasStrictTypes()
+    {
+        return true;
+    }
+
+    bool isArray() const
+    {
+        return node().type == PackedValueStore::kArray;
+    }
+
+    bool isBool() const
+    {
+        return node().type == PackedValueStore::kTrue || node().type == PackedValueStore::kFalse;
+    }
+
+    bool isDouble() const
+    {
+        return node().type == PackedValueStore::kDouble;
+    }
+
+    bool isInteger() const
+    {
+        return node().type == PackedValueStore::kInteger;
+    }
+
+    bool isNull() const
+    {
+        return node().type == PackedValueStore::kNull;
+    }
+
+    bool isNumber() const
+    {
+        return isInteger() || isDouble();
+    }
+
+    bool isObject() const
+    {
+        return node().type == PackedValueStore::kObject;
+    }
+
+    bool isString() const
+    {
+        return node().type == PackedValueStore::kString;
+    }
+
+private:
+
+    const PackedValueStore::Node & node() const
+    {
+        return m_store->node(m_index);
+    }
+
+    /// Store containing the value
+    const PackedValueStore *m_store;
+
+    /// Index of the value's node
+    uint32_t m_index;
+};
+
+/**
+ * @brief   An implementation of the Adapter interface supporting values held
+ *          by a PackedValueStore.
+ *
+ * This class is defined in terms of the BasicAdapter template class, which
+ * helps to ensure that all of the Adapter implementations behave consistently.
+ *
+ * @see Adapter
+ * @see BasicAdapter
+ */
+class PackedAdapter:
+    public BasicAdapter<PackedAdapter,
+                        PackedArray,
+                        PackedObjectMember,
+                        PackedObject,
+                        PackedValue>
+{
+public:
+
+    /// Construct a PackedAdapter that contains an empty object
+    PackedAdapter()
+      : BasicAdapter() { }
+
+    /// Construct a PackedAdapter for a specific node in a store
+    PackedAdapter(const PackedValueStore &store, uint32_t index)
+      : BasicAdapter(PackedValue(store, index)) { }
+};
+
+/**
+ * @brief   Class for iterating over values held in a packed array.
+ *
+ * This class provides a JSON array iterator that dereferences as an instance of
+ * PackedAdapter representing a value stored in the array. Moving to the next
+ * element skips over any descendants of the current element in constant time.
+ *
+ * @see PackedArray
+ */
+class PackedArrayValueIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PackedAdapter;
+    using difference_type = PackedAdapter;
+    using pointer = PackedAdapter*;
+    using reference = PackedAdapter&;
+
+    /**
+     * @brief   Construct a new PackedArrayValueIterator.
+     *
+     * @param   store  store containing the array
+     * @param   index  index of the current element, or of the first node
+     *                 after the array for the end iterator
+     */
+    PackedArrayValueIterator(const PackedValueStore &store, uint32_t index)
+      : m_store(&store),
+        m_index(index) { }
+
+    /// Returns a PackedAdapter that contains the value of the current
+    /// element.
+    PackedAdapter operator*() const
+    {
+        return PackedAdapter(*m_store, m_index);
+    }
+
+    DerefProxy<PackedAdapter> operator->() const
+    {
+        return DerefProxy<PackedAdapter>(**this);
+    }
+
+    bool operator==(const PackedArrayValueIterator &other) const
+    {
+        return m_index == other.m_index;
+    }
+
+    bool operator!=(const PackedArrayValueIterator &other) const
+    {
+        return !(m_index == other.m_index);
+    }
+
+    const PackedArrayValueIterator& operator++()
+    {
+        m_index = m_store->next(m_index);
+
+        return *this;
+    }
+
+    PackedArrayValueIterator operator++(int)
+    {
+        PackedArrayValueIterator iterator_pre(*m_store, m_index);
+        ++(*this);
+        return iterator_pre;
+    }
+
+    void advance(std::ptrdiff_t n)
+    {
+        for (; n > 0; n--) {
+            ++(*this);
+        }
+    }
+
+private:
+
+    /// Store containing the array
+    const PackedValueStore *m_store;
+
+    /// Index of the current element
+    uint32_t m_index;
+};
+
+/**
+ * @brief   Class for iterating over the members belonging to a packed object.
+ *
+ * This class provides a JSON object iterator that dereferences as an instance
+ * of PackedObjectMember representing one of the members of the object.
+ *
+ * @see PackedObject
+ * @see PackedObjectMember
+ */
+class PackedObjectMemberIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PackedObjectMember;
+    using difference_type = PackedObjectMember;
+    using pointer = PackedObjectMember*;
+    using reference = PackedObjectMember&;
+
+    /**
+     * @brief   Construct a new PackedObjectMemberIterator.
+     *
+     * @param   store  store containing the object
+     * @param   index  index of the current member's key node, or of the node
+     *                 after the last key node for the end iterator
+     */
+    PackedObjectMemberIterator(const PackedValueStore &store, uint32_t index)
+      : m_store(&store),
+        m_index(index) { }
+
+    /**
+     * @brief   Returns a PackedObjectMember that contains the key and value
+     *          belonging to the object member identified by the iterator.
+     */
+    PackedObjectMember operator*() const
+    {
+        const PackedValueStore::Node &key = m_store->node(m_index);
+        return PackedObjectMember(std::string(m_store->stringData(key), key.size),
+                PackedAdapter(*m_store, key.string.value));
+    }
+
+    DerefProxy<PackedObjectMember> operator->() const
+    {
+        return DerefProxy<PackedObjectMember>(**this);
+    }
+
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        const PackedValueStore::Node &name = m_store->node(m_index);
+        return ObjectMemberKey(m_store->stringData(name), name.size);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    PackedAdapter value() const
+    {
+        return PackedAdapter(*m_store, m_store->node(m_index).string.value);
+    }
+
+    bool operator==(const PackedObjectMemberIterator &other) const
+    {
+        return m_index == other.m_index;
+    }
+
+    bool operator!=(const PackedObjectMemberIterator &other) const
+    {
+        return !(m_index == other.m_index);
+    }
+
+    const PackedObjectMemberIterator& operator++()
+    {
+        m_index++;
+
+        return *this;
+    }
+
+    PackedObjectMemberIterator operator++(int)
+    {
+        PackedObjectMemberIterator iterator_pre(*m_store, m_index);
+        ++(*this);
+        return iterator_pre;
+    }
+
+private:
+
+    /// Store containing the object
+    const PackedValueStore *m_store;
+
+    /// Index of the current member's key node
+    uint32_t m_index;
+};
+
+/// Specialisation of the AdapterTraits template struct for PackedAdapter.
+template<>
+struct AdapterTraits<valijson::adapters::PackedAdapter>
+{
+    typedef PackedValueStore DocumentType;
+
+    static std::string adapterName()
+    {
+        return "PackedAdapter";
+    }
+};
+
+inline PackedFrozenValue::PackedFrozenValue(const Adapter &source)
+  : m_store(nullptr),
+    m_index(0),
+    m_hash(0)
+{
+    const std::shared_ptr<PackedValueStore> store = std::make_shared<PackedValueStore>();
+    m_index = store->add(source);
+    m_hash = PackedAdapter(*store, m_index).hash();
+    store->compact();
+    m_owned = store;
+    m_store = store.get();
+}
+
+inline FrozenValue * PackedFrozenValue::clone() const
+{
+    if (m_owned) {
+        return new PackedFrozenValue(m_owned, m_index, m_hash);
+    }
+
+    return new PackedFrozenValue(PackedAdapter(*m_store, m_index));
+}
+
+inline bool PackedFrozenValue::equalTo(const Adapter &other, bool strict) const
+{
+    return PackedAdapter(*m_store, m_index).equalTo(other, strict);
+}
+
+inline FrozenValue * PackedValue::freeze() const
+{
+    return new PackedFrozenValue(PackedAdapter(*m_store, m_index));
+}
+
+inline PackedArrayValueIterator PackedArray::begin() const
+{
+    return PackedArrayValueIterator(*m_store, m_index + 1);
+}
+
+inline PackedArrayValueIterator PackedArray::end() const
+{
+    return PackedArrayValueIterator(*m_store, m_store->next(m_index));
+}
+
+inline PackedObjectMemberIterator PackedObject::begin() const
+{
+    return PackedObjectMemberIterator(*m_store, m_index + 1);
+}
+
+inline PackedObjectMemberIterator PackedObject::end() const
+{
+    return PackedObjectMemberIterator(*m_store, m_index + 1 + m_store->node(m_index).size);
+}
+
+inline PackedObjectMemberIterator PackedObject::find(const std::string &propertyName) const
+{
+    return PackedObjectMemberIterator(*m_store,
+            m_store->findKey(m_index, propertyName.data(), propertyName.size()));
+}
+
+}  // namespace adapters
+}  // namespace valijson
@@ -38,6 +38,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -202,6 +203,18 @@ public:
         return object.size();
     }
 
+    /**
+     * @brief   Members are iterated in sorted order, with unique names
+     *
+     * PicoJson stores object members in a std::map.
+     *
+     * @see ObjectMembersSorted
+     */
+    static bool hasSortedMembers()
+    {
+        return true;
+    }
+
 private:
 
     /**
@@ -247,6 +260,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored PicoJson value
@@ -632,6 +647,18 @@ public:
         return DerefProxy<PicoJsonObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->first);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    PicoJsonAdapter value() const
+    {
+        return PicoJsonAdapter(m_itr->second);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -697,6 +724,11 @@ inline bool PicoJsonFrozenValue::equalTo(const Adapter &other, bool strict) cons
     return PicoJsonAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t PicoJsonFrozenValue::hash() const
+{
+    return PicoJsonAdapter(m_value).hash();
+}
+
 inline PicoJsonArrayValueIterator PicoJsonArray::begin() const
 {
     const picojson::array &array = m_value.get<picojson::array>();
@@ -31,6 +31,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -237,6 +238,8 @@ public:
 
     virtual bool equalTo(const Adapter &other, bool strict) const;
 
+    virtual uint64_t hash() const;
+
 private:
 
     /// Stored PocoJson value
@@ -621,6 +624,18 @@ public:
         return DerefProxy<PocoJsonObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->first);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    PocoJsonAdapter value() const
+    {
+        return PocoJsonAdapter(m_itr->second);
+    }
+
     /**
     * @brief   Compare this iterator with another iterator.
     *
@@ -716,5 +731,10 @@ inline bool PocoJsonFrozenValue::equalTo(const Adapter &other, bool strict) cons
     return PocoJsonAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t PocoJsonFrozenValue::hash() const
+{
+    return PocoJsonAdapter(m_value).hash();
+}
+
 }  // namespace adapters
 }  // namespace valijson
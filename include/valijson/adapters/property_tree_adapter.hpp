@@ -32,6 +32,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 
 namespace valijson {
 namespace adapters {
@@ -233,6 +234,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored value
@@ -653,6 +656,18 @@ public:
         return DerefProxy<PropertyTreeObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->first);
+    }
+
+    /// Returns an Adapter for the value of the current member
+    PropertyTreeAdapter value() const
+    {
+        return PropertyTreeAdapter(m_itr->second);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -717,6 +732,11 @@ inline bool PropertyTreeFrozenValue::equalTo(const Adapter &other, bool strict)
     return PropertyTreeAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t PropertyTreeFrozenValue::hash() const
+{
+    return PropertyTreeAdapter(m_value).hash();
+}
+
 inline PropertyTreeArrayValueIterator PropertyTreeArray::begin() const
 {
     return m_array.begin();
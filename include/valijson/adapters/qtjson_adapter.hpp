@@ -25,16 +25,20 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <utility>
 
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonArray>
+#include <QLatin1String>
+#include <QString>
 
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -201,6 +205,18 @@ public:
         return m_value.size();
     }
 
+    /**
+     * @brief   Members are iterated in sorted order, with unique names
+     *
+     * QJsonObject keeps its members sorted by property name.
+     *
+     * @see ObjectMembersSorted
+     */
+    static bool hasSortedMembers()
+    {
+        return true;
+    }
+
 private:
 
     /**
@@ -246,6 +262,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /// Stored QtJson value
@@ -410,6 +428,43 @@ public:
         return false;
     }
 
+    /**
+     * @brief   Retrieve the length of a string value, in code points
+     *
+     * QtJson stores strings as UTF-16, so the length is computed directly
+     * from the UTF-16 data, without converting the string to UTF-8. A valid
+     * surrogate pair counts as a single code point, and an unpaired
+     * surrogate counts as one code point, just as it would after being
+     * replaced during conversion to UTF-8.
+     *
+     * @param   result  reference to set with the length of the string
+     *
+     * @returns true if the value is a string, false otherwise
+     */
+    bool getStringLength(uint64_t &result) const
+    {
+        if (!m_value.isString()) {
+            return false;
+        }
+
+        const QString s = m_value.toString();
+        const QChar *itr = s.constData();
+        const QChar *end = itr + s.size();
+        uint64_t count = 0;
+        while (itr != end) {
+            if (itr->isHighSurrogate() && itr + 1 != end && (itr + 1)->isLowSurrogate()) {
+                itr += 2;
+            } else {
+                ++itr;
+            }
+
+            count++;
+        }
+
+        result = count;
+        return true;
+    }
+
     static bool hasStrictTypes()
     {
         return true;
@@ -611,7 +666,8 @@ public:
      * @param   itr  QtJson iterator to store
      */
     QtJsonObjectMemberIterator(const QJsonObject::const_iterator &itr)
-      : m_itr(itr) { }
+      : m_itr(itr),
+        m_keyValid(false) { }
 
     /**
      * @brief   Returns a QtJsonObjectMember that contains the key and value
@@ -628,6 +684,37 @@ public:
         return DerefProxy<QtJsonObjectMember>(**this);
     }
 
+    /**
+     * @brief   Return the name of the object member identified by the
+     *          iterator.
+     *
+     * QtJson stores names as UTF-16, so the name is converted to UTF-8 the
+     * first time it is requested at each position, into a buffer owned by the
+     * iterator. The buffer is reused as the iterator advances, so names are
+     * not copied into a new std::string for each member, and members whose
+     * names are never requested are not converted at all.
+     *
+     * The returned key is valid until the iterator is modified or destroyed.
+     */
+    ObjectMemberKey key() const
+    {
+        if (!m_keyValid) {
+            toUtf8(m_itr.key(), m_key);
+            m_keyValid = true;
+        }
+
+        return ObjectMemberKey(m_key.data(), m_key.size());
+    }
+
+    /**
+     * @brief   Return an adapter for the value of the object member
+     *          identified by the iterator, without converting its name.
+     */
+    QtJsonAdapter value() const
+    {
+        return QtJsonAdapter(m_itr.value());
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -652,6 +739,7 @@ public:
     const QtJsonObjectMemberIterator& operator++()
     {
         m_itr++;
+        m_keyValid = false;
         return *this;
     }
 
@@ -665,14 +753,67 @@ public:
     const QtJsonObjectMemberIterator& operator--(int)
     {
         m_itr--;
+        m_keyValid = false;
 
         return *this;
     }
 
 private:
 
+    /**
+     * @brief   Convert a UTF-16 string to UTF-8, reusing the storage held by
+     *          the result.
+     *
+     * An unpaired surrogate is replaced with '?', as QString::toUtf8() does.
+     */
+    static void toUtf8(const QString &s, std::string &result)
+    {
+        result.clear();
+
+        const QChar *itr = s.constData();
+        const QChar *end = itr + s.size();
+        while (itr != end) {
+            uint32_t c = itr->unicode();
+            if (c < 0x80) {
+                result.push_back(static_cast<char>(c));
+                ++itr;
+                continue;
+            }
+
+            if (itr->isHighSurrogate() && itr + 1 != end && (itr + 1)->isLowSurrogate()) {
+                c = QChar::surrogateToUcs4(*itr, *(itr + 1));
+                itr += 2;
+            } else if (itr->isSurrogate()) {
+                result.push_back('?');
+                ++itr;
+                continue;
+            } else {
+                ++itr;
+            }
+
+            if (c < 0x800) {
+                result.push_back(static_cast<char>(0xC0 | (c >> 6)));
+            } else if (c < 0x10000) {
+                result.push_back(static_cast<char>(0xE0 | (c >> 12)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            } else {
+                result.push_back(static_cast<char>(0xF0 | (c >> 18)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            }
+
+            result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+
     /// Internal copy of the original QtJson iterator
     QJsonObject::const_iterator m_itr;
+
+    /// UTF-8 form of the current member's name, once it has been requested
+    mutable std::string m_key;
+
+    /// True if m_key holds the name of the current member
+    mutable bool m_keyValid;
 };
 
 /// Specialisation of the AdapterTraits template struct for QtJsonAdapter.
@@ -692,6 +833,11 @@ inline bool QtJsonFrozenValue::equalTo(const Adapter &other, bool strict) const
     return QtJsonAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t QtJsonFrozenValue::hash() const
+{
+    return QtJsonAdapter(m_value).hash();
+}
+
 inline QtJsonArrayValueIterator QtJsonArray::begin() const
 {
     return m_value.begin();
@@ -715,7 +861,15 @@ inline QtJsonObjectMemberIterator QtJsonObject::end() const
 inline QtJsonObjectMemberIterator QtJsonObject::find(
     const std::string &propertyName) const
 {
-    return m_value.find(QString::fromStdString(propertyName));
+    // Property names are usually ASCII, in which case they can be compared
+    // with the keys in the object as Latin-1, without converting to UTF-16
+    for (const char c : propertyName) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            return m_value.constFind(QString::fromStdString(propertyName));
+        }
+    }
+
+    return m_value.constFind(QLatin1String(propertyName.data(), static_cast<int>(propertyName.size())));
 }
 
 }  // namespace adapters
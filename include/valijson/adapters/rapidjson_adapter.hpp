@@ -66,6 +66,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -300,6 +301,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
 
     /**
@@ -778,6 +781,18 @@ public:
         return DerefProxy<GenericRapidJsonObjectMember<ValueType>>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->name.GetString(), m_itr->name.GetStringLength());
+    }
+
+    /// Returns an Adapter for the value of the current member
+    GenericRapidJsonAdapter<ValueType> value() const
+    {
+        return GenericRapidJsonAdapter<ValueType>(m_itr->value);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -835,6 +850,12 @@ inline bool GenericRapidJsonFrozenValue<ValueType>::equalTo(const Adapter &other
     return GenericRapidJsonAdapter<ValueType>(m_value).equalTo(other, strict);
 }
 
+template<class ValueType>
+inline uint64_t GenericRapidJsonFrozenValue<ValueType>::hash() const
+{
+    return GenericRapidJsonAdapter<ValueType>(m_value).hash();
+}
+
 template<class ValueType>
 inline typename GenericRapidJsonArray<ValueType>::iterator GenericRapidJsonArray<ValueType>::begin() const
 {
@@ -14,11 +14,14 @@
 
 #pragma once
 
+#include <sstream>
 #include <string>
 
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
 #include <valijson/internal/basic_adapter.hpp>
+#include <valijson/internal/structural_hash.hpp>
+#include <valijson/utils/utf8_utils.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -81,6 +84,8 @@ public:
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
 private:
     std::string value;
 };
@@ -167,6 +172,11 @@ public:
         return true;
     }
 
+    uint64_t asStringLength() const override
+    {
+        return utils::u8_strlen(m_value.c_str());
+    }
+
     bool equalTo(const Adapter &other, bool strict) const override
     {
         if (strict && !other.isString()) {
@@ -176,6 +186,11 @@ public:
         return m_value == other.asString();
     }
 
+    uint64_t hash() const override
+    {
+        return StructuralHash::string(m_value.data(), m_value.size());
+    }
+
     FrozenValue* freeze() const override
     {
         return new StdStringFrozenValue(m_value);
@@ -487,5 +502,10 @@ inline bool StdStringFrozenValue::equalTo(const Adapter &other, bool strict) con
     return StdStringAdapter(value).equalTo(other, strict);
 }
 
+inline uint64_t StdStringFrozenValue::hash() const
+{
+    return StdStringAdapter(value).hash();
+}
+
 }  // namespace adapters
 }  // namespace valijson
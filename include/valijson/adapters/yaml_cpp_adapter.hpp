@@ -32,6 +32,7 @@
 #include <valijson/internal/adapter.hpp>
 #include <valijson/internal/basic_adapter.hpp>
 #include <valijson/internal/frozen_value.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -234,6 +235,8 @@ class YamlCppFrozenValue : public FrozenValue
 
     bool equalTo(const Adapter &other, bool strict) const override;
 
+    uint64_t hash() const override;
+
   private:
     /// Stored YamlCpp value
     YAML::Node m_value;
@@ -251,6 +254,11 @@ class YamlCppFrozenValue : public FrozenValue
  * The functions that need to be provided by this class are defined implicitly
  * by the implementation of the BasicAdapter template class.
  *
+ * yaml-cpp reports every scalar as a string, so numbers are parsed from the
+ * scalar each time they are requested. The results are not cached, which keeps
+ * this class free of mutable state, so that one value can be read from several
+ * threads at once.
+ *
  * @see BasicAdapter
  */
 class YamlCppValue
@@ -315,31 +323,17 @@ class YamlCppValue
 
     bool getBool(bool &result) const
     {
-        if (m_value.IsScalar()) {
-            result = m_value.as<bool>();
-            return true;
-        }
-
-        return false;
+        return m_value.IsScalar() && YAML::convert<bool>::decode(m_value, result);
     }
 
     bool getDouble(double &result) const
     {
-        if (m_value.IsScalar()) {
-            result = m_value.as<double>();
-            return true;
-        }
-
-        return false;
+        return m_value.IsScalar() && YAML::convert<double>::decode(m_value, result);
     }
 
     bool getInteger(int64_t &result) const
     {
-        if (m_value.IsScalar()) {
-            result = m_value.as<int64_t>();
-            return true;
-        }
-        return false;
+        return m_value.IsScalar() && YAML::convert<int64_t>::decode(m_value, result);
     }
 
     /**
@@ -384,7 +378,9 @@ class YamlCppValue
     bool getString(std::string &result) const
     {
         if (m_value.IsScalar()) {
-            result = m_value.as<std::string>();
+            // Scalar() returns a reference to the stored text, avoiding the
+            // conversion machinery used by as<std::string>()
+            result = m_value.Scalar();
             return true;
         }
 
@@ -593,8 +589,7 @@ class YamlCppObjectMemberIterator
      */
     YamlCppObjectMember operator*() const
     {
-        return YamlCppObjectMember(m_itr->first.as<std::string>(),
-                                   m_itr->second);
+        return YamlCppObjectMember(m_itr->first.Scalar(), m_itr->second);
     }
 
     DerefProxy<YamlCppObjectMember> operator->() const
@@ -602,6 +597,18 @@ class YamlCppObjectMemberIterator
         return DerefProxy<YamlCppObjectMember>(**this);
     }
 
+    /// Returns a view of the name of the current member, without copying it
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_itr->first.Scalar());
+    }
+
+    /// Returns an Adapter for the value of the current member
+    YamlCppAdapter value() const
+    {
+        return YamlCppAdapter(m_itr->second);
+    }
+
     /**
      * @brief   Compare this iterator with another iterator.
      *
@@ -658,6 +665,11 @@ inline bool YamlCppFrozenValue::equalTo(const Adapter &other, bool strict) const
     return YamlCppAdapter(m_value).equalTo(other, strict);
 }
 
+inline uint64_t YamlCppFrozenValue::hash() const
+{
+    return YamlCppAdapter(m_value).hash();
+}
+
 inline YamlCppArrayValueIterator YamlCppArray::begin() const
 {
     return m_value.begin();
@@ -681,8 +693,10 @@ inline YamlCppObjectMemberIterator YamlCppObject::end() const
 inline YamlCppObjectMemberIterator
 YamlCppObject::find(const std::string &propertyName) const
 {
-    for (auto itr = begin(); itr != end(); ++itr) {
-        if (itr->first == propertyName) {
+    // Compare keys in place, rather than constructing a YamlCppObjectMember
+    // (and copying the key) for each member
+    for (YAML::Node::const_iterator itr = m_value.begin(); itr != m_value.end(); ++itr) {
+        if (itr->first.Scalar() == propertyName) {
             return itr;
         }
     }
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validator.hpp>
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#  include <coroutine>
+#  define VALIJSON_HAS_COROUTINES 1
+#endif
+
+namespace valijson {
+
+class Subschema;
+
+/**
+ * @brief  Shared flag used to cancel an asynchronous validation
+ *
+ * Copies of a CancellationToken share the same flag, so a token can be passed
+ * to AsyncValidatorT::validate() while a copy is kept to cancel it later.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken()
+      : m_flag(std::make_shared<std::atomic<bool>>(false)) { }
+
+    /**
+     * @brief  Request cancellation of any validation using this token
+     *
+     * Validation stops before the next sub-schema is applied, so this may be
+     * called from any thread.
+     */
+    void cancel()
+    {
+        m_flag->store(true);
+    }
+
+    /**
+     * @brief  Return true if cancellation has been requested
+     */
+    bool isCancelled() const
+    {
+        return m_flag->load();
+    }
+
+    /**
+     * @brief  Return a pointer to the underlying flag, which can be passed to
+     *         Validator::setCancellationFlag()
+     */
+    const std::atomic<bool> * flag() const
+    {
+        return m_flag.get();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+/**
+ * @brief  Outcome of an asynchronous validation
+ */
+struct AsyncValidationResult
+{
+    enum Status
+    {
+        kValid,
+        kInvalid,
+        kCancelled,
+        kError
+    };
+
+    AsyncValidationResult()
+      : status(kValid) { }
+
+    /// Whether validation succeeded, failed, was cancelled, or threw
+    Status status;
+
+    /// Errors reported by validation; empty if it was cancelled, or if the
+    /// AsyncValidator was configured not to collect results
+    ValidationResults results;
+
+    /// Exception thrown by validation, when status is kError
+    std::exception_ptr exception;
+};
+
+/**
+ * @brief  Validates documents on an executor, without blocking the caller
+ *
+ * An executor is any function that accepts a std::function<void()> and
+ * arranges for it to be called, e.g. by posting it to an event loop or a
+ * thread pool. Each call to validate() submits a single task to the executor,
+ * and the outcome is delivered through a std::future, a completion callback,
+ * or (when compiled as C++20) by resuming a coroutine.
+ *
+ * Validation is performed by copies of a prototype Validator, so settings such
+ * as the type checking mode, a thread pool, or metrics can be configured on
+ * the prototype. Because validations may run concurrently, the prototype must
+ * not have an observer or instrumentation attached (see
+ * ValidatorT::concurrentCopy()). Each copy has its own ValidationScratch
+ * object, and copies are kept for reuse once a validation completes, so that
+ * their regex caches and scratch storage remain warm. An AsyncValidator can
+ * be used from any thread, and may be destroyed while validations are still
+ * in progress.
+ *
+ * The schema and the document that the target adapter refers to must outlive
+ * the validation.
+ *
+ * @tparam  RegexEngine  regular expression engine used by the Validator
+ * @tparam  Policy       type checking policy used by the Validator
+ */
+template<typename RegexEngine, TypeCheckingPolicy Policy = kRuntimeTypeChecking>
+class AsyncValidatorT
+{
+public:
+    typedef ValidatorT<RegexEngine, Policy> ValidatorType;
+
+    /// Function used to schedule validation tasks
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    /// Function called with the result of a validation
+    typedef std::function<void(AsyncValidationResult)> Callback;
+
+    /**
+     * @brief  Construct an AsyncValidator
+     *
+     * @param  executor        function used to schedule validation tasks
+     * @param  prototype       Validator to be copied to perform validation; it
+     *                         must not have an observer or instrumentation
+     *                         attached
+     * @param  collectResults  whether errors should be collected, or validation
+     *                         should stop as soon as the target is invalid
+     */
+    explicit AsyncValidatorT(Executor executor, const ValidatorType &prototype = ValidatorType(),
+            bool collectResults = true)
+      : m_state(std::make_shared<State>(std::move(executor), prototype, collectResults)) { }
+
+    /**
+     * @brief  Validate a document on the executor, and return a future for
+     *         the result
+     *
+     * If validation throws an exception, it is rethrown by the future.
+     *
+     * @param  schema  schema to validate against
+     * @param  target  adapter for the document to be validated
+     * @param  token   optional token that can be used to cancel validation
+     */
+    template<typename AdapterType>
+    std::future<AsyncValidationResult> validate(const Subschema &schema, const AdapterType &target,
+            CancellationToken token = CancellationToken()) const
+    {
+        const std::shared_ptr<std::promise<AsyncValidationResult>> promise =
+                std::make_shared<std::promise<AsyncValidationResult>>();
+        std::future<AsyncValidationResult> future = promise->get_future();
+
+        validate(schema, target, [promise](AsyncValidationResult result) {
+            if (result.status == AsyncValidationResult::kError) {
+                promise->set_exception(result.exception);
+            } else {
+                promise->set_value(std::move(result));
+            }
+        }, token);
+
+        return future;
+    }
+
+    /**
+     * @brief  Validate a document on the executor, and call a function with
+     *         the result
+     *
+     * The callback is called on the thread that performed validation, with a
+     * status of kError if validation threw an exception.
+     *
+     * @param  schema    schema to validate against
+     * @param  target    adapter for the document to be validated
+     * @param  callback  function to call with the result
+     * @param  token     optional token that can be used to cancel validation
+     */
+    template<typename AdapterType>
+    void validate(const Subschema &schema, const AdapterType &target, Callback callback,
+            CancellationToken token = CancellationToken()) const
+    {
+        const std::shared_ptr<State> state = m_state;
+        state->executor([state, &schema, target, callback, token]() {
+            callback(run(*state, schema, target, token));
+        });
+    }
+
+#if VALIJSON_HAS_COROUTINES
+    /**
+     * @brief  Awaitable returned by validateAwaitable()
+     */
+    template<typename AdapterType>
+    class Awaitable
+    {
+    public:
+        Awaitable(const AsyncValidatorT &owner, const Subschema &schema, const AdapterType &target,
+                CancellationToken token)
+          : m_owner(owner),
+            m_schema(schema),
+            m_target(target),
+            m_token(std::move(token)) { }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // The coroutine may be resumed, and this object destroyed, before
+            // validate() returns, so nothing here may be used afterwards
+            const AsyncValidatorT owner = m_owner;
+            AsyncValidationResult *result = &m_result;
+            owner.validate(m_schema, m_target, [result, handle](AsyncValidationResult r) {
+                *result = std::move(r);
+                handle.resume();
+            }, m_token);
+        }
+
+        AsyncValidationResult await_resume()
+        {
+            if (m_result.status == AsyncValidationResult::kError) {
+                std::rethrow_exception(m_result.exception);
+            }
+
+            return std::move(m_result);
+        }
+
+    private:
+        const AsyncValidatorT m_owner;
+        const Subschema &m_schema;
+        const AdapterType m_target;
+        const CancellationToken m_token;
+        AsyncValidationResult m_result;
+    };
+
+    /**
+     * @brief  Return an object that can be used with co_await to validate a
+     *         document on the executor
+     *
+     * The coroutine is resumed on the thread that performed validation. If
+     * validation throws an exception, it is rethrown by co_await.
+     *
+     * @param  schema  schema to validate against
+     * @param  target  adapter for the document to be validated
+     * @param  token   optional token that can be used to cancel validation
+     */
+    template<typename AdapterType>
+    Awaitable<AdapterType> validateAwaitable(const Subschema &schema, const AdapterType &target,
+            CancellationToken token = CancellationToken()) const
+    {
+        return Awaitable<AdapterType>(*this, schema, target, std::move(token));
+    }
+#endif
+
+private:
+
+    /**
+     * @brief  State shared by an AsyncValidator, its copies, and any
+     *         validations that are in progress
+     */
+    struct State
+    {
+        State(Executor stateExecutor, const ValidatorType &statePrototype, bool stateCollectResults)
+          : executor(std::move(stateExecutor)),
+            prototype(statePrototype.concurrentCopy()),
+            collectResults(stateCollectResults) { }
+
+        /**
+         * @brief  Validator that is used by one validation at a time, along
+         *         with its scratch storage
+         */
+        struct Worker
+        {
+            explicit Worker(const ValidatorType &workerPrototype)
+              : validator(workerPrototype)
+            {
+                validator.setScratch(&scratch);
+            }
+
+            Worker(const Worker &) = delete;
+            Worker & operator=(const Worker &) = delete;
+
+            ValidationScratch scratch;
+            ValidatorType validator;
+        };
+
+        /**
+         * @brief  Take an idle Worker, or copy the prototype if there are
+         *         none
+         */
+        std::unique_ptr<Worker> acquire()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (idle.empty()) {
+                return std::unique_ptr<Worker>(new Worker(prototype));
+            }
+
+            std::unique_ptr<Worker> worker = std::move(idle.back());
+            idle.pop_back();
+            return worker;
+        }
+
+        /**
+         * @brief  Return a Worker for reuse
+         */
+        void release(std::unique_ptr<Worker> worker)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(std::move(worker));
+        }
+
+        const Executor executor;
+        const ValidatorType prototype;
+        const bool collectResults;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Worker>> idle;
+    };
+
+    /**
+     * @brief  Perform validation on the current thread
+     */
+    template<typename AdapterType>
+    static AsyncValidationResult run(State &state, const Subschema &schema, const AdapterType &target,
+            const CancellationToken &token)
+    {
+        AsyncValidationResult result;
+        if (token.isCancelled()) {
+            result.status = AsyncValidationResult::kCancelled;
+            return result;
+        }
+
+        std::unique_ptr<typename State::Worker> worker = state.acquire();
+        ValidatorType &validator = worker->validator;
+        validator.setCancellationFlag(token.flag());
+
+#if VALIJSON_USE_EXCEPTIONS
+        try {
+#endif
+            if (validator.validate(schema, target, state.collectResults ? &result.results : nullptr)) {
+                result.status = AsyncValidationResult::kValid;
+            } else if (token.isCancelled()) {
+                // Errors reported after cancellation are not meaningful
+                result.status = AsyncValidationResult::kCancelled;
+                result.results = ValidationResults();
+            } else {
+                result.status = AsyncValidationResult::kInvalid;
+            }
+#if VALIJSON_USE_EXCEPTIONS
+        } catch (...) {
+            result.status = AsyncValidationResult::kError;
+            result.exception = std::current_exception();
+        }
+#endif
+
+        validator.setCancellationFlag(nullptr);
+        state.release(std::move(worker));
+
+        return result;
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+using AsyncValidator = AsyncValidatorT<DefaultRegexEngine>;
+
+}  // namespace valijson
@@ -0,0 +1,708 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace valijson {
+
+/**
+ * @brief  Decoded header of a single value in a binary document
+ *
+ * Headers are produced by a binary format class (MsgPackFormat or CborFormat)
+ * and describe a value without decoding its contents.
+ */
+struct BinaryHeader
+{
+    /// Types of value, as seen by the validator
+    enum Kind
+    {
+        kNull,
+        kFalse,
+        kTrue,
+        kInteger,
+        kDouble,
+        kString,
+        kArray,
+        kObject
+    };
+
+    /// Type of value
+    Kind kind;
+
+    /// True if a container is encoded with an indefinite length (CBOR only)
+    bool indefinite;
+
+    /// Offset of the first byte after the header; for strings this is the
+    /// first byte of the string, and for containers it is the first child
+    size_t payload;
+
+    /// Length of a string in bytes, or number of elements or members in a
+    /// container with a definite length
+    uint64_t length;
+
+    union
+    {
+        /// Value of an integer
+        int64_t integer;
+
+        /// Value of a floating point number
+        double number;
+    };
+};
+
+namespace internal {
+namespace binary {
+
+/// Read a big-endian unsigned integer of a given width, checking bounds
+inline bool readUint(const uint8_t *data, size_t length, size_t &pos, size_t width, uint64_t &result)
+{
+    if (length - pos < width) {
+        return false;
+    }
+
+    result = 0;
+    for (size_t i = 0; i < width; i++) {
+        result = (result << 8) | data[pos + i];
+    }
+
+    pos += width;
+
+    return true;
+}
+
+inline double floatFromBits(uint64_t bits)
+{
+    const uint32_t value = static_cast<uint32_t>(bits);
+    float result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+inline double doubleFromBits(uint64_t bits)
+{
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+inline double halfFromBits(uint64_t bits)
+{
+    const int exponent = static_cast<int>((bits >> 10) & 0x1f);
+    const double mantissa = static_cast<double>(bits & 0x3ff);
+    double result;
+    if (exponent == 0) {
+        result = std::ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        result = std::ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        result = mantissa == 0 ? std::numeric_limits<double>::infinity() :
+                std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return (bits & 0x8000) ? -result : result;
+}
+
+/// Store an unsigned integer as an integer if possible, otherwise a double
+inline void setUnsigned(BinaryHeader &header, uint64_t value)
+{
+    if (value <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        header.kind = BinaryHeader::kInteger;
+        header.integer = static_cast<int64_t>(value);
+    } else {
+        header.kind = BinaryHeader::kDouble;
+        header.number = static_cast<double>(value);
+    }
+}
+
+}  // namespace binary
+}  // namespace internal
+
+/**
+ * @brief  Decodes value headers in the MessagePack format
+ *
+ * Binary and extension types cannot be represented in JSON, and are rejected.
+ * Unsigned integers larger than the maximum value of int64_t are treated as
+ * doubles.
+ */
+struct MsgPackFormat
+{
+    /// Encodings of an empty array and an empty map
+    static const uint8_t kEmptyArray = 0x90;
+    static const uint8_t kEmptyMap = 0x80;
+
+    static const char * name()
+    {
+        return "MessagePack";
+    }
+
+    static bool isBreak(const uint8_t *, size_t, size_t)
+    {
+        return false;
+    }
+
+    static bool readHeader(const uint8_t *data, size_t length, size_t pos, BinaryHeader &header,
+            const char *&error)
+    {
+        using internal::binary::readUint;
+
+        header.indefinite = false;
+        header.length = 0;
+        header.integer = 0;
+
+        const uint8_t b = data[pos++];
+        uint64_t value = 0;
+        bool ok = true;
+
+        if (b <= 0x7f) {
+            header.kind = BinaryHeader::kInteger;
+            header.integer = b;
+        } else if (b <= 0x8f) {
+            header.kind = BinaryHeader::kObject;
+            header.length = b & 0x0f;
+        } else if (b <= 0x9f) {
+            header.kind = BinaryHeader::kArray;
+            header.length = b & 0x0f;
+        } else if (b <= 0xbf) {
+            header.kind = BinaryHeader::kString;
+            header.length = b & 0x1f;
+        } else if (b >= 0xe0) {
+            header.kind = BinaryHeader::kInteger;
+            header.integer = static_cast<int8_t>(b);
+        } else {
+            switch (b) {
+            case 0xc0:
+                header.kind = BinaryHeader::kNull;
+                break;
+            case 0xc2:
+                header.kind = BinaryHeader::kFalse;
+                break;
+            case 0xc3:
+                header.kind = BinaryHeader::kTrue;
+                break;
+            case 0xca:
+                header.kind = BinaryHeader::kDouble;
+                ok = readUint(data, length, pos, 4, value);
+                header.number = internal::binary::floatFromBits(value);
+                break;
+            case 0xcb:
+                header.kind = BinaryHeader::kDouble;
+                ok = readUint(data, length, pos, 8, value);
+                header.number = internal::binary::doubleFromBits(value);
+                break;
+            case 0xcc:
+            case 0xcd:
+            case 0xce:
+            case 0xcf:
+                ok = readUint(data, length, pos, size_t(1) << (b - 0xcc), value);
+                internal::binary::setUnsigned(header, value);
+                break;
+            case 0xd0:
+            case 0xd1:
+            case 0xd2:
+            case 0xd3:
+                {
+                    const size_t width = size_t(1) << (b - 0xd0);
+                    ok = readUint(data, length, pos, width, value);
+                    // Sign-extend from the encoded width
+                    const unsigned shift = static_cast<unsigned>(64 - width * 8);
+                    header.kind = BinaryHeader::kInteger;
+                    header.integer = static_cast<int64_t>(value << shift) >> shift;
+                }
+                break;
+            case 0xd9:
+            case 0xda:
+            case 0xdb:
+                header.kind = BinaryHeader::kString;
+                ok = readUint(data, length, pos, size_t(1) << (b - 0xd9), header.length);
+                break;
+            case 0xdc:
+            case 0xdd:
+                header.kind = BinaryHeader::kArray;
+                ok = readUint(data, length, pos, b == 0xdc ? 2 : 4, header.length);
+                break;
+            case 0xde:
+            case 0xdf:
+                header.kind = BinaryHeader::kObject;
+                ok = readUint(data, length, pos, b == 0xde ? 2 : 4, header.length);
+                break;
+            case 0xc4:
+            case 0xc5:
+            case 0xc6:
+                error = "Binary values are not supported";
+                return false;
+            case 0xc1:
+                error = "Invalid type byte";
+                return false;
+            default:
+                error = "Extension types are not supported";
+                return false;
+            }
+        }
+
+        if (!ok) {
+            error = "Unexpected end of document";
+            return false;
+        }
+
+        header.payload = pos;
+
+        return true;
+    }
+};
+
+/**
+ * @brief  Decodes value headers in the CBOR format
+ *
+ * Arrays and maps may have indefinite lengths, but strings must have definite
+ * lengths so that they can be read without copying. Tags are skipped, so that
+ * the tagged value is validated. Byte strings, 'undefined' and other simple
+ * values cannot be represented in JSON, and are rejected.
+ */
+struct CborFormat
+{
+    /// Encodings of an empty array and an empty map
+    static const uint8_t kEmptyArray = 0x80;
+    static const uint8_t kEmptyMap = 0xa0;
+
+    static const char * name()
+    {
+        return "CBOR";
+    }
+
+    static bool isBreak(const uint8_t *data, size_t length, size_t pos)
+    {
+        return pos < length && data[pos] == 0xff;
+    }
+
+    static bool readHeader(const uint8_t *data, size_t length, size_t pos, BinaryHeader &header,
+            const char *&error)
+    {
+        header.indefinite = false;
+        header.length = 0;
+        header.integer = 0;
+
+        for (;;) {
+            if (pos >= length) {
+                error = "Unexpected end of document";
+                return false;
+            }
+
+            const uint8_t major = data[pos] >> 5;
+            const uint8_t info = data[pos] & 0x1f;
+            pos++;
+
+            uint64_t argument = info;
+            if (info >= 24 && info <= 27) {
+                if (!internal::binary::readUint(data, length, pos, size_t(1) << (info - 24), argument)) {
+                    error = "Unexpected end of document";
+                    return false;
+                }
+            } else if (info >= 28 && info <= 30) {
+                error = "Invalid additional information";
+                return false;
+            } else if (info == 31) {
+                if (major == 4 || major == 5) {
+                    header.indefinite = true;
+                } else if (major == 2 || major == 3) {
+                    error = "Indefinite length strings are not supported";
+                    return false;
+                } else {
+                    error = "Unexpected break";
+                    return false;
+                }
+            }
+
+            switch (major) {
+            case 0:
+                internal::binary::setUnsigned(header, argument);
+                break;
+            case 1:
+                if (argument <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                    header.kind = BinaryHeader::kInteger;
+                    header.integer = -1 - static_cast<int64_t>(argument);
+                } else {
+                    header.kind = BinaryHeader::kDouble;
+                    header.number = -1.0 - static_cast<double>(argument);
+                }
+                break;
+            case 2:
+                error = "Byte strings are not supported";
+                return false;
+            case 3:
+                header.kind = BinaryHeader::kString;
+                header.length = argument;
+                break;
+            case 4:
+                header.kind = BinaryHeader::kArray;
+                header.length = header.indefinite ? 0 : argument;
+                break;
+            case 5:
+                header.kind = BinaryHeader::kObject;
+                header.length = header.indefinite ? 0 : argument;
+                break;
+            case 6:
+                // Skip tag, and read the tagged value
+                continue;
+            default:
+                if (info == 20) {
+                    header.kind = BinaryHeader::kFalse;
+                } else if (info == 21) {
+                    header.kind = BinaryHeader::kTrue;
+                } else if (info == 22) {
+                    header.kind = BinaryHeader::kNull;
+                } else if (info == 25) {
+                    header.kind = BinaryHeader::kDouble;
+                    header.number = internal::binary::halfFromBits(argument);
+                } else if (info == 26) {
+                    header.kind = BinaryHeader::kDouble;
+                    header.number = internal::binary::floatFromBits(argument);
+                } else if (info == 27) {
+                    header.kind = BinaryHeader::kDouble;
+                    header.number = internal::binary::doubleFromBits(argument);
+                } else {
+                    error = "Unsupported simple value";
+                    return false;
+                }
+            }
+
+            header.payload = pos;
+
+            return true;
+        }
+    }
+};
+
+/**
+ * @brief  Read-only view of a MessagePack or CBOR document
+ *
+ * BinaryDocument allows binary documents to be validated without first
+ * decoding them into a DOM. When a document is parsed, its structure is
+ * checked in a single pass, and the end offset and number of children of each
+ * array and map are recorded in an index. Scalar values and strings are not
+ * decoded or copied until they are read by the validator, and strings are
+ * read directly from the original bytes.
+ *
+ * Values are identified by their offset in the document; the root value is at
+ * offset zero. Map keys must be strings.
+ *
+ * Parsing with parse(const void *, size_t) does not copy the bytes, which must
+ * outlive the document. The parse(std::string) overload takes ownership of the
+ * bytes instead.
+ *
+ * The GenericBinaryAdapter class (see adapters/binary_adapter.hpp) allows a
+ * document to be validated.
+ *
+ * @tparam  Format  MsgPackFormat or CborFormat
+ */
+template<typename Format>
+class BinaryDocument
+{
+public:
+    /// Maximum nesting depth for arrays and maps
+    static const size_t kMaxDepth = 1024;
+
+    BinaryDocument()
+      : m_source(nullptr),
+        m_length(0),
+        m_owned(false),
+        m_valid(false),
+        m_errorOffset(0) { }
+
+    /**
+     * @brief  Parse a document without copying it
+     *
+     * @param  data    pointer to encoded document, which must outlive this
+     *                 object
+     * @param  length  length of encoded document in bytes
+     *
+     * @return  true if the document was parsed successfully; otherwise the
+     *          error can be retrieved using getError() and getErrorOffset()
+     */
+    bool parse(const void *data, size_t length)
+    {
+        m_buffer.clear();
+        m_owned = false;
+        m_source = static_cast<const uint8_t *>(data);
+        m_length = length;
+
+        return index();
+    }
+
+    /**
+     * @brief  Parse a document, taking ownership of the bytes
+     *
+     * @param  bytes  encoded document
+     *
+     * @return  true if the document was parsed successfully
+     */
+    bool parse(std::string bytes)
+    {
+        m_buffer = std::move(bytes);
+        m_owned = true;
+        m_source = nullptr;
+        m_length = m_buffer.size();
+
+        return index();
+    }
+
+    /// Return a description of the last parse error, or an empty string
+    const std::string & getError() const
+    {
+        return m_error;
+    }
+
+    /// Return the offset in the document at which the last parse error occurred
+    size_t getErrorOffset() const
+    {
+        return m_errorOffset;
+    }
+
+    /// Return true if the object contains a successfully parsed document
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    /// Decode the header of the value at a given offset
+    BinaryHeader header(size_t offset) const
+    {
+        BinaryHeader result;
+        const char *error = nullptr;
+        Format::readHeader(data(), m_length, offset, result, error);
+        return result;
+    }
+
+    /// Return a pointer to the bytes of a string (not null-terminated)
+    const char * stringData(const BinaryHeader &header) const
+    {
+        return reinterpret_cast<const char *>(data() + header.payload);
+    }
+
+    /// Return the number of elements or members in the container at an offset
+    size_t containerSize(size_t offset) const
+    {
+        return container(offset).size;
+    }
+
+    /// Return the offset of the first byte after the value at an offset
+    size_t next(size_t offset) const
+    {
+        const BinaryHeader h = header(offset);
+        if (h.kind == BinaryHeader::kArray || h.kind == BinaryHeader::kObject) {
+            return container(offset).end;
+        } else if (h.kind == BinaryHeader::kString) {
+            return h.payload + static_cast<size_t>(h.length);
+        }
+
+        return h.payload;
+    }
+
+    /**
+     * @brief  Return the offset of the end of a container's children
+     *
+     * For a container with an indefinite length, this is the offset of the
+     * break marker; otherwise it is the same as next().
+     */
+    size_t childrenEnd(size_t offset) const
+    {
+        const BinaryHeader h = header(offset);
+        const size_t end = container(offset).end;
+        return h.indefinite ? end - 1 : end;
+    }
+
+    /**
+     * @brief  Copy a value into a new, self-contained document
+     *
+     * @param  offset  offset of the value to copy
+     */
+    BinaryDocument copyValue(size_t offset) const
+    {
+        BinaryDocument copy;
+        copy.parse(std::string(reinterpret_cast<const char *>(data()) + offset, next(offset) - offset));
+        return copy;
+    }
+
+private:
+    /// Index entry for an array or map
+    struct Container
+    {
+        size_t offset;
+        size_t end;
+        size_t size;
+
+        bool operator<(size_t other) const
+        {
+            return offset < other;
+        }
+    };
+
+    /// State of an array or map that is being indexed
+    struct Frame
+    {
+        size_t container;
+        uint64_t remaining;
+        bool indefinite;
+        bool isMap;
+        bool expectKey;
+    };
+
+    const uint8_t * data() const
+    {
+        return m_owned ? reinterpret_cast<const uint8_t *>(m_buffer.data()) : m_source;
+    }
+
+    const Container & container(size_t offset) const
+    {
+        return *std::lower_bound(m_containers.begin(), m_containers.end(), offset);
+    }
+
+    bool fail(size_t offset, const char *message)
+    {
+        m_containers.clear();
+        m_error = message;
+        m_errorOffset = offset;
+
+        return false;
+    }
+
+    bool index()
+    {
+        m_containers.clear();
+        m_error.clear();
+        m_errorOffset = 0;
+        m_valid = false;
+
+        const uint8_t *bytes = data();
+        std::vector<Frame> stack;
+        size_t pos = 0;
+
+        for (;;) {
+            if (pos >= m_length) {
+                return fail(pos, "Unexpected end of document");
+            }
+
+            BinaryHeader h;
+            const char *error = nullptr;
+            if (!Format::readHeader(bytes, m_length, pos, h, error)) {
+                return fail(pos, error);
+            }
+
+            if (!stack.empty()) {
+                Frame &parent = stack.back();
+                if (parent.isMap && parent.expectKey) {
+                    if (h.kind != BinaryHeader::kString) {
+                        return fail(pos, "Map keys must be strings");
+                    }
+                    m_containers[parent.container].size++;
+                } else if (!parent.isMap) {
+                    m_containers[parent.container].size++;
+                }
+                parent.expectKey = parent.isMap && !parent.expectKey;
+                if (!parent.indefinite) {
+                    parent.remaining--;
+                }
+            }
+
+            if (h.kind == BinaryHeader::kArray || h.kind == BinaryHeader::kObject) {
+                if (stack.size() >= kMaxDepth) {
+                    return fail(pos, "Maximum nesting depth exceeded");
+                }
+
+                // Each child occupies at least one byte
+                const bool isMap = h.kind == BinaryHeader::kObject;
+                if (h.length > (m_length - h.payload) / (isMap ? 2 : 1)) {
+                    return fail(pos, "Container length exceeds document size");
+                }
+
+                Container c;
+                c.offset = pos;
+                c.end = 0;
+                c.size = 0;
+                m_containers.push_back(c);
+
+                Frame f;
+                f.container = m_containers.size() - 1;
+                f.remaining = isMap ? h.length * 2 : h.length;
+                f.indefinite = h.indefinite;
+                f.isMap = isMap;
+                f.expectKey = isMap;
+                stack.push_back(f);
+
+                pos = h.payload;
+            } else if (h.kind == BinaryHeader::kString) {
+                if (h.length > m_length - h.payload) {
+                    return fail(pos, "String length exceeds document size");
+                }
+                pos = h.payload + static_cast<size_t>(h.length);
+            } else {
+                pos = h.payload;
+            }
+
+            // Close any containers that end here
+            for (;;) {
+                if (stack.empty()) {
+                    if (pos != m_length) {
+                        return fail(pos, "Unexpected data after document");
+                    }
+
+                    m_valid = true;
+                    return true;
+                }
+
+                const Frame &f = stack.back();
+                if (f.indefinite) {
+                    if (!Format::isBreak(bytes, m_length, pos)) {
+                        break;
+                    }
+                    if (f.isMap && !f.expectKey) {
+                        return fail(pos, "Map is missing a value");
+                    }
+                    pos++;
+                } else if (f.remaining > 0) {
+                    break;
+                }
+
+                m_containers[f.container].end = pos;
+                stack.pop_back();
+            }
+        }
+    }
+
+    /// Non-owned bytes, when m_owned is false
+    const uint8_t *m_source;
+
+    /// Owned bytes, when m_owned is true
+    std::string m_buffer;
+
+    /// Length of document in bytes
+    size_t m_length;
+
+    /// True if the bytes are stored in m_buffer
+    bool m_owned;
+
+    /// True if the document was parsed successfully
+    bool m_valid;
+
+    /// Index of arrays and maps, ordered by offset
+    std::vector<Container> m_containers;
+
+    /// Description of the last parse error
+    std::string m_error;
+
+    /// Offset of the last parse error
+    size_t m_errorOffset;
+};
+
+/// Read-only view of a MessagePack document
+typedef BinaryDocument<MsgPackFormat> MsgPackDocument;
+
+/// Read-only view of a CBOR document
+typedef BinaryDocument<CborFormat> CborDocument;
+
+}  // namespace valijson
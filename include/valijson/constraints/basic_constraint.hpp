@@ -27,7 +27,7 @@ struct BasicConstraint: Constraint
       : m_allocator(allocFn, freeFn) { }
 
     BasicConstraint(const BasicConstraint &other)
-      : m_allocator(other.m_allocator) { }
+      : m_allocator(other.m_allocator.select_on_container_copy_construction()) { }
 
     ~BasicConstraint() override = default;
 
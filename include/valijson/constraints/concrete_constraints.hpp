@@ -16,11 +16,15 @@
 
 #include <limits>
 #include <map>
+#include <new>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 #include <cmath>
 
+#include <valijson/adapters/packed_value_adapter.hpp>
 #include <valijson/constraints/basic_constraint.hpp>
 #include <valijson/internal/custom_allocator.hpp>
 #include <valijson/internal/frozen_value.hpp>
@@ -200,7 +204,8 @@ public:
 
     void setValue(const adapters::Adapter &value)
     {
-        m_value = std::unique_ptr<adapters::FrozenValue>(value.freeze());
+        // Store a compact copy, rather than a copy of the parser's own DOM
+        m_value = std::unique_ptr<adapters::FrozenValue>(new adapters::PackedFrozenValue(value));
     }
 
 private:
@@ -349,81 +354,143 @@ private:
  * An enum constraint provides a collection of permissible values for a JSON
  * node. The node will only validate against this constraint if it matches one
  * or more of the values in the collection.
+ *
+ * Values added as Adapters are copied into a single PackedValueStore, which
+ * stores each distinct string only once, and uses the constraint's allocation
+ * functions. Values added as FrozenValues are cloned and kept as they are.
  */
 class EnumConstraint: public BasicConstraint<EnumConstraint>
 {
 public:
     EnumConstraint()
-      : m_enumValues(Allocator::rebind<const EnumValue *>::other(m_allocator)) { }
+      : m_packedValues(m_allocator.allocationFunctions()),
+        m_enumValues(Allocator::rebind<EnumValue>::other(m_allocator)) { }
 
     EnumConstraint(CustomAlloc allocFn, CustomFree freeFn)
       : BasicConstraint(allocFn, freeFn),
-        m_enumValues(Allocator::rebind<const EnumValue *>::other(m_allocator)) { }
+        m_packedValues(allocFn, freeFn),
+        m_enumValues(Allocator::rebind<EnumValue>::other(m_allocator)) { }
 
     EnumConstraint(const EnumConstraint &other)
       : BasicConstraint(other),
-        m_enumValues(Allocator::rebind<const EnumValue *>::other(m_allocator))
+        m_packedValues(other.m_packedValues),
+        m_enumValues(Allocator::rebind<EnumValue>::other(m_allocator))
     {
+        m_enumValues.reserve(other.m_enumValues.size());
+
 #if VALIJSON_USE_EXCEPTIONS
         try {
 #endif
-            // Clone individual enum values
-            for (const EnumValue *otherValue : other.m_enumValues) {
-                const EnumValue *value = otherValue->clone();
-#if VALIJSON_USE_EXCEPTIONS
-                try {
-#endif
-                    m_enumValues.push_back(value);
-#if VALIJSON_USE_EXCEPTIONS
-                } catch (...) {
-                    delete value;
-                    value = nullptr;
-                    throw;
+            // Clone individual enum values that are not packed
+            for (const EnumValue &otherValue : other.m_enumValues) {
+                EnumValue value = otherValue;
+                if (value.frozen) {
+                    value.frozen = value.frozen->clone();
                 }
+                m_enumValues.push_back(value);
             }
+#if VALIJSON_USE_EXCEPTIONS
         } catch (...) {
             // Delete values already added to constraint
-            for (const EnumValue *value : m_enumValues) {
-                delete value;
+            for (const EnumValue &value : m_enumValues) {
+                delete value.frozen;
             }
             throw;
-#endif
         }
+#endif
     }
 
     ~EnumConstraint() override
     {
-        for (const EnumValue *value : m_enumValues) {
-            delete value;
+        for (const EnumValue &value : m_enumValues) {
+            delete value.frozen;
         }
     }
 
     void addValue(const adapters::Adapter &value)
     {
-        // TODO: Freeze value using custom alloc/free functions
-        m_enumValues.push_back(value.freeze());
+        m_enumValues.reserve(m_enumValues.size() + 1);
+
+        EnumValue enumValue;
+        enumValue.index = m_packedValues.add(value);
+        enumValue.hash = adapters::PackedAdapter(m_packedValues, enumValue.index).hash();
+        enumValue.frozen = nullptr;
+        m_enumValues.push_back(enumValue);
     }
 
     void addValue(const adapters::FrozenValue &value)
     {
+        m_enumValues.reserve(m_enumValues.size() + 1);
+
         // TODO: Clone using custom alloc/free functions
-        m_enumValues.push_back(value.clone());
+        EnumValue enumValue;
+        enumValue.index = 0;
+        enumValue.hash = value.hash();
+        enumValue.frozen = value.clone();
+        m_enumValues.push_back(enumValue);
     }
 
     template<typename FunctorType>
     void applyToValues(const FunctorType &fn) const
     {
-        for (const EnumValue *value : m_enumValues) {
-            if (!fn(*value)) {
+        for (const EnumValue &value : m_enumValues) {
+            if (!applyToValue(value, fn)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief   Apply a functor to the values that have a given structural hash
+     *
+     * Values that are equal under strict comparison have the same hash, so
+     * when strict types are in use, only these values need to be compared
+     * with a target value. Values from FrozenValue implementations that do
+     * not provide a structural hash are always compared.
+     *
+     * @param   hash  structural hash of the target value
+     * @param   fn    functor to apply to each matching value
+     */
+    template<typename FunctorType>
+    void applyToValuesWithHash(uint64_t hash, const FunctorType &fn) const
+    {
+        for (const EnumValue &value : m_enumValues) {
+            if ((value.hash == hash || value.hash == adapters::FrozenValue::unknownHash()) &&
+                    !applyToValue(value, fn)) {
                 return;
             }
         }
     }
 
 private:
-    typedef adapters::FrozenValue EnumValue;
 
-    typedef std::vector<const EnumValue *, internal::CustomAllocator<const EnumValue *>> EnumValues;
+    /// A permissible value, which is either packed or frozen
+    struct EnumValue
+    {
+        /// Structural hash of the value
+        uint64_t hash;
+
+        /// Index of the value in m_packedValues, if it is packed
+        uint32_t index;
+
+        /// Frozen value, or nullptr if the value is packed
+        const adapters::FrozenValue *frozen;
+    };
+
+    typedef std::vector<EnumValue, internal::CustomAllocator<EnumValue>> EnumValues;
+
+    template<typename FunctorType>
+    bool applyToValue(const EnumValue &value, const FunctorType &fn) const
+    {
+        if (value.frozen) {
+            return fn(*value.frozen);
+        }
+
+        return fn(adapters::PackedFrozenValue(m_packedValues, value.index, value.hash));
+    }
+
+    /// Compact copies of the values that were added as Adapters
+    adapters::PackedValueStore m_packedValues;
 
     EnumValues m_enumValues;
 };
@@ -933,6 +1000,30 @@ private:
     String m_pattern;
 };
 
+/**
+ * @brief   Common base class for TypedPolyValidator instantiations
+ */
+class TypedPolyValidatorBase
+{
+public:
+    virtual ~TypedPolyValidatorBase() { }
+};
+
+/**
+ * @brief   Interface for custom constraints that can validate values of a
+ *          specific adapter type, without type erasure
+ *
+ * @tparam  AdapterType  type of Adapter that can be validated
+ */
+template<typename AdapterType>
+class TypedPolyValidator : public TypedPolyValidatorBase
+{
+public:
+    virtual bool validateTyped(const AdapterType &target,
+            const std::vector<std::string> &context,
+            valijson::ValidationResults *results) const = 0;
+};
+
 class PolyConstraint : public Constraint
 {
 public:
@@ -961,12 +1052,126 @@ public:
             const std::vector<std::string>& context,
             valijson::ValidationResults *results) const = 0;
 
+    /**
+     * @brief   Return a validator for values of a specific adapter type, if
+     *          this constraint provides one
+     *
+     * @tparam  AdapterType  type of Adapter to be validated
+     *
+     * @returns pointer to a TypedPolyValidator, or nullptr if values of this
+     *          type must be validated using the type-erased validate() function
+     */
+    template<typename AdapterType>
+    const TypedPolyValidator<AdapterType> * getTypedValidator() const
+    {
+        return static_cast<const TypedPolyValidator<AdapterType> *>(
+                findTypedValidator(typeid(AdapterType)));
+    }
+
+protected:
+    /**
+     * @brief   Find the TypedPolyValidator for an adapter type
+     *
+     * The pointer returned by this function must point to an instance of
+     * TypedPolyValidator<T>, where T is the type identified by adapterType.
+     */
+    virtual const TypedPolyValidatorBase * findTypedValidator(const std::type_info &) const
+    {
+        return nullptr;
+    }
+
 private:
     virtual Constraint * cloneInto(void *) const = 0;
 
     virtual size_t sizeOf() const = 0;
 };
 
+/**
+ * @brief   Implements TypedPolyValidator for a PolyConstraintT, by calling the
+ *          validateTarget() function template of the Derived class
+ */
+template<typename Derived, typename AdapterType>
+class TypedPolyValidatorImpl : public TypedPolyValidator<AdapterType>
+{
+public:
+    bool validateTyped(const AdapterType &target,
+            const std::vector<std::string> &context,
+            valijson::ValidationResults *results) const override
+    {
+        return static_cast<const Derived *>(this)->template validateTarget<AdapterType>(
+                target, context, results);
+    }
+};
+
+/**
+ * @brief   Base class for custom constraints that are implemented using a
+ *          function template
+ *
+ * The Derived class must be copy constructible, and must provide a function
+ * template with the following signature:
+ *
+ *   template<typename AdapterType>
+ *   bool validateTarget(const AdapterType &target,
+ *           const std::vector<std::string> &context,
+ *           valijson::ValidationResults *results) const;
+ *
+ * This is instantiated for each of the adapter types listed as template
+ * arguments, allowing ValidationVisitor to call it directly with the target's
+ * concrete adapter type. It is also instantiated for adapters::Adapter, which
+ * is used to validate values of any other adapter type.
+ *
+ * @tparam  Derived       the custom constraint class (CRTP)
+ * @tparam  AdapterTypes  adapter types to be validated without type erasure
+ */
+template<typename Derived, typename... AdapterTypes>
+class PolyConstraintT :
+    public PolyConstraint,
+    public TypedPolyValidatorImpl<Derived, AdapterTypes>...
+{
+public:
+    bool validate(const adapters::Adapter &target,
+            const std::vector<std::string> &context,
+            valijson::ValidationResults *results) const override
+    {
+        return static_cast<const Derived *>(this)->template validateTarget<adapters::Adapter>(
+                target, context, results);
+    }
+
+protected:
+    const TypedPolyValidatorBase * findTypedValidator(const std::type_info &adapterType) const override
+    {
+        return findTypedValidatorIn<AdapterTypes...>(adapterType);
+    }
+
+private:
+    template<typename... Types>
+    typename std::enable_if<sizeof...(Types) == 0, const TypedPolyValidatorBase *>::type
+    findTypedValidatorIn(const std::type_info &) const
+    {
+        return nullptr;
+    }
+
+    template<typename AdapterType, typename... Types>
+    const TypedPolyValidatorBase * findTypedValidatorIn(const std::type_info &adapterType) const
+    {
+        if (adapterType == typeid(AdapterType)) {
+            return static_cast<const TypedPolyValidator<AdapterType> *>(this);
+        }
+
+        return findTypedValidatorIn<Types...>(adapterType);
+    }
+
+    Constraint * cloneInto(void *ptr) const override
+    {
+        return new (ptr) Derived(*static_cast<const Derived *>(this));
+    }
+
+    size_t sizeOf() const override
+    {
+        return sizeof(Derived);
+    }
+};
+
 /**
  * @brief   Represents a combination of 'properties', 'patternProperties' and
  *          'additionalProperties' constraints
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <valijson/constraints/constraint.hpp>
+#include <valijson/constraints/constraint_visitor.hpp>
+
+namespace valijson {
+namespace constraints {
+
+/**
+ * @brief  Enumeration of the concrete constraint types known to ConstraintVisitor
+ *
+ * This is intended for code that needs to aggregate information by constraint
+ * type (e.g. instrumentation and statistics), where a small integral key is
+ * more convenient than dispatching through a ConstraintVisitor.
+ */
+enum ConstraintKind
+{
+    kAllOf,
+    kAnyOf,
+    kConditional,
+    kConst,
+    kContains,
+    kDependencies,
+    kEnum,
+    kFormat,
+    kLinearItems,
+    kMaximum,
+    kMaxItems,
+    kMaxLength,
+    kMaxProperties,
+    kMinimum,
+    kMinItems,
+    kMinLength,
+    kMinProperties,
+    kMultipleOfDouble,
+    kMultipleOfInt,
+    kNot,
+    kOneOf,
+    kPattern,
+    kPoly,
+    kProperties,
+    kPropertyNames,
+    kRequired,
+    kSingularItems,
+    kType,
+    kUniqueItems,
+
+    /// Number of constraint kinds; not a valid kind
+    kNumConstraintKinds
+};
+
+/**
+ * @brief  Implementation of the ConstraintVisitor interface that records the
+ *         kind of the constraint that was visited.
+ */
+class ConstraintKindVisitor: public ConstraintVisitor
+{
+public:
+    ConstraintKindVisitor()
+      : m_kind(kNumConstraintKinds) { }
+
+    ConstraintKind getKind() const
+    {
+        return m_kind;
+    }
+
+    bool visit(const AllOfConstraint &) override
+    {
+        return set(kAllOf);
+    }
+
+    bool visit(const AnyOfConstraint &) override
+    {
+        return set(kAnyOf);
+    }
+
+    bool visit(const ConditionalConstraint &) override
+    {
+        return set(kConditional);
+    }
+
+    bool visit(const ConstConstraint &) override
+    {
+        return set(kConst);
+    }
+
+    bool visit(const ContainsConstraint &) override
+    {
+        return set(kContains);
+    }
+
+    bool visit(const DependenciesConstraint &) override
+    {
+        return set(kDependencies);
+    }
+
+    bool visit(const EnumConstraint &) override
+    {
+        return set(kEnum);
+    }
+
+    bool visit(const FormatConstraint &) override
+    {
+        return set(kFormat);
+    }
+
+    bool visit(const LinearItemsConstraint &) override
+    {
+        return set(kLinearItems);
+    }
+
+    bool visit(const MaximumConstraint &) override
+    {
+        return set(kMaximum);
+    }
+
+    bool visit(const MaxItemsConstraint &) override
+    {
+        return set(kMaxItems);
+    }
+
+    bool visit(const MaxLengthConstraint &) override
+    {
+        return set(kMaxLength);
+    }
+
+    bool visit(const MaxPropertiesConstraint &) override
+    {
+        return set(kMaxProperties);
+    }
+
+    bool visit(const MinimumConstraint &) override
+    {
+        return set(kMinimum);
+    }
+
+    bool visit(const MinItemsConstraint &) override
+    {
+        return set(kMinItems);
+    }
+
+    bool visit(const MinLengthConstraint &) override
+    {
+        return set(kMinLength);
+    }
+
+    bool visit(const MinPropertiesConstraint &) override
+    {
+        return set(kMinProperties);
+    }
+
+    bool visit(const MultipleOfDoubleConstraint &) override
+    {
+        return set(kMultipleOfDouble);
+    }
+
+    bool visit(const MultipleOfIntConstraint &) override
+    {
+        return set(kMultipleOfInt);
+    }
+
+    bool visit(const NotConstraint &) override
+    {
+        return set(kNot);
+    }
+
+    bool visit(const OneOfConstraint &) override
+    {
+        return set(kOneOf);
+    }
+
+    bool visit(const PatternConstraint &) override
+    {
+        return set(kPattern);
+    }
+
+    bool visit(const PolyConstraint &) override
+    {
+        return set(kPoly);
+    }
+
+    bool visit(const PropertiesConstraint &) override
+    {
+        return set(kProperties);
+    }
+
+    bool visit(const PropertyNamesConstraint &) override
+    {
+        return set(kPropertyNames);
+    }
+
+    bool visit(const RequiredConstraint &) override
+    {
+        return set(kRequired);
+    }
+
+    bool visit(const SingularItemsConstraint &) override
+    {
+        return set(kSingularItems);
+    }
+
+    bool visit(const TypeConstraint &) override
+    {
+        return set(kType);
+    }
+
+    bool visit(const UniqueItemsConstraint &) override
+    {
+        return set(kUniqueItems);
+    }
+
+private:
+    bool set(ConstraintKind kind)
+    {
+        m_kind = kind;
+        return true;
+    }
+
+    ConstraintKind m_kind;
+};
+
+/**
+ * @brief  Return the kind of a constraint
+ *
+ * @param  constraint  constraint to inspect
+ */
+inline ConstraintKind getConstraintKind(const Constraint &constraint)
+{
+    ConstraintKindVisitor visitor;
+    constraint.accept(visitor);
+    return visitor.getKind();
+}
+
+/**
+ * @brief  Return a unique, human readable name for a kind of constraint
+ *
+ * Names are derived from the constraint class names, e.g. 'LinearItems' for
+ * LinearItemsConstraint, so that constraints that share a keyword in JSON
+ * Schema can still be told apart.
+ */
+inline const char * constraintKindName(ConstraintKind kind)
+{
+    switch (kind) {
+    case kAllOf: return "AllOf";
+    case kAnyOf: return "AnyOf";
+    case kConditional: return "Conditional";
+    case kConst: return "Const";
+    case kContains: return "Contains";
+    case kDependencies: return "Dependencies";
+    case kEnum: return "Enum";
+    case kFormat: return "Format";
+    case kLinearItems: return "LinearItems";
+    case kMaximum: return "Maximum";
+    case kMaxItems: return "MaxItems";
+    case kMaxLength: return "MaxLength";
+    case kMaxProperties: return "MaxProperties";
+    case kMinimum: return "Minimum";
+    case kMinItems: return "MinItems";
+    case kMinLength: return "MinLength";
+    case kMinProperties: return "MinProperties";
+    case kMultipleOfDouble: return "MultipleOfDouble";
+    case kMultipleOfInt: return "MultipleOfInt";
+    case kNot: return "Not";
+    case kOneOf: return "OneOf";
+    case kPattern: return "Pattern";
+    case kPoly: return "Poly";
+    case kProperties: return "Properties";
+    case kPropertyNames: return "PropertyNames";
+    case kRequired: return "Required";
+    case kSingularItems: return "SingularItems";
+    case kType: return "Type";
+    case kUniqueItems: return "UniqueItems";
+    default: break;
+    }
+
+    return "Unknown";
+}
+
+/**
+ * @brief  Return the JSON Schema keyword that usually gives rise to a kind of
+ *         constraint
+ *
+ * Custom constraints (PolyConstraint) are not associated with a keyword that
+ * is known to the library, so an empty string is returned for them.
+ */
+inline const char * constraintKeyword(ConstraintKind kind)
+{
+    switch (kind) {
+    case kAllOf: return "allOf";
+    case kAnyOf: return "anyOf";
+    case kConditional: return "if";
+    case kConst: return "const";
+    case kContains: return "contains";
+    case kDependencies: return "dependencies";
+    case kEnum: return "enum";
+    case kFormat: return "format";
+    case kLinearItems: return "items";
+    case kMaximum: return "maximum";
+    case kMaxItems: return "maxItems";
+    case kMaxLength: return "maxLength";
+    case kMaxProperties: return "maxProperties";
+    case kMinimum: return "minimum";
+    case kMinItems: return "minItems";
+    case kMinLength: return "minLength";
+    case kMinProperties: return "minProperties";
+    case kMultipleOfDouble: return "multipleOf";
+    case kMultipleOfInt: return "multipleOf";
+    case kNot: return "not";
+    case kOneOf: return "oneOf";
+    case kPattern: return "pattern";
+    case kPoly: return "";
+    case kProperties: return "properties";
+    case kPropertyNames: return "propertyNames";
+    case kRequired: return "required";
+    case kSingularItems: return "items";
+    case kType: return "type";
+    case kUniqueItems: return "uniqueItems";
+    default: break;
+    }
+
+    return "";
+}
+
+}  // namespace constraints
+}  // namespace valijson
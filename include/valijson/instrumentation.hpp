@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valijson/constraints/constraint_kind.hpp>
+#include <valijson/subschema.hpp>
+
+/**
+ * Instrumentation hooks are compiled in by default. When no Instrumentation,
+ * ValidationObserver or ValidationStats object has been attached to a
+ * Validator, the cost is a few null pointer checks per sub-schema. Define
+ * VALIJSON_USE_INSTRUMENTATION to 0 to remove the hooks from
+ * ValidationVisitor entirely. Attaching an Instrumentation object or observer
+ * is then a compile error.
+ */
+#ifndef VALIJSON_USE_INSTRUMENTATION
+#define VALIJSON_USE_INSTRUMENTATION 1
+#endif
+
+namespace valijson {
+
+/**
+ * @brief  Collects invocation counts, failure counts and latency histograms
+ *         for each constraint evaluated during validation.
+ *
+ * Statistics are aggregated per (Subschema, constraint kind) pair, so that a
+ * report can identify which keywords of which sub-schemas account for the most
+ * validation time. Timings are inclusive; the time recorded for a constraint
+ * such as 'properties' or 'anyOf' includes the time spent validating nested
+ * sub-schemas.
+ *
+ * An Instrumentation object is attached to a Validator via the
+ * setInstrumentation() function. Instances are not thread-safe, so each
+ * Validator should be given its own Instrumentation object.
+ */
+class Instrumentation
+{
+public:
+    /// Clock used to measure constraint latency
+    typedef std::chrono::steady_clock Clock;
+
+    /// Number of buckets in each latency histogram
+    enum { kNumHistogramBuckets = 32 };
+
+    /**
+     * @brief  Statistics recorded for a single constraint, or an aggregate of
+     *         several constraints.
+     *
+     * Bucket \c i of the histogram counts invocations that took less than
+     * 2^i nanoseconds, but no less than 2^(i-1) nanoseconds. The final bucket
+     * also counts all invocations that took longer than that.
+     */
+    struct ConstraintStats
+    {
+        ConstraintStats()
+          : invocations(0),
+            failures(0),
+            totalNanoseconds(0),
+            maxNanoseconds(0),
+            histogram() { }
+
+        /// Number of times the constraint was evaluated
+        uint64_t invocations;
+
+        /// Number of evaluations that reported a validation failure
+        uint64_t failures;
+
+        /// Total time spent evaluating the constraint
+        uint64_t totalNanoseconds;
+
+        /// Longest time spent on a single evaluation
+        uint64_t maxNanoseconds;
+
+        /// Latency histogram, using power-of-two buckets
+        uint64_t histogram[kNumHistogramBuckets];
+
+        void add(const ConstraintStats &other)
+        {
+            invocations += other.invocations;
+            failures += other.failures;
+            totalNanoseconds += other.totalNanoseconds;
+            maxNanoseconds = std::max(maxNanoseconds, other.maxNanoseconds);
+            for (size_t i = 0; i < kNumHistogramBuckets; i++) {
+                histogram[i] += other.histogram[i];
+            }
+        }
+    };
+
+    /**
+     * @brief  Statistics for a particular constraint kind within a particular
+     *         sub-schema.
+     */
+    struct ReportEntry
+    {
+        /// Sub-schema that owns the constraint
+        const Subschema *subschema;
+
+        /// Kind of constraint
+        constraints::ConstraintKind kind;
+
+        /// Statistics recorded for the constraint
+        ConstraintStats stats;
+    };
+
+    Instrumentation()
+      : m_enabled(true) { }
+
+    /**
+     * @brief  Enable or disable collection of statistics
+     *
+     * A disabled Instrumentation object remains attached to a Validator, but
+     * validation proceeds as though it were not.
+     */
+    void setEnabled(bool enabled)
+    {
+        m_enabled = enabled;
+    }
+
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * @brief  Record a single evaluation of a constraint
+     *
+     * @param  subschema    sub-schema that owns the constraint
+     * @param  kind         kind of constraint that was evaluated
+     * @param  validated    whether the target satisfied the constraint
+     * @param  nanoseconds  time taken to evaluate the constraint
+     */
+    void record(const Subschema &subschema, constraints::ConstraintKind kind,
+            bool validated, uint64_t nanoseconds)
+    {
+        ConstraintStats &stats = m_stats[Key(&subschema, kind)];
+        stats.invocations++;
+        if (!validated) {
+            stats.failures++;
+        }
+        stats.totalNanoseconds += nanoseconds;
+        stats.maxNanoseconds = std::max(stats.maxNanoseconds, nanoseconds);
+        stats.histogram[bucketIndex(nanoseconds)]++;
+    }
+
+    /**
+     * @brief  Discard all statistics that have been recorded so far
+     */
+    void reset()
+    {
+        m_stats.clear();
+    }
+
+    /**
+     * @brief  Return the statistics recorded for each constraint
+     *
+     * Entries are ordered by total time, with the most expensive constraints
+     * appearing first.
+     */
+    std::vector<ReportEntry> report() const
+    {
+        std::vector<ReportEntry> entries;
+        entries.reserve(m_stats.size());
+        for (const auto &stats : m_stats) {
+            entries.push_back(ReportEntry{stats.first.first, stats.first.second, stats.second});
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const ReportEntry &a, const ReportEntry &b) {
+            if (a.stats.totalNanoseconds != b.stats.totalNanoseconds) {
+                return a.stats.totalNanoseconds > b.stats.totalNanoseconds;
+            }
+            return a.stats.invocations > b.stats.invocations;
+        });
+
+        return entries;
+    }
+
+    /**
+     * @brief  Return statistics aggregated over all sub-schemas, for a given
+     *         kind of constraint
+     */
+    ConstraintStats totalsForKind(constraints::ConstraintKind kind) const
+    {
+        ConstraintStats totals;
+        for (const auto &stats : m_stats) {
+            if (stats.first.second == kind) {
+                totals.add(stats.second);
+            }
+        }
+
+        return totals;
+    }
+
+    /**
+     * @brief  Return the histogram bucket for a given latency
+     */
+    static size_t bucketIndex(uint64_t nanoseconds)
+    {
+        size_t index = 0;
+        while (nanoseconds > 0 && index < kNumHistogramBuckets - 1) {
+            nanoseconds >>= 1;
+            index++;
+        }
+
+        return index;
+    }
+
+private:
+    typedef std::pair<const Subschema *, constraints::ConstraintKind> Key;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return std::hash<const Subschema *>()(key.first) * 31 + static_cast<size_t>(key.second);
+        }
+    };
+
+    /// Flag indicating whether statistics should be collected
+    bool m_enabled;
+
+    /// Statistics for each constraint that has been evaluated
+    std::unordered_map<Key, ConstraintStats, KeyHash> m_stats;
+};
+
+}  // namespace valijson
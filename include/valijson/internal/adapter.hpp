@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
+
+#include <valijson/internal/structural_hash.hpp>
+#include <valijson/utils/utf8_utils.hpp>
 
 namespace valijson {
 namespace adapters {
@@ -175,6 +180,24 @@ public:
      */
     virtual bool asString(std::string &result) const = 0;
 
+    /**
+     * @brief   Return the length of the string representation of the
+     *          contained value, in Unicode code points.
+     *
+     * The string representation is the same as that returned by asString().
+     * The default implementation counts the code points in that string.
+     * Adapters for parsers that do not store strings as UTF-8 may override
+     * this to avoid a conversion.
+     *
+     * An exception shall be thrown if the value cannot be cast to a string.
+     *
+     * @returns  number of code points in the string representation
+     */
+    virtual uint64_t asStringLength() const
+    {
+        return utils::u8_strlen(asString().c_str());
+    }
+
     /**
      * @brief   Compare the value held by this Adapter instance with the value
      *          held by another Adapter instance.
@@ -186,6 +209,53 @@ public:
      */
     virtual bool equalTo(const Adapter &other, bool strict) const = 0;
 
+    /**
+     * @brief   Return a structural hash of the value held by this Adapter.
+     *
+     * Values that are equal under strict comparison (i.e. values for which
+     * equalTo() returns true when the strict flag is set) shall produce the
+     * same hash, even if they are held by different kinds of Adapter. Objects
+     * are assumed not to contain duplicate property names.
+     *
+     * The default implementation walks the value using the rest of this
+     * interface. Adapters may override it to avoid the callbacks.
+     *
+     * @see StructuralHash
+     *
+     * @returns hash of the contained value
+     */
+    virtual uint64_t hash() const
+    {
+        if (isNull()) {
+            return StructuralHash::null();
+        } else if (isBool()) {
+            return StructuralHash::boolean(getBool());
+        } else if (isNumber()) {
+            return StructuralHash::number(getNumber());
+        } else if (isString()) {
+            const std::string s = getString();
+            return StructuralHash::string(s.data(), s.size());
+        } else if (isArray()) {
+            uint64_t result = StructuralHash::beginArray(getArraySize());
+            applyToArray([&result](const Adapter &element) {
+                result = StructuralHash::element(result, element.hash());
+                return true;
+            });
+
+            return result;
+        } else if (isObject()) {
+            uint64_t sum = 0;
+            applyToObject([&sum](const std::string &name, const Adapter &value) {
+                sum += StructuralHash::member(name.data(), name.size(), value.hash());
+                return true;
+            });
+
+            return StructuralHash::object(sum, getObjectSize());
+        }
+
+        return 0;
+    }
+
     /**
      * @brief   Create a new FrozenValue instance that is equivalent to the
      *          value contained by the Adapter.
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cerrno>
 #include <cstdint>
-#include <sstream>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <typeinfo>
+#include <utility>
 
 #include <valijson/internal/adapter.hpp>
+#include <valijson/internal/object_member_key.hpp>
 #include <valijson/internal/optional.hpp>
+#include <valijson/internal/structural_hash.hpp>
+#include <valijson/utils/utf8_utils.hpp>
 #include <valijson/exceptions.hpp>
 
 namespace valijson {
@@ -38,6 +46,40 @@ private:
     Value m_ref;
 };
 
+namespace detail {
+
+/**
+ * @brief   Measures a string held by a value type that does not provide a
+ *          getStringLength() function
+ *
+ * @returns false, so that the length is computed from the UTF-8 form of the
+ *          string
+ */
+template<typename ValueType, typename Enable = void>
+struct ValueStringLength
+{
+    static bool get(const ValueType &, uint64_t &)
+    {
+        return false;
+    }
+};
+
+/**
+ * @brief   Specialisation of ValueStringLength for value types that can
+ *          measure their own strings
+ */
+template<typename ValueType>
+struct ValueStringLength<ValueType, typename VoidType<decltype(
+        std::declval<const ValueType &>().getStringLength(std::declval<uint64_t &>()))>::type>
+{
+    static bool get(const ValueType &value, uint64_t &result)
+    {
+        return value.getStringLength(result);
+    }
+};
+
+}  // namespace detail
+
 /**
  * @brief  Template class that implements the expected semantics of an Adapter.
  *
@@ -354,14 +396,7 @@ public:
         } else if (m_value.isString()) {
             std::string s;
             if (m_value.getString(s)) {
-                const char *b = s.c_str();
-                char *e = nullptr;
-                double x = strtod(b, &e);
-                if (e == b || e != b + s.length()) {
-                    return false;
-                }
-                result = x;
-                return true;
+                return parseDouble(s, result);
             }
         }
 
@@ -385,13 +420,7 @@ public:
         } else if (m_value.isString()) {
             std::string s;
             if (m_value.getString(s)) {
-                std::istringstream i(s);
-                int64_t x;
-                char c;
-                if (!(!(i >> x) || i.get(c))) {
-                    result = x;
-                    return true;
-                }
+                return parseInteger(s, result);
             }
         }
 
@@ -481,44 +510,88 @@ public:
         return false;
     }
 
+    /**
+     * @brief   Return the length of the string representation of the
+     *          contained value, in code points
+     *
+     * A ValueType that does not store strings as UTF-8 may provide a
+     * getStringLength() function, which is used for string values instead of
+     * converting them with asString().
+     */
+    uint64_t asStringLength() const override
+    {
+        uint64_t result;
+        if (detail::ValueStringLength<ValueType>::get(m_value, result)) {
+            return result;
+        }
+
+        return Adapter::asStringLength();
+    }
+
     bool equalTo(const Adapter &other, bool strict) const override
     {
-        if (isNull() || (!strict && maybeNull())) {
-            return other.isNull() || (!strict && other.maybeNull());
-        } else if (isBool() || (!strict && maybeBool())) {
-            return (other.isBool() || (!strict && other.maybeBool())) && other.asBool() == asBool();
-        } else if (isNumber() && strict) {
-            return other.isNumber() && other.getNumber() == getNumber();
-        } else if (!strict && maybeDouble()) {
-            return (other.maybeDouble() && other.asDouble() == asDouble());
-        } else if (!strict && maybeInteger()) {
-            return (other.maybeInteger() && other.asInteger() == asInteger());
-        } else if (isString() || (!strict && maybeString())) {
-            return (other.isString() || (!strict && other.maybeString())) &&
-                other.asString() == asString();
-        } else if (isArray()) {
-            if (other.isArray() && getArraySize() == other.getArraySize()) {
-                const opt::optional<ArrayType> array = m_value.getArrayOptional();
-                if (array) {
-                    ArrayComparisonFunctor fn(*array, strict);
-                    return other.applyToArray(fn);
-                }
-            } else if (!strict && other.maybeArray() && getArraySize() == 0) {
-                return true;
+        // Values held by the same kind of Adapter can be compared without
+        // going through the callback-based parts of the Adapter interface
+        if (typeid(other) == typeid(AdapterType)) {
+            return equalTo(static_cast<const AdapterType &>(other), strict);
+        }
+
+        return compareWith(other, strict);
+    }
+
+    /**
+     * @brief   Compare the value held by this Adapter instance with the value
+     *          held by another Adapter of the same type.
+     *
+     * This has the same semantics as the equalTo() function declared in the
+     * Adapter interface, but arrays and objects are compared by iterating
+     * over both values directly. When the ObjectType guarantees that members
+     * are iterated in sorted order, objects are compared member-by-member
+     * without looking up each property name in the other object.
+     *
+     * @param   other   the other adapter instance
+     * @param   strict  flag to use strict type comparison
+     *
+     * @returns true if values are equal, false otherwise
+     */
+    bool equalTo(const AdapterType &other, bool strict) const
+    {
+        return compareWith(other, strict);
+    }
+
+    uint64_t hash() const override
+    {
+        if (m_value.isNull()) {
+            return StructuralHash::null();
+        } else if (m_value.isBool()) {
+            return StructuralHash::boolean(getBool());
+        } else if (m_value.isInteger() || m_value.isDouble()) {
+            return StructuralHash::number(getNumber());
+        } else if (m_value.isString()) {
+            const std::string s = getString();
+            return StructuralHash::string(s.data(), s.size());
+        } else if (m_value.isArray()) {
+            const ArrayType array = getArray();
+            uint64_t result = StructuralHash::beginArray(array.size());
+            for (const AdapterType element : array) {
+                result = StructuralHash::element(result, element.hash());
             }
-        } else if (isObject()) {
-            if (other.isObject() && other.getObjectSize() == getObjectSize()) {
-                const opt::optional<ObjectType> object = m_value.getObjectOptional();
-                if (object) {
-                    ObjectComparisonFunctor fn(*object, strict);
-                    return other.applyToObject(fn);
-                }
-            } else if (!strict && other.maybeObject() && getObjectSize() == 0) {
-                return true;
+
+            return result;
+        } else if (m_value.isObject()) {
+            typedef typename ObjectType::const_iterator MemberIterator;
+            const ObjectType object = getObject();
+            uint64_t sum = 0;
+            for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+                const ObjectMemberAccessor<MemberIterator> member(itr);
+                const ObjectMemberKey key = member.key();
+                sum += StructuralHash::member(key.data(), key.size(), member.value().hash());
             }
+
+            return StructuralHash::object(sum, object.size());
         }
 
-        return false;
+        return 0;
     }
 
     /**
@@ -770,11 +843,9 @@ public:
             return true;
         } else if (maybeString()) {
             std::string s;
+            double x;
             if (m_value.getString(s)) {
-                const char *b = s.c_str();
-                char *e = nullptr;
-                strtod(b, &e);
-                return e != b && e == b + s.length();
+                return parseDouble(s, x);
             }
         }
 
@@ -787,14 +858,9 @@ public:
             return true;
         } else if (maybeString()) {
             std::string s;
+            int64_t x;
             if (m_value.getString(s)) {
-                std::istringstream i(s);
-                int64_t x;
-                char c;
-                if (!(i >> x) || i.get(c)) {
-                    return false;
-                }
-                return true;
+                return parseInteger(s, x);
             }
         }
 
@@ -852,6 +918,165 @@ public:
 
 private:
 
+    /**
+     * @brief   Compare the value held by this Adapter with the value held by
+     *          another Adapter, which may or may not be of the same type
+     */
+    template<typename OtherAdapterType>
+    bool compareWith(const OtherAdapterType &other, bool strict) const
+    {
+        if (isNull() || (!strict && maybeNull())) {
+            return other.isNull() || (!strict && other.maybeNull());
+        } else if (isBool() || (!strict && maybeBool())) {
+            return (other.isBool() || (!strict && other.maybeBool())) && other.asBool() == asBool();
+        } else if (isNumber() && strict) {
+            return other.isNumber() && other.getNumber() == getNumber();
+        } else if (!strict && maybeDouble()) {
+            return (other.maybeDouble() && other.asDouble() == asDouble());
+        } else if (!strict && maybeInteger()) {
+            return (other.maybeInteger() && other.asInteger() == asInteger());
+        } else if (isString() || (!strict && maybeString())) {
+            return (other.isString() || (!strict && other.maybeString())) &&
+                other.asString() == asString();
+        } else if (isArray()) {
+            if (other.isArray() && getArraySize() == other.getArraySize()) {
+                return compareArrayWith(other, strict);
+            } else if (!strict && other.maybeArray() && getArraySize() == 0) {
+                return true;
+            }
+        } else if (isObject()) {
+            if (other.isObject() && other.getObjectSize() == getObjectSize()) {
+                return compareObjectWith(other, strict);
+            } else if (!strict && other.maybeObject() && getObjectSize() == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool compareArrayWith(const Adapter &other, bool strict) const
+    {
+        const opt::optional<ArrayType> array = m_value.getArrayOptional();
+        if (array) {
+            ArrayComparisonFunctor fn(*array, strict);
+            return other.applyToArray(fn);
+        }
+
+        return false;
+    }
+
+    bool compareArrayWith(const AdapterType &other, bool strict) const
+    {
+        typedef typename ArrayType::const_iterator ValueIterator;
+        const ArrayType array = getArray();
+        const ArrayType otherArray = other.getArray();
+        ValueIterator otherItr = otherArray.begin();
+        for (ValueIterator itr = array.begin(); itr != array.end(); ++itr, ++otherItr) {
+            if (otherItr == otherArray.end()) {
+                return false;
+            }
+
+            const AdapterType element = *itr;
+            if (!element.equalTo(AdapterType(*otherItr), strict)) {
+                return false;
+            }
+        }
+
+        return otherItr == otherArray.end();
+    }
+
+    bool compareObjectWith(const Adapter &other, bool strict) const
+    {
+        const opt::optional<ObjectType> object = m_value.getObjectOptional();
+        if (object) {
+            ObjectComparisonFunctor fn(*object, strict);
+            return other.applyToObject(fn);
+        }
+
+        return false;
+    }
+
+    bool compareObjectWith(const AdapterType &other, bool strict) const
+    {
+        typedef typename ObjectType::const_iterator MemberIterator;
+        const ObjectType object = getObject();
+        const ObjectType otherObject = other.getObject();
+
+        if (ObjectMembersSorted<ObjectType>::value()) {
+            // Both objects have the same number of members, so they can only
+            // be equal if their property names appear in the same sequence
+            MemberIterator otherItr = otherObject.begin();
+            for (MemberIterator itr = object.begin(); itr != object.end(); ++itr, ++otherItr) {
+                if (otherItr == otherObject.end()) {
+                    return false;
+                }
+
+                const ObjectMemberAccessor<MemberIterator> member(itr);
+                const ObjectMemberAccessor<MemberIterator> otherMember(otherItr);
+                if (member.key() != otherMember.key() ||
+                        !member.value().equalTo(otherMember.value(), strict)) {
+                    return false;
+                }
+            }
+
+            return otherItr == otherObject.end();
+        }
+
+        for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+            const ObjectMemberType member = *itr;
+            const MemberIterator found = otherObject.find(member.first);
+            if (found == otherObject.end() || !member.second.equalTo((*found).second, strict)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief   Parse a string that contains only a floating point number
+     *
+     * @returns true if the whole string was parsed, false otherwise
+     */
+    static bool parseDouble(const std::string &s, double &result)
+    {
+        const char *b = s.c_str();
+        char *e = nullptr;
+        const double x = strtod(b, &e);
+        if (e == b || e != b + s.length()) {
+            return false;
+        }
+
+        result = x;
+        return true;
+    }
+
+    /**
+     * @brief   Parse a string that contains only a decimal integer
+     *
+     * Accepts the same strings as extracting an int64_t from a
+     * std::istringstream and requiring that no characters remain, but without
+     * constructing a stream.
+     *
+     * @returns true if the whole string was parsed and the value fits in an
+     *          int64_t, false otherwise
+     */
+    static bool parseInteger(const std::string &s, int64_t &result)
+    {
+        const char *b = s.c_str();
+        char *e = nullptr;
+        errno = 0;
+        const long long x = strtoll(b, &e, 10);
+        if (e == b || e != b + s.length() || errno == ERANGE ||
+                x < std::numeric_limits<int64_t>::min() || x > std::numeric_limits<int64_t>::max()) {
+            return false;
+        }
+
+        result = static_cast<int64_t>(x);
+        return true;
+    }
+
     const ValueType m_value;
 };
 
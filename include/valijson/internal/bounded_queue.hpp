@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace valijson {
+namespace internal {
+
+/**
+ * @brief  Fixed-capacity, lock-free queue for any number of producers and
+ *         consumers
+ *
+ * Each slot in a ring buffer has a sequence number, which tells producers and
+ * consumers whether the slot is ready to be written or read for a particular
+ * position. Positions are claimed by a compare-and-swap on the head or tail
+ * counter, so a thread never waits for a lock held by another thread.
+ *
+ * Operations never block; tryPush() fails when the queue is full, and tryPop()
+ * fails when it is empty. Callers are expected to apply back-pressure, or to
+ * back off and retry.
+ *
+ * @tparam  T  type of value to be queued; must be default constructible and
+ *             move assignable
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief  Construct a queue that can hold at least \c capacity values
+     *
+     * The capacity is rounded up to a power of two.
+     */
+    explicit BoundedQueue(size_t capacity)
+      : m_cells(roundUp(capacity)),
+        m_mask(m_cells.size() - 1)
+    {
+        m_head.value.store(0, std::memory_order_relaxed);
+        m_tail.value.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < m_cells.size(); i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief  Return the number of values that the queue can hold
+     */
+    size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    /**
+     * @brief  Push a value on to the back of the queue, unless it is full
+     *
+     * @returns  true if the value was moved into the queue, false otherwise
+     */
+    bool tryPush(T &value)
+    {
+        size_t pos = m_tail.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_tail.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_tail.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief  Pop a value from the front of the queue, unless it is empty
+     *
+     * @returns  true if a value was moved into \c value, false otherwise
+     */
+    bool tryPop(T &value)
+    {
+        size_t pos = m_head.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_head.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_head.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+
+    static size_t roundUp(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+
+        return size;
+    }
+
+    struct Cell
+    {
+        Cell()
+          : sequence(0),
+            value() { }
+
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    /// Counter that is kept on a separate cache line from other members
+    struct PaddedCounter
+    {
+        char padding[64];
+        std::atomic<size_t> value;
+    };
+
+    /// Ring buffer of cells
+    std::vector<Cell> m_cells;
+
+    /// Mask used to map a position to a cell
+    size_t m_mask;
+
+    /// Position of the next value to be popped
+    PaddedCounter m_head;
+
+    /// Position of the next value to be pushed
+    PaddedCounter m_tail;
+};
+
+}  // namespace internal
+}  // namespace valijson
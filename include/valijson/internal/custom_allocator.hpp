@@ -1,10 +1,97 @@
 #pragma once
 
+#include <cstddef>
 #include <limits>
+#include <new>
 
 namespace valijson {
 namespace internal {
 
+/**
+ * @brief  Allocation functions used by default-constructed CustomAllocator
+ *         and Subschema instances
+ */
+struct AllocationFunctions
+{
+    void * (*allocFn)(size_t size);
+
+    void (*freeFn)(void *);
+
+    /// Function used instead of allocFn when context is set, which is given
+    /// the context explicitly
+    void * (*contextAllocFn)(void *context, size_t size);
+
+    /// Opaque state passed to contextAllocFn, such as a memory resource
+    void *context;
+
+    /**
+     * @brief  Allocate memory using contextAllocFn if there is a context, or
+     *         allocFn otherwise
+     */
+    void * allocate(size_t size) const
+    {
+        return context ? contextAllocFn(context, size) : allocFn(size);
+    }
+};
+
+inline void * defaultAlloc(size_t size)
+{
+    return ::operator new(size, std::nothrow);
+}
+
+inline void defaultFree(void *ptr)
+{
+    ::operator delete(ptr);
+}
+
+/**
+ * @brief  Return allocation functions that use ::operator new and
+ *         ::operator delete
+ */
+inline AllocationFunctions heapAllocationFunctions()
+{
+    return { defaultAlloc, defaultFree, nullptr, nullptr };
+}
+
+/**
+ * @brief  Return the allocation functions used by default on this thread
+ *
+ * These are ::operator new and ::operator delete, unless they have been
+ * replaced for a limited scope, e.g. by a ScopedMemoryResource. They are only
+ * read when a default-constructed object records its allocation functions,
+ * much like std::pmr::get_default_resource().
+ */
+inline AllocationFunctions & defaultAllocationFunctions()
+{
+    static thread_local AllocationFunctions functions = heapAllocationFunctions();
+    return functions;
+}
+
+/**
+ * @brief  Replaces the allocation functions used by default on this thread,
+ *         for the lifetime of this object
+ */
+class ScopedAllocationFunctions
+{
+public:
+    explicit ScopedAllocationFunctions(const AllocationFunctions &functions)
+      : m_previousFunctions(defaultAllocationFunctions())
+    {
+        defaultAllocationFunctions() = functions;
+    }
+
+    ~ScopedAllocationFunctions()
+    {
+        defaultAllocationFunctions() = m_previousFunctions;
+    }
+
+    ScopedAllocationFunctions(const ScopedAllocationFunctions &) = delete;
+    ScopedAllocationFunctions & operator=(const ScopedAllocationFunctions &) = delete;
+
+private:
+    const AllocationFunctions m_previousFunctions;
+};
+
 template<class T>
 class CustomAllocator
 {
@@ -15,6 +102,10 @@ public:
     /// Typedef for custom free-like function
     typedef void (*CustomFree)(void *);
 
+    /// Typedef for a new-like function that allocates using some state, such
+    /// as a memory resource
+    typedef void * (*ContextAlloc)(void *context, size_t size);
+
     // Standard allocator typedefs
     typedef T value_type;
     typedef T* pointer;
@@ -30,31 +121,70 @@ public:
         typedef CustomAllocator<U> other;
     };
 
+    /**
+     * @brief  Construct an allocator that uses the default allocation
+     *         functions for this thread, as they are now
+     */
     CustomAllocator()
-      : m_allocFn([](size_t size) { return ::operator new(size, std::nothrow); }),
-        m_freeFn(::operator delete) { }
+      : CustomAllocator(defaultAllocationFunctions()) { }
 
     CustomAllocator(CustomAlloc allocFn, CustomFree freeFn)
       : m_allocFn(allocFn),
-        m_freeFn(freeFn) { }
+        m_freeFn(freeFn),
+        m_contextAllocFn(nullptr),
+        m_context(nullptr) { }
+
+    explicit CustomAllocator(const AllocationFunctions &functions)
+      : m_allocFn(functions.allocFn),
+        m_freeFn(functions.freeFn),
+        m_contextAllocFn(functions.contextAllocFn),
+        m_context(functions.context) { }
 
     CustomAllocator(const CustomAllocator &other)
       : m_allocFn(other.m_allocFn),
-        m_freeFn(other.m_freeFn) { }
+        m_freeFn(other.m_freeFn),
+        m_contextAllocFn(other.m_contextAllocFn),
+        m_context(other.m_context) { }
 
     template<typename U>
     CustomAllocator(CustomAllocator<U> const &other)
       : m_allocFn(other.m_allocFn),
-        m_freeFn(other.m_freeFn) { }
+        m_freeFn(other.m_freeFn),
+        m_contextAllocFn(other.m_contextAllocFn),
+        m_context(other.m_context) { }
 
     CustomAllocator & operator=(const CustomAllocator &other)
     {
         m_allocFn = other.m_allocFn;
         m_freeFn = other.m_freeFn;
+        m_contextAllocFn = other.m_contextAllocFn;
+        m_context = other.m_context;
 
         return *this;
     }
 
+    /**
+     * @brief  Return the allocator used by a copy of a container
+     *
+     * As with std::pmr::polymorphic_allocator, the copy uses the default
+     * allocation functions, rather than those of the original. Subschema
+     * makes its own functions the default while it copies a constraint, so
+     * that constraints cloned into a schema use the schema's memory resource.
+     */
+    CustomAllocator select_on_container_copy_construction() const
+    {
+        return CustomAllocator();
+    }
+
+    /**
+     * @brief  Return the functions, and the state that they use, that this
+     *         allocator allocates and frees memory with
+     */
+    AllocationFunctions allocationFunctions() const
+    {
+        return { m_allocFn, m_freeFn, m_contextAllocFn, m_context };
+    }
+
     pointer address(reference r)
     {
         return &r;
@@ -67,7 +197,8 @@ public:
 
     pointer allocate(size_type cnt, const void * = nullptr)
     {
-        return reinterpret_cast<pointer>(m_allocFn(cnt * sizeof(T)));
+        const size_t size = cnt * sizeof(T);
+        return reinterpret_cast<pointer>(m_context ? m_contextAllocFn(m_context, size) : m_allocFn(size));
     }
 
     void deallocate(pointer p, size_type)
@@ -90,9 +221,17 @@ public:
         p->~T();
     }
 
+    /**
+     * @brief  Allocators are only equal if they allocate from the same place,
+     *         so those bound to different memory resources are not equal
+     *
+     * A container that is move-assigned from, or swapped with, a container
+     * whose allocator is not equal does not adopt the other's storage.
+     */
     bool operator==(const CustomAllocator &other) const
     {
-        return other.m_allocFn == m_allocFn && other.m_freeFn == m_freeFn;
+        return other.m_allocFn == m_allocFn && other.m_freeFn == m_freeFn &&
+                other.m_contextAllocFn == m_contextAllocFn && other.m_context == m_context;
     }
 
     bool operator!=(const CustomAllocator &other) const
@@ -103,6 +242,12 @@ public:
     CustomAlloc m_allocFn;
 
     CustomFree m_freeFn;
+
+    /// Function used instead of m_allocFn when m_context is set
+    ContextAlloc m_contextAllocFn;
+
+    /// State passed to m_contextAllocFn, such as a memory resource
+    void *m_context;
 };
 
 } // end namespace internal
@@ -13,8 +13,8 @@ namespace adapters {
  * this interface. That class should be able to maintain its own copy of a
  * JSON value, independent of the original document.
  *
- * This interface currently provides just the clone and equalTo functions, but
- * could be expanded to include other functions declared in the Adapter
+ * This interface currently provides just the clone, equalTo and hash functions,
+ * but could be expanded to include other functions declared in the Adapter
  * interface.
  *
  * @todo  it would be nice to better integrate this with the Adapter interface
@@ -46,6 +46,29 @@ public:
      */
     virtual bool equalTo(const Adapter &adapter, bool strict) const = 0;
 
+    /**
+     * @brief   Return the structural hash of the stored value.
+     *
+     * The result shall be the same as the result of calling hash() on an
+     * Adapter for the original value. The default implementation returns
+     * unknownHash(), so that the value is compared with every target.
+     */
+    virtual uint64_t hash() const
+    {
+        return unknownHash();
+    }
+
+    /**
+     * @brief   Return the hash of a value whose structural hash is not known
+     *
+     * Values with this hash must be compared with every target, rather than
+     * only with targets that have the same hash.
+     */
+    static uint64_t unknownHash()
+    {
+        return 0;
+    }
+
 };
 
 }  // namespace adapters
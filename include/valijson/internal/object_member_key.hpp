@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace valijson {
+namespace adapters {
+
+/**
+ * @brief   Non-owning view of the name of an object member
+ *
+ * An ObjectMemberIterator may provide a key() function that returns an
+ * ObjectMemberKey referring to a member's name as it is stored by the parser,
+ * and a value() function that returns an Adapter for the member's value. This
+ * allows members to be inspected without copying each name into the
+ * std::string held by an ObjectMember.
+ *
+ * The characters referred to by an ObjectMemberKey are not owned by it, and
+ * are only valid for as long as the storage that they came from.
+ */
+class ObjectMemberKey
+{
+public:
+
+    ObjectMemberKey(const char *data, size_t size)
+      : m_data(data),
+        m_size(size) { }
+
+    explicit ObjectMemberKey(const std::string &name)
+      : m_data(name.data()),
+        m_size(name.size()) { }
+
+    const char * data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    const char * begin() const
+    {
+        return m_data;
+    }
+
+    const char * end() const
+    {
+        return m_data + m_size;
+    }
+
+    /// Return a copy of the name
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    /**
+     * @brief   Compare the name with a string, using the same ordering as
+     *          std::string
+     *
+     * @returns a negative value, zero or a positive value if the name is
+     *          less than, equal to, or greater than the string
+     */
+    int compare(const std::string &other) const
+    {
+        return compare(other.data(), other.size());
+    }
+
+    int compare(const ObjectMemberKey &other) const
+    {
+        return compare(other.m_data, other.m_size);
+    }
+
+    bool operator==(const std::string &other) const
+    {
+        return m_size == other.size() && compare(other) == 0;
+    }
+
+    bool operator!=(const std::string &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator==(const ObjectMemberKey &other) const
+    {
+        return m_size == other.m_size && compare(other) == 0;
+    }
+
+    bool operator!=(const ObjectMemberKey &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+
+    int compare(const char *data, size_t size) const
+    {
+        const size_t n = m_size < size ? m_size : size;
+        const int result = n == 0 ? 0 : std::memcmp(m_data, data, n);
+        if (result != 0) {
+            return result;
+        }
+
+        return m_size < size ? -1 : m_size > size ? 1 : 0;
+    }
+
+    /// Pointer to the first character of the name
+    const char *m_data;
+
+    /// Length of the name, in bytes
+    size_t m_size;
+};
+
+namespace detail {
+
+template<typename T>
+struct VoidType
+{
+    typedef void type;
+};
+
+}  // namespace detail
+
+/**
+ * @brief   Provides access to the name and value of the object member
+ *          identified by an ObjectMemberIterator
+ *
+ * For iterators that do not provide key() and value() functions, the member
+ * is dereferenced once, and the name refers to the copy held by the accessor.
+ *
+ * @tparam  Iterator  ObjectMemberIterator type
+ */
+template<typename Iterator, typename Enable = void>
+class ObjectMemberAccessor
+{
+public:
+
+    typedef typename Iterator::value_type ObjectMember;
+    typedef typename ObjectMember::second_type AdapterType;
+
+    explicit ObjectMemberAccessor(const Iterator &itr)
+      : m_member(*itr) { }
+
+    ObjectMemberKey key() const
+    {
+        return ObjectMemberKey(m_member.first);
+    }
+
+    const AdapterType & value() const
+    {
+        return m_member.second;
+    }
+
+private:
+
+    /// Copy of the object member
+    const ObjectMember m_member;
+};
+
+/**
+ * @brief   Specialisation of ObjectMemberAccessor for iterators that provide
+ *          key() and value() functions
+ */
+template<typename Iterator>
+class ObjectMemberAccessor<Iterator,
+        typename detail::VoidType<decltype(std::declval<const Iterator &>().key())>::type>
+{
+public:
+
+    typedef typename Iterator::value_type::second_type AdapterType;
+
+    explicit ObjectMemberAccessor(const Iterator &itr)
+      : m_itr(itr) { }
+
+    ObjectMemberKey key() const
+    {
+        return m_itr.key();
+    }
+
+    AdapterType value() const
+    {
+        return m_itr.value();
+    }
+
+private:
+
+    /// Copy of the iterator
+    const Iterator m_itr;
+};
+
+/**
+ * @brief   Determines whether the members of an ObjectType are always
+ *          iterated in the same order for a given set of property names
+ *
+ * This is the case for parsers that store object members in a sorted
+ * container, with unique property names. Two such objects of the same type
+ * contain the same property names if and only if iteration yields the names
+ * in the same sequence. An ObjectType advertises this by providing a static
+ * hasSortedMembers() function that returns true.
+ *
+ * @tparam  ObjectType  Object type used by an Adapter
+ */
+template<typename ObjectType, typename Enable = void>
+struct ObjectMembersSorted
+{
+    static bool value()
+    {
+        return false;
+    }
+};
+
+template<typename ObjectType>
+struct ObjectMembersSorted<ObjectType,
+        typename detail::VoidType<decltype(ObjectType::hasSortedMembers())>::type>
+{
+    static bool value()
+    {
+        return ObjectType::hasSortedMembers();
+    }
+};
+
+}  // namespace adapters
+}  // namespace valijson
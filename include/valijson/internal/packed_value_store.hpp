@@ -0,0 +1,443 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valijson/internal/adapter.hpp>
+#include <valijson/internal/custom_allocator.hpp>
+#include <valijson/exceptions.hpp>
+
+namespace valijson {
+namespace adapters {
+
+/**
+ * @brief   Compact, adapter-independent storage for immutable JSON values
+ *
+ * PackedValueStore holds copies of the values used by 'const' and 'enum'
+ * constraints, so that a schema does not need to retain a DOM from the parser
+ * that it was loaded with. Any number of values can be added to a store, and
+ * each is identified by the index of its root node:
+ *
+ *  - every value is a fixed-size node, with numbers and booleans packed into
+ *    the node itself
+ *  - strings, including property names, are stored once in a shared pool,
+ *    no matter how many values they appear in
+ *  - an array node is followed by the nodes for its elements
+ *  - an object node is followed by one key node per member, sorted by
+ *    property name, and then by the nodes for its values; each key node
+ *    records the index of its value, so that members can be found using a
+ *    binary search
+ *  - array and object nodes record the index of the first node after their
+ *    last descendant, so that a value can be skipped in constant time
+ *
+ * Values are copied using the Adapter interface, so the type information
+ * reported by the source Adapter is preserved exactly.
+ *
+ * Memory is allocated using a pair of allocation functions, which default to
+ * those used by default-constructed CustomAllocator instances. While values
+ * are being added, a table of the strings in the pool is kept so that they
+ * can be shared. The table is released by compact(), and is not copied when
+ * the store is copied, e.g. when a constraint is copied into a Schema.
+ *
+ * The PackedAdapter class (see adapters/packed_value_adapter.hpp) provides
+ * access to stored values.
+ */
+class PackedValueStore
+{
+public:
+    typedef internal::CustomAllocator<char>::CustomAlloc CustomAlloc;
+    typedef internal::CustomAllocator<char>::CustomFree CustomFree;
+
+    PackedValueStore()
+      : m_nodes(NodeAllocator()),
+        m_strings(StringAllocator()),
+        m_interned(0, InternTable::hasher(), InternTable::key_equal(), InternTableAllocator()) { }
+
+    /**
+     * @brief  Construct a store that uses custom memory management functions
+     *
+     * @param  allocFn  malloc- or new-like function to allocate memory
+     * @param  freeFn   free-like function to free memory allocated with
+     *                  allocFn
+     */
+    PackedValueStore(CustomAlloc allocFn, CustomFree freeFn)
+      : PackedValueStore(internal::AllocationFunctions{ allocFn, freeFn, nullptr, nullptr }) { }
+
+    /**
+     * @brief  Construct a store that uses a set of allocation functions, and
+     *         the state that they use, such as a memory resource
+     *
+     * @param  functions  allocation functions
+     */
+    explicit PackedValueStore(const internal::AllocationFunctions &functions)
+      : m_nodes(NodeAllocator(functions)),
+        m_strings(StringAllocator(functions)),
+        m_interned(0, InternTable::hasher(), InternTable::key_equal(), InternTableAllocator(functions)) { }
+
+    /**
+     * @brief  Copy the values in another store, without its intern table
+     *
+     * Strings that are added to the copy are shared only with other strings
+     * that are added to the copy.
+     */
+    PackedValueStore(const PackedValueStore &other)
+      : m_nodes(other.m_nodes),
+        m_strings(other.m_strings),
+        m_interned(0, InternTable::hasher(), InternTable::key_equal(),
+                other.m_interned.get_allocator().select_on_container_copy_construction()) { }
+
+    PackedValueStore & operator=(const PackedValueStore &) = delete;
+
+    /// Types of node
+    enum Type
+    {
+        kNull,
+        kFalse,
+        kTrue,
+        kInteger,
+        kDouble,
+        kString,
+        kArray,
+        kObject
+    };
+
+    /**
+     * @brief  A single value, or object key, in the store
+     */
+    struct Node
+    {
+        /// Type of value, one of the values of the Type enum
+        uint8_t type;
+
+        /// Length of a string in bytes, or number of elements or members
+        uint32_t size;
+
+        union
+        {
+            /// Value of an integer
+            int64_t integer;
+
+            /// Value of a double
+            double number;
+
+            /// Index of the first node after an array or object and its
+            /// descendants
+            uint32_t next;
+
+            struct
+            {
+                /// Offset of a string or property name in the string pool
+                uint32_t offset;
+
+                /// Index of the value of an object member; only used by
+                /// key nodes
+                uint32_t value;
+            } string;
+        };
+    };
+
+    /**
+     * @brief  Copy a value into the store
+     *
+     * @param  value  Adapter containing the value to be copied
+     *
+     * @returns  index of the root node of the copy
+     */
+    uint32_t add(const Adapter &value)
+    {
+        return append(value, 0);
+    }
+
+    /**
+     * @brief  Release memory that is only needed while values are being added
+     *
+     * This frees the intern table, and any spare capacity in the node list
+     * and string pool. Values can still be added afterwards, but their
+     * strings will not be shared with those that are already in the store.
+     */
+    void compact()
+    {
+        InternTable(0, InternTable::hasher(), InternTable::key_equal(), m_interned.get_allocator()).swap(m_interned);
+        Nodes(m_nodes.begin(), m_nodes.end(), m_nodes.get_allocator()).swap(m_nodes);
+        String(m_strings.begin(), m_strings.end(), m_strings.get_allocator()).swap(m_strings);
+    }
+
+    /**
+     * @brief  Return a store containing an empty object at index zero, and an
+     *         empty array at index one
+     *
+     * Note that the store returned by this function is a singleton.
+     */
+    static const PackedValueStore & emptyValues()
+    {
+        static const PackedValueStore store(internal::defaultAlloc, internal::defaultFree, kEmptyValues);
+        return store;
+    }
+
+    /// Return a node in the store
+    const Node & node(uint32_t index) const
+    {
+        return m_nodes[index];
+    }
+
+    /// Return the index of the first node after a value and its descendants
+    uint32_t next(uint32_t index) const
+    {
+        const Node &n = m_nodes[index];
+        return (n.type == kArray || n.type == kObject) ? n.next : index + 1;
+    }
+
+    /// Return a pointer to the bytes of a string or key node (not
+    /// null-terminated)
+    const char * stringData(const Node &n) const
+    {
+        return m_strings.data() + n.string.offset;
+    }
+
+    /**
+     * @brief  Find the key node for a member of an object
+     *
+     * @param  index   index of an object node
+     * @param  data    property name to search for
+     * @param  length  length of the property name
+     *
+     * @returns  index of the first key node with the given name, or the index
+     *           one-past the last key node if there is no such member
+     */
+    uint32_t findKey(uint32_t index, const char *data, size_t length) const
+    {
+        uint32_t first = index + 1;
+        uint32_t count = m_nodes[index].size;
+        while (count > 0) {
+            const uint32_t step = count / 2;
+            const uint32_t mid = first + step;
+            if (compareKey(m_nodes[mid], data, length) < 0) {
+                first = mid + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+
+        const uint32_t end = index + 1 + m_nodes[index].size;
+        if (first != end && compareKey(m_nodes[first], data, length) == 0) {
+            return first;
+        }
+
+        return end;
+    }
+
+    /// Return the number of nodes in the store
+    size_t size() const
+    {
+        return m_nodes.size();
+    }
+
+    /// Return the number of bytes used by the string pool
+    size_t stringPoolSize() const
+    {
+        return m_strings.size();
+    }
+
+    /// Return the number of distinct strings in the intern table, which is
+    /// empty once the store has been compacted or copied
+    size_t internTableSize() const
+    {
+        return m_interned.size();
+    }
+
+private:
+
+    /// Tag used to construct the empty values singleton
+    enum EmptyValuesTag { kEmptyValues };
+
+    PackedValueStore(CustomAlloc allocFn, CustomFree freeFn, EmptyValuesTag)
+      : PackedValueStore(allocFn, freeFn)
+    {
+        m_nodes.resize(2);
+        m_nodes[0].type = kObject;
+        m_nodes[0].size = 0;
+        m_nodes[0].next = 1;
+        m_nodes[1].type = kArray;
+        m_nodes[1].size = 0;
+        m_nodes[1].next = 2;
+    }
+
+    /// Member of an object that is being copied
+    struct PendingMember
+    {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t value;
+    };
+
+    uint32_t append(const Adapter &value, size_t depth)
+    {
+        // Deeply nested values are almost certainly malicious
+        if (depth > kMaxDepth) {
+            throwRuntimeError("Value is too deeply nested to be stored.");
+        }
+
+        const uint32_t index = push(kNull);
+        if (value.isNull()) {
+            // Nothing more to do
+        } else if (value.isBool()) {
+            m_nodes[index].type = value.getBool() ? kTrue : kFalse;
+        } else if (value.isInteger()) {
+            m_nodes[index].type = kInteger;
+            m_nodes[index].integer = value.getInteger();
+        } else if (value.isDouble()) {
+            m_nodes[index].type = kDouble;
+            m_nodes[index].number = value.getDouble();
+        } else if (value.isString()) {
+            const std::string s = value.getString();
+            m_nodes[index].type = kString;
+            m_nodes[index].size = checkedSize(s.size());
+            m_nodes[index].string.offset = intern(s);
+            m_nodes[index].string.value = 0;
+        } else if (value.isArray()) {
+            m_nodes[index].type = kArray;
+            m_nodes[index].size = checkedSize(value.getArraySize());
+            value.applyToArray([this, depth](const Adapter &element) {
+                append(element, depth + 1);
+                return true;
+            });
+            m_nodes[index].next = checkedSize(m_nodes.size());
+        } else if (value.isObject()) {
+            const uint32_t size = checkedSize(value.getObjectSize());
+            m_nodes[index].type = kObject;
+            m_nodes[index].size = size;
+
+            // Reserve space for the key nodes, which are filled in once all
+            // of the names are known
+            for (uint32_t i = 0; i < size; i++) {
+                push(kString);
+            }
+
+            std::vector<PendingMember> members;
+            members.reserve(size);
+            value.applyToObject([this, depth, &members](const std::string &name, const Adapter &member) {
+                PendingMember pending;
+                pending.offset = intern(name);
+                pending.length = checkedSize(name.size());
+                pending.value = append(member, depth + 1);
+                members.push_back(pending);
+                return true;
+            });
+
+            if (members.size() != size) {
+                throwRuntimeError("Object size does not match number of members.");
+            }
+
+            std::stable_sort(members.begin(), members.end(),
+                    [this](const PendingMember &lhs, const PendingMember &rhs) {
+                return compareBytes(m_strings.data() + lhs.offset, lhs.length,
+                        m_strings.data() + rhs.offset, rhs.length) < 0;
+            });
+
+            for (uint32_t i = 0; i < size; i++) {
+                Node &key = m_nodes[index + 1 + i];
+                key.size = members[i].length;
+                key.string.offset = members[i].offset;
+                key.string.value = members[i].value;
+            }
+
+            m_nodes[index].next = checkedSize(m_nodes.size());
+        }
+
+        return index;
+    }
+
+    uint32_t push(Type type)
+    {
+        Node n;
+        n.type = static_cast<uint8_t>(type);
+        n.size = 0;
+        n.integer = 0;
+        m_nodes.push_back(n);
+
+        return checkedSize(m_nodes.size() - 1);
+    }
+
+    /**
+     * @brief  Return the offset of a string in the pool, adding it if it has
+     *         not been stored already
+     */
+    uint32_t intern(const std::string &s)
+    {
+        const size_t hash = std::hash<std::string>()(s);
+        const std::pair<InternTable::const_iterator, InternTable::const_iterator> range =
+                m_interned.equal_range(hash);
+        for (InternTable::const_iterator itr = range.first; itr != range.second; ++itr) {
+            if (itr->second.second == s.size() &&
+                    std::memcmp(m_strings.data() + itr->second.first, s.data(), s.size()) == 0) {
+                return itr->second.first;
+            }
+        }
+
+        const uint32_t offset = checkedSize(m_strings.size());
+        checkedSize(m_strings.size() + s.size());
+        m_strings.append(s.data(), s.size());
+        m_interned.insert(std::make_pair(hash, std::make_pair(offset, static_cast<uint32_t>(s.size()))));
+
+        return offset;
+    }
+
+    int compareKey(const Node &key, const char *data, size_t length) const
+    {
+        return compareBytes(stringData(key), key.size, data, length);
+    }
+
+    /// Compare two strings, using the same ordering as std::string
+    static int compareBytes(const char *lhs, size_t lhsLength, const char *rhs, size_t rhsLength)
+    {
+        const size_t n = std::min(lhsLength, rhsLength);
+        const int result = n == 0 ? 0 : std::memcmp(lhs, rhs, n);
+        if (result != 0) {
+            return result;
+        }
+
+        return lhsLength < rhsLength ? -1 : lhsLength > rhsLength ? 1 : 0;
+    }
+
+    static uint32_t checkedSize(size_t size)
+    {
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throwRuntimeError("Value is too large to be stored.");
+        }
+
+        return static_cast<uint32_t>(size);
+    }
+
+    /// Maximum nesting depth for arrays and objects
+    static const size_t kMaxDepth = 1024;
+
+    typedef internal::CustomAllocator<Node> NodeAllocator;
+    typedef std::vector<Node, NodeAllocator> Nodes;
+
+    typedef internal::CustomAllocator<char> StringAllocator;
+    typedef std::basic_string<char, std::char_traits<char>, StringAllocator> String;
+
+    typedef internal::CustomAllocator<std::pair<const size_t, std::pair<uint32_t, uint32_t>>> InternTableAllocator;
+    typedef std::unordered_multimap<size_t, std::pair<uint32_t, uint32_t>, std::hash<size_t>,
+            std::equal_to<size_t>, InternTableAllocator> InternTable;
+
+    /// Nodes for all of the values in the store
+    Nodes m_nodes;
+
+    /// Pool of strings and property names, each stored once
+    String m_strings;
+
+    /// Offsets and lengths of strings in the pool, keyed by hash
+    InternTable m_interned;
+};
+
+}  // namespace adapters
+}  // namespace valijson
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace valijson {
+namespace adapters {
+
+/**
+ * @brief   Functions used to compute the structural hash of a JSON value
+ *
+ * A structural hash is computed from the type and content of a value, rather
+ * than from the way that it happens to be stored by a parser. Values that are
+ * equal under strict comparison produce the same hash, regardless of which
+ * Adapter they are accessed through. In particular:
+ *
+ *  - integers and doubles that compare equal (e.g. 1 and 1.0) produce the
+ *    same hash, as do 0.0 and -0.0
+ *  - the hash of an array depends on the order of its elements
+ *  - the hash of an object does not depend on the order of its members
+ *
+ * The hash of an array is built by passing the hash of each element to
+ * element(), starting with the value returned by beginArray(). The hash of an
+ * object is built by summing the values returned by member(), and passing the
+ * sum to object().
+ */
+class StructuralHash
+{
+public:
+
+    static uint64_t null()
+    {
+        return mix(0x6e756c6c00000001ull);
+    }
+
+    static uint64_t boolean(bool value)
+    {
+        return mix(value ? 0x7472756500000002ull : 0x66616c7365000003ull);
+    }
+
+    static uint64_t number(double value)
+    {
+        // Ensure that -0.0 produces the same hash as 0.0
+        if (value == 0.0) {
+            value = 0.0;
+        }
+
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return combine(0x6e756d6265720004ull, bits);
+    }
+
+    static uint64_t string(const char *data, size_t size)
+    {
+        return combine(0x737472696e670005ull, bytes(data, size));
+    }
+
+    static uint64_t beginArray(size_t size)
+    {
+        return combine(0x6172726179000006ull, size);
+    }
+
+    static uint64_t element(uint64_t arrayHash, uint64_t elementHash)
+    {
+        return combine(arrayHash, elementHash);
+    }
+
+    static uint64_t member(const char *name, size_t size, uint64_t valueHash)
+    {
+        return mix(bytes(name, size) ^ (valueHash * 0x9e3779b97f4a7c15ull));
+    }
+
+    static uint64_t object(uint64_t memberSum, size_t size)
+    {
+        return combine(combine(0x6f626a6563740007ull, size), memberSum);
+    }
+
+private:
+
+    /// 64-bit FNV-1a hash of a sequence of bytes
+    static uint64_t bytes(const char *data, size_t size)
+    {
+        uint64_t result = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++) {
+            result ^= static_cast<unsigned char>(data[i]);
+            result *= 0x100000001b3ull;
+        }
+
+        return result;
+    }
+
+    /// Order-dependent combination of two hashes
+    static uint64_t combine(uint64_t seed, uint64_t value)
+    {
+        return mix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+    }
+
+    /// Finalisation step from SplitMix64, so that every input bit affects
+    /// every output bit
+    static uint64_t mix(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+};
+
+}  // namespace adapters
+}  // namespace valijson
@@ -0,0 +1,696 @@
+#pragma once
+
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace valijson {
+
+/**
+ * @brief  Read-only JSON document, stored as a flat tape over the original text
+ *
+ * JsonTape is a small JSON parser that is intended for documents that only
+ * need to be validated, such as in a gateway that validates requests before
+ * forwarding them unchanged. Rather than building a mutable DOM, the parser
+ * produces a flat array of entries in document order:
+ *
+ *  - each array entry is followed by its elements
+ *  - each object entry is followed by alternating key and value entries
+ *  - array and object entries record their number of elements or members,
+ *    and the index of the first entry after their last descendant, so that
+ *    a value can be skipped in constant time
+ *  - string entries refer to the original text, unless the string contains
+ *    escape sequences, in which case the decoded string is stored in a
+ *    separate buffer owned by the tape
+ *  - object keys record a hash of the key, so that property lookups can
+ *    skip most string comparisons
+ *
+ * Parsing with parse(const char *, size_t) does not copy the text, which must
+ * outlive the tape. The parse(std::string) overload takes ownership of the
+ * text instead.
+ *
+ * The JsonTapeAdapter class (see adapters/json_tape_adapter.hpp) allows a tape
+ * to be validated.
+ */
+class JsonTape
+{
+public:
+    /// Types of entry
+    enum Type
+    {
+        kNull,
+        kFalse,
+        kTrue,
+        kInteger,
+        kDouble,
+        kString,
+        kArray,
+        kObject
+    };
+
+    /// Maximum nesting depth for arrays and objects
+    static const size_t kMaxDepth = 1024;
+
+    /**
+     * @brief  A single value in the tape
+     */
+    struct Entry
+    {
+        /// Type of value, one of the values of the Type enum
+        uint8_t type;
+
+        /// True if a string is stored in the tape's decoded string buffer,
+        /// rather than in the original text
+        bool decoded;
+
+        /// Length of a string in bytes, or number of elements or members
+        uint32_t size;
+
+        /// Index of the first entry after this value and its descendants
+        uint32_t next;
+
+        /// Hash of an object key; zero for other strings
+        uint32_t hash;
+
+        union
+        {
+            /// Value of an integer
+            int64_t integer;
+
+            /// Value of a double
+            double number;
+
+            /// Offset of a string in the original text or decoded buffer
+            size_t offset;
+        };
+    };
+
+    JsonTape()
+      : m_source(nullptr),
+        m_length(0),
+        m_owned(false),
+        m_errorOffset(0) { }
+
+    /**
+     * @brief  Parse a JSON document without copying it
+     *
+     * @param  data    pointer to JSON text, which must outlive the tape
+     * @param  length  length of JSON text in bytes
+     *
+     * @return  true if the document was parsed successfully; otherwise the
+     *          error can be retrieved using getError() and getErrorOffset()
+     */
+    bool parse(const char *data, size_t length)
+    {
+        m_buffer.clear();
+        m_owned = false;
+        m_source = data;
+        m_length = length;
+
+        return parseSource();
+    }
+
+    /**
+     * @brief  Parse a JSON document, taking ownership of the text
+     *
+     * @param  text  JSON text
+     *
+     * @return  true if the document was parsed successfully
+     */
+    bool parse(std::string text)
+    {
+        m_buffer = std::move(text);
+        m_owned = true;
+        m_source = nullptr;
+        m_length = m_buffer.size();
+
+        return parseSource();
+    }
+
+    /// Return a description of the last parse error, or an empty string
+    const std::string & getError() const
+    {
+        return m_error;
+    }
+
+    /// Return the offset in the text at which the last parse error occurred
+    size_t getErrorOffset() const
+    {
+        return m_errorOffset;
+    }
+
+    /// Return true if the tape contains a successfully parsed document
+    bool isValid() const
+    {
+        return !m_entries.empty();
+    }
+
+    /// Return the number of entries in the tape
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+    /// Return an entry in the tape; the root value is at index zero
+    const Entry & entry(uint32_t index) const
+    {
+        return m_entries[index];
+    }
+
+    /// Return the index of the first entry after a value and its descendants
+    uint32_t next(uint32_t index) const
+    {
+        const Entry &e = m_entries[index];
+        return (e.type == kArray || e.type == kObject) ? e.next : index + 1;
+    }
+
+    /// Return a pointer to the bytes of a string entry (not null-terminated)
+    const char * stringData(const Entry &e) const
+    {
+        return e.decoded ? m_strings.data() + e.offset : source() + e.offset;
+    }
+
+    /**
+     * @brief  Compare a string entry with another string
+     *
+     * @param  index   index of a string entry
+     * @param  data    string to compare with
+     * @param  length  length of string to compare with
+     * @param  hash    hash of string, as returned by hashString(); only used
+     *                 when the entry is an object key
+     */
+    bool stringEquals(uint32_t index, const char *data, size_t length, uint32_t hash) const
+    {
+        const Entry &e = m_entries[index];
+        return (e.hash == 0 || e.hash == hash) && e.size == length &&
+                std::memcmp(stringData(e), data, length) == 0;
+    }
+
+    /**
+     * @brief  Copy a value and its descendants into a new, self-contained tape
+     *
+     * The new tape does not refer to the original text.
+     *
+     * @param  index  index of value to copy
+     */
+    JsonTape copyValue(uint32_t index) const
+    {
+        JsonTape copy;
+        copy.m_owned = true;
+
+        const uint32_t end = next(index);
+        copy.m_entries.reserve(end - index);
+        for (uint32_t i = index; i < end; i++) {
+            Entry e = m_entries[i];
+            if (e.type == kString) {
+                const char *data = stringData(e);
+                e.offset = copy.m_strings.size();
+                e.decoded = true;
+                copy.m_strings.append(data, e.size);
+            } else if (e.type == kArray || e.type == kObject) {
+                e.next -= index;
+            }
+            copy.m_entries.push_back(e);
+        }
+
+        return copy;
+    }
+
+    /**
+     * @brief  Hash a string, using the same function as for object keys
+     *
+     * The result is never zero, so that zero can indicate that an entry does
+     * not have a hash.
+     */
+    static uint32_t hashString(const char *data, size_t length)
+    {
+        // 32-bit FNV-1a
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+
+        return hash == 0 ? 1 : hash;
+    }
+
+private:
+    const char * source() const
+    {
+        return m_owned ? m_buffer.data() : m_source;
+    }
+
+    uint32_t push(Type type)
+    {
+        Entry e;
+        e.type = static_cast<uint8_t>(type);
+        e.decoded = false;
+        e.size = 0;
+        e.next = 0;
+        e.hash = 0;
+        e.integer = 0;
+        m_entries.push_back(e);
+
+        return static_cast<uint32_t>(m_entries.size() - 1);
+    }
+
+    bool fail(size_t offset, const char *message)
+    {
+        m_entries.clear();
+        m_strings.clear();
+        m_error = message;
+        m_errorOffset = offset;
+
+        return false;
+    }
+
+    void skipWhitespace(const char *data, size_t &pos) const
+    {
+        while (pos < m_length &&
+                (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r' || data[pos] == '\t')) {
+            pos++;
+        }
+    }
+
+    bool parseSource()
+    {
+        m_entries.clear();
+        m_strings.clear();
+        m_error.clear();
+        m_errorOffset = 0;
+
+        if (m_length >= std::numeric_limits<uint32_t>::max()) {
+            return fail(0, "Document is too large");
+        }
+
+        const char *data = source();
+        std::vector<uint32_t> stack;
+        size_t pos = 0;
+
+        skipWhitespace(data, pos);
+
+        for (;;) {
+            if (pos >= m_length) {
+                return fail(pos, "Unexpected end of document");
+            }
+
+            const char c = data[pos];
+            bool completed = true;
+
+            if (c == '{' || c == '[') {
+                if (stack.size() >= kMaxDepth) {
+                    return fail(pos, "Maximum nesting depth exceeded");
+                }
+
+                const uint32_t index = push(c == '{' ? kObject : kArray);
+                stack.push_back(index);
+                pos++;
+                skipWhitespace(data, pos);
+
+                if (pos < m_length && data[pos] == (c == '{' ? '}' : ']')) {
+                    pos++;
+                    m_entries[index].next = static_cast<uint32_t>(m_entries.size());
+                    stack.pop_back();
+                } else if (c == '{') {
+                    if (!parseMemberKey(data, pos)) {
+                        return false;
+                    }
+                    completed = false;
+                } else {
+                    completed = false;
+                }
+            } else if (c == '"') {
+                if (!parseString(data, pos, false)) {
+                    return false;
+                }
+            } else if (c == 't') {
+                if (!parseLiteral(data, pos, "true", kTrue)) {
+                    return false;
+                }
+            } else if (c == 'f') {
+                if (!parseLiteral(data, pos, "false", kFalse)) {
+                    return false;
+                }
+            } else if (c == 'n') {
+                if (!parseLiteral(data, pos, "null", kNull)) {
+                    return false;
+                }
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                if (!parseNumber(data, pos)) {
+                    return false;
+                }
+            } else {
+                return fail(pos, "Unexpected character");
+            }
+
+            if (!completed) {
+                continue;
+            }
+
+            // A value has been completed; count it as a child of the enclosing
+            // container, and close any containers that end here
+            for (;;) {
+                if (stack.empty()) {
+                    skipWhitespace(data, pos);
+                    if (pos != m_length) {
+                        return fail(pos, "Unexpected data after document");
+                    }
+
+                    return true;
+                }
+
+                const uint32_t parent = stack.back();
+                const bool isObject = m_entries[parent].type == kObject;
+                m_entries[parent].size++;
+
+                skipWhitespace(data, pos);
+                if (pos >= m_length) {
+                    return fail(pos, "Unexpected end of document");
+                }
+
+                if (data[pos] == ',') {
+                    pos++;
+                    skipWhitespace(data, pos);
+                    if (isObject && !parseMemberKey(data, pos)) {
+                        return false;
+                    }
+                    break;
+                }
+
+                if (data[pos] != (isObject ? '}' : ']')) {
+                    return fail(pos, isObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+                }
+
+                pos++;
+                m_entries[parent].next = static_cast<uint32_t>(m_entries.size());
+                stack.pop_back();
+            }
+        }
+    }
+
+    bool parseMemberKey(const char *data, size_t &pos)
+    {
+        if (pos >= m_length || data[pos] != '"') {
+            return fail(pos, "Expected object key");
+        }
+
+        if (!parseString(data, pos, true)) {
+            return false;
+        }
+
+        skipWhitespace(data, pos);
+        if (pos >= m_length || data[pos] != ':') {
+            return fail(pos, "Expected ':'");
+        }
+
+        pos++;
+        skipWhitespace(data, pos);
+
+        return true;
+    }
+
+    bool parseLiteral(const char *data, size_t &pos, const char *literal, Type type)
+    {
+        const size_t length = std::strlen(literal);
+        if (m_length - pos < length || std::memcmp(data + pos, literal, length) != 0) {
+            return fail(pos, "Invalid literal");
+        }
+
+        pos += length;
+        push(type);
+
+        return true;
+    }
+
+    bool parseString(const char *data, size_t &pos, bool isKey)
+    {
+        const size_t start = pos + 1;
+        bool escaped = false;
+        size_t i = start;
+        while (i < m_length && data[i] != '"') {
+            if (data[i] == '\\') {
+                escaped = true;
+                i += 2;
+            } else if (static_cast<unsigned char>(data[i]) < 0x20) {
+                return fail(i, "Invalid control character in string");
+            } else {
+                i++;
+            }
+        }
+
+        if (i >= m_length) {
+            return fail(pos, "Unterminated string");
+        }
+
+        const uint32_t index = push(kString);
+        if (escaped) {
+            const size_t offset = m_strings.size();
+            if (!decodeString(data, start, i)) {
+                return false;
+            }
+            m_entries[index].decoded = true;
+            m_entries[index].offset = offset;
+            m_entries[index].size = static_cast<uint32_t>(m_strings.size() - offset);
+        } else {
+            m_entries[index].offset = start;
+            m_entries[index].size = static_cast<uint32_t>(i - start);
+        }
+
+        if (isKey) {
+            Entry &e = m_entries[index];
+            e.hash = hashString(stringData(e), e.size);
+        }
+
+        pos = i + 1;
+
+        return true;
+    }
+
+    bool parseHex4(const char *data, size_t pos, size_t end, uint32_t &result)
+    {
+        if (end - pos < 4) {
+            return fail(pos, "Invalid unicode escape");
+        }
+
+        result = 0;
+        for (size_t i = pos; i < pos + 4; i++) {
+            const char c = data[i];
+            result <<= 4;
+            if (c >= '0' && c <= '9') {
+                result |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                result |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                result |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return fail(i, "Invalid unicode escape");
+            }
+        }
+
+        return true;
+    }
+
+    bool decodeString(const char *data, size_t pos, size_t end)
+    {
+        while (pos < end) {
+            const char c = data[pos];
+            if (c != '\\') {
+                m_strings.push_back(c);
+                pos++;
+                continue;
+            }
+
+            const char escape = data[pos + 1];
+            pos += 2;
+            switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                m_strings.push_back(escape);
+                break;
+            case 'b':
+                m_strings.push_back('\b');
+                break;
+            case 'f':
+                m_strings.push_back('\f');
+                break;
+            case 'n':
+                m_strings.push_back('\n');
+                break;
+            case 'r':
+                m_strings.push_back('\r');
+                break;
+            case 't':
+                m_strings.push_back('\t');
+                break;
+            case 'u':
+                {
+                    uint32_t codepoint;
+                    if (!parseHex4(data, pos, end, codepoint)) {
+                        return false;
+                    }
+                    pos += 4;
+
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                        uint32_t low;
+                        if (end - pos < 6 || data[pos] != '\\' || data[pos + 1] != 'u' ||
+                                !parseHex4(data, pos + 2, end, low) || low < 0xDC00 || low > 0xDFFF) {
+                            return fail(pos, "Invalid surrogate pair");
+                        }
+                        pos += 6;
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                        return fail(pos, "Invalid surrogate pair");
+                    }
+
+                    appendUtf8(codepoint);
+                }
+                break;
+            default:
+                return fail(pos - 1, "Invalid escape sequence");
+            }
+        }
+
+        return true;
+    }
+
+    void appendUtf8(uint32_t codepoint)
+    {
+        if (codepoint < 0x80) {
+            m_strings.push_back(static_cast<char>(codepoint));
+        } else if (codepoint < 0x800) {
+            m_strings.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            m_strings.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        } else if (codepoint < 0x10000) {
+            m_strings.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            m_strings.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            m_strings.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        } else {
+            m_strings.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            m_strings.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            m_strings.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            m_strings.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    bool parseNumber(const char *data, size_t &pos)
+    {
+        const size_t start = pos;
+        const bool negative = data[pos] == '-';
+        if (negative) {
+            pos++;
+        }
+
+        // Integer part, accumulated while it fits in 64 bits
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        if (pos < m_length && data[pos] == '0') {
+            pos++;
+        } else if (pos < m_length && data[pos] >= '1' && data[pos] <= '9') {
+            while (pos < m_length && data[pos] >= '0' && data[pos] <= '9') {
+                const uint64_t digit = static_cast<uint64_t>(data[pos] - '0');
+                if (magnitude > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+                    overflow = true;
+                } else {
+                    magnitude = magnitude * 10 + digit;
+                }
+                pos++;
+            }
+        } else {
+            return fail(pos, "Invalid number");
+        }
+
+        bool isInteger = true;
+        if (pos < m_length && data[pos] == '.') {
+            isInteger = false;
+            pos++;
+            if (pos >= m_length || data[pos] < '0' || data[pos] > '9') {
+                return fail(pos, "Invalid number");
+            }
+            while (pos < m_length && data[pos] >= '0' && data[pos] <= '9') {
+                pos++;
+            }
+        }
+
+        if (pos < m_length && (data[pos] == 'e' || data[pos] == 'E')) {
+            isInteger = false;
+            pos++;
+            if (pos < m_length && (data[pos] == '+' || data[pos] == '-')) {
+                pos++;
+            }
+            if (pos >= m_length || data[pos] < '0' || data[pos] > '9') {
+                return fail(pos, "Invalid number");
+            }
+            while (pos < m_length && data[pos] >= '0' && data[pos] <= '9') {
+                pos++;
+            }
+        }
+
+        const uint64_t maxMagnitude = negative ?
+                static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1 :
+                static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+        if (isInteger && !overflow && magnitude <= maxMagnitude) {
+            const uint32_t index = push(kInteger);
+            m_entries[index].integer = negative ?
+                    static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+            return true;
+        }
+
+        // The text is not necessarily null-terminated, so copy it for strtod.
+        // strtod uses the decimal point of the current C locale, so the '.'
+        // is replaced with that decimal point while copying.
+        const char *decimalPoint = std::localeconv()->decimal_point;
+        std::string text;
+        text.reserve(pos - start);
+        for (size_t i = start; i < pos; i++) {
+            if (data[i] == '.') {
+                text.append(decimalPoint);
+            } else {
+                text.push_back(data[i]);
+            }
+        }
+
+        const double number = std::strtod(text.c_str(), nullptr);
+        if (number == std::numeric_limits<double>::infinity() ||
+                number == -std::numeric_limits<double>::infinity()) {
+            return fail(start, "Number is too large to be stored as a double");
+        }
+
+        const uint32_t index = push(kDouble);
+        m_entries[index].number = number;
+
+        return true;
+    }
+
+    /// Non-owned JSON text, when m_owned is false
+    const char *m_source;
+
+    /// Owned JSON text, when m_owned is true
+    std::string m_buffer;
+
+    /// Length of JSON text
+    size_t m_length;
+
+    /// True if the text is stored in m_buffer
+    bool m_owned;
+
+    /// Entries in document order
+    std::vector<Entry> m_entries;
+
+    /// Decoded strings that contained escape sequences
+    std::string m_strings;
+
+    /// Description of the last parse error
+    std::string m_error;
+
+    /// Offset of the last parse error
+    size_t m_errorOffset;
+};
+
+}  // namespace valijson
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#include <valijson/exceptions.hpp>
+#include <valijson/internal/custom_allocator.hpp>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#  if __has_include(<memory_resource>)
+#    include <memory_resource>
+#    define VALIJSON_HAS_MEMORY_RESOURCE 1
+#  endif
+#endif
+
+#if VALIJSON_HAS_MEMORY_RESOURCE
+
+namespace valijson {
+namespace internal {
+
+/**
+ * @brief  Information stored before each block allocated from a memory
+ *         resource, so that it can be returned to the same resource
+ */
+struct MemoryResourceHeader
+{
+    std::pmr::memory_resource *resource;
+    size_t size;
+};
+
+/// Size of the header, rounded up so that blocks remain suitably aligned
+constexpr size_t kMemoryResourceHeaderSize =
+        (sizeof(MemoryResourceHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+        alignof(std::max_align_t);
+
+/**
+ * @brief  Allocate memory from a memory resource, recording the resource in
+ *         a header so that the memory can be freed by freeToMemoryResource()
+ *
+ * @param  context  the std::pmr::memory_resource to allocate from
+ * @param  size     number of bytes to allocate
+ *
+ * @returns  pointer to memory, or nullptr if it could not be allocated
+ */
+inline void * allocateFromResource(void *context, size_t size)
+{
+    if (size > std::numeric_limits<size_t>::max() - kMemoryResourceHeaderSize) {
+        return nullptr;
+    }
+
+    std::pmr::memory_resource *resource = static_cast<std::pmr::memory_resource *>(context);
+    const size_t blockSize = size + kMemoryResourceHeaderSize;
+    void *block = nullptr;
+#if VALIJSON_USE_EXCEPTIONS
+    try {
+#endif
+        block = resource->allocate(blockSize, alignof(std::max_align_t));
+#if VALIJSON_USE_EXCEPTIONS
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+#endif
+
+    new (block) MemoryResourceHeader{resource, blockSize};
+    return static_cast<char *>(block) + kMemoryResourceHeaderSize;
+}
+
+}  // namespace internal
+
+/**
+ * @brief  Return the memory resource that schemas built on this thread
+ *         allocate from
+ *
+ * This is the resource of the innermost ScopedMemoryResource on this thread,
+ * or std::pmr::get_default_resource() if there is none.
+ */
+inline std::pmr::memory_resource * currentMemoryResource()
+{
+    void *resource = internal::defaultAllocationFunctions().context;
+    return resource ? static_cast<std::pmr::memory_resource *>(resource) : std::pmr::get_default_resource();
+}
+
+/**
+ * @brief  Allocate memory from the current memory resource
+ *
+ * This function, along with freeToMemoryResource(), can be passed to the
+ * Schema constructor, in which case the schema allocates from whichever
+ * resource is current on the calling thread each time it allocates. Schemas
+ * and containers that are default-constructed inside a ScopedMemoryResource
+ * instead record that scope's resource, and keep allocating from it. The
+ * memory resource is recorded with each block, so memory can be freed after
+ * the ScopedMemoryResource that was active when it was allocated has been
+ * destroyed, or on another thread.
+ *
+ * @returns  pointer to memory, or nullptr if it could not be allocated
+ */
+inline void * allocateFromMemoryResource(size_t size)
+{
+    return internal::allocateFromResource(currentMemoryResource(), size);
+}
+
+/**
+ * @brief  Free memory allocated by allocateFromMemoryResource(), or by an
+ *         object that was given allocationFunctions() for a resource
+ */
+inline void freeToMemoryResource(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    char *block = static_cast<char *>(ptr) - internal::kMemoryResourceHeaderSize;
+    const internal::MemoryResourceHeader header = *reinterpret_cast<internal::MemoryResourceHeader *>(block);
+    header.resource->deallocate(block, header.size, alignof(std::max_align_t));
+}
+
+namespace internal {
+
+/**
+ * @brief  Return allocation functions that allocate from a memory resource,
+ *         which is passed to allocateFromResource() explicitly
+ */
+inline AllocationFunctions memoryResourceFunctions(std::pmr::memory_resource *resource)
+{
+    return { allocateFromMemoryResource, freeToMemoryResource, allocateFromResource, resource };
+}
+
+}  // namespace internal
+
+/**
+ * @brief  Directs memory allocated while building schemas on this thread to a
+ *         std::pmr::memory_resource, for the lifetime of this object
+ *
+ * While a ScopedMemoryResource exists, Schema, Subschema and constraint
+ * objects that are constructed without explicit allocation functions use
+ * allocateFromMemoryResource() and freeToMemoryResource(). This includes the
+ * constraints created by SchemaParser, and the containers that they own, so
+ * a schema can be parsed into an arena such as a
+ * std::pmr::monotonic_buffer_resource:
+ *
+ *     std::pmr::monotonic_buffer_resource arena;
+ *     ScopedMemoryResource scope(&arena);
+ *     Schema schema;
+ *     SchemaParser parser;
+ *     parser.populateSchema(schemaAdapter, schema);
+ *
+ * The Schema must be constructed while the scope exists, but may be used,
+ * modified and destroyed after it has ended; it keeps allocating from the
+ * resource that it was constructed with. The memory resource must outlive
+ * any schema that is built using it. Scopes may be nested, and must be
+ * destroyed in the reverse order of their construction.
+ *
+ * Only memory owned by schemas is allocated from the scoped resource, since
+ * memory used while validating a document would otherwise grow a monotonic
+ * resource without bound. To allocate validation results and temporary state
+ * from a resource instead, construct a ValidationSession, ValidationScratch
+ * or ValidationResults with it. Matching std::regex patterns still allocates
+ * from the global heap.
+ */
+class ScopedMemoryResource
+{
+public:
+    explicit ScopedMemoryResource(std::pmr::memory_resource *resource)
+      : m_scope(internal::memoryResourceFunctions(resource)) { }
+
+    ScopedMemoryResource(const ScopedMemoryResource &) = delete;
+    ScopedMemoryResource & operator=(const ScopedMemoryResource &) = delete;
+
+private:
+    const internal::ScopedAllocationFunctions m_scope;
+};
+
+}  // namespace valijson
+
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <valijson/validation_observer.hpp>
+
+namespace valijson {
+namespace observers {
+
+/**
+ * @brief  ValidationObserver that records a timeline of validation events in
+ *         the Chrome trace event format
+ *
+ * Each sub-schema and constraint produces a pair of begin/end events, named
+ * after its location in the schema (e.g. '#/properties/items/anyOf/3/type').
+ * The JSON Pointer of the target within the document is attached to each
+ * begin event as an argument. The output of write() can be loaded into
+ * chrome://tracing, Perfetto or Speedscope.
+ *
+ * Events are buffered in memory until write() or clear() is called, so this
+ * observer is intended for diagnosing individual slow validations rather
+ * than for continuous use.
+ */
+class ChromeTraceObserver: public ValidationObserver
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ChromeTraceObserver()
+      : m_start(Clock::now()) { }
+
+    void enterSubschema(const Subschema &subschema,
+            const std::vector<std::string> &context) override
+    {
+        begin("subschema", describeSubschema(subschema), context);
+    }
+
+    void exitSubschema(const Subschema &,
+            const std::vector<std::string> &, bool validated) override
+    {
+        end(validated);
+    }
+
+    void enterConstraint(const Subschema &subschema,
+            const constraints::Constraint &, constraints::ConstraintKind kind,
+            const std::vector<std::string> &context) override
+    {
+        begin("constraint", describeConstraint(subschema, kind), context);
+    }
+
+    void exitConstraint(const Subschema &,
+            const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &, bool validated) override
+    {
+        end(validated);
+    }
+
+    /**
+     * @brief  Discard all recorded events, and restart the timeline
+     */
+    void clear()
+    {
+        m_events.clear();
+        m_start = Clock::now();
+    }
+
+    /**
+     * @brief  Return the number of events that have been recorded
+     */
+    size_t size() const
+    {
+        return m_events.size();
+    }
+
+    /**
+     * @brief  Write recorded events as a JSON object in the trace event format
+     *
+     * @param  os  output stream
+     */
+    void write(std::ostream &os) const
+    {
+        os << "{\"traceEvents\":[";
+        for (size_t i = 0; i < m_events.size(); i++) {
+            const Event &event = m_events[i];
+            if (i > 0) {
+                os << ",";
+            }
+            os << "\n{\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":1,\"ts\":";
+            writeMicroseconds(os, event.nanoseconds);
+            if (event.phase == 'B') {
+                os << ",\"cat\":\"" << event.category << "\",\"name\":";
+                writeString(os, event.name);
+                os << ",\"args\":{\"document\":";
+                writeString(os, event.documentPath);
+                os << "}}";
+            } else {
+                os << ",\"args\":{\"valid\":" << (event.validated ? "true" : "false") << "}}";
+            }
+        }
+        os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+private:
+    struct Event
+    {
+        char phase;
+        const char *category;
+        std::string name;
+        std::string documentPath;
+        bool validated;
+        uint64_t nanoseconds;
+    };
+
+    void begin(const char *category, std::string name, const std::vector<std::string> &context)
+    {
+        m_events.push_back(Event{'B', category, std::move(name), documentPath(context), false, elapsed()});
+    }
+
+    void end(bool validated)
+    {
+        m_events.push_back(Event{'E', "", std::string(), std::string(), validated, elapsed()});
+    }
+
+    uint64_t elapsed() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - m_start).count());
+    }
+
+    static void writeMicroseconds(std::ostream &os, uint64_t nanoseconds)
+    {
+        char fraction[8];
+        snprintf(fraction, sizeof(fraction), "%03u", static_cast<unsigned>(nanoseconds % 1000));
+        os << (nanoseconds / 1000) << "." << fraction;
+    }
+
+    static void writeString(std::ostream &os, const std::string &s)
+    {
+        os << '"';
+        for (const char c : s) {
+            if (c == '"' || c == '\\') {
+                os << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                os << escaped;
+            } else {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+
+    /// Time at which the timeline started
+    Clock::time_point m_start;
+
+    /// Events recorded so far, in order
+    std::vector<Event> m_events;
+};
+
+}  // namespace observers
+}  // namespace valijson
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <valijson/validation_observer.hpp>
+
+namespace valijson {
+namespace observers {
+
+/**
+ * @brief  ValidationObserver that aggregates validation time into collapsed
+ *         stacks, suitable for rendering as a flame graph
+ *
+ * Each frame in a stack is either a sub-schema, named after its location in
+ * the schema (e.g. '#/definitions/Order'), or a constraint keyword belonging
+ * to the enclosing sub-schema. The weight of each stack is the self time, in
+ * nanoseconds, spent in its innermost frame.
+ *
+ * Stacks are aggregated across all validations until clear() is called. The
+ * output of write() can be passed directly to flamegraph.pl or loaded into
+ * Speedscope.
+ */
+class CollapsedStackObserver: public ValidationObserver
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    void enterSubschema(const Subschema &subschema,
+            const std::vector<std::string> &) override
+    {
+        push(describeSubschema(subschema));
+    }
+
+    void exitSubschema(const Subschema &,
+            const std::vector<std::string> &, bool) override
+    {
+        pop();
+    }
+
+    void enterConstraint(const Subschema &,
+            const constraints::Constraint &, constraints::ConstraintKind kind,
+            const std::vector<std::string> &) override
+    {
+        const char *keyword = constraints::constraintKeyword(kind);
+        push(*keyword ? keyword : constraints::constraintKindName(kind));
+    }
+
+    void exitConstraint(const Subschema &,
+            const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &, bool) override
+    {
+        pop();
+    }
+
+    /**
+     * @brief  Discard all aggregated stacks
+     */
+    void clear()
+    {
+        m_stacks.clear();
+    }
+
+    /**
+     * @brief  Return the aggregated self time for each stack, in nanoseconds
+     *
+     * Frames within each key are separated by semicolons.
+     */
+    const std::map<std::string, uint64_t> & stacks() const
+    {
+        return m_stacks;
+    }
+
+    /**
+     * @brief  Write aggregated stacks in the collapsed stack format, with one
+     *         stack per line followed by its weight in nanoseconds
+     *
+     * @param  os  output stream
+     */
+    void write(std::ostream &os) const
+    {
+        for (const auto &stack : m_stacks) {
+            os << stack.first << " " << stack.second << "\n";
+        }
+    }
+
+private:
+    struct Frame
+    {
+        /// Semicolon-separated names of this frame and its ancestors
+        std::string stack;
+
+        /// Time at which the frame was entered
+        Clock::time_point start;
+
+        /// Total time spent in child frames
+        uint64_t childNanoseconds;
+    };
+
+    void push(const std::string &name)
+    {
+        std::string stack = m_frames.empty() ? std::string() : m_frames.back().stack + ";";
+        for (const char c : name) {
+            // Semicolons separate frames, and newlines separate stacks
+            stack += (c == ';' || c == '\n') ? '_' : c;
+        }
+
+        m_frames.push_back(Frame{std::move(stack), Clock::now(), 0});
+    }
+
+    void pop()
+    {
+        if (m_frames.empty()) {
+            return;
+        }
+
+        const Frame &frame = m_frames.back();
+        const uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - frame.start).count());
+        m_stacks[frame.stack] += elapsed > frame.childNanoseconds ? elapsed - frame.childNanoseconds : 0;
+        m_frames.pop_back();
+
+        if (!m_frames.empty()) {
+            m_frames.back().childNanoseconds += elapsed;
+        }
+    }
+
+    /// Frames that are currently active
+    std::vector<Frame> m_frames;
+
+    /// Aggregated self time for each stack
+    std::map<std::string, uint64_t> m_stacks;
+};
+
+}  // namespace observers
+}  // namespace valijson
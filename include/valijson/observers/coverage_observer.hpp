@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <valijson/schema.hpp>
+#include <valijson/validation_observer.hpp>
+
+namespace valijson {
+namespace observers {
+
+/**
+ * @brief  ValidationObserver that records which sub-schemas and constraints
+ *         are exercised while validating a corpus of documents
+ *
+ * After validating each document in a corpus with the observer attached, the
+ * report() function can be used to produce a coverage report for a Schema.
+ * The report includes every sub-schema and constraint in the schema, keyed by
+ * its location in the schema document, including those that were never
+ * applied. This makes it possible to find branches that are dead for a given
+ * corpus, as well as branches that account for most of the work.
+ *
+ * Counters are aggregated until clear() is called. Like any observer, it
+ * requires VALIJSON_USE_INSTRUMENTATION, without which Validator::setObserver()
+ * does not compile, so an empty report cannot be mistaken for dead branches.
+ */
+class CoverageObserver: public ValidationObserver
+{
+public:
+    /**
+     * @brief  Coverage for a single sub-schema or constraint
+     */
+    struct Entry
+    {
+        /// Location of the sub-schema or constraint in the schema document
+        std::string path;
+
+        /// Sub-schema, or sub-schema that owns the constraint
+        const Subschema *subschema;
+
+        /// Constraint, or nullptr if this entry describes a sub-schema
+        const constraints::Constraint *constraint;
+
+        /// Kind of constraint; only valid if constraint is not nullptr
+        constraints::ConstraintKind kind;
+
+        /// Number of times the sub-schema or constraint was applied
+        uint64_t hits;
+
+        /// Number of times the target failed to satisfy the sub-schema or
+        /// constraint
+        uint64_t failures;
+    };
+
+    CoverageObserver()
+      : m_depth(0),
+        m_documents(0) { }
+
+    void enterSubschema(const Subschema &subschema,
+            const std::vector<std::string> &) override
+    {
+        if (m_depth++ == 0) {
+            m_documents++;
+        }
+
+        m_subschemas[&subschema].hits++;
+    }
+
+    void exitSubschema(const Subschema &subschema,
+            const std::vector<std::string> &, bool validated) override
+    {
+        m_depth--;
+        if (!validated) {
+            m_subschemas[&subschema].failures++;
+        }
+    }
+
+    void enterConstraint(const Subschema &,
+            const constraints::Constraint &constraint, constraints::ConstraintKind,
+            const std::vector<std::string> &) override
+    {
+        m_constraints[&constraint].hits++;
+    }
+
+    void exitConstraint(const Subschema &,
+            const constraints::Constraint &constraint, constraints::ConstraintKind,
+            const std::vector<std::string> &, bool validated) override
+    {
+        if (!validated) {
+            m_constraints[&constraint].failures++;
+        }
+    }
+
+    /**
+     * @brief  Discard all recorded coverage
+     */
+    void clear()
+    {
+        m_depth = 0;
+        m_documents = 0;
+        m_subschemas.clear();
+        m_constraints.clear();
+    }
+
+    /**
+     * @brief  Return the number of documents validated since the observer was
+     *         created or cleared
+     */
+    uint64_t documents() const
+    {
+        return m_documents;
+    }
+
+    /**
+     * @brief  Produce a coverage report for a schema
+     *
+     * Each sub-schema in the schema is followed by entries for its
+     * constraints. Entries are ordered by path.
+     *
+     * @param  schema  schema that was used for validation
+     */
+    std::vector<Entry> report(const Schema &schema) const
+    {
+        std::vector<Entry> entries;
+        schema.applyToSubschemas([&](const Subschema &subschema) {
+            entries.push_back(makeEntry(describeSubschema(subschema), subschema, nullptr,
+                    constraints::kNumConstraintKinds, find(m_subschemas, &subschema)));
+
+            Subschema::ApplyFunction fn([&](const constraints::Constraint &constraint) {
+                const constraints::ConstraintKind kind = constraints::getConstraintKind(constraint);
+                entries.push_back(makeEntry(describeConstraint(subschema, kind), subschema, &constraint, kind,
+                        find(m_constraints, &constraint)));
+                return true;
+            });
+            subschema.apply(fn);
+        });
+
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.path < b.path;
+        });
+
+        return entries;
+    }
+
+    /**
+     * @brief  Write a coverage report for a schema as tab-separated text
+     *
+     * Each line contains a path, hit count, and failure count. Lines for
+     * sub-schemas and constraints that were never applied are marked as such.
+     *
+     * @param  os      output stream
+     * @param  schema  schema that was used for validation
+     */
+    void write(std::ostream &os, const Schema &schema) const
+    {
+        const std::vector<Entry> entries = report(schema);
+
+        size_t covered = 0;
+        for (const Entry &entry : entries) {
+            if (entry.hits > 0) {
+                covered++;
+            }
+        }
+
+        os << "# documents: " << m_documents << "\n";
+        os << "# covered: " << covered << "/" << entries.size() << "\n";
+        os << "# path\thits\tfailures\n";
+        for (const Entry &entry : entries) {
+            os << entry.path << "\t" << entry.hits << "\t" << entry.failures;
+            if (entry.hits == 0) {
+                os << "\tNEVER";
+            }
+            os << "\n";
+        }
+    }
+
+private:
+    struct Counters
+    {
+        Counters()
+          : hits(0),
+            failures(0) { }
+
+        uint64_t hits;
+        uint64_t failures;
+    };
+
+    template<typename Key>
+    static Counters find(const std::unordered_map<Key, Counters> &counters, Key key)
+    {
+        const auto itr = counters.find(key);
+        return itr == counters.end() ? Counters() : itr->second;
+    }
+
+    static Entry makeEntry(std::string path, const Subschema &subschema,
+            const constraints::Constraint *constraint, constraints::ConstraintKind kind, const Counters &counters)
+    {
+        return Entry{std::move(path), &subschema, constraint, kind, counters.hits, counters.failures};
+    }
+
+    /// Current sub-schema nesting, used to count documents
+    size_t m_depth;
+
+    /// Number of documents validated
+    uint64_t m_documents;
+
+    /// Counters for each sub-schema that has been applied
+    std::unordered_map<const Subschema *, Counters> m_subschemas;
+
+    /// Counters for each constraint that has been applied
+    std::unordered_map<const constraints::Constraint *, Counters> m_constraints;
+};
+
+}  // namespace observers
+}  // namespace valijson
@@ -123,6 +123,23 @@ public:
         mutableSubschema(subschema)->addConstraint(constraint);
     }
 
+    /**
+     * @brief  Invoke a function for each of the sub-schemas owned by this
+     *         Schema instance, including the root sub-schema
+     *
+     * The shared empty sub-schema is not included. Sub-schemas other than the
+     * root are visited in no particular order.
+     *
+     * @param  fn  function to invoke for each sub-schema
+     */
+    void applyToSubschemas(const std::function<void (const Subschema &)> &fn) const
+    {
+        fn(*this);
+        for (const Subschema *subschema : subschemaSet) {
+            fn(*subschema);
+        }
+    }
+
     /**
      * @brief  Create a new Subschema instance that is owned by this Schema
      *
@@ -195,6 +212,18 @@ public:
         mutableSubschema(subschema)->setId(id);
     }
 
+    /**
+     * @brief  Update the path for one of the sub-schemas owned by this Schema
+     *         instance
+     *
+     * @param  subschema  sub-schema to update
+     * @param  path       new path
+     */
+    void setSubschemaPath(const Subschema *subschema, const std::string &path)
+    {
+        mutableSubschema(subschema)->setPath(path);
+    }
+
     /**
      * @brief  Update the title for one of the sub-schemas owned by this Schema
      *         instance
@@ -211,7 +240,7 @@ private:
 
     Subschema *newSubschema()
     {
-        void *ptr = m_allocFn(sizeof(Subschema));
+        void *ptr = allocationFunctions().allocate(sizeof(Subschema));
         if (!ptr) {
             throwRuntimeError(
                     "Failed to allocate memory for shared empty sub-schema");
@@ -220,7 +249,7 @@ private:
 #if VALIJSON_USE_EXCEPTIONS
         try {
 #endif
-            return new (ptr) Subschema();
+            return new (ptr) Subschema(allocationFunctions());
 #if VALIJSON_USE_EXCEPTIONS
         } catch (...) {
             m_freeFn(ptr);
@@ -0,0 +1,774 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valijson/constraints/concrete_constraints.hpp>
+#include <valijson/constraints/constraint_kind.hpp>
+#include <valijson/constraints/constraint_visitor.hpp>
+#include <valijson/subschema.hpp>
+#include <valijson/validation_observer.hpp>
+
+namespace valijson {
+
+/**
+ * @brief  Static analysis of a parsed schema, to estimate validation cost and
+ *         to flag constructs that are likely to make validation expensive
+ *
+ * The analyser walks every sub-schema that is reachable from a root schema,
+ * without validating any documents. For each sub-schema it estimates the
+ * worst-case number of constraint evaluations needed to validate a single
+ * value (excluding values nested within it), and the number of sub-schemas
+ * that are applied to that value via combinators such as 'allOf', 'anyOf'
+ * and 'oneOf'.
+ *
+ * Estimates saturate at the largest uint64_t value, rather than wrapping.
+ *
+ * It also reports the following hazards, keyed by schema path:
+ *
+ *  - combinators whose nested sub-schemas fan out beyond a limit
+ *  - enums with more values than a limit; values are found by hash under
+ *    strict type checking, but are otherwise compared in turn
+ *  - 'uniqueItems' on arrays with no (or a very large) 'maxItems' bound;
+ *    items are hashed and sorted, and items with equal hashes are compared
+ *    pairwise, so the worst case is quadratic in the number of items
+ *  - patterns with nested unbounded quantifiers, which are prone to
+ *    catastrophic backtracking in engines such as std::regex
+ *  - recursive sub-schemas, which are flagged as critical when a sub-schema
+ *    can be re-applied to the same value (validation will not terminate)
+ *
+ * Reports are intended to be used to gate untrusted schemas before they are
+ * deployed. The analysis is heuristic; an empty hazard list does not
+ * guarantee that validation will be cheap for all documents.
+ */
+class SchemaAnalyser
+{
+public:
+    /// Kinds of hazard that can be reported
+    enum HazardKind
+    {
+        kBacktrackingPattern,
+        kCombinatorFanOut,
+        kInfiniteRecursion,
+        kLargeEnum,
+        kUnboundedRecursion,
+        kUnboundedUniqueItems
+    };
+
+    /// Severity of a hazard
+    enum Severity
+    {
+        kWarning,
+        kCritical
+    };
+
+    /**
+     * @brief  A construct that is likely to make validation expensive
+     */
+    struct Hazard
+    {
+        /// Severity of the hazard
+        Severity severity;
+
+        /// Kind of hazard
+        HazardKind kind;
+
+        /// Location of the hazard in the schema
+        std::string path;
+
+        /// Human readable description of the hazard
+        std::string description;
+    };
+
+    /**
+     * @brief  Estimated cost of validating a single value against a sub-schema
+     */
+    struct SubschemaCost
+    {
+        /// Sub-schema that was analysed
+        const Subschema *subschema;
+
+        /// Location of the sub-schema in the schema
+        std::string path;
+
+        /// Estimated worst-case number of constraint evaluations, excluding
+        /// those for values nested within the value being validated
+        uint64_t cost;
+
+        /// Number of sub-schemas applied to the value, including this one
+        uint64_t fanOut;
+    };
+
+    /**
+     * @brief  Thresholds above which hazards are reported
+     */
+    struct Limits
+    {
+        Limits()
+          : maxFanOut(64),
+            maxEnumValues(256),
+            maxUniqueItems(1000) { }
+
+        /// Maximum number of sub-schemas that a combinator may apply
+        uint64_t maxFanOut;
+
+        /// Maximum number of values in an 'enum' constraint
+        uint64_t maxEnumValues;
+
+        /// Maximum 'maxItems' bound for an array that has 'uniqueItems'
+        uint64_t maxUniqueItems;
+    };
+
+    /**
+     * @brief  Result of analysing a schema
+     */
+    struct Report
+    {
+        /// Estimated cost for each reachable sub-schema, ordered by path
+        std::vector<SubschemaCost> costs;
+
+        /// Hazards, ordered by path
+        std::vector<Hazard> hazards;
+
+        /**
+         * @brief  Return true if any hazard has critical severity
+         */
+        bool hasCriticalHazards() const
+        {
+            for (const Hazard &hazard : hazards) {
+                if (hazard.severity == kCritical) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief  Write the report as text, with hazards followed by the cost
+         *         of each sub-schema
+         *
+         * @param  os  output stream
+         */
+        void write(std::ostream &os) const
+        {
+            os << "# hazards: " << hazards.size() << "\n";
+            for (const Hazard &hazard : hazards) {
+                os << (hazard.severity == kCritical ? "CRITICAL" : "WARNING") << "\t"
+                   << hazard.path << "\t" << hazard.description << "\n";
+            }
+
+            os << "# path\tcost\tfan-out\n";
+            for (const SubschemaCost &cost : costs) {
+                os << cost.path << "\t" << cost.cost << "\t" << cost.fanOut << "\n";
+            }
+        }
+    };
+
+    SchemaAnalyser() = default;
+
+    /**
+     * @brief  Construct a SchemaAnalyser with custom thresholds
+     *
+     * @param  limits  thresholds above which hazards are reported
+     */
+    explicit SchemaAnalyser(const Limits &limits)
+      : m_limits(limits) { }
+
+    /**
+     * @brief  Analyse a schema, starting from its root sub-schema
+     *
+     * @param  schema  root of the schema to analyse
+     *
+     * @return  Report containing estimated costs and hazards
+     */
+    Report analyse(const Subschema &schema) const
+    {
+        Analysis analysis(m_limits);
+        analysis.analyseSubschema(schema, false);
+
+        Report report;
+        report.costs = std::move(analysis.costs);
+        report.hazards = std::move(analysis.hazards);
+
+        std::stable_sort(report.costs.begin(), report.costs.end(),
+                [](const SubschemaCost &a, const SubschemaCost &b) {
+            return a.path < b.path;
+        });
+
+        std::stable_sort(report.hazards.begin(), report.hazards.end(), [](const Hazard &a, const Hazard &b) {
+            return a.path < b.path;
+        });
+
+        return report;
+    }
+
+    /**
+     * @brief  Check whether a regular expression is prone to catastrophic
+     *         backtracking
+     *
+     * This is a conservative heuristic, which looks for groups that contain
+     * an unbounded quantifier or an alternation, and are themselves repeated
+     * by an unbounded quantifier, e.g. '(a+)+', '(\\w*)*' or '(a|ab)*'.
+     *
+     * @param  pattern  regular expression to check
+     */
+    static bool isBacktrackingProne(const std::string &pattern)
+    {
+        struct Group
+        {
+            bool unbounded;
+            bool alternation;
+        };
+
+        std::vector<Group> groups(1, Group{false, false});
+        bool closedGroupIsRisky = false;
+
+        for (size_t i = 0; i < pattern.size(); i++) {
+            const char c = pattern[i];
+            bool unboundedQuantifier = false;
+
+            if (c == '\\') {
+                i++;
+            } else if (c == '[') {
+                // Skip character class, which may contain a literal ']' first
+                i++;
+                if (i < pattern.size() && pattern[i] == '^') {
+                    i++;
+                }
+                if (i < pattern.size() && pattern[i] == ']') {
+                    i++;
+                }
+                while (i < pattern.size() && pattern[i] != ']') {
+                    if (pattern[i] == '\\') {
+                        i++;
+                    }
+                    i++;
+                }
+            } else if (c == '(') {
+                groups.push_back(Group{false, false});
+                closedGroupIsRisky = false;
+                continue;
+            } else if (c == ')') {
+                if (groups.size() > 1) {
+                    const Group group = groups.back();
+                    groups.pop_back();
+                    groups.back().unbounded |= group.unbounded;
+                    closedGroupIsRisky = group.unbounded || group.alternation;
+                    continue;
+                }
+            } else if (c == '|') {
+                groups.back().alternation = true;
+            } else if (c == '*' || c == '+') {
+                unboundedQuantifier = true;
+            } else if (c == '{') {
+                const size_t end = pattern.find('}', i);
+                if (end != std::string::npos) {
+                    // Only '{n,}' is unbounded
+                    unboundedQuantifier = pattern[end - 1] == ',';
+                    i = end;
+                }
+            } else if (c == '?') {
+                // Optional or lazy modifier; does not affect the previous atom
+                continue;
+            }
+
+            if (unboundedQuantifier) {
+                if (closedGroupIsRisky) {
+                    return true;
+                }
+                groups.back().unbounded = true;
+            }
+
+            closedGroupIsRisky = false;
+        }
+
+        return false;
+    }
+
+private:
+    /// Estimated cost of a sub-schema
+    struct Totals
+    {
+        uint64_t cost;
+        uint64_t fanOut;
+    };
+
+    /// Add two estimates, saturating at the largest uint64_t value
+    static uint64_t saturatingAdd(uint64_t a, uint64_t b)
+    {
+        return a > std::numeric_limits<uint64_t>::max() - b ? std::numeric_limits<uint64_t>::max() : a + b;
+    }
+
+    /// Multiply two estimates, saturating at the largest uint64_t value
+    static uint64_t saturatingMultiply(uint64_t a, uint64_t b)
+    {
+        return b != 0 && a > std::numeric_limits<uint64_t>::max() / b ? std::numeric_limits<uint64_t>::max() : a * b;
+    }
+
+    class AnalysisVisitor;
+
+    /**
+     * @brief  State for a single call to analyse()
+     */
+    class Analysis
+    {
+    public:
+        explicit Analysis(const Limits &analysisLimits)
+          : limits(analysisLimits) { }
+
+        /**
+         * @brief  Analyse a sub-schema, if it has not already been analysed
+         *
+         * @param  subschema   sub-schema to analyse
+         * @param  childValue  true if the sub-schema is applied to values
+         *                     nested within the current value
+         */
+        Totals analyseSubschema(const Subschema &subschema, bool childValue);
+
+        void addHazard(Severity severity, HazardKind kind, std::string path, std::string description)
+        {
+            hazards.push_back(Hazard{severity, kind, std::move(path), std::move(description)});
+        }
+
+        const Limits &limits;
+        std::vector<SubschemaCost> costs;
+        std::vector<Hazard> hazards;
+
+    private:
+        /// Sub-schemas that have been analysed, or are being analysed
+        std::unordered_map<const Subschema *, std::pair<bool, Totals>> m_analysed;
+
+        /// Sub-schemas currently being analysed, and whether each was
+        /// reached by descending into a nested value
+        std::vector<std::pair<const Subschema *, bool>> m_stack;
+
+        /// Sub-schemas for which each kind of recursion has already been
+        /// reported; a cycle that descends into nested values must not hide
+        /// a later cycle that re-applies the sub-schema to the same value
+        std::set<std::pair<const Subschema *, HazardKind>> m_recursionReported;
+    };
+
+    /**
+     * @brief  Implementation of the ConstraintVisitor interface that estimates
+     *         the cost of each constraint in a sub-schema
+     */
+    class AnalysisVisitor: public constraints::ConstraintVisitor
+    {
+    public:
+        AnalysisVisitor(Analysis &analysis, const Subschema &subschema)
+          : m_analysis(analysis),
+            m_subschema(subschema),
+            m_cost(0),
+            m_fanOut(1),
+            m_hasMaxItems(false),
+            m_maxItems(0),
+            m_hasUniqueItems(false) { }
+
+        /**
+         * @brief  Report any hazards that depend on several constraints, and
+         *         return the totals for the sub-schema
+         */
+        Totals finish()
+        {
+            if (m_hasUniqueItems) {
+                const std::string path = describeConstraint(constraints::kUniqueItems);
+                if (!m_hasMaxItems) {
+                    m_analysis.addHazard(kWarning, kUnboundedUniqueItems, path,
+                            "'uniqueItems' applies to an array with no 'maxItems' bound; "
+                            "items with equal hashes are compared pairwise");
+                } else if (m_maxItems > m_analysis.limits.maxUniqueItems) {
+                    m_analysis.addHazard(kWarning, kUnboundedUniqueItems, path,
+                            "'uniqueItems' applies to an array of up to " + std::to_string(m_maxItems) +
+                            " items; items with equal hashes are compared pairwise");
+                }
+
+                // Worst case, in which every item has the same hash
+                if (m_hasMaxItems && m_maxItems > 1) {
+                    const uint64_t pairs = m_maxItems % 2 == 0 ?
+                            saturatingMultiply(m_maxItems / 2, m_maxItems - 1) :
+                            saturatingMultiply(m_maxItems, (m_maxItems - 1) / 2);
+                    addCost(pairs);
+                }
+            }
+
+            return Totals{m_cost, m_fanOut};
+        }
+
+        bool visit(const AllOfConstraint &constraint) override
+        {
+            return visitCombinator(constraint, constraints::kAllOf);
+        }
+
+        bool visit(const AnyOfConstraint &constraint) override
+        {
+            return visitCombinator(constraint, constraints::kAnyOf);
+        }
+
+        bool visit(const ConditionalConstraint &constraint) override
+        {
+            Totals condition{0, 0};
+            if (constraint.getIfSubschema()) {
+                condition = m_analysis.analyseSubschema(*constraint.getIfSubschema(), false);
+            }
+
+            Totals branch{0, 0};
+            const Subschema *branches[] = { constraint.getThenSubschema(), constraint.getElseSubschema() };
+            for (const Subschema *subschema : branches) {
+                if (subschema) {
+                    const Totals totals = m_analysis.analyseSubschema(*subschema, false);
+                    branch.cost = std::max(branch.cost, totals.cost);
+                    branch.fanOut = std::max(branch.fanOut, totals.fanOut);
+                }
+            }
+
+            addCost(saturatingAdd(1, saturatingAdd(condition.cost, branch.cost)));
+            addFanOut(saturatingAdd(condition.fanOut, branch.fanOut));
+            return true;
+        }
+
+        bool visit(const ConstConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const ContainsConstraint &constraint) override
+        {
+            addCost(1);
+            visitChild(constraint.getSubschema());
+            return true;
+        }
+
+        bool visit(const DependenciesConstraint &constraint) override
+        {
+            addCost(1);
+            constraint.applyToSchemaDependencies(
+                    [this](const DependenciesConstraint::String &, const Subschema *subschema) {
+                visitSameValue(subschema);
+                return true;
+            });
+
+            return true;
+        }
+
+        bool visit(const EnumConstraint &constraint) override
+        {
+            uint64_t values = 0;
+            constraint.applyToValues([&values](const adapters::FrozenValue &) {
+                values++;
+                return true;
+            });
+
+            addCost(values);
+            if (values > m_analysis.limits.maxEnumValues) {
+                m_analysis.addHazard(kWarning, kLargeEnum, describeConstraint(constraints::kEnum),
+                        "'enum' contains " + std::to_string(values) +
+                        " values; unless types are checked strictly, each may be compared with the target");
+            }
+
+            return true;
+        }
+
+        bool visit(const FormatConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const LinearItemsConstraint &constraint) override
+        {
+            addCost(1);
+            constraint.applyToItemSubschemas([this](unsigned int, const Subschema *subschema) {
+                visitChild(subschema);
+                return true;
+            });
+            visitChild(constraint.getAdditionalItemsSubschema());
+            return true;
+        }
+
+        bool visit(const MaximumConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MaxItemsConstraint &constraint) override
+        {
+            addCost(1);
+            m_hasMaxItems = true;
+            m_maxItems = constraint.getMaxItems();
+            return true;
+        }
+
+        bool visit(const MaxLengthConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MaxPropertiesConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MinimumConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MinItemsConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MinLengthConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MinPropertiesConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MultipleOfDoubleConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const MultipleOfIntConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const NotConstraint &constraint) override
+        {
+            addCost(1);
+            visitSameValue(constraint.getSubschema());
+            return true;
+        }
+
+        bool visit(const OneOfConstraint &constraint) override
+        {
+            return visitCombinator(constraint, constraints::kOneOf);
+        }
+
+        bool visit(const PatternConstraint &constraint) override
+        {
+            addCost(1);
+            checkPattern(constraint.getPattern<std::string::allocator_type>(),
+                    describeConstraint(constraints::kPattern), "'pattern'");
+            return true;
+        }
+
+        bool visit(const PolyConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const PropertiesConstraint &constraint) override
+        {
+            addCost(1);
+            constraint.applyToProperties(
+                    [this](const PropertiesConstraint::String &, const Subschema *subschema) {
+                visitChild(subschema);
+                return true;
+            });
+
+            const std::string path = describeConstraint(constraints::kProperties);
+            constraint.applyToPatternProperties(
+                    [this, &path](const PropertiesConstraint::String &pattern, const Subschema *subschema) {
+                checkPattern(std::string(pattern.c_str()), path, "'patternProperties' key");
+                visitChild(subschema);
+                return true;
+            });
+
+            visitChild(constraint.getAdditionalPropertiesSubschema());
+            return true;
+        }
+
+        bool visit(const PropertyNamesConstraint &constraint) override
+        {
+            addCost(1);
+            visitChild(constraint.getSubschema());
+            return true;
+        }
+
+        bool visit(const RequiredConstraint &) override
+        {
+            addCost(1);
+            return true;
+        }
+
+        bool visit(const SingularItemsConstraint &constraint) override
+        {
+            addCost(1);
+            visitChild(constraint.getItemsSubschema());
+            return true;
+        }
+
+        bool visit(const TypeConstraint &constraint) override
+        {
+            addCost(1);
+            constraint.applyToSchemaTypes([this](unsigned int, const Subschema *subschema) {
+                visitSameValue(subschema);
+                return true;
+            });
+
+            return true;
+        }
+
+        bool visit(const UniqueItemsConstraint &) override
+        {
+            addCost(1);
+            m_hasUniqueItems = true;
+            return true;
+        }
+
+    private:
+        template<typename ConstraintType>
+        bool visitCombinator(const ConstraintType &constraint, constraints::ConstraintKind kind)
+        {
+            Totals nested{0, 0};
+            constraint.applyToSubschemas([this, &nested](unsigned int, const Subschema *subschema) {
+                const Totals totals = m_analysis.analyseSubschema(*subschema, false);
+                nested.cost = saturatingAdd(nested.cost, totals.cost);
+                nested.fanOut = saturatingAdd(nested.fanOut, totals.fanOut);
+                return true;
+            });
+
+            addCost(saturatingAdd(1, nested.cost));
+            addFanOut(nested.fanOut);
+
+            if (nested.fanOut > m_analysis.limits.maxFanOut) {
+                m_analysis.addHazard(kWarning, kCombinatorFanOut, describeConstraint(kind),
+                        "'" + std::string(constraints::constraintKeyword(kind)) + "' may apply " +
+                        std::to_string(nested.fanOut) + " sub-schemas to each value");
+            }
+
+            return true;
+        }
+
+        void visitChild(const Subschema *subschema)
+        {
+            if (subschema) {
+                m_analysis.analyseSubschema(*subschema, true);
+            }
+        }
+
+        void visitSameValue(const Subschema *subschema)
+        {
+            if (subschema) {
+                const Totals totals = m_analysis.analyseSubschema(*subschema, false);
+                addCost(totals.cost);
+                addFanOut(totals.fanOut);
+            }
+        }
+
+        void checkPattern(const std::string &pattern, const std::string &path, const char *description)
+        {
+            if (isBacktrackingProne(pattern)) {
+                m_analysis.addHazard(kWarning, kBacktrackingPattern, path,
+                        std::string(description) + " '" + pattern +
+                        "' contains nested unbounded quantifiers, and is prone to catastrophic backtracking");
+            }
+        }
+
+        void addCost(uint64_t cost)
+        {
+            m_cost = saturatingAdd(m_cost, cost);
+        }
+
+        void addFanOut(uint64_t fanOut)
+        {
+            m_fanOut = saturatingAdd(m_fanOut, fanOut);
+        }
+
+        std::string describeConstraint(constraints::ConstraintKind kind) const
+        {
+            return ValidationObserver::describeConstraint(m_subschema, kind);
+        }
+
+        Analysis &m_analysis;
+        const Subschema &m_subschema;
+        uint64_t m_cost;
+        uint64_t m_fanOut;
+        bool m_hasMaxItems;
+        uint64_t m_maxItems;
+        bool m_hasUniqueItems;
+    };
+
+    /// Thresholds above which hazards are reported
+    Limits m_limits;
+};
+
+inline SchemaAnalyser::Totals SchemaAnalyser::Analysis::analyseSubschema(const Subschema &subschema, bool childValue)
+{
+    const auto itr = m_analysed.find(&subschema);
+    if (itr != m_analysed.end()) {
+        if (itr->second.first) {
+            return itr->second.second;
+        }
+
+        // Sub-schema is already being analysed, so there is a cycle. Check
+        // whether any step in the cycle descends into a nested value.
+        bool descends = childValue;
+        for (auto frame = m_stack.rbegin(); frame != m_stack.rend() && frame->first != &subschema; ++frame) {
+            descends |= frame->second;
+        }
+
+        const HazardKind kind = descends ? kUnboundedRecursion : kInfiniteRecursion;
+        if (m_recursionReported.insert(std::make_pair(&subschema, kind)).second) {
+            const std::string path = ValidationObserver::describeSubschema(subschema);
+            if (descends) {
+                addHazard(kWarning, kind, path,
+                        "Sub-schema is recursive; validation depth is limited only by the depth of the document");
+            } else {
+                addHazard(kCritical, kind, path,
+                        "Sub-schema can be re-applied to the same value; validation will not terminate");
+            }
+        }
+
+        return Totals{0, 0};
+    }
+
+    m_analysed[&subschema] = std::make_pair(false, Totals{0, 0});
+    m_stack.push_back(std::make_pair(&subschema, childValue));
+
+    AnalysisVisitor visitor(*this, subschema);
+    Subschema::ApplyFunction fn([&visitor](const constraints::Constraint &constraint) {
+        return constraint.accept(visitor);
+    });
+    subschema.apply(fn);
+    const Totals totals = visitor.finish();
+
+    m_stack.pop_back();
+    m_analysed[&subschema] = std::make_pair(true, totals);
+
+    // Skip empty sub-schemas synthesised by the parser, such as the default
+    // for 'additionalProperties'
+    if (totals.cost > 0 || subschema.hasPath()) {
+        costs.push_back(SubschemaCost{&subschema, ValidationObserver::describeSubschema(subschema), totals.cost,
+                totals.fanOut});
+    }
+
+    return totals;
+}
+
+}  // namespace valijson
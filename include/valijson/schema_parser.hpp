@@ -587,6 +587,8 @@ private:
             "SchemaParser::populateSchema must be invoked with an "
             "appropriate Adapter implementation");
 
+        rootSchema.setSubschemaPath(&subschema, nodePath);
+
         if (!node.isObject()) {
             if (m_version == kDraft7 && node.maybeBool()) {
                 // Boolean schema
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include <valijson/constraints/constraint.hpp>
+#include <valijson/internal/custom_allocator.hpp>
 #include <valijson/internal/optional.hpp>
 #include <valijson/exceptions.hpp>
 
@@ -51,10 +52,13 @@ public:
     Subschema(Subschema &&other)
       : m_allocFn(other.m_allocFn),
         m_freeFn(other.m_freeFn),
+        m_contextAllocFn(other.m_contextAllocFn),
+        m_allocContext(other.m_allocContext),
         m_alwaysInvalid(std::move(other.m_alwaysInvalid)),
         m_constraints(std::move(other.m_constraints)),
         m_description(std::move(other.m_description)),
         m_id(std::move(other.m_id)),
+        m_path(std::move(other.m_path)),
         m_title(std::move(other.m_title)) { }
 
     /**
@@ -68,22 +72,25 @@ public:
         // Swaps all members
         std::swap(m_allocFn, other.m_allocFn);
         std::swap(m_freeFn, other.m_freeFn);
+        std::swap(m_contextAllocFn, other.m_contextAllocFn);
+        std::swap(m_allocContext, other.m_allocContext);
         std::swap(m_alwaysInvalid, other.m_alwaysInvalid);
         std::swap(m_constraints, other.m_constraints);
         std::swap(m_description, other.m_description);
         std::swap(m_id, other.m_id);
+        std::swap(m_path, other.m_path);
         std::swap(m_title, other.m_title);
 
         return *this;
     }
 
     /**
-     * @brief  Construct a new Subschema object
+     * @brief  Construct a new Subschema object, using the default allocation
+     *         functions for this thread, e.g. those set by a
+     *         ScopedMemoryResource
      */
     Subschema()
-      : m_allocFn([](size_t size) { return ::operator new(size, std::nothrow); })
-      , m_freeFn(::operator delete)
-      , m_alwaysInvalid(false) { }
+      : Subschema(internal::defaultAllocationFunctions()) { }
 
     /**
      * @brief  Construct a new Subschema using custom memory management
@@ -95,13 +102,26 @@ public:
      *                  the `customAlloc` function
      */
     Subschema(CustomAlloc allocFn, CustomFree freeFn)
-      : m_allocFn(allocFn)
-      , m_freeFn(freeFn)
+      : Subschema(internal::AllocationFunctions{ allocFn, freeFn, nullptr, nullptr }) { }
+
+    /**
+     * @brief  Construct a new Subschema that allocates memory using a set of
+     *         allocation functions, and the state that they use
+     *
+     * @param  functions  allocation functions, such as those for a memory
+     *                    resource
+     */
+    explicit Subschema(const internal::AllocationFunctions &functions)
+      : m_allocFn(functions.allocFn)
+      , m_freeFn(functions.freeFn)
+      , m_contextAllocFn(functions.contextAllocFn)
+      , m_allocContext(functions.context)
       , m_alwaysInvalid(false)
     {
         // explicitly initialise optionals. See: https://github.com/tristanpenman/valijson/issues/124
         m_description = opt::nullopt;
         m_id = opt::nullopt;
+        m_path = opt::nullopt;
         m_title = opt::nullopt;
     }
 
@@ -135,6 +155,11 @@ public:
      */
     void addConstraint(const Constraint &constraint)
     {
+        // Constraint::clone() only takes allocFn and freeFn, so make this
+        // sub-schema's functions the default while the constraint and the
+        // containers that it owns are copied
+        const internal::ScopedAllocationFunctions scope(allocationFunctions());
+
         // the vector allocation might throw but the constraint memory will be taken care of anyways
         m_constraints.push_back(constraint.clone(m_allocFn, m_freeFn));
     }
@@ -223,6 +248,26 @@ public:
         throwRuntimeError("Schema does not have an ID");
     }
 
+    /**
+     * @brief  Get the path at which this sub-schema was defined
+     *
+     * The path is a JSON Pointer, relative to the root of the schema document
+     * from which the sub-schema was parsed. An empty string refers to the
+     * root of that document.
+     *
+     * @throws  std::runtime_error if a path has not been set
+     *
+     * @returns  string containing sub-schema path
+     */
+    std::string getPath() const
+    {
+        if (m_path) {
+            return *m_path;
+        }
+
+        throwRuntimeError("Schema does not have a path");
+    }
+
     /**
      * @brief  Get the title associated with this sub-schema
      *
@@ -259,6 +304,16 @@ public:
         return static_cast<bool>(m_id);
     }
 
+    /**
+     * @brief  Check whether this sub-schema has a path
+     *
+     * @return  boolean value
+     */
+    bool hasPath() const
+    {
+        return static_cast<bool>(m_path);
+    }
+
     /**
      * @brief  Check whether this sub-schema has a title
      *
@@ -294,6 +349,19 @@ public:
         m_id = id;
     }
 
+    /**
+     * @brief  Set the path at which this sub-schema was defined
+     *
+     * The path will not be used for validation, but may be used to attribute
+     * validation work to a particular part of a schema, e.g. when tracing.
+     *
+     * @param  path  JSON Pointer to the sub-schema
+     */
+    void setPath(const std::string &path)
+    {
+        m_path = path;
+    }
+
     /**
      * @brief  Set the title for this sub-schema
      *
@@ -311,10 +379,25 @@ public:
 
 protected:
 
+    /**
+     * @brief  Return the allocation functions, and the state that they use,
+     *         that were in effect when this sub-schema was constructed
+     */
+    internal::AllocationFunctions allocationFunctions() const
+    {
+        return { m_allocFn, m_freeFn, m_contextAllocFn, m_allocContext };
+    }
+
     CustomAlloc m_allocFn;
 
     CustomFree m_freeFn;
 
+    /// Function used instead of m_allocFn when m_allocContext is set
+    internal::CustomAllocator<char>::ContextAlloc m_contextAllocFn;
+
+    /// State passed to m_contextAllocFn, such as a memory resource
+    void *m_allocContext;
+
 private:
 
     bool m_alwaysInvalid;
@@ -328,6 +411,9 @@ private:
     /// ID to apply when resolving the schema URI
     opt::optional<std::string> m_id;
 
+    /// JSON Pointer to the sub-schema within its schema document (optional)
+    opt::optional<std::string> m_path;
+
     /// Title string associated with the schema (optional)
     opt::optional<std::string> m_title;
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace valijson {
+
+/**
+ * @brief  Controls whether the type checking mode used during validation is
+ *         chosen at runtime, or fixed at compile time
+ *
+ * With kRuntimeTypeChecking (the default), strong or weak type checking is
+ * selected when a Validator is constructed. The other policies fix the mode
+ * at compile time, so that the unused mode is compiled out of the validation
+ * code. In particular, kStrongTypeChecking checks types using only the isX()
+ * functions of an adapter, and never calls the more expensive maybeX()
+ * functions that are needed to support weakly typed formats.
+ */
+enum TypeCheckingPolicy
+{
+    kRuntimeTypeChecking,
+    kStrongTypeChecking,
+    kWeakTypeChecking
+};
+
+}  // namespace valijson
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <valijson/binary_document.hpp>
+
+namespace valijson {
+namespace utils {
+
+template<typename Format>
+inline bool loadDocument(const std::string &path, BinaryDocument<Format> &document)
+{
+    // Load document from file, without any newline conversion
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to load " << Format::name() << " from file '" << path << "'." << std::endl;
+        return false;
+    }
+
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Index document, transferring ownership of the bytes
+    if (!document.parse(std::move(bytes))) {
+        std::cerr << Format::name() << " document could not be parsed:" << std::endl
+                  << "Parse error: " << document.getError() << std::endl
+                  << "Near: offset " << document.getErrorOffset() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace utils
+}  // namespace valijson
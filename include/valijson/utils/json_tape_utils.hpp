@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iostream>
+
+#include <valijson/json_tape.hpp>
+#include <valijson/utils/file_utils.hpp>
+
+namespace valijson {
+namespace utils {
+
+inline bool loadDocument(const std::string &path, JsonTape &document)
+{
+    // Load schema JSON from file
+    std::string file;
+    if (!loadFile(path, file)) {
+        std::cerr << "Failed to load json from file '" << path << "'." << std::endl;
+        return false;
+    }
+
+    // Parse schema, transferring ownership of the text to the tape
+    if (!document.parse(std::move(file))) {
+        std::cerr << "JsonTape failed to parse the document:" << std::endl
+                  << "Parse error: " << document.getError() << std::endl
+                  << "Near: offset " << document.getErrorOffset() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace utils
+}  // namespace valijson
@@ -0,0 +1,496 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include <valijson/adapters/yaml_cpp_adapter.hpp>
+#include <valijson/subschema.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_thread_pool.hpp>
+#include <valijson/validator.hpp>
+
+namespace valijson {
+namespace utils {
+
+/**
+ * @brief  Reads the documents in a multi-document YAML stream one at a time
+ *
+ * Documents are separated by '---' and '...' markers at the start of a line.
+ * Only the text of the current document is held in memory, so arbitrarily
+ * long streams can be processed. Because the YAML specification forbids
+ * document markers at the start of a line within a document, a document that
+ * fails to parse does not prevent later documents from being read.
+ */
+class YamlDocumentReader
+{
+public:
+
+    /**
+     * @brief  Construct a reader for a stream
+     *
+     * The stream is not owned by the reader, and must outlive it.
+     */
+    explicit YamlDocumentReader(std::istream &input)
+      : m_input(input),
+        m_lineNumber(0),
+        m_pendingLine(0),
+        m_documentLine(0) { }
+
+    /**
+     * @brief  Read the text of the next document in the stream
+     *
+     * @param  text  string to be populated with the text of the document
+     *
+     * @returns  true if a document was read, false at the end of the stream
+     */
+    bool nextText(std::string &text)
+    {
+        text.clear();
+
+        bool hasContent = false;
+        std::string directives;
+
+        // A document start marker that terminated the previous document
+        if (m_pendingLine != 0) {
+            text = m_pending;
+            text.push_back('\n');
+            m_documentLine = m_pendingLine;
+            m_pending.clear();
+            m_pendingLine = 0;
+            hasContent = true;
+        }
+
+        std::string line;
+        while (std::getline(m_input, line)) {
+            m_lineNumber++;
+
+            if (isMarker(line, '-')) {
+                if (hasContent) {
+                    m_pending.swap(line);
+                    m_pendingLine = m_lineNumber;
+                    return true;
+                }
+
+                text = directives;
+                text.append(line);
+                text.push_back('\n');
+                m_documentLine = m_lineNumber;
+                hasContent = true;
+                continue;
+            }
+
+            if (isMarker(line, '.')) {
+                if (hasContent) {
+                    return true;
+                }
+
+                directives.clear();
+                continue;
+            }
+
+            if (!hasContent) {
+                // Directives apply to the document that follows them, and
+                // blank lines and comments before a document are ignored
+                if (!line.empty() && line[0] == '%') {
+                    directives.append(line);
+                    directives.push_back('\n');
+                    continue;
+                } else if (isBlankOrComment(line)) {
+                    continue;
+                }
+
+                m_documentLine = m_lineNumber;
+                hasContent = true;
+            }
+
+            text.append(line);
+            text.push_back('\n');
+        }
+
+        return hasContent;
+    }
+
+    /**
+     * @brief  Read and parse the next document in the stream
+     *
+     * @param  document  node to be populated with the parsed document
+     *
+     * @throws YAML::Exception if the document cannot be parsed
+     *
+     * @returns  true if a document was read, false at the end of the stream
+     */
+    bool next(YAML::Node &document)
+    {
+        std::string text;
+        if (!nextText(text)) {
+            return false;
+        }
+
+        document = YAML::Load(text);
+        return true;
+    }
+
+    /**
+     * @brief  Return the 1-based line number at which the most recently read
+     *         document begins
+     */
+    size_t documentLine() const
+    {
+        return m_documentLine;
+    }
+
+private:
+
+    /**
+     * @brief  Return true if a line consists of a '---' or '...' marker,
+     *         optionally followed by whitespace and content
+     */
+    static bool isMarker(const std::string &line, char c)
+    {
+        if (line.size() < 3 || line[0] != c || line[1] != c || line[2] != c) {
+            return false;
+        }
+
+        return line.size() == 3 || line[3] == ' ' || line[3] == '\t' || line[3] == '\r';
+    }
+
+    static bool isBlankOrComment(const std::string &line)
+    {
+        const size_t pos = line.find_first_not_of(" \t\r");
+        return pos == std::string::npos || line[pos] == '#';
+    }
+
+    /// Stream from which documents are read
+    std::istream &m_input;
+
+    /// Number of lines read from the stream so far
+    size_t m_lineNumber;
+
+    /// Document start marker that terminated the previous document
+    std::string m_pending;
+
+    /// Line number of the pending marker, or zero if there is none
+    size_t m_pendingLine;
+
+    /// Line number at which the most recently read document begins
+    size_t m_documentLine;
+};
+
+/**
+ * @brief  Validates each of the documents in a multi-document YAML stream
+ *
+ * Documents are read lazily using YamlDocumentReader, and each document is
+ * validated against a schema chosen by a SchemaSelector. When more than one
+ * thread is requested, documents are parsed on the calling thread and then
+ * validated in parallel batches, with results still reported in stream order.
+ * The threads are created once, and are reused for every batch.
+ *
+ * @tparam  RegexEngine  regular expression engine used by the Validator
+ * @tparam  Policy       type checking policy used by the Validator
+ */
+template<typename RegexEngine, TypeCheckingPolicy Policy = kRuntimeTypeChecking>
+class YamlStreamValidatorT
+{
+public:
+
+    typedef ValidatorT<RegexEngine, Policy> ValidatorType;
+
+    /**
+     * @brief  Function that chooses the schema for a document
+     *
+     * A selector may return nullptr if no schema applies to a document.
+     */
+    typedef std::function<const Subschema * (const adapters::YamlCppAdapter &)> SchemaSelector;
+
+    /**
+     * @brief  Outcome of validating a single document in a stream
+     */
+    struct Result
+    {
+        Result()
+          : index(0),
+            line(0),
+            schema(nullptr),
+            parsed(false),
+            valid(false) { }
+
+        /// Zero-based position of the document in the stream
+        size_t index;
+
+        /// One-based line number at which the document begins
+        size_t line;
+
+        /// Schema used to validate the document, or nullptr if none was found
+        const Subschema *schema;
+
+        /// Whether the document could be parsed
+        bool parsed;
+
+        /// Whether the document was parsed and satisfied its schema
+        bool valid;
+
+        /// Reason why the document could not be validated, if applicable
+        std::string error;
+
+        /// Validation errors reported for the document
+        ValidationResults results;
+    };
+
+    typedef std::function<void (const Result &)> ResultCallback;
+
+    /**
+     * @brief  Construct a validator that uses the same schema for every
+     *         document in a stream
+     *
+     * The schema is not owned by the validator, and must outlive it.
+     *
+     * @param  schema     schema used for every document
+     * @param  prototype  Validator to be copied to validate documents; it
+     *                    must not have an observer or instrumentation
+     *                    attached. A TypeCheckingMode may be passed instead.
+     */
+    explicit YamlStreamValidatorT(const Subschema &schema,
+            const ValidatorType &prototype = ValidatorType(ValidatorType::kWeakTypes))
+      : m_prototype(prototype.concurrentCopy()),
+        m_threads(1)
+    {
+        const Subschema *ptr = &schema;
+        m_selector = [ptr](const adapters::YamlCppAdapter &) { return ptr; };
+    }
+
+    /**
+     * @brief  Construct a validator that chooses the schema for each document
+     *         using a SchemaSelector
+     *
+     * @see YamlStreamValidatorT(const Subschema &, const ValidatorType &)
+     */
+    explicit YamlStreamValidatorT(SchemaSelector selector,
+            const ValidatorType &prototype = ValidatorType(ValidatorType::kWeakTypes))
+      : m_selector(std::move(selector)),
+        m_prototype(prototype.concurrentCopy()),
+        m_threads(1) { }
+
+    /**
+     * @brief  Set the number of threads used to validate documents
+     *
+     * Values of zero and one both result in documents being validated on the
+     * calling thread. Otherwise, the calling thread validates documents
+     * alongside a pool of threads - 1 worker threads, which is kept until the
+     * number of threads is changed. The SchemaSelector is always invoked on
+     * the calling thread.
+     */
+    void setThreads(unsigned int threads)
+    {
+        const unsigned int newThreads = threads > 0 ? threads : 1;
+        if (newThreads != m_threads) {
+            m_pool.reset();
+            m_threads = newThreads;
+        }
+    }
+
+    /**
+     * @brief  Validate each document in a stream
+     *
+     * @param  input     stream containing zero or more YAML documents
+     * @param  callback  function invoked with the result for each document,
+     *                   in the order that the documents appear in the stream
+     *
+     * If validating a document throws an exception, on any thread, the
+     * exception is rethrown on the calling thread once the rest of the batch
+     * has been validated, and no results are reported for that batch.
+     *
+     * @returns  true if every document was parsed and validated successfully
+     */
+    bool validate(std::istream &input, const ResultCallback &callback)
+    {
+        YamlDocumentReader reader(input);
+        std::vector<ValidatorType> validators(m_threads, m_prototype);
+        if (m_threads > 1 && !m_pool) {
+            m_pool.reset(new ValidationThreadPool(m_threads - 1));
+        }
+
+        // Keep a bounded number of documents in memory at any one time
+        const size_t batchSize = m_threads > 1 ? m_threads * 8 : 1;
+        std::vector<YAML::Node> documents;
+        std::vector<Result> results;
+        documents.reserve(batchSize);
+        results.reserve(batchSize);
+
+        bool valid = true;
+        size_t index = 0;
+        bool more = true;
+        while (more) {
+            documents.clear();
+            results.clear();
+
+            while (documents.size() < batchSize) {
+                std::string text;
+                if (!reader.nextText(text)) {
+                    more = false;
+                    break;
+                }
+
+                documents.push_back(YAML::Node());
+                results.push_back(Result());
+                Result &result = results.back();
+                result.index = index++;
+                result.line = reader.documentLine();
+                prepare(text, documents.back(), result);
+            }
+
+            if (m_threads > 1 && documents.size() > 1) {
+                validateInParallel(documents, results, validators, *m_pool);
+            } else {
+                for (size_t i = 0; i < documents.size(); i++) {
+                    validateDocument(documents[i], results[i], validators.front());
+                }
+            }
+
+            for (const Result &result : results) {
+                valid = valid && result.valid;
+                callback(result);
+            }
+        }
+
+        return valid;
+    }
+
+    /**
+     * @brief  Validate each document in a stream, and collect the results
+     *
+     * @param  input    stream containing zero or more YAML documents
+     * @param  results  vector to which a result is appended for each document
+     *
+     * @returns  true if every document was parsed and validated successfully
+     */
+    bool validate(std::istream &input, std::vector<Result> &results)
+    {
+        return validate(input, [&results](const Result &result) {
+            results.push_back(result);
+        });
+    }
+
+    /**
+     * @brief  Create a SchemaSelector that chooses a schema using the values of
+     *         discriminator properties in each document
+     *
+     * The values of the properties are joined with '/' to form a key, which is
+     * then looked up in the map of schemas. For example, with the default
+     * properties, a document containing 'apiVersion: apps/v1' and
+     * 'kind: Deployment' is validated against the schema registered with the
+     * key 'apps/v1/Deployment'. Documents that are missing a property, or for
+     * which no schema has been registered, are matched against the fallback
+     * schema, if one is provided.
+     *
+     * @param  schemas     map of keys to schemas, which must outlive the
+     *                     selector
+     * @param  properties  names of the discriminator properties
+     * @param  fallback    optional schema for documents that do not match
+     */
+    static SchemaSelector selectByDiscriminator(
+            std::map<std::string, const Subschema *> schemas,
+            std::vector<std::string> properties = {"apiVersion", "kind"},
+            const Subschema *fallback = nullptr)
+    {
+        return [schemas, properties, fallback](const adapters::YamlCppAdapter &document)
+                -> const Subschema * {
+            if (!document.isObject()) {
+                return fallback;
+            }
+
+            const adapters::YamlCppObject object = document.asObject();
+            std::string key;
+            for (const std::string &property : properties) {
+                const adapters::YamlCppObject::const_iterator itr = object.find(property);
+                std::string value;
+                if (itr == object.end() || !itr->second.getString(value)) {
+                    return fallback;
+                }
+
+                if (!key.empty()) {
+                    key.push_back('/');
+                }
+
+                key.append(value);
+            }
+
+            const std::map<std::string, const Subschema *>::const_iterator found = schemas.find(key);
+            return found == schemas.end() ? fallback : found->second;
+        };
+    }
+
+private:
+
+    /**
+     * @brief  Parse a document and choose its schema
+     */
+    void prepare(const std::string &text, YAML::Node &document, Result &result) const
+    {
+        try {
+            document = YAML::Load(text);
+        } catch (const YAML::Exception &ex) {
+            result.error = ex.what();
+            return;
+        }
+
+        result.parsed = true;
+        result.schema = m_selector(adapters::YamlCppAdapter(document));
+        if (!result.schema) {
+            result.error = "No schema found for document";
+        }
+    }
+
+    static void validateDocument(const YAML::Node &document, Result &result, ValidatorType &validator)
+    {
+        if (result.schema) {
+            result.valid = validator.validate(*result.schema,
+                    adapters::YamlCppAdapter(document), &result.results);
+        }
+    }
+
+    /**
+     * @brief  Validate a batch of documents using a thread pool
+     *
+     * The batch is divided into one task per Validator, so that a Validator
+     * and its regex cache are only ever used by one thread at a time. The pool
+     * rethrows the first exception thrown by a task once all of the tasks
+     * have finished.
+     */
+    static void validateInParallel(const std::vector<YAML::Node> &documents,
+            std::vector<Result> &results, std::vector<ValidatorType> &validators,
+            ValidationThreadPool &pool)
+    {
+        const size_t tasks = std::min(validators.size(), documents.size());
+        pool.parallelFor(tasks, [&documents, &results, &validators, tasks](size_t task) {
+            for (size_t i = task; i < documents.size(); i += tasks) {
+                validateDocument(documents[i], results[i], validators[task]);
+            }
+        });
+    }
+
+    /// Function used to choose the schema for each document
+    SchemaSelector m_selector;
+
+    /// Validator that is copied for each thread
+    const ValidatorType m_prototype;
+
+    /// Number of threads used to validate documents
+    unsigned int m_threads;
+
+    /// Worker threads used when m_threads is greater than one
+    std::unique_ptr<ValidationThreadPool> m_pool;
+};
+
+using YamlStreamValidator = YamlStreamValidatorT<DefaultRegexEngine>;
+
+} // namespace utils
+} // namespace valijson
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include <valijson/constraints/constraint_kind.hpp>
+#include <valijson/validation_stats.hpp>
+
+namespace valijson {
+
+/**
+ * @brief  Thread-safe counters for long-lived validators, which can be
+ *         rendered in the Prometheus text exposition format
+ *
+ * A ValidationMetrics object is attached to one or more Validator instances
+ * via Validator::setMetrics(). Each call to validate() then records its
+ * outcome, the number of errors reported, its latency, and (optionally) the
+ * counters from a ValidationStats object.
+ *
+ * ValidationStats counters are only recorded for calls to validate() that are
+ * passed a ValidationStats object, unless collectStats is set when the
+ * metrics are constructed. Collecting counters for every call requires the
+ * validator to take its slower, instrumented path.
+ *
+ * Counters are spread across a fixed number of shards, assigned to threads in
+ * turn, so that validators running on different threads rarely contend on the
+ * same cache line. Shards are summed when the metrics are read. Rendering does
+ * not require any network service; write() can be used to serve a scrape
+ * endpoint or to dump metrics to a file for the node exporter textfile
+ * collector.
+ */
+class ValidationMetrics
+{
+public:
+    /// Number of shards that counters are spread across
+    enum { kNumShards = 16 };
+
+    /// Number of finite latency histogram buckets
+    enum { kNumLatencyBuckets = 13 };
+
+    /**
+     * @brief  Totals obtained by summing all shards
+     */
+    struct Snapshot
+    {
+        Snapshot()
+          : validations(0),
+            failures(0),
+            errors(0),
+            latencyNanoseconds(0),
+            latencyBuckets(),
+            stats() { }
+
+        /// Number of calls to validate()
+        uint64_t validations;
+
+        /// Number of calls to validate() that returned false
+        uint64_t failures;
+
+        /// Number of errors added to ValidationResults objects
+        uint64_t errors;
+
+        /// Total time spent in validate()
+        uint64_t latencyNanoseconds;
+
+        /// Non-cumulative latency histogram; the final bucket is unbounded
+        uint64_t latencyBuckets[kNumLatencyBuckets + 1];
+
+        /// Aggregated work counters; peak depth is the largest observed
+        ValidationStats stats;
+    };
+
+    /**
+     * @brief  Construct a new ValidationMetrics object
+     *
+     * @param  prefix        prefix for metric names
+     * @param  collectStats  whether validators should collect ValidationStats
+     *                       counters for every call, even if the caller did
+     *                       not ask for them; this is off by default, since
+     *                       it forces the slower, instrumented path, and
+     *                       requires VALIJSON_USE_INSTRUMENTATION
+     */
+    explicit ValidationMetrics(const std::string &prefix = "valijson", bool collectStats = false)
+      : m_prefix(prefix),
+        m_collectStats(collectStats) { }
+
+    // Disable copy construction
+    ValidationMetrics(const ValidationMetrics &) = delete;
+
+    // Disable copy assignment
+    ValidationMetrics & operator=(const ValidationMetrics &) = delete;
+
+    bool collectsStats() const
+    {
+        return m_collectStats;
+    }
+
+    /**
+     * @brief  Return the upper bound of a latency histogram bucket
+     *
+     * @param  index  bucket index, less than kNumLatencyBuckets
+     */
+    static uint64_t latencyBucketBound(size_t index)
+    {
+        // 1us, 5us, 10us, 50us, ... 1s
+        static const uint64_t bounds[kNumLatencyBuckets] = {
+            1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000,
+            10000000, 50000000, 100000000, 500000000, 1000000000
+        };
+
+        return bounds[index];
+    }
+
+    /**
+     * @brief  Record the outcome of a single validation
+     *
+     * @param  validated    value returned by validate()
+     * @param  errors       number of errors that were reported
+     * @param  nanoseconds  time spent in validate()
+     * @param  stats        optional counters collected during validation
+     */
+    void record(bool validated, uint64_t errors, uint64_t nanoseconds, const ValidationStats *stats)
+    {
+        Shard &shard = m_shards[shardIndex()];
+        shard.validations.fetch_add(1, std::memory_order_relaxed);
+        if (!validated) {
+            shard.failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.errors.fetch_add(errors, std::memory_order_relaxed);
+        shard.latencyNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        size_t bucket = 0;
+        while (bucket < kNumLatencyBuckets && nanoseconds > latencyBucketBound(bucket)) {
+            bucket++;
+        }
+        shard.latencyBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        if (stats) {
+            shard.nodesVisited.fetch_add(stats->nodesVisited, std::memory_order_relaxed);
+            shard.subschemasEntered.fetch_add(stats->subschemasEntered, std::memory_order_relaxed);
+            for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+                if (stats->constraintsEvaluated[i]) {
+                    shard.constraintsEvaluated[i].fetch_add(stats->constraintsEvaluated[i],
+                            std::memory_order_relaxed);
+                }
+            }
+            shard.regexInvocations.fetch_add(stats->regexInvocations, std::memory_order_relaxed);
+            shard.regexCacheHits.fetch_add(stats->regexCacheHits, std::memory_order_relaxed);
+            shard.regexCacheMisses.fetch_add(stats->regexCacheMisses, std::memory_order_relaxed);
+            shard.valueComparisons.fetch_add(stats->valueComparisons, std::memory_order_relaxed);
+
+            uint64_t peakDepth = shard.peakDepth.load(std::memory_order_relaxed);
+            while (stats->peakDepth > peakDepth &&
+                    !shard.peakDepth.compare_exchange_weak(peakDepth, stats->peakDepth,
+                            std::memory_order_relaxed)) { }
+        }
+    }
+
+    /**
+     * @brief  Reset all counters to zero
+     *
+     * Counters that are updated concurrently with a call to reset() may or
+     * may not be included in the next snapshot.
+     */
+    void reset()
+    {
+        for (Shard &shard : m_shards) {
+            shard.reset();
+        }
+    }
+
+    /**
+     * @brief  Return the sum of all shards
+     */
+    Snapshot snapshot() const
+    {
+        Snapshot totals;
+        for (const Shard &shard : m_shards) {
+            totals.validations += shard.validations.load(std::memory_order_relaxed);
+            totals.failures += shard.failures.load(std::memory_order_relaxed);
+            totals.errors += shard.errors.load(std::memory_order_relaxed);
+            totals.latencyNanoseconds += shard.latencyNanoseconds.load(std::memory_order_relaxed);
+            for (size_t i = 0; i <= kNumLatencyBuckets; i++) {
+                totals.latencyBuckets[i] += shard.latencyBuckets[i].load(std::memory_order_relaxed);
+            }
+
+            ValidationStats &stats = totals.stats;
+            stats.nodesVisited += shard.nodesVisited.load(std::memory_order_relaxed);
+            stats.subschemasEntered += shard.subschemasEntered.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+                stats.constraintsEvaluated[i] += shard.constraintsEvaluated[i].load(std::memory_order_relaxed);
+            }
+            stats.regexInvocations += shard.regexInvocations.load(std::memory_order_relaxed);
+            stats.regexCacheHits += shard.regexCacheHits.load(std::memory_order_relaxed);
+            stats.regexCacheMisses += shard.regexCacheMisses.load(std::memory_order_relaxed);
+            stats.valueComparisons += shard.valueComparisons.load(std::memory_order_relaxed);
+            stats.peakDepth = std::max(stats.peakDepth, shard.peakDepth.load(std::memory_order_relaxed));
+        }
+
+        return totals;
+    }
+
+    /**
+     * @brief  Write all metrics in the Prometheus text exposition format
+     *
+     * @param  os  output stream
+     */
+    void write(std::ostream &os) const
+    {
+        const Snapshot totals = snapshot();
+        const ValidationStats &stats = totals.stats;
+
+        writeCounter(os, "validations_total", "Number of documents validated.", totals.validations);
+        writeCounter(os, "validation_failures_total", "Number of documents that failed validation.",
+                totals.failures);
+        writeCounter(os, "validation_errors_total", "Number of validation errors reported.", totals.errors);
+
+        const std::string latency = m_prefix + "_validation_duration_seconds";
+        os << "# HELP " << latency << " Time spent validating documents.\n";
+        os << "# TYPE " << latency << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < kNumLatencyBuckets; i++) {
+            cumulative += totals.latencyBuckets[i];
+            os << latency << "_bucket{le=\"" << seconds(latencyBucketBound(i)) << "\"} " << cumulative << "\n";
+        }
+        cumulative += totals.latencyBuckets[kNumLatencyBuckets];
+        os << latency << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+        os << latency << "_sum " << seconds(totals.latencyNanoseconds) << "\n";
+        os << latency << "_count " << cumulative << "\n";
+
+        if (!m_collectStats && stats.subschemasEntered == 0) {
+            return;
+        }
+
+        writeCounter(os, "nodes_visited_total", "Number of document values visited.", stats.nodesVisited);
+        writeCounter(os, "subschemas_entered_total", "Number of times a value was validated against a sub-schema.",
+                stats.subschemasEntered);
+
+        const std::string constraintsName = m_prefix + "_constraints_evaluated_total";
+        os << "# HELP " << constraintsName << " Number of constraints evaluated, by kind.\n";
+        os << "# TYPE " << constraintsName << " counter\n";
+        for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+            os << constraintsName << "{kind=\""
+               << constraints::constraintKindName(static_cast<constraints::ConstraintKind>(i)) << "\"} "
+               << stats.constraintsEvaluated[i] << "\n";
+        }
+
+        writeCounter(os, "regex_invocations_total", "Number of regular expression searches.",
+                stats.regexInvocations);
+        writeCounter(os, "regex_cache_hits_total", "Number of compiled regular expressions reused from the cache.",
+                stats.regexCacheHits);
+        writeCounter(os, "regex_cache_misses_total", "Number of regular expressions compiled.",
+                stats.regexCacheMisses);
+        writeCounter(os, "value_comparisons_total", "Number of equality comparisons between values.",
+                stats.valueComparisons);
+
+        const std::string depthName = m_prefix + "_peak_depth";
+        os << "# HELP " << depthName << " Deepest sub-schema nesting observed.\n";
+        os << "# TYPE " << depthName << " gauge\n";
+        os << depthName << " " << stats.peakDepth << "\n";
+    }
+
+    /**
+     * @brief  Return all metrics in the Prometheus text exposition format
+     */
+    std::string render() const
+    {
+        std::ostringstream ss;
+        write(ss);
+        return ss.str();
+    }
+
+private:
+    /**
+     * @brief  Counters for a single shard
+     *
+     * Each shard is padded so that shards updated by different threads do not
+     * share a cache line.
+     */
+    struct Shard
+    {
+        Shard()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            validations.store(0, std::memory_order_relaxed);
+            failures.store(0, std::memory_order_relaxed);
+            errors.store(0, std::memory_order_relaxed);
+            latencyNanoseconds.store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i <= kNumLatencyBuckets; i++) {
+                latencyBuckets[i].store(0, std::memory_order_relaxed);
+            }
+            nodesVisited.store(0, std::memory_order_relaxed);
+            subschemasEntered.store(0, std::memory_order_relaxed);
+            for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+                constraintsEvaluated[i].store(0, std::memory_order_relaxed);
+            }
+            regexInvocations.store(0, std::memory_order_relaxed);
+            regexCacheHits.store(0, std::memory_order_relaxed);
+            regexCacheMisses.store(0, std::memory_order_relaxed);
+            valueComparisons.store(0, std::memory_order_relaxed);
+            peakDepth.store(0, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t> validations;
+        std::atomic<uint64_t> failures;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint64_t> latencyNanoseconds;
+        std::atomic<uint64_t> latencyBuckets[kNumLatencyBuckets + 1];
+        std::atomic<uint64_t> nodesVisited;
+        std::atomic<uint64_t> subschemasEntered;
+        std::atomic<uint64_t> constraintsEvaluated[constraints::kNumConstraintKinds];
+        std::atomic<uint64_t> regexInvocations;
+        std::atomic<uint64_t> regexCacheHits;
+        std::atomic<uint64_t> regexCacheMisses;
+        std::atomic<uint64_t> valueComparisons;
+        std::atomic<uint64_t> peakDepth;
+
+        char padding[64];
+    };
+
+    /**
+     * @brief  Return the shard used by the calling thread
+     *
+     * Shards are handed out round-robin as threads first record a
+     * validation, so up to kNumShards threads never share a shard. Hashing
+     * the thread id instead is not enough, since std::hash<std::thread::id>
+     * may return the id unchanged, and ids that are multiples of a power of
+     * two would all fall in the same shard.
+     */
+    static size_t shardIndex()
+    {
+        static std::atomic<size_t> nextShard(0);
+        static thread_local const size_t index =
+                nextShard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+
+        return index;
+    }
+
+    static std::string seconds(uint64_t nanoseconds)
+    {
+        std::ostringstream ss;
+        ss.precision(12);
+        ss << (static_cast<double>(nanoseconds) / 1e9);
+        return ss.str();
+    }
+
+    void writeCounter(std::ostream &os, const char *name, const char *help, uint64_t value) const
+    {
+        os << "# HELP " << m_prefix << "_" << name << " " << help << "\n";
+        os << "# TYPE " << m_prefix << "_" << name << " counter\n";
+        os << m_prefix << "_" << name << " " << value << "\n";
+    }
+
+    /// Prefix for metric names
+    const std::string m_prefix;
+
+    /// Whether validators should collect ValidationStats for every call
+    const bool m_collectStats;
+
+    /// Counters, spread across shards to reduce contention
+    Shard m_shards[kNumShards];
+};
+
+}  // namespace valijson
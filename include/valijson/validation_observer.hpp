@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <valijson/constraints/constraint_kind.hpp>
+#include <valijson/subschema.hpp>
+
+namespace valijson {
+
+/**
+ * @brief  Interface for objects that are notified as validation proceeds
+ *
+ * A ValidationObserver is notified when the ValidationVisitor enters and exits
+ * each sub-schema and each constraint. Notifications are strictly nested, so
+ * an observer can maintain a stack to attribute validation work to particular
+ * parts of a schema (see the sinks in the valijson/observers directory).
+ *
+ * The \c context argument is the same context that is used for validation
+ * error descriptions. The documentPath() function can be used to convert it
+ * to a JSON Pointer.
+ *
+ * Observers are attached to a Validator via the setObserver() function. Hooks
+ * are compiled out when VALIJSON_USE_INSTRUMENTATION is defined to 0, in
+ * which case calling setObserver() is a compile error.
+ */
+class ValidationObserver
+{
+public:
+    virtual ~ValidationObserver() { }
+
+    /**
+     * @brief  Called before the target is validated against a sub-schema
+     *
+     * @param  subschema  sub-schema that is about to be applied
+     * @param  context    context of the target within the document
+     */
+    virtual void enterSubschema(const Subschema &subschema,
+            const std::vector<std::string> &context) = 0;
+
+    /**
+     * @brief  Called after the target has been validated against a sub-schema
+     *
+     * @param  subschema  sub-schema that was applied
+     * @param  context    context of the target within the document
+     * @param  validated  whether the target satisfied the sub-schema
+     */
+    virtual void exitSubschema(const Subschema &subschema,
+            const std::vector<std::string> &context, bool validated) = 0;
+
+    /**
+     * @brief  Called before the target is validated against a constraint
+     *
+     * @param  subschema   sub-schema that owns the constraint
+     * @param  constraint  constraint that is about to be applied
+     * @param  kind        kind of the constraint
+     * @param  context     context of the target within the document
+     */
+    virtual void enterConstraint(const Subschema &subschema,
+            const constraints::Constraint &constraint, constraints::ConstraintKind kind,
+            const std::vector<std::string> &context) = 0;
+
+    /**
+     * @brief  Called after the target has been validated against a constraint
+     *
+     * @param  subschema   sub-schema that owns the constraint
+     * @param  constraint  constraint that was applied
+     * @param  kind        kind of the constraint
+     * @param  context     context of the target within the document
+     * @param  validated   whether the target satisfied the constraint
+     */
+    virtual void exitConstraint(const Subschema &subschema,
+            const constraints::Constraint &constraint, constraints::ConstraintKind kind,
+            const std::vector<std::string> &context, bool validated) = 0;
+
+    /**
+     * @brief  Return a JSON Pointer to the target described by a validation
+     *         context
+     *
+     * The first element of a context is '<root>', and each subsequent element
+     * is a property name or array index enclosed in square brackets.
+     */
+    static std::string documentPath(const std::vector<std::string> &context)
+    {
+        std::string path;
+        for (size_t i = 1; i < context.size(); i++) {
+            const std::string &element = context[i];
+            const std::string token = element.size() >= 2 ? element.substr(1, element.size() - 2) : element;
+            path += '/';
+            for (const char c : token) {
+                if (c == '~') {
+                    path += "~0";
+                } else if (c == '/') {
+                    path += "~1";
+                } else {
+                    path += c;
+                }
+            }
+        }
+
+        return path;
+    }
+
+    /**
+     * @brief  Return a human readable description of a sub-schema
+     *
+     * Sub-schemas created by SchemaParser are described by a URI fragment
+     * containing their path within the schema document (e.g. '#/properties/a').
+     * Other sub-schemas are described by their ID or title, if available.
+     */
+    static std::string describeSubschema(const Subschema &subschema)
+    {
+        if (subschema.hasPath()) {
+            return "#" + subschema.getPath();
+        } else if (subschema.hasId()) {
+            return subschema.getId();
+        } else if (subschema.hasTitle()) {
+            return subschema.getTitle();
+        }
+
+        return "<subschema>";
+    }
+
+    /**
+     * @brief  Return a human readable description of a constraint, consisting
+     *         of the sub-schema description followed by the constraint keyword
+     */
+    static std::string describeConstraint(const Subschema &subschema, constraints::ConstraintKind kind)
+    {
+        const char *keyword = constraints::constraintKeyword(kind);
+        return describeSubschema(subschema) + "/" + (*keyword ? keyword : constraints::constraintKindName(kind));
+    }
+};
+
+}  // namespace valijson
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <valijson/internal/bounded_queue.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validator.hpp>
+
+namespace valijson {
+
+class Subschema;
+
+/**
+ * @brief  Parses and validates a stream of documents using separate groups
+ *         of threads for each stage
+ *
+ * Raw documents are read from a Source on the calling thread, parsed by one
+ * group of threads, validated by another, and then handed to a Sink on the
+ * calling thread, in the order that they were read. Stages are connected by
+ * lock-free bounded queues. No more than a fixed number of documents may be
+ * in the pipeline at once, so the Source is not read again until the Sink
+ * has received enough results to make room. A thread that runs out of work
+ * yields briefly, and then blocks until another stage hands it a document.
+ *
+ * Each validation thread uses its own copy of a prototype Validator, with
+ * its own ValidationScratch object, so the prototype must not have an
+ * observer or instrumentation attached (see ValidatorT::concurrentCopy()).
+ *
+ * Documents are parsed using a function with the same signature as the
+ * loadDocument() functions provided by the utils headers, so those can be
+ * used directly when the Source produces file paths. Otherwise, a function
+ * that parses text held in memory can be used instead.
+ *
+ * @tparam  DocumentType   type of document produced by the parse function;
+ *                         must be default constructible
+ * @tparam  AdapterType    Adapter type used to validate a document
+ * @tparam  ValidatorType  type of Validator used to validate documents
+ */
+template<typename DocumentType, typename AdapterType, typename ValidatorType = Validator>
+class ValidationPipeline
+{
+public:
+
+    /**
+     * @brief  Function that reads the next raw document (or path) into a
+     *         string, and returns false once there are no more documents
+     */
+    typedef std::function<bool (std::string &)> Source;
+
+    /**
+     * @brief  Function that parses a raw document, and returns false if the
+     *         document could not be parsed
+     */
+    typedef std::function<bool (const std::string &, DocumentType &)> Parser;
+
+    /**
+     * @brief  Outcome of parsing and validating a single document
+     */
+    struct Result
+    {
+        Result()
+          : index(0),
+            parsed(false),
+            valid(false) { }
+
+        /// Zero-based position of the document in the stream
+        size_t index;
+
+        /// Whether the document could be parsed
+        bool parsed;
+
+        /// Whether the document was parsed and satisfied the schema
+        bool valid;
+
+        /// Reason why the document could not be validated, if applicable
+        std::string error;
+
+        /// Validation errors reported for the document
+        ValidationResults results;
+    };
+
+    /**
+     * @brief  Function that receives the result for each document
+     */
+    typedef std::function<void (const Result &)> Sink;
+
+    /**
+     * @brief  Construct a pipeline that validates documents against a schema
+     *
+     * The schema is not owned by the pipeline, and must outlive it.
+     *
+     * @param  schema     schema to validate documents against
+     * @param  parser     function used to parse raw documents
+     * @param  prototype  Validator to be copied for each validation thread; it
+     *                    must not have an observer or instrumentation attached
+     */
+    ValidationPipeline(const Subschema &schema, Parser parser,
+            const ValidatorType &prototype = ValidatorType())
+      : m_schema(schema),
+        m_parser(std::move(parser)),
+        m_prototype(prototype.concurrentCopy()),
+        m_parseThreads(1),
+        m_validateThreads(1),
+        m_capacity(64),
+        m_collectResults(true) { }
+
+    /**
+     * @brief  Set the number of threads used to parse documents
+     */
+    void setParseThreads(unsigned int threads)
+    {
+        m_parseThreads = threads > 0 ? threads : 1;
+    }
+
+    /**
+     * @brief  Set the number of threads used to validate documents
+     */
+    void setValidateThreads(unsigned int threads)
+    {
+        m_validateThreads = threads > 0 ? threads : 1;
+    }
+
+    /**
+     * @brief  Set the maximum number of documents that may be in the
+     *         pipeline at once
+     */
+    void setCapacity(size_t capacity)
+    {
+        m_capacity = capacity > 0 ? capacity : 1;
+    }
+
+    /**
+     * @brief  Set whether validation errors are collected for each document,
+     *         or validation stops as soon as a document is found to be invalid
+     */
+    void setCollectResults(bool collectResults)
+    {
+        m_collectResults = collectResults;
+    }
+
+    /**
+     * @brief  Parse and validate each document provided by a Source
+     *
+     * The Source and Sink are only called on the calling thread.
+     *
+     * @param  source  function that provides raw documents
+     * @param  sink    function invoked with the result for each document, in
+     *                 the order that the documents were read
+     *
+     * @returns  true if every document was parsed and validated successfully
+     */
+    bool validate(const Source &source, const Sink &sink)
+    {
+        Queues queues(m_capacity);
+        std::atomic<bool> stopping(false);
+
+        std::vector<std::thread> threads;
+        threads.reserve(m_parseThreads + m_validateThreads);
+        for (unsigned int i = 0; i < m_parseThreads; i++) {
+            threads.emplace_back([this, &queues, &stopping]() {
+                parseWorker(queues, stopping);
+            });
+        }
+        for (unsigned int i = 0; i < m_validateThreads; i++) {
+            threads.emplace_back([this, &queues, &stopping]() {
+                validateWorker(queues, stopping);
+            });
+        }
+
+        bool valid = true;
+#if VALIJSON_USE_EXCEPTIONS
+        try {
+#endif
+            valid = run(queues, source, sink);
+#if VALIJSON_USE_EXCEPTIONS
+        } catch (...) {
+            stop(queues, threads, stopping);
+            throw;
+        }
+#endif
+
+        stop(queues, threads, stopping);
+
+        return valid;
+    }
+
+private:
+
+    /**
+     * @brief  A document as it moves through the pipeline
+     */
+    struct Item
+    {
+        /// Raw document, released once it has been parsed
+        std::string input;
+
+        /// Parsed document, released once it has been validated
+        DocumentType document;
+
+        /// Result to be passed to the Sink
+        Result result;
+    };
+
+    typedef std::unique_ptr<Item> ItemPtr;
+
+    /**
+     * @brief  Queue that connects two stages of the pipeline, along with the
+     *         means for a consumer to wait until it is not empty
+     *
+     * A consumer that finds the queue empty yields for a short while, then
+     * blocks on a condition variable. Each push increments an epoch under a
+     * mutex before waking a consumer, and a consumer reads the epoch before
+     * checking the queue for the last time, so a push is never missed.
+     */
+    class Channel
+    {
+    public:
+        explicit Channel(size_t capacity)
+          : m_queue(capacity),
+            m_epoch(0) { }
+
+        /**
+         * @brief  Push an item, retrying if the queue is momentarily full, and
+         *         wake a consumer
+         */
+        void push(ItemPtr &item)
+        {
+            while (!m_queue.tryPush(item)) {
+                std::this_thread::yield();
+            }
+
+            notify(false);
+        }
+
+        /**
+         * @brief  Pop an item, waiting until one is available
+         *
+         * @returns  false if the pipeline is stopping
+         */
+        bool pop(ItemPtr &item, const std::atomic<bool> &stopping)
+        {
+            for (unsigned int spins = 0; ; spins++) {
+                if (m_queue.tryPop(item)) {
+                    return true;
+                } else if (stopping.load()) {
+                    return false;
+                } else if (spins < kSpins) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                uint64_t epoch;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    epoch = m_epoch;
+                }
+
+                if (m_queue.tryPop(item)) {
+                    return true;
+                } else if (stopping.load()) {
+                    return false;
+                }
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this, epoch]() { return m_epoch != epoch; });
+            }
+        }
+
+        /**
+         * @brief  Pop an item if one is available, without waiting
+         */
+        bool tryPop(ItemPtr &item)
+        {
+            return m_queue.tryPop(item);
+        }
+
+        /**
+         * @brief  Wake one consumer, or all of them so that they can observe
+         *         that the pipeline is stopping
+         */
+        void notify(bool all)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_epoch++;
+            }
+
+            if (all) {
+                m_condition.notify_all();
+            } else {
+                m_condition.notify_one();
+            }
+        }
+
+    private:
+        /// Number of times to yield before blocking
+        static const unsigned int kSpins = 64;
+
+        internal::BoundedQueue<ItemPtr> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint64_t m_epoch;
+    };
+
+    /**
+     * @brief  Channels that connect the stages of the pipeline
+     *
+     * Each queue is large enough to hold every document in the pipeline, so
+     * pushing to a queue never fails while the capacity is respected.
+     */
+    struct Queues
+    {
+        explicit Queues(size_t capacity)
+          : toParse(capacity),
+            toValidate(capacity),
+            completed(capacity) { }
+
+        Channel toParse;
+        Channel toValidate;
+        Channel completed;
+    };
+
+    /**
+     * @brief  Read documents, apply back-pressure, and deliver results in
+     *         order, on the calling thread
+     */
+    bool run(Queues &queues, const Source &source, const Sink &sink)
+    {
+        // Results that have arrived before those for earlier documents
+        std::map<size_t, ItemPtr> pending;
+
+        size_t numRead = 0;
+        size_t numDelivered = 0;
+        bool endOfInput = false;
+        bool valid = true;
+
+        // Worker threads are only stopped after this function returns, so
+        // waiting for a result never has to be abandoned
+        const std::atomic<bool> stopping(false);
+
+        while (!endOfInput || numDelivered < numRead) {
+            ItemPtr item;
+            if (!endOfInput && numRead - numDelivered < m_capacity) {
+                item.reset(new Item());
+                if (source(item->input)) {
+                    item->result.index = numRead++;
+                    queues.toParse.push(item);
+                } else {
+                    endOfInput = true;
+                }
+            } else if (queues.completed.pop(item, stopping)) {
+                // No more documents can be read until a result arrives
+                const size_t index = item->result.index;
+                pending[index] = std::move(item);
+            }
+
+            while (queues.completed.tryPop(item)) {
+                const size_t index = item->result.index;
+                pending[index] = std::move(item);
+            }
+
+            typename std::map<size_t, ItemPtr>::iterator itr = pending.find(numDelivered);
+            while (itr != pending.end()) {
+                valid = valid && itr->second->result.valid;
+                sink(itr->second->result);
+                pending.erase(itr);
+                itr = pending.find(++numDelivered);
+            }
+        }
+
+        return valid;
+    }
+
+    void parseWorker(Queues &queues, const std::atomic<bool> &stopping)
+    {
+        ItemPtr item;
+        while (queues.toParse.pop(item, stopping)) {
+            parseItem(*item);
+            (item->result.parsed ? queues.toValidate : queues.completed).push(item);
+        }
+    }
+
+    void validateWorker(Queues &queues, const std::atomic<bool> &stopping)
+    {
+        // Each thread has its own Validator and scratch storage, which are
+        // reused for every document that it validates
+        ValidationScratch scratch;
+        ValidatorType validator(m_prototype);
+        validator.setScratch(&scratch);
+
+        ItemPtr item;
+        while (queues.toValidate.pop(item, stopping)) {
+            validateItem(*item, validator);
+            queues.completed.push(item);
+        }
+    }
+
+    void parseItem(Item &item) const
+    {
+        Result &result = item.result;
+#if VALIJSON_USE_EXCEPTIONS
+        try {
+#endif
+            result.parsed = m_parser(item.input, item.document);
+            if (!result.parsed) {
+                result.error = "Failed to parse document.";
+            }
+#if VALIJSON_USE_EXCEPTIONS
+        } catch (const std::exception &e) {
+            result.parsed = false;
+            result.error = e.what();
+        } catch (...) {
+            result.parsed = false;
+            result.error = "Failed to parse document.";
+        }
+#endif
+
+        std::string().swap(item.input);
+    }
+
+    void validateItem(Item &item, ValidatorType &validator) const
+    {
+        Result &result = item.result;
+#if VALIJSON_USE_EXCEPTIONS
+        try {
+#endif
+            result.valid = validator.validate(m_schema, AdapterType(item.document),
+                    m_collectResults ? &result.results : nullptr);
+#if VALIJSON_USE_EXCEPTIONS
+        } catch (const std::exception &e) {
+            result.valid = false;
+            result.error = e.what();
+        } catch (...) {
+            result.valid = false;
+            result.error = "Failed to validate document.";
+        }
+#endif
+
+        item.document = DocumentType();
+    }
+
+    static void stop(Queues &queues, std::vector<std::thread> &threads, std::atomic<bool> &stopping)
+    {
+        stopping.store(true);
+        queues.toParse.notify(true);
+        queues.toValidate.notify(true);
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    /// Schema that documents are validated against
+    const Subschema &m_schema;
+
+    /// Function used to parse raw documents
+    const Parser m_parser;
+
+    /// Validator that is copied for each validation thread
+    const ValidatorType m_prototype;
+
+    /// Number of threads used to parse documents
+    unsigned int m_parseThreads;
+
+    /// Number of threads used to validate documents
+    unsigned int m_validateThreads;
+
+    /// Maximum number of documents in the pipeline at once
+    size_t m_capacity;
+
+    /// Whether validation errors are collected
+    bool m_collectResults;
+};
+
+}  // namespace valijson
@@ -1,10 +1,14 @@
 #pragma once
 
-#include <deque>
+#include <cstring>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <valijson/internal/custom_allocator.hpp>
+#include <valijson/memory_resource.hpp>
+
 namespace valijson {
 
 /**
@@ -13,6 +17,13 @@ namespace valijson {
  * This class maintains an internal FIFO queue of errors that are reported
  * during validation. Errors are pushed on to the back of an internal
  * queue, and can retrieved by popping them from the front of the queue.
+ *
+ * The text of each error is packed into storage that is kept when the queue
+ * is cleared or emptied, so a ValidationResults object that is reused for
+ * many validations stops allocating memory once it has grown large enough.
+ * That storage uses the global heap, unless the object is constructed with a
+ * std::pmr::memory_resource to allocate from instead. Copies always use the
+ * global heap.
  */
 class ValidationResults
 {
@@ -33,20 +44,177 @@ public:
         std::string description;
     };
 
+    /**
+     * @brief  Iterator over the errors in the queue
+     *
+     * Errors are stored in packed form, so dereferencing an iterator returns
+     * a copy of an error rather than a reference to one.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Error value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Error reference;
+
+        /// Holds the copy of an error that operator-> returns a pointer to
+        class pointer
+        {
+        public:
+            explicit pointer(Error error)
+              : m_error(std::move(error)) { }
+
+            const Error * operator->() const
+            {
+                return &m_error;
+            }
+
+        private:
+            const Error m_error;
+        };
+
+        const_iterator(const ValidationResults *results, size_t index)
+          : m_results(results),
+            m_index(index) { }
+
+        reference operator*() const
+        {
+            Error error;
+            m_results->copyError(m_index, error);
+            return error;
+        }
+
+        pointer operator->() const
+        {
+            return pointer(**this);
+        }
+
+        const_iterator & operator++()
+        {
+            m_index++;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator previous(*this);
+            m_index++;
+            return previous;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return m_results == other.m_results && m_index == other.m_index;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const ValidationResults *m_results;
+        size_t m_index;
+    };
+
+    /**
+     * @brief  Construct an empty ValidationResults object that allocates from
+     *         the global heap
+     */
+    ValidationResults()
+      : ValidationResults(internal::heapAllocationFunctions()) { }
+
+    /**
+     * @brief  Construct an empty ValidationResults object that allocates
+     *         using the given functions
+     */
+    explicit ValidationResults(const internal::AllocationFunctions &functions)
+      : m_text(internal::CustomAllocator<char>(functions)),
+        m_elements(internal::CustomAllocator<Span>(functions)),
+        m_records(internal::CustomAllocator<Record>(functions)),
+        m_first(0) { }
+
+#if VALIJSON_HAS_MEMORY_RESOURCE
+    /**
+     * @brief  Construct an empty ValidationResults object that allocates from
+     *         a memory resource, which must outlive it
+     */
+    explicit ValidationResults(std::pmr::memory_resource *resource)
+      : ValidationResults(internal::memoryResourceFunctions(resource)) { }
+#endif
+
+    ValidationResults(const ValidationResults &other)
+      : ValidationResults()
+    {
+        *this = other;
+    }
+
+    ValidationResults(ValidationResults &&other)
+      : m_text(std::move(other.m_text)),
+        m_elements(std::move(other.m_elements)),
+        m_records(std::move(other.m_records)),
+        m_first(other.m_first)
+    {
+        other.clear();
+    }
+
+    ValidationResults & operator=(const ValidationResults &other)
+    {
+        if (this != &other) {
+            m_text = other.m_text;
+            m_elements = other.m_elements;
+            m_records = other.m_records;
+            m_first = other.m_first;
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief  Take the errors of another ValidationResults object
+     *
+     * Storage is only taken as well if both objects allocate in the same way;
+     * otherwise the errors are copied into storage allocated by this object.
+     */
+    ValidationResults & operator=(ValidationResults &&other)
+    {
+        if (this != &other) {
+            m_text = std::move(other.m_text);
+            m_elements = std::move(other.m_elements);
+            m_records = std::move(other.m_records);
+            m_first = other.m_first;
+            other.clear();
+        }
+
+        return *this;
+    }
+
     /**
      * @brief  Return begin iterator for results in the queue.
      */
-    std::deque<Error>::const_iterator begin() const
+    const_iterator begin() const
     {
-        return m_errors.begin();
+        return const_iterator(this, m_first);
     }
 
     /**
      * @brief  Return end iterator for results in the queue.
      */
-    std::deque<Error>::const_iterator end() const
+    const_iterator end() const
+    {
+        return const_iterator(this, m_records.size());
+    }
+
+    /**
+     * @brief  Remove all errors from the queue, keeping storage for reuse
+     */
+    void clear()
     {
-        return m_errors.end();
+        m_text.clear();
+        m_elements.clear();
+        m_records.clear();
+        m_first = 0;
     }
 
     /**
@@ -54,7 +222,7 @@ public:
      */
     size_t numErrors() const
     {
-        return m_errors.size();
+        return m_records.size() - m_first;
     }
 
     /**
@@ -64,7 +232,7 @@ public:
      */
     void pushError(const Error &error)
     {
-        m_errors.push_back(error);
+        pushError(error.context, error.description);
     }
 
     /**
@@ -76,7 +244,60 @@ public:
     void
     pushError(const std::vector<std::string> &context, const std::string &description)
     {
-        m_errors.push_back({context, description});
+        pushError(context, description.data(), description.size());
+    }
+
+    /**
+     * @brief  Push an error with a null-terminated description onto the back
+     *         of the queue, without first copying it into a std::string
+     */
+    void
+    pushError(const std::vector<std::string> &context, const char *description)
+    {
+        pushError(context, description, std::strlen(description));
+    }
+
+    /**
+     * @brief  Push an error onto the back of the queue.
+     *
+     * @param  context      Context of the validation error.
+     * @param  description  Pointer to the characters of the description.
+     * @param  length       Length of the description.
+     */
+    void
+    pushError(const std::vector<std::string> &context, const char *description, size_t length)
+    {
+        const size_t firstElement = m_elements.size();
+        for (const std::string &element : context) {
+            m_elements.push_back(appendText(element.data(), element.size()));
+        }
+
+        m_records.push_back(Record{firstElement, context.size(), appendText(description, length)});
+    }
+
+    /**
+     * @brief  Move all of the errors from another ValidationResults object to
+     *         the back of this queue, leaving the other object empty
+     *
+     * This is equivalent to popping each error from \c other and pushing it on
+     * to this queue, without copying each one into an Error object.
+     */
+    void appendErrors(ValidationResults &other)
+    {
+        const size_t textOffset = m_text.size();
+        const size_t elementOffset = m_elements.size();
+        m_text.insert(m_text.end(), other.m_text.begin(), other.m_text.end());
+        for (const Span &element : other.m_elements) {
+            m_elements.push_back(Span{element.offset + textOffset, element.length});
+        }
+
+        for (size_t index = other.m_first; index < other.m_records.size(); index++) {
+            const Record &record = other.m_records[index];
+            m_records.push_back(Record{record.firstElement + elementOffset, record.numElements,
+                    Span{record.description.offset + textOffset, record.description.length}});
+        }
+
+        other.clear();
     }
 
     /**
@@ -89,19 +310,71 @@ public:
     bool
     popError(Error &error)
     {
-        if (m_errors.empty()) {
+        if (m_first == m_records.size()) {
             return false;
         }
 
-        error = m_errors.front();
-        m_errors.pop_front();
+        copyError(m_first++, error);
+        if (m_first == m_records.size()) {
+            clear();
+        }
+
         return true;
     }
 
 private:
 
-    /// FIFO queue of validation errors that have been reported
-    std::deque<Error> m_errors;
+    /// Location of a string in m_text
+    struct Span
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    /// Location of the context elements and description of an error
+    struct Record
+    {
+        size_t firstElement;
+        size_t numElements;
+        Span description;
+    };
+
+    /**
+     * @brief  Append characters to m_text, returning their location
+     */
+    Span appendText(const char *text, size_t length)
+    {
+        const Span span{m_text.size(), length};
+        m_text.insert(m_text.end(), text, text + length);
+        return span;
+    }
+
+    /**
+     * @brief  Copy the error at an index in m_records into an Error object
+     */
+    void copyError(size_t index, Error &error) const
+    {
+        const Record &record = m_records[index];
+        error.context.resize(record.numElements);
+        for (size_t i = 0; i < record.numElements; i++) {
+            const Span &element = m_elements[record.firstElement + i];
+            error.context[i].assign(m_text.data() + element.offset, element.length);
+        }
+
+        error.description.assign(m_text.data() + record.description.offset, record.description.length);
+    }
+
+    /// Characters of the context elements and descriptions of all errors
+    std::vector<char, internal::CustomAllocator<char>> m_text;
+
+    /// Context elements of all errors, in order
+    std::vector<Span, internal::CustomAllocator<Span>> m_elements;
+
+    /// Errors that have been reported, including those already popped
+    std::vector<Record, internal::CustomAllocator<Record>> m_records;
+
+    /// Index of the error at the front of the queue
+    size_t m_first;
 };
 
 } // namespace valijson
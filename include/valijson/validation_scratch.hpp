@@ -0,0 +1,257 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valijson/internal/custom_allocator.hpp>
+#include <valijson/memory_resource.hpp>
+#include <valijson/validation_results.hpp>
+
+namespace valijson {
+
+/**
+ * @brief  Storage that is reused by successive validations on one thread
+ *
+ * Validation builds a context for each array item and object member that it
+ * visits, creates temporary ValidationResults for 'anyOf', 'oneOf' and
+ * conditional constraints, and compiles the regular expressions used by
+ * 'patternProperties' constraints. When a ValidationScratch object is
+ * attached to a Validator, these are kept between calls to validate(), so
+ * that validating small documents does not require repeated allocations.
+ *
+ * Contexts are built in one buffer per depth, and temporary results are
+ * taken from a stack, so storage is only ever used by one visitor at a time.
+ * A ValidationScratch object must not be used by more than one validation
+ * at once.
+ *
+ * A ValidationScratch object may be constructed with a
+ * std::pmr::memory_resource, in which case the temporary results, and the
+ * other containers that the validator creates while it is using this object,
+ * allocate from that resource instead of the global heap. Parallel tasks
+ * still use the global heap, since the resource need not be thread-safe.
+ */
+class ValidationScratch
+{
+public:
+    /// String that is allocated using the functions of a ValidationScratch
+    typedef std::basic_string<char, std::char_traits<char>, internal::CustomAllocator<char>> String;
+
+    /**
+     * @brief  Construct a ValidationScratch object that allocates from the
+     *         global heap
+     */
+    ValidationScratch()
+      : ValidationScratch(internal::heapAllocationFunctions()) { }
+
+    /**
+     * @brief  Construct a ValidationScratch object that allocates using the
+     *         given functions
+     */
+    explicit ValidationScratch(const internal::AllocationFunctions &functions)
+      : m_functions(functions),
+        m_contexts(internal::CustomAllocator<std::vector<std::string>>(functions)),
+        m_results(internal::CustomAllocator<ValidationResults>(functions)),
+        m_resultsInUse(0),
+        m_description(internal::CustomAllocator<char>(functions)) { }
+
+#if VALIJSON_HAS_MEMORY_RESOURCE
+    /**
+     * @brief  Construct a ValidationScratch object that allocates from a
+     *         memory resource, which must outlive it
+     */
+    explicit ValidationScratch(std::pmr::memory_resource *resource)
+      : ValidationScratch(internal::memoryResourceFunctions(resource)) { }
+#endif
+
+    ValidationScratch(const ValidationScratch &) = delete;
+    ValidationScratch & operator=(const ValidationScratch &) = delete;
+
+    /**
+     * @brief  Return the buffer used to hold contexts with a given number of
+     *         elements
+     *
+     * A buffer remains valid until the ValidationScratch object is cleared or
+     * destroyed, and may be overwritten by the next visitor at the same depth.
+     */
+    std::vector<std::string> & contextBuffer(size_t length)
+    {
+        while (m_contexts.size() <= length) {
+            m_contexts.emplace_back();
+        }
+
+        return m_contexts[length];
+    }
+
+    /**
+     * @brief  Return the buffer that error descriptions are built in before
+     *         they are copied into a ValidationResults object
+     */
+    String & descriptionBuffer()
+    {
+        return m_description;
+    }
+
+    /**
+     * @brief  Return the buffer that object member names and patterns are
+     *         copied into, so that they can be looked up using std::string
+     */
+    std::string & keyBuffer()
+    {
+        return m_key;
+    }
+
+    /**
+     * @brief  Return the functions used to allocate storage for temporary
+     *         results, and for the other temporary containers used during
+     *         validation
+     */
+    const internal::AllocationFunctions & allocationFunctions() const
+    {
+        return m_functions;
+    }
+
+    /**
+     * @brief  Take an empty ValidationResults object from the top of the stack
+     *
+     * Each call must be matched by a call to releaseResults(), in reverse
+     * order, as is done by ResultsLease.
+     */
+    ValidationResults & acquireResults()
+    {
+        if (m_resultsInUse == m_results.size()) {
+            m_results.emplace_back(m_functions);
+        }
+
+        ValidationResults &results = m_results[m_resultsInUse++];
+        results.clear();
+        return results;
+    }
+
+    /**
+     * @brief  Return the most recently acquired ValidationResults object
+     */
+    void releaseResults()
+    {
+        m_resultsInUse--;
+    }
+
+    /**
+     * @brief  Return a previously compiled regular expression, or nullptr if
+     *         the pattern has not been compiled yet
+     */
+    const std::regex * findRegex(const std::string &pattern) const
+    {
+        const std::unordered_map<std::string, std::regex>::const_iterator itr = m_regexes.find(pattern);
+        return itr == m_regexes.end() ? nullptr : &itr->second;
+    }
+
+    /**
+     * @brief  Store a compiled regular expression for later calls to
+     *         findRegex()
+     */
+    const std::regex & addRegex(const std::string &pattern, std::regex regex)
+    {
+        return m_regexes.emplace(pattern, std::move(regex)).first->second;
+    }
+
+    /**
+     * @brief  Move the compiled regular expressions from another object into
+     *         this one, keeping any that are already here
+     */
+    void mergeRegexes(ValidationScratch &other)
+    {
+        for (std::pair<const std::string, std::regex> &entry : other.m_regexes) {
+            m_regexes.emplace(entry.first, std::move(entry.second));
+        }
+        other.m_regexes.clear();
+    }
+
+    /**
+     * @brief  Release all storage
+     *
+     * Must not be called while a validation is using this object.
+     */
+    void clear()
+    {
+        m_contexts.clear();
+        m_results.clear();
+        m_regexes.clear();
+        m_description = String(internal::CustomAllocator<char>(m_functions));
+        m_key = std::string();
+    }
+
+    /**
+     * @brief  Temporary ValidationResults object that is taken from a
+     *         ValidationScratch object when one is available
+     */
+    class ResultsLease
+    {
+    public:
+        /**
+         * @param  scratch  optional pointer to a ValidationScratch object
+         * @param  needed   whether results are needed at all; if not, get()
+         *                  returns nullptr
+         */
+        ResultsLease(ValidationScratch *scratch, bool needed)
+          : m_scratch(needed ? scratch : nullptr),
+            m_results(nullptr)
+        {
+            if (m_scratch) {
+                m_results = &m_scratch->acquireResults();
+            } else if (needed) {
+                m_local.reset(new ValidationResults());
+                m_results = m_local.get();
+            }
+        }
+
+        ~ResultsLease()
+        {
+            if (m_scratch) {
+                m_scratch->releaseResults();
+            }
+        }
+
+        ResultsLease(const ResultsLease &) = delete;
+        ResultsLease & operator=(const ResultsLease &) = delete;
+
+        ValidationResults * get() const
+        {
+            return m_results;
+        }
+
+    private:
+        ValidationScratch * const m_scratch;
+        ValidationResults *m_results;
+        std::unique_ptr<ValidationResults> m_local;
+    };
+
+private:
+
+    /// Functions used to allocate temporary results and containers
+    const internal::AllocationFunctions m_functions;
+
+    /// Context buffers, indexed by the number of elements in the context
+    std::deque<std::vector<std::string>, internal::CustomAllocator<std::vector<std::string>>> m_contexts;
+
+    /// Stack of temporary results objects
+    std::deque<ValidationResults, internal::CustomAllocator<ValidationResults>> m_results;
+
+    /// Number of temporary results objects currently in use
+    size_t m_resultsInUse;
+
+    /// Buffer for building error descriptions
+    String m_description;
+
+    /// Buffer for object member names and patterns that are looked up
+    std::string m_key;
+
+    /// Compiled regular expressions for 'patternProperties' constraints
+    std::unordered_map<std::string, std::regex> m_regexes;
+};
+
+}  // namespace valijson
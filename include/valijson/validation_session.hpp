@@ -0,0 +1,143 @@
+#pragma once
+
+#include <valijson/internal/custom_allocator.hpp>
+#include <valijson/memory_resource.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validator.hpp>
+
+namespace valijson {
+
+class Subschema;
+
+/**
+ * @brief  Validator that keeps its working storage between validations
+ *
+ * A ValidationSession owns a Validator, the ValidationResults that errors are
+ * reported to, and a ValidationScratch object holding context buffers,
+ * temporary results and compiled regular expressions. Each call to validate()
+ * resets the results and reuses this storage, so that validating many small
+ * documents on the same thread does not require repeated allocations.
+ *
+ * A ValidationSession may be given a std::pmr::memory_resource, such as a
+ * std::pmr::unsynchronized_pool_resource owned by the same thread. Its
+ * results and scratch storage, and the temporary containers used while
+ * validating, then allocate from that resource rather than the global heap:
+ *
+ *     std::pmr::unsynchronized_pool_resource pool;
+ *     ValidationSession session(&pool);
+ *     session.validate(schema, targetAdapter);
+ *
+ * A ValidationSession is not thread-safe. Each thread should have its own.
+ *
+ * @tparam  RegexEngine  regular expression engine used by the Validator
+ * @tparam  Policy       type checking policy used by the Validator
+ */
+template<typename RegexEngine, TypeCheckingPolicy Policy = kRuntimeTypeChecking>
+class ValidationSessionT
+{
+public:
+    typedef ValidatorT<RegexEngine, Policy> ValidatorType;
+
+    /**
+     * @brief  Construct a ValidationSession
+     *
+     * @param  prototype       Validator to be copied to perform validation
+     * @param  collectResults  whether errors should be collected, or validation
+     *                         should stop as soon as the target is invalid
+     */
+    explicit ValidationSessionT(const ValidatorType &prototype = ValidatorType(), bool collectResults = true)
+      : ValidationSessionT(internal::heapAllocationFunctions(), prototype, collectResults) { }
+
+#if VALIJSON_HAS_MEMORY_RESOURCE
+    /**
+     * @brief  Construct a ValidationSession that allocates from a memory
+     *         resource
+     *
+     * @param  resource        memory resource, which must outlive the session
+     * @param  prototype       Validator to be copied to perform validation
+     * @param  collectResults  whether errors should be collected, or validation
+     *                         should stop as soon as the target is invalid
+     */
+    explicit ValidationSessionT(std::pmr::memory_resource *resource,
+            const ValidatorType &prototype = ValidatorType(), bool collectResults = true)
+      : ValidationSessionT(internal::memoryResourceFunctions(resource), prototype, collectResults) { }
+#endif
+
+    ValidationSessionT(const ValidationSessionT &) = delete;
+    ValidationSessionT & operator=(const ValidationSessionT &) = delete;
+
+    /**
+     * @brief  Validate a document, replacing the results of any previous
+     *         validation
+     *
+     * @param  schema  schema to validate against
+     * @param  target  adapter for the document to be validated
+     * @param  stats   optional pointer to a ValidationStats object to populate;
+     *                 see ValidatorT::validate()
+     *
+     * @returns  true if validation succeeds, false otherwise
+     */
+    template<typename AdapterType>
+    bool validate(const Subschema &schema, const AdapterType &target, ValidationStats *stats = nullptr)
+    {
+        reset();
+        return m_validator.validate(schema, target, m_collectResults ? &m_results : nullptr, stats);
+    }
+
+    /**
+     * @brief  Return the errors reported by the most recent validation
+     */
+    const ValidationResults & results() const
+    {
+        return m_results;
+    }
+
+    /**
+     * @brief  Discard the errors reported by the most recent validation,
+     *         keeping storage for reuse
+     */
+    void reset()
+    {
+        m_results.clear();
+    }
+
+    /**
+     * @brief  Release the storage that has been kept for reuse
+     */
+    void releaseMemory()
+    {
+        m_results = ValidationResults(m_scratch.allocationFunctions());
+        m_scratch.clear();
+    }
+
+    /**
+     * @brief  Return the Validator used by this session, so that an observer,
+     *         metrics and so on can be attached
+     */
+    ValidatorType & validator()
+    {
+        return m_validator;
+    }
+
+private:
+    ValidationSessionT(const internal::AllocationFunctions &functions, const ValidatorType &prototype,
+            bool collectResults)
+      : m_validator(prototype),
+        m_scratch(functions),
+        m_results(functions),
+        m_collectResults(collectResults)
+    {
+        m_validator.setScratch(&m_scratch);
+    }
+
+    ValidatorType m_validator;
+    ValidationScratch m_scratch;
+    ValidationResults m_results;
+    const bool m_collectResults;
+};
+
+using ValidationSession = ValidationSessionT<DefaultRegexEngine>;
+
+}  // namespace valijson
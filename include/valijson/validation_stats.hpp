@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <valijson/constraints/constraint_kind.hpp>
+
+namespace valijson {
+
+namespace internal {
+class ValidationDepthTracker;
+}
+
+/**
+ * @brief  Counters describing the amount of work performed by a validation
+ *
+ * A ValidationStats object can be passed to Validator::validate(), which will
+ * reset it and then populate it as validation proceeds. Counters from several
+ * validations can be combined using the add() function.
+ *
+ * These counters are cheap enough to collect on every call, and are intended
+ * to help identify schemas or documents that are disproportionately expensive
+ * to validate. They are only collected when VALIJSON_USE_INSTRUMENTATION is
+ * enabled (the default); when it is defined to 0, passing a ValidationStats
+ * object to Validator::validate() is a logic error.
+ */
+class ValidationStats
+{
+public:
+    ValidationStats()
+    {
+        reset();
+    }
+
+    /**
+     * @brief  Reset all counters to zero
+     */
+    void reset()
+    {
+        nodesVisited = 0;
+        subschemasEntered = 0;
+        std::fill(constraintsEvaluated, constraintsEvaluated + constraints::kNumConstraintKinds, 0);
+        regexInvocations = 0;
+        regexCacheHits = 0;
+        regexCacheMisses = 0;
+        valueComparisons = 0;
+        peakDepth = 0;
+        m_depth = 0;
+    }
+
+    /**
+     * @brief  Add the counters from another ValidationStats object to this one
+     *
+     * Peak depth is combined by taking the larger of the two values.
+     */
+    void add(const ValidationStats &other)
+    {
+        nodesVisited += other.nodesVisited;
+        subschemasEntered += other.subschemasEntered;
+        for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+            constraintsEvaluated[i] += other.constraintsEvaluated[i];
+        }
+        regexInvocations += other.regexInvocations;
+        regexCacheHits += other.regexCacheHits;
+        regexCacheMisses += other.regexCacheMisses;
+        valueComparisons += other.valueComparisons;
+        peakDepth = std::max(peakDepth, other.peakDepth);
+    }
+
+    /**
+     * @brief  Return the total number of constraints evaluated, of all kinds
+     */
+    uint64_t totalConstraintsEvaluated() const
+    {
+        uint64_t total = 0;
+        for (size_t i = 0; i < constraints::kNumConstraintKinds; i++) {
+            total += constraintsEvaluated[i];
+        }
+
+        return total;
+    }
+
+    /// Number of document values that were validated, including the root
+    uint64_t nodesVisited;
+
+    /// Number of times a value was validated against a sub-schema
+    uint64_t subschemasEntered;
+
+    /// Number of constraints evaluated, indexed by constraints::ConstraintKind
+    uint64_t constraintsEvaluated[constraints::kNumConstraintKinds];
+
+    /// Number of regular expression searches performed
+    uint64_t regexInvocations;
+
+    /// Number of times a compiled regular expression was found in the cache
+    uint64_t regexCacheHits;
+
+    /// Number of times a regular expression had to be compiled
+    uint64_t regexCacheMisses;
+
+    /// Number of times two values were compared for equality by 'const',
+    /// 'enum' and 'uniqueItems' constraints
+    uint64_t valueComparisons;
+
+    /// Deepest nesting of sub-schemas reached during validation
+    uint64_t peakDepth;
+
+private:
+    friend class internal::ValidationDepthTracker;
+
+    /// Current nesting of sub-schemas
+    uint64_t m_depth;
+};
+
+namespace internal {
+
+/**
+ * @brief  Tracks the current nesting of sub-schemas in a ValidationStats
+ *         object, on behalf of ValidationVisitor
+ */
+class ValidationDepthTracker
+{
+public:
+    /**
+     * @brief  Record entry to a sub-schema, updating the peak depth
+     *
+     * @returns  true if this is the outermost sub-schema
+     */
+    static bool enter(ValidationStats &stats)
+    {
+        const bool outermost = stats.m_depth == 0;
+        stats.m_depth++;
+        stats.peakDepth = std::max(stats.peakDepth, stats.m_depth);
+        return outermost;
+    }
+
+    /// Record exit from a sub-schema
+    static void exit(ValidationStats &stats)
+    {
+        stats.m_depth--;
+    }
+
+    /// Continue from the current depth of another ValidationStats object,
+    /// e.g. when part of a validation is performed by another thread
+    static void inherit(ValidationStats &stats, const ValidationStats &parent)
+    {
+        stats.m_depth = parent.m_depth;
+    }
+
+    /// Return the current depth
+    static uint64_t depth(const ValidationStats &stats)
+    {
+        return stats.m_depth;
+    }
+};
+
+}  // namespace internal
+
+}  // namespace valijson
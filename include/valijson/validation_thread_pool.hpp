@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace valijson {
+
+/**
+ * @brief  Pool of worker threads used to validate large arrays and objects in
+ *         parallel
+ *
+ * A ValidationThreadPool is attached to one or more Validator instances via
+ * Validator::setThreadPool(). When an array or object that is large enough is
+ * encountered during validation, its items are divided into tasks, and the
+ * tasks are run by the pool.
+ *
+ * Each worker thread has its own queue of tasks. Tasks created by a worker are
+ * pushed on to the back of its own queue, and the worker takes tasks from the
+ * back of that queue first, so that nested arrays tend to be validated by the
+ * thread that found them. A worker with an empty queue steals tasks from the
+ * front of the other queues. The thread that calls parallelFor() also runs
+ * tasks until all of its tasks are complete, so a pool can be shared by any
+ * number of threads, and parallel loops may be nested.
+ */
+class ValidationThreadPool
+{
+public:
+    /**
+     * @brief  Construct a pool and start its worker threads
+     *
+     * @param  numThreads  number of worker threads; the threads that call
+     *                     parallelFor() are not included in this count
+     */
+    explicit ValidationThreadPool(size_t numThreads = defaultNumThreads())
+      : m_pending(0),
+        m_stopping(false),
+        m_nextQueue(0)
+    {
+        for (size_t i = 0; i < numThreads; i++) {
+            m_queues.emplace_back(new Queue());
+        }
+
+        m_threads.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; i++) {
+            m_threads.emplace_back(&ValidationThreadPool::workerMain, this, i);
+        }
+    }
+
+    /**
+     * @brief  Stop the worker threads, after any queued tasks have been run
+     */
+    ~ValidationThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_wake.notify_all();
+        for (std::thread &thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    ValidationThreadPool(const ValidationThreadPool &) = delete;
+    ValidationThreadPool & operator=(const ValidationThreadPool &) = delete;
+
+    /**
+     * @brief  Return the default number of worker threads, which is one less
+     *         than the number of hardware threads
+     */
+    static size_t defaultNumThreads()
+    {
+        const unsigned int n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 0;
+    }
+
+    /**
+     * @brief  Return the number of worker threads in the pool
+     */
+    size_t numThreads() const
+    {
+        return m_threads.size();
+    }
+
+    /**
+     * @brief  Call a function once for each index in [0, numTasks), and return
+     *         once all of the calls are complete
+     *
+     * Calls may be made concurrently, in any order, from any of the worker
+     * threads or the calling thread. If a call throws an exception, the
+     * remaining calls are still made, and the first exception is rethrown
+     * once they are complete.
+     *
+     * @param  numTasks  number of calls to make
+     * @param  task      function to call with each index
+     */
+    void parallelFor(size_t numTasks, const std::function<void(size_t)> &task)
+    {
+        if (numTasks == 0) {
+            return;
+        }
+
+        if (m_queues.empty() || numTasks == 1) {
+            for (size_t i = 0; i < numTasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        Loop loop(task, numTasks);
+
+        // Workers keep nested tasks to themselves until they are stolen, while
+        // tasks from other threads are spread across all of the queues
+        const size_t worker = currentWorker();
+        m_pending.fetch_add(numTasks);
+        for (size_t i = 0; i < numTasks; i++) {
+            const size_t q = worker < m_queues.size() ? worker :
+                    m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+            std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+            m_queues[q]->tasks.push_back(Task(&loop, i));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_wake.notify_all();
+
+        // Help with any queued tasks while waiting. Tasks belonging to other
+        // loops are run as well, since they may be blocking this one.
+        while (loop.remaining.load() > 0) {
+            Task t;
+            if (acquire(worker, t)) {
+                run(t);
+            } else {
+                std::unique_lock<std::mutex> lock(loop.mutex);
+                loop.done.wait_for(lock, std::chrono::milliseconds(1), [&loop]() {
+                    return loop.remaining.load() == 0;
+                });
+            }
+        }
+
+        // Wait for the last task to release the mutex before destroying it
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (loop.exception) {
+            std::rethrow_exception(loop.exception);
+        }
+    }
+
+private:
+
+    /**
+     * @brief  State shared by the tasks created by a call to parallelFor()
+     */
+    struct Loop
+    {
+        Loop(const std::function<void(size_t)> &fn, size_t numTasks)
+          : task(fn),
+            remaining(numTasks) { }
+
+        const std::function<void(size_t)> &task;
+        std::atomic<size_t> remaining;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    /// A single call to be made on behalf of a Loop
+    struct Task
+    {
+        Task()
+          : loop(nullptr),
+            index(0) { }
+
+        Task(Loop *taskLoop, size_t taskIndex)
+          : loop(taskLoop),
+            index(taskIndex) { }
+
+        Loop *loop;
+        size_t index;
+    };
+
+    /// Queue of tasks owned by a worker thread
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * @brief  Return a reference to the index of the worker that the calling
+     *         thread belongs to, if any
+     */
+    static size_t & workerIndex()
+    {
+        static thread_local size_t index = static_cast<size_t>(-1);
+        return index;
+    }
+
+    /**
+     * @brief  Return a reference to the pool that the calling thread belongs
+     *         to, if any
+     */
+    static const ValidationThreadPool * & workerPool()
+    {
+        static thread_local const ValidationThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    /**
+     * @brief  Return the index of the calling thread in this pool, or a value
+     *         that is not a valid index if it does not belong to this pool
+     */
+    size_t currentWorker() const
+    {
+        return workerPool() == this ? workerIndex() : static_cast<size_t>(-1);
+    }
+
+    /**
+     * @brief  Take the next task from a worker's own queue, or steal one from
+     *         another queue
+     */
+    bool acquire(size_t worker, Task &t)
+    {
+        if (m_pending.load() == 0) {
+            return false;
+        }
+
+        const size_t numQueues = m_queues.size();
+        if (worker < numQueues) {
+            Queue &own = *m_queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                t = own.tasks.back();
+                own.tasks.pop_back();
+                m_pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        const size_t first = worker < numQueues ? worker + 1 : 0;
+        for (size_t i = 0; i < numQueues; i++) {
+            Queue &victim = *m_queues[(first + i) % numQueues];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                t = victim.tasks.front();
+                victim.tasks.pop_front();
+                m_pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief  Run a task, and wake the thread waiting for its loop if it was
+     *         the last one
+     */
+    static void run(const Task &t)
+    {
+        Loop &loop = *t.loop;
+#if VALIJSON_USE_EXCEPTIONS
+        try {
+            loop.task(t.index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            if (!loop.exception) {
+                loop.exception = std::current_exception();
+            }
+        }
+#else
+        loop.task(t.index);
+#endif
+
+        // The waiting thread may destroy the loop as soon as the count reaches
+        // zero, so the mutex is held while notifying it
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (loop.remaining.fetch_sub(1) == 1) {
+            loop.done.notify_all();
+        }
+    }
+
+    void workerMain(size_t worker)
+    {
+        workerPool() = this;
+        workerIndex() = worker;
+
+        for (;;) {
+            Task t;
+            if (acquire(worker, t)) {
+                run(t);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() {
+                return m_stopping || m_pending.load() > 0;
+            });
+
+            if (m_stopping && m_pending.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    /// Task queues, one per worker thread
+    std::vector<std::unique_ptr<Queue>> m_queues;
+
+    /// Worker threads
+    std::vector<std::thread> m_threads;
+
+    /// Number of tasks that are queued, but have not yet been started
+    std::atomic<size_t> m_pending;
+
+    /// Mutex used with m_wake, to put idle workers to sleep
+    std::mutex m_mutex;
+
+    /// Condition variable used to wake idle workers
+    std::condition_variable m_wake;
+
+    /// Set when the pool is being destroyed
+    bool m_stopping;
+
+    /// Queue that the next task from a non-worker thread will be pushed to
+    std::atomic<size_t> m_nextQueue;
+};
+
+/**
+ * @brief  Settings that control when arrays and objects are validated in
+ *         parallel
+ */
+struct ParallelValidation
+{
+    /// Default minimum number of items for parallel validation
+    enum { kDefaultMinItems = 4096 };
+
+    /// Default minimum number of items in each task
+    enum { kDefaultMinItemsPerTask = 256 };
+
+    ParallelValidation()
+      : pool(nullptr),
+        minItems(kDefaultMinItems),
+        minItemsPerTask(kDefaultMinItemsPerTask) { }
+
+    /**
+     * @brief  Return the number of tasks that a number of items should be
+     *         divided into, or zero if they should be validated serially
+     *
+     * Items are validated serially unless there are at least \c minItems of
+     * them and at least two tasks' worth of \c minItemsPerTask. Otherwise
+     * each task gets at least \c minItemsPerTask items, and there are at
+     * most four tasks for each thread, counting the caller.
+     */
+    size_t numTasks(size_t numItems) const
+    {
+        if (!pool || pool->numThreads() == 0 || numItems < minItems) {
+            return 0;
+        }
+
+        // A few tasks per thread allows for items that vary in cost
+        const size_t maxTasks = (pool->numThreads() + 1) * 4;
+        const size_t n = numItems / std::max<size_t>(minItemsPerTask, 1);
+        return n < 2 ? 0 : std::min(n, maxTasks);
+    }
+
+    /// Pool used to run tasks, or nullptr to always validate serially
+    ValidationThreadPool *pool;
+
+    /// Arrays and objects with fewer items than this are validated serially
+    size_t minItems;
+
+    /// Items are not divided into tasks smaller than this
+    size_t minItemsPerTask;
+};
+
+}  // namespace valijson
@@ -1,17 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <limits>
 #include <string>
 #include <regex>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 
 #include <valijson/adapters/std_string_adapter.hpp>
 #include <valijson/constraints/concrete_constraints.hpp>
 #include <valijson/constraints/constraint_visitor.hpp>
+#include <valijson/instrumentation.hpp>
+#include <valijson/internal/object_member_key.hpp>
+#include <valijson/type_checking_policy.hpp>
+#include <valijson/validation_observer.hpp>
 #include <valijson/validation_results.hpp>
-
-#include <valijson/utils/utf8_utils.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validation_thread_pool.hpp>
 
 #ifdef _MSC_VER
 #pragma warning( push )
@@ -22,13 +32,113 @@ namespace valijson {
 
 class ValidationResults;
 
+/**
+ * @brief  State shared by all of the visitors that take part in validating a
+ *         single document
+ *
+ * Visitors for child values are given a pointer to the same state, rather
+ * than a copy of each field, so that per-validation hooks can be added here
+ * without changing every place that a visitor is created.
+ *
+ * Tasks that validate part of a range in parallel have their own state, and
+ * point back to the state of the visitor that started them. Regexes compiled
+ * by that visitor, or by any of its own parents, are used without being
+ * compiled again.
+ *
+ * @tparam  RegexEngine  Regular expression engine used for pattern constraints.
+ */
+template<typename RegexEngine>
+struct ValidationState
+{
+    explicit ValidationState(std::unordered_map<std::string, RegexEngine> &cache)
+      : regexesCache(cache),
+        instrumentation(nullptr),
+        observer(nullptr),
+        stats(nullptr),
+        parallel(nullptr),
+        cancelled(nullptr),
+        scratch(nullptr),
+        parent(nullptr) { }
+
+    /**
+     * @brief  Return a RegexEngine for a pattern constraint from this state or
+     *         one of its parents, or nullptr if it has not been compiled yet
+     */
+    const RegexEngine * findRegex(const std::string &pattern) const
+    {
+        for (const ValidationState *state = this; state; state = state->parent) {
+            const auto itr = state->regexesCache.find(pattern);
+            if (itr != state->regexesCache.end()) {
+                return &itr->second;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief  Return an allocator for temporary containers, which allocates
+     *         using the functions of the scratch storage, if there is any, or
+     *         from the global heap otherwise
+     */
+    template<typename T>
+    internal::CustomAllocator<T> allocator() const
+    {
+        return internal::CustomAllocator<T>(scratch ? scratch->allocationFunctions() :
+                internal::heapAllocationFunctions());
+    }
+
+    /**
+     * @brief  Return a compiled 'patternProperties' regex from the scratch
+     *         storage of this state or one of its parents, or nullptr
+     */
+    const std::regex * findScratchRegex(const std::string &pattern) const
+    {
+        for (const ValidationState *state = this; state; state = state->parent) {
+            const std::regex *regex = state->scratch ? state->scratch->findRegex(pattern) : nullptr;
+            if (regex) {
+                return regex;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Cache of already created RegexEngine objects for pattern constraints
+    std::unordered_map<std::string, RegexEngine> &regexesCache;
+
+    /// Optional pointer to an Instrumentation object to be populated
+    Instrumentation *instrumentation;
+
+    /// Optional pointer to a ValidationObserver to be notified of progress
+    ValidationObserver *observer;
+
+    /// Optional pointer to a ValidationStats object to be populated
+    ValidationStats *stats;
+
+    /// Optional pointer to settings for parallel validation
+    const ParallelValidation *parallel;
+
+    /// Optional pointer to a flag that is set when validation is cancelled
+    const std::atomic<bool> *cancelled;
+
+    /// Optional pointer to storage that is reused between validations
+    ValidationScratch *scratch;
+
+    /// State of the visitor that started this parallel task, which is only
+    /// read while the task is running; nullptr outside of parallel tasks
+    const ValidationState *parent;
+};
+
 /**
  * @brief   Implementation of the ConstraintVisitor interface that validates a
  *          target document
  *
  * @tparam  AdapterType  Adapter type for the target document.
+ * @tparam  RegexEngine  Regular expression engine used for pattern constraints.
+ * @tparam  Policy       Whether the type checking mode is fixed at compile time.
  */
-template<typename AdapterType, typename RegexEngine>
+template<typename AdapterType, typename RegexEngine, TypeCheckingPolicy Policy = kRuntimeTypeChecking>
 class ValidationVisitor: public constraints::ConstraintVisitor
 {
 public:
@@ -39,24 +149,26 @@ public:
      * @param  target       Target value to be validated
      * @param  context      Current context for validation error descriptions,
      *                      only used if results is set.
-     * @param  strictTypes  Use strict type comparison
+     * @param  strictTypes  Use strict type comparison; ignored if the type
+     *                      checking mode is fixed by the Policy parameter
      * @param  results      Optional pointer to ValidationResults object, for
      *                      recording error descriptions. If this pointer is set
      *                      to nullptr, validation errors will caused validation to
      *                      stop immediately.
-     * @param  regexesCache Cache of already created RegexEngine objects for pattern
-     *                      constraints.
+     * @param  state        State shared by all of the visitors for a single
+     *                      validation, such as the regex cache and optional
+     *                      observers; must outlive the visitor.
      */
     ValidationVisitor(const AdapterType &target,
-                      std::vector<std::string> context,
+                      const std::vector<std::string> &context,
                       const bool strictTypes,
                       ValidationResults *results,
-                      std::unordered_map<std::string, RegexEngine>& regexesCache)
+                      ValidationState<RegexEngine> *state)
       : m_target(target),
-        m_context(std::move(context)),
+        m_context(context),
         m_results(results),
         m_strictTypes(strictTypes),
-        m_regexesCache(regexesCache) { }
+        m_state(state) { }
 
     /**
      * @brief  Validate the target against a schema.
@@ -71,18 +183,33 @@ public:
      *
      * @param   subschema  Sub-schema that the target must validate against
      *
+     * Validation fails immediately if it has been cancelled.
+     *
      * @return  \c true if validation passes; \c false otherwise
      */
     bool validateSchema(const Subschema &subschema)
     {
+        if (isCancelled()) {
+            return false;
+        }
+
+#if VALIJSON_USE_INSTRUMENTATION
+        if (m_state->observer || m_state->stats || (m_state->instrumentation && m_state->instrumentation->isEnabled())) {
+            return validateSchemaInstrumented(subschema);
+        }
+#endif
+
         if (subschema.getAlwaysInvalid()) {
             return false;
         }
 
         // Wrap the validationCallback() function below so that it will be
-        // passed a reference to a constraint (_1), and a reference to the
-        // visitor (*this).
-        Subschema::ApplyFunction fn(std::bind(validationCallback, std::placeholders::_1, std::ref(*this)));
+        // passed a reference to a constraint, and a reference to the visitor.
+        // Only a pointer is captured, so the std::function does not need to
+        // allocate memory.
+        Subschema::ApplyFunction fn([this](const constraints::Constraint &constraint) {
+            return validationCallback(constraint, *this);
+        });
 
         // Perform validation against each constraint defined in the schema
         if (m_results == nullptr) {
@@ -152,18 +279,15 @@ public:
     {
         unsigned int numValidated = 0;
 
-        ValidationResults newResults;
-        ValidationResults *childResults = (m_results) ? &newResults : nullptr;
+        const ValidationScratch::ResultsLease newResults(m_state->scratch, m_results != nullptr);
+        ValidationResults *childResults = newResults.get();
 
-        ValidationVisitor<AdapterType, RegexEngine> v(m_target, m_context, m_strictTypes, childResults, m_regexesCache);
+        ValidationVisitor<AdapterType, RegexEngine, Policy> v(m_target, m_context, strictTypes(), childResults, m_state);
         constraint.applyToSubschemas(
                 ValidateSubschemas(m_target, m_context, false, true, v, childResults, &numValidated, nullptr));
 
         if (numValidated == 0 && m_results) {
-            ValidationResults::Error childError;
-            while (childResults->popError(childError)) {
-                m_results->pushError( childError.context, childError.description);
-            }
+            m_results->appendErrors(*childResults);
             m_results->pushError(m_context, "Failed to validate against any schemas allowed by anyOf constraint.");
         }
 
@@ -183,12 +307,12 @@ public:
      */
     bool visit(const ConditionalConstraint &constraint) override
     {
-        ValidationResults newResults;
-        ValidationResults* conditionalResults = (m_results) ? &newResults : nullptr;
+        const ValidationScratch::ResultsLease newResults(m_state->scratch, m_results != nullptr);
+        ValidationResults* conditionalResults = newResults.get();
 
         // Create a validator to evaluate the conditional
-        ValidationVisitor ifValidator(m_target, m_context, m_strictTypes, nullptr, m_regexesCache);
-        ValidationVisitor thenElseValidator(m_target, m_context, m_strictTypes, conditionalResults, m_regexesCache);
+        ValidationVisitor ifValidator(m_target, m_context, strictTypes(), nullptr, m_state);
+        ValidationVisitor thenElseValidator(m_target, m_context, strictTypes(), conditionalResults, m_state);
 
         bool validated = false;
         if (ifValidator.validateSchema(*constraint.getIfSubschema())) {
@@ -200,10 +324,7 @@ public:
         }
 
         if (!validated && m_results) {
-            ValidationResults::Error conditionalError;
-            while (conditionalResults->popError(conditionalError)) {
-                m_results->pushError(conditionalError.context, conditionalError.description);
-            }
+            m_results->appendErrors(*conditionalResults);
             m_results->pushError(m_context, "Failed to validate against a conditional schema set by if-then-else constraints.");
         }
 
@@ -221,7 +342,8 @@ public:
      */
     bool visit(const ConstConstraint &constraint) override
     {
-        if (!constraint.getValue()->equalTo(m_target, m_strictTypes)) {
+        recordValueComparison(m_state->stats);
+        if (!constraint.getValue()->equalTo(m_target, strictTypes())) {
             if (m_results) {
                 m_results->pushError(m_context, "Failed to match expected value set by 'const' constraint.");
             }
@@ -243,7 +365,7 @@ public:
      */
     bool visit(const ContainsConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isArray()) || !m_target.maybeArray()) {
+        if (!targetIsArray()) {
             return true;
         }
 
@@ -252,7 +374,8 @@ public:
 
         bool validated = false;
         for (const auto &el : arr) {
-            ValidationVisitor containsValidator(el, m_context, m_strictTypes, nullptr, m_regexesCache);
+            recordNodeVisited(m_state->stats);
+            ValidationVisitor containsValidator(el, m_context, strictTypes(), nullptr, m_state);
             if (containsValidator.validateSchema(*subschema)) {
                 validated = true;
                 break;
@@ -290,7 +413,7 @@ public:
     bool visit(const DependenciesConstraint &constraint) override
     {
         // Ignore non-objects
-        if ((m_strictTypes && !m_target.isObject()) || (!m_target.maybeObject())) {
+        if (!targetIsObject()) {
             return true;
         }
 
@@ -303,7 +426,8 @@ public:
         // Iterate over all dependent properties defined by this constraint,
         // invoking the DependentPropertyValidator functor once for each
         // set of dependent properties
-        constraint.applyToPropertyDependencies(ValidatePropertyDependencies(object, m_context, m_results, &validated));
+        constraint.applyToPropertyDependencies(
+                ValidatePropertyDependencies(object, m_context, m_results, &validated, m_state));
         if (!m_results && !validated) {
             return false;
         }
@@ -333,8 +457,13 @@ public:
     bool visit(const EnumConstraint &constraint) override
     {
         unsigned int numValidated = 0;
-        constraint.applyToValues(
-                ValidateEquality(m_target, m_context, false, true, m_strictTypes, nullptr, &numValidated));
+        const ValidateEquality fn(m_target, m_context, false, true, strictTypes(), nullptr, &numValidated, m_state->stats);
+        if (strictTypes()) {
+            // Only values with the same structural hash can be equal
+            constraint.applyToValuesWithHash(m_target.hash(), fn);
+        } else {
+            constraint.applyToValues(fn);
+        }
 
         if (numValidated == 0) {
             if (m_results) {
@@ -371,7 +500,7 @@ public:
         // Reference:
         // https://json-schema.org/understanding-json-schema/reference/string.html#format
         //
-        if (!m_target.maybeString()) {
+        if (!targetIsString()) {
             return true;
         }
 
@@ -443,7 +572,7 @@ public:
     bool visit(const LinearItemsConstraint &constraint) override
     {
         // Ignore values that are not arrays
-        if ((m_strictTypes && !m_target.isArray()) || (!m_target.maybeArray())) {
+        if (!targetIsArray()) {
             return true;
         }
 
@@ -475,8 +604,8 @@ public:
             }
 
             constraint.applyToItemSubschemas(
-                    ValidateItems(arr, m_context, true, m_results != nullptr, m_strictTypes, m_results, &numValidated,
-                            &validated, m_regexesCache));
+                    ValidateItems(arr, m_context, true, m_results != nullptr, strictTypes(), m_results, &numValidated,
+                            &validated, m_state));
 
             if (!m_results && !validated) {
                 return false;
@@ -488,33 +617,34 @@ public:
             if (additionalItemsSubschema) {
                 // Begin validation from the first item not validated against
                 // an sub-schema provided by the 'items' constraint
-                unsigned int index = numValidated;
-                typename AdapterType::Array::const_iterator begin = arr.begin();
+                typedef typename AdapterType::Array::const_iterator ArrayIterator;
+                ArrayIterator begin = arr.begin();
                 begin.advance(numValidated);
-                for (typename AdapterType::Array::const_iterator itr = begin;
-                        itr != arr.end(); ++itr) {
+                const bool additionalItemsValidated = validateRange(begin, arr.end(), arrSize - numValidated,
+                        [additionalItemsSubschema, numValidated](ValidationVisitor &visitor,
+                                const ArrayIterator &itr, size_t offset) -> bool {
+                    const size_t index = numValidated + offset;
+                    if (visitor.validateChild(*itr, index, *additionalItemsSubschema)) {
+                        return true;
+                    }
 
-                    // Update context for current array item
-                    std::vector<std::string> newContext = m_context;
-                    newContext.push_back("[" + std::to_string(index) + "]");
+                    if (visitor.m_results) {
+                        reportError(*visitor.m_results, *visitor.m_state, visitor.m_context, "Failed to validate item #",
+                                index, " against additional items schema.");
+                    }
 
-                    ValidationVisitor<AdapterType, RegexEngine> validator(*itr, newContext, m_strictTypes, m_results, m_regexesCache);
+                    return false;
+                });
 
-                    if (!validator.validateSchema(*additionalItemsSubschema)) {
-                        if (m_results) {
-                            m_results->pushError(m_context, "Failed to validate item #" + std::to_string(index) +
-                                    " against additional items schema.");
-                            validated = false;
-                        } else {
-                            return false;
-                        }
+                if (!additionalItemsValidated) {
+                    if (!m_results) {
+                        return false;
                     }
-
-                    index++;
+                    validated = false;
                 }
 
             } else if (m_results) {
-                m_results->pushError(m_context, "Cannot validate item #" + std::to_string(numValidated) +
+                reportError(*m_results, *m_state, m_context, "Cannot validate item #", numValidated,
                         " or greater using 'items' constraint or 'additionalItems' constraint.");
                 validated = false;
 
@@ -535,7 +665,7 @@ public:
      */
     bool visit(const MaximumConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isNumber()) || !m_target.maybeDouble()) {
+        if (!targetIsNumber()) {
             // Ignore values that are not numbers
             return true;
         }
@@ -545,7 +675,7 @@ public:
         if (constraint.getExclusiveMaximum()) {
             if (m_target.asDouble() >= maximum) {
                 if (m_results) {
-                    m_results->pushError(m_context, "Expected number less than " + std::to_string(maximum));
+                    reportError(*m_results, *m_state, m_context, "Expected number less than ", maximum);
                 }
 
                 return false;
@@ -553,7 +683,7 @@ public:
 
         } else if (m_target.asDouble() > maximum) {
             if (m_results) {
-                m_results->pushError(m_context, "Expected number less than or equal to " + std::to_string(maximum));
+                reportError(*m_results, *m_state, m_context, "Expected number less than or equal to ", maximum);
             }
 
             return false;
@@ -571,7 +701,7 @@ public:
      */
     bool visit(const MaxItemsConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isArray()) || !m_target.maybeArray()) {
+        if (!targetIsArray()) {
             return true;
         }
 
@@ -581,8 +711,7 @@ public:
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "Array should contain no more than " + std::to_string(maxItems) +
-                    " elements.");
+            reportError(*m_results, *m_state, m_context, "Array should contain no more than ", maxItems, " elements.");
         }
 
         return false;
@@ -597,19 +726,18 @@ public:
      */
     bool visit(const MaxLengthConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isString()) || !m_target.maybeString()) {
+        if (!targetIsString()) {
             return true;
         }
 
-        const std::string s = m_target.asString();
-        const uint64_t len = utils::u8_strlen(s.c_str());
+        const uint64_t len = m_target.asStringLength();
         const uint64_t maxLength = constraint.getMaxLength();
         if (len <= maxLength) {
             return true;
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "String should be no more than " + std::to_string(maxLength) +
+            reportError(*m_results, *m_state, m_context, "String should be no more than ", maxLength,
                     " characters in length.");
         }
 
@@ -625,7 +753,7 @@ public:
      */
     bool visit(const MaxPropertiesConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isObject()) || !m_target.maybeObject()) {
+        if (!targetIsObject()) {
             return true;
         }
 
@@ -636,7 +764,7 @@ public:
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "Object should have no more than " + std::to_string(maxProperties) +
+            reportError(*m_results, *m_state, m_context, "Object should have no more than ", maxProperties,
                     " properties.");
         }
 
@@ -652,7 +780,7 @@ public:
      */
     bool visit(const MinimumConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isNumber()) || !m_target.maybeDouble()) {
+        if (!targetIsNumber()) {
             // Ignore values that are not numbers
             return true;
         }
@@ -662,14 +790,14 @@ public:
         if (constraint.getExclusiveMinimum()) {
             if (m_target.asDouble() <= minimum) {
                 if (m_results) {
-                    m_results->pushError(m_context, "Expected number greater than " + std::to_string(minimum));
+                    reportError(*m_results, *m_state, m_context, "Expected number greater than ", minimum);
                 }
 
                 return false;
             }
         } else if (m_target.asDouble() < minimum) {
             if (m_results) {
-                m_results->pushError(m_context, "Expected number greater than or equal to " + std::to_string(minimum));
+                reportError(*m_results, *m_state, m_context, "Expected number greater than or equal to ", minimum);
             }
 
             return false;
@@ -687,7 +815,7 @@ public:
      */
     bool visit(const MinItemsConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isArray()) || !m_target.maybeArray()) {
+        if (!targetIsArray()) {
             return true;
         }
 
@@ -697,8 +825,7 @@ public:
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "Array should contain no fewer than " + std::to_string(minItems) +
-                    " elements.");
+            reportError(*m_results, *m_state, m_context, "Array should contain no fewer than ", minItems, " elements.");
         }
 
         return false;
@@ -713,19 +840,18 @@ public:
      */
     bool visit(const MinLengthConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isString()) || !m_target.maybeString()) {
+        if (!targetIsString()) {
             return true;
         }
 
-        const std::string s = m_target.asString();
-        const uint64_t len = utils::u8_strlen(s.c_str());
+        const uint64_t len = m_target.asStringLength();
         const uint64_t minLength = constraint.getMinLength();
         if (len >= minLength) {
             return true;
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "String should be no fewer than " + std::to_string(minLength) +
+            reportError(*m_results, *m_state, m_context, "String should be no fewer than ", minLength,
                     " characters in length.");
         }
 
@@ -741,7 +867,7 @@ public:
      */
     bool visit(const MinPropertiesConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isObject()) || !m_target.maybeObject()) {
+        if (!targetIsObject()) {
             return true;
         }
 
@@ -752,7 +878,7 @@ public:
         }
 
         if (m_results) {
-            m_results->pushError(m_context, "Object should have no fewer than " + std::to_string(minProperties) +
+            reportError(*m_results, *m_state, m_context, "Object should have no fewer than ", minProperties,
                     " properties.");
         }
 
@@ -771,20 +897,20 @@ public:
         const double divisor = constraint.getDivisor();
 
         double d = 0.;
-        if (m_target.maybeDouble()) {
+        if (targetIsDouble()) {
             if (!m_target.asDouble(d)) {
                 if (m_results) {
-                    m_results->pushError(m_context, "Value could not be converted "
-                            "to a number to check if it is a multiple of " + std::to_string(divisor));
+                    reportError(*m_results, *m_state, m_context, "Value could not be converted "
+                            "to a number to check if it is a multiple of ", divisor);
                 }
                 return false;
             }
-        } else if (m_target.maybeInteger()) {
+        } else if (targetIsInteger()) {
             int64_t i = 0;
             if (!m_target.asInteger(i)) {
                 if (m_results) {
-                    m_results->pushError(m_context, "Value could not be converted "
-                            "to a number to check if it is a multiple of " + std::to_string(divisor));
+                    reportError(*m_results, *m_state, m_context, "Value could not be converted "
+                            "to a number to check if it is a multiple of ", divisor);
                 }
                 return false;
             }
@@ -801,7 +927,7 @@ public:
 
         if (fabs(r) > std::numeric_limits<double>::epsilon()) {
             if (m_results) {
-                m_results->pushError(m_context, "Value should be a multiple of " + std::to_string(divisor));
+                reportError(*m_results, *m_state, m_context, "Value should be a multiple of ", divisor);
             }
             return false;
         }
@@ -821,14 +947,14 @@ public:
         const int64_t divisor = constraint.getDivisor();
 
         int64_t i = 0;
-        if (m_target.maybeInteger()) {
+        if (targetIsInteger()) {
             if (!m_target.asInteger(i)) {
                 if (m_results) {
                     m_results->pushError(m_context, "Value could not be converted to an integer for multipleOf check");
                 }
                 return false;
             }
-        } else if (m_target.maybeDouble()) {
+        } else if (targetIsDouble()) {
             double d;
             if (!m_target.asDouble(d)) {
                 if (m_results) {
@@ -847,7 +973,7 @@ public:
 
         if (i % divisor != 0) {
             if (m_results) {
-                m_results->pushError(m_context, "Value should be a multiple of " + std::to_string(divisor));
+                reportError(*m_results, *m_state, m_context, "Value should be a multiple of ", divisor);
             }
             return false;
         }
@@ -874,7 +1000,7 @@ public:
             return false;
         }
 
-        ValidationVisitor<AdapterType, RegexEngine> v(m_target, m_context, m_strictTypes, nullptr, m_regexesCache);
+        ValidationVisitor<AdapterType, RegexEngine, Policy> v(m_target, m_context, strictTypes(), nullptr, m_state);
         if (v.validateSchema(*subschema)) {
             if (m_results) {
                 m_results->pushError(m_context,
@@ -898,21 +1024,16 @@ public:
     {
         unsigned int numValidated = 0;
 
-        ValidationResults newResults;
-        ValidationResults *childResults = (m_results) ? &newResults : nullptr;
+        const ValidationScratch::ResultsLease newResults(m_state->scratch, m_results != nullptr);
+        ValidationResults *childResults = newResults.get();
 
-        ValidationVisitor<AdapterType, RegexEngine> v(m_target, m_context, m_strictTypes, childResults, m_regexesCache);
+        ValidationVisitor<AdapterType, RegexEngine, Policy> v(m_target, m_context, strictTypes(), childResults, m_state);
         constraint.applyToSubschemas(
                 ValidateSubschemas(m_target, m_context, true, true, v, childResults, &numValidated, nullptr));
 
         if (numValidated == 0) {
             if (m_results) {
-                ValidationResults::Error childError;
-                while (childResults->popError(childError)) {
-                    m_results->pushError(
-                            childError.context,
-                            childError.description);
-                }
+                m_results->appendErrors(*childResults);
                 m_results->pushError(m_context, "Failed to validate against any "
                         "child schemas allowed by oneOf constraint.");
             }
@@ -936,17 +1057,21 @@ public:
      */
     bool visit(const PatternConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isString()) || !m_target.maybeString()) {
+        if (!targetIsString()) {
             return true;
         }
 
-        std::string pattern(constraint.getPattern<std::string::allocator_type>());
-        auto it = m_regexesCache.find(pattern);
-        if (it == m_regexesCache.end()) {
-            it = m_regexesCache.emplace(pattern, RegexEngine(pattern)).first;
+        std::string localPattern;
+        std::string &pattern = m_state->scratch ? m_state->scratch->keyBuffer() : localPattern;
+        constraint.getPattern(pattern);
+        const RegexEngine *regex = m_state->findRegex(pattern);
+        recordRegexLookup(m_state->stats, regex != nullptr);
+        if (!regex) {
+            regex = &m_state->regexesCache.emplace(pattern, RegexEngine(pattern)).first->second;
         }
 
-        if (!RegexEngine::search(m_target.asString(), it->second)) {
+        recordRegexSearch(m_state->stats);
+        if (!RegexEngine::search(m_target.asString(), *regex)) {
             if (m_results) {
                 m_results->pushError(m_context, "Failed to match regex specified by 'pattern' constraint.");
             }
@@ -958,7 +1083,7 @@ public:
     }
 
     /**
-     * @brief   Validate a value against a PatternConstraint
+     * @brief   Validate a value against a PolyConstraint
      *
      * @param   constraint  Constraint that the target must validate against
      *
@@ -966,6 +1091,14 @@ public:
      */
     bool visit(const constraints::PolyConstraint &constraint) override
     {
+        // Custom constraints derived from PolyConstraintT may be able to
+        // validate the target without type erasure
+        const constraints::TypedPolyValidator<AdapterType> *typedValidator =
+                constraint.getTypedValidator<AdapterType>();
+        if (typedValidator) {
+            return typedValidator->validateTyped(m_target, m_context, m_results);
+        }
+
         return constraint.validate(m_target, m_context, m_results);
     }
 
@@ -995,35 +1128,55 @@ public:
      */
     bool visit(const PropertiesConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isObject()) || !m_target.maybeObject()) {
+        if (!targetIsObject()) {
             return true;
         }
 
         bool validated = true;
 
         // Track which properties have already been validated
-        std::set<std::string> propertiesMatched;
+        PropertyNames propertiesMatched(m_state->template allocator<ValidationScratch::String>());
 
-        // Validate properties against subschemas for matching 'properties'
-        // constraints
         const typename AdapterType::Object object = m_target.asObject();
-        constraint.applyToProperties(
-                ValidatePropertySubschemas(
-                        object, m_context, true, m_results != nullptr, true, m_strictTypes, m_results,
-                        &propertiesMatched, &validated, m_regexesCache));
+        if (parallelTasks(m_target.getObjectSize()) > 0) {
+            // Large objects are matched first, so that members matching
+            // 'properties' and 'patternProperties' can be validated in parallel
+            if (!validateMatchedProperties(constraint, object, propertiesMatched)) {
+                if (!m_results) {
+                    return false;
+                }
+                validated = false;
+            }
+        } else {
+            // Validate properties against subschemas for matching 'properties'
+            // constraints
+            constraint.applyToProperties(
+                    ValidatePropertySubschemas(
+                            object, m_context, true, m_results != nullptr, true, strictTypes(), m_results,
+                            &propertiesMatched, &validated, m_state));
+
+            // Exit early if validation failed, and we're not collecting exhaustive
+            // validation results
+            if (!validated && !m_results) {
+                return false;
+            }
 
-        // Exit early if validation failed, and we're not collecting exhaustive
-        // validation results
-        if (!validated && !m_results) {
-            return false;
+            // Validate properties against subschemas for matching patternProperties
+            // constraints
+            constraint.applyToPatternProperties(
+                    ValidatePatternPropertySubschemas(
+                            object, m_context, true, m_results != nullptr, true, strictTypes(), m_results,
+                            &propertiesMatched, &validated, m_state));
         }
 
-        // Validate properties against subschemas for matching patternProperties
-        // constraints
-        constraint.applyToPatternProperties(
-                ValidatePatternPropertySubschemas(
-                        object, m_context, true, false, true, m_strictTypes, m_results, &propertiesMatched,
-                        &validated, m_regexesCache));
+        // Sort the names of matched properties, so that the names of object
+        // members can be looked up without being copied
+        std::sort(propertiesMatched.begin(), propertiesMatched.end());
+        propertiesMatched.erase(std::unique(propertiesMatched.begin(), propertiesMatched.end()),
+                propertiesMatched.end());
+
+        typedef typename AdapterType::Object::const_iterator MemberIterator;
+        typedef adapters::ObjectMemberAccessor<MemberIterator> MemberAccessor;
 
         // Validate against additionalProperties subschema for any properties
         // that have not yet been matched
@@ -1032,16 +1185,18 @@ public:
         if (!additionalPropertiesSubschema) {
             if (propertiesMatched.size() != m_target.getObjectSize()) {
                 if (m_results) {
-                    std::string unwanted;
-                    for (const typename AdapterType::ObjectMember m : object) {
-                        if (propertiesMatched.find(m.first) == propertiesMatched.end()) {
-                            unwanted = m.first;
+                    ValidationScratch::String unwanted(m_state->template allocator<char>());
+                    for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+                        const MemberAccessor member(itr);
+                        const adapters::ObjectMemberKey name = member.key();
+                        if (!isPropertyMatched(propertiesMatched, name)) {
+                            unwanted.assign(name.data(), name.size());
                             break;
                         }
                     }
-                    m_results->pushError(m_context, "Object contains a property "
+                    reportError(*m_results, *m_state, m_context, "Object contains a property "
                             "that could not be validated using 'properties' "
-                            "or 'additionalProperties' constraints: '" + unwanted + "'.");
+                            "or 'additionalProperties' constraints: '", unwanted, "'.");
                 }
 
                 return false;
@@ -1050,25 +1205,24 @@ public:
             return validated;
         }
 
-        for (const typename AdapterType::ObjectMember m : object) {
-            if (propertiesMatched.find(m.first) == propertiesMatched.end()) {
-                // Update context
-                std::vector<std::string> newContext = m_context;
-                newContext.push_back("[" + m.first + "]");
-
-                // Create a validator to validate the property's value
-                ValidationVisitor validator(m.second, newContext, m_strictTypes, m_results, m_regexesCache);
-                if (!validator.validateSchema(*additionalPropertiesSubschema)) {
-                    if (m_results) {
-                        m_results->pushError(m_context, "Failed to validate against additional properties schema");
-                    }
+        const bool additionalPropertiesValidated = validateRange(object.begin(), object.end(), m_target.getObjectSize(),
+                [&propertiesMatched, additionalPropertiesSubschema](ValidationVisitor &visitor,
+                        const MemberIterator &itr, size_t) -> bool {
+            const MemberAccessor member(itr);
+            const adapters::ObjectMemberKey name = member.key();
+            if (isPropertyMatched(propertiesMatched, name) ||
+                    visitor.validateChild(member.value(), name, *additionalPropertiesSubschema)) {
+                return true;
+            }
 
-                    validated = false;
-                }
+            if (visitor.m_results) {
+                visitor.m_results->pushError(visitor.m_context, "Failed to validate against additional properties schema");
             }
-        }
 
-        return validated;
+            return false;
+        });
+
+        return validated && additionalPropertiesValidated;
     }
 
     /**
@@ -1080,13 +1234,23 @@ public:
      */
     bool visit(const PropertyNamesConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isObject()) || !m_target.maybeObject()) {
+        if (!targetIsObject()) {
             return true;
         }
 
-        for (const typename AdapterType::ObjectMember m : m_target.asObject()) {
-            adapters::StdStringAdapter stringAdapter(m.first);
-            ValidationVisitor<adapters::StdStringAdapter, RegexEngine> validator(stringAdapter, m_context, m_strictTypes, nullptr, m_regexesCache);
+        typedef typename AdapterType::Object::const_iterator MemberIterator;
+        typedef adapters::ObjectMemberAccessor<MemberIterator> MemberAccessor;
+
+        // Reuse a single string for property names, so that its storage is
+        // only reallocated when a longer name is encountered
+        std::string name;
+        const typename AdapterType::Object object = m_target.asObject();
+        for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+            const MemberAccessor member(itr);
+            const adapters::ObjectMemberKey key = member.key();
+            name.assign(key.data(), key.size());
+            adapters::StdStringAdapter stringAdapter(name);
+            ValidationVisitor<adapters::StdStringAdapter, RegexEngine, Policy> validator(stringAdapter, m_context, strictTypes(), nullptr, m_state);
             if (!validator.validateSchema(*constraint.getSubschema())) {
                 return false;
             }
@@ -1107,14 +1271,14 @@ public:
      */
     bool visit(const RequiredConstraint &constraint) override
     {
-        if ((m_strictTypes && !m_target.isObject()) || !m_target.maybeObject()) {
+        if (!targetIsObject()) {
             return true;
         }
 
         bool validated = true;
         const typename AdapterType::Object object = m_target.asObject();
         constraint.applyToRequiredProperties(
-                ValidateProperties(object, m_context, true, m_results != nullptr, m_results, &validated));
+                ValidateProperties(object, m_context, true, m_results != nullptr, m_results, &validated, m_state));
 
         return validated;
     }
@@ -1145,32 +1309,22 @@ public:
             return true;
         }
 
-        // Track whether validation has failed
-        bool validated = true;
-
-        unsigned int index = 0;
-        for (const AdapterType &item : m_target.getArray()) {
-            // Update context for current array item
-            std::vector<std::string> newContext = m_context;
-            newContext.push_back("[" + std::to_string(index) + "]");
+        typedef typename AdapterType::Array::const_iterator ArrayIterator;
 
-            // Create a validator for the current array item
-            ValidationVisitor<AdapterType, RegexEngine> validationVisitor(item, newContext, m_strictTypes, m_results, m_regexesCache);
-
-            // Perform validation
-            if (!validationVisitor.validateSchema(*itemsSubschema)) {
-                if (m_results) {
-                    m_results->pushError(m_context, "Failed to validate item #" + std::to_string(index) + " in array.");
-                    validated = false;
-                } else {
-                    return false;
-                }
+        const typename AdapterType::Array arr = m_target.getArray();
+        return validateRange(arr.begin(), arr.end(), arr.size(),
+                [itemsSubschema](ValidationVisitor &visitor, const ArrayIterator &itr, size_t index) -> bool {
+            if (visitor.validateChild(*itr, index, *itemsSubschema)) {
+                return true;
             }
 
-            index++;
-        }
+            if (visitor.m_results) {
+                reportError(*visitor.m_results, *visitor.m_state, visitor.m_context,
+                        "Failed to validate item #", index, " in array.");
+            }
 
-        return validated;
+            return false;
+        });
     }
 
     /**
@@ -1189,7 +1343,7 @@ public:
         {
             // ValidateNamedTypes functor assumes target is invalid
             bool validated = false;
-            constraint.applyToNamedTypes(ValidateNamedTypes(m_target, false, true, m_strictTypes, &validated));
+            constraint.applyToNamedTypes(ValidateNamedTypes(m_target, false, true, strictTypes(), &validated));
             if (validated) {
                 return true;
             }
@@ -1223,7 +1377,7 @@ public:
      */
     bool visit(const UniqueItemsConstraint &) override
     {
-        if ((m_strictTypes && !m_target.isArray()) || !m_target.maybeArray()) {
+        if (!targetIsArray()) {
             return true;
         }
 
@@ -1234,34 +1388,64 @@ public:
             return true;
         }
 
-        bool validated = true;
-
+        // Sort the elements by structural hash, so that only elements with
+        // equal hashes need to be compared with each other
         const typename AdapterType::Array targetArray = m_target.asArray();
-        const typename AdapterType::Array::const_iterator end = targetArray.end();
-
-        typename AdapterType::Array::const_iterator outerItr = targetArray.begin();
-        for (unsigned int outerIndex = 0; outerIndex < array_size - 1 /*outerItr != secondLast*/; ++outerItr) {
-            unsigned int innerIndex = outerIndex + 1;
-            typename AdapterType::Array::const_iterator innerItr(outerItr);
-            for (++innerItr; innerItr != end; ++innerItr) {
-                if (outerItr->equalTo(*innerItr, true)) {
-                    if (!m_results) {
-                        return false;
+        std::vector<AdapterType, internal::CustomAllocator<AdapterType>> elements(
+                m_state->template allocator<AdapterType>());
+        std::vector<std::pair<uint64_t, size_t>, internal::CustomAllocator<std::pair<uint64_t, size_t>>> hashes(
+                m_state->template allocator<std::pair<uint64_t, size_t>>());
+        elements.reserve(array_size);
+        hashes.reserve(array_size);
+        for (const AdapterType element : targetArray) {
+            hashes.emplace_back(element.hash(), elements.size());
+            elements.push_back(element);
+        }
+
+        std::sort(hashes.begin(), hashes.end());
+
+        std::vector<std::pair<size_t, size_t>, internal::CustomAllocator<std::pair<size_t, size_t>>> duplicates(
+                m_state->template allocator<std::pair<size_t, size_t>>());
+        for (size_t first = 0; first < hashes.size(); ) {
+            size_t last = first + 1;
+            while (last < hashes.size() && hashes[last].first == hashes[first].first) {
+                ++last;
+            }
+
+            for (size_t outer = first; outer + 1 < last; ++outer) {
+                const size_t outerIndex = hashes[outer].second;
+                for (size_t inner = outer + 1; inner < last; ++inner) {
+                    const size_t innerIndex = hashes[inner].second;
+                    recordValueComparison(m_state->stats);
+                    if (elements[outerIndex].equalTo(elements[innerIndex], true)) {
+                        if (!m_results) {
+                            return false;
+                        }
+                        duplicates.emplace_back(outerIndex, innerIndex);
                     }
-                    m_results->pushError(m_context, "Elements at indexes #" + std::to_string(outerIndex)
-                        + " and #" + std::to_string(innerIndex) + " violate uniqueness constraint.");
-                    validated = false;
                 }
-                ++innerIndex;
             }
-            ++outerIndex;
+
+            first = last;
         }
 
-        return validated;
+        // Report duplicates in the order that they appear in the array
+        std::sort(duplicates.begin(), duplicates.end());
+        for (const std::pair<size_t, size_t> &duplicate : duplicates) {
+            reportError(*m_results, *m_state, m_context, "Elements at indexes #", duplicate.first,
+                    " and #", duplicate.second, " violate uniqueness constraint.");
+        }
+
+        return duplicates.empty();
     }
 
 private:
 
+    /// Names of the object members that have been matched by 'properties'
+    /// and 'patternProperties' constraints
+    typedef std::vector<ValidationScratch::String, internal::CustomAllocator<ValidationScratch::String>>
+            PropertyNames;
+
     /**
      * @brief  Functor to compare a node with a collection of values
      */
@@ -1274,18 +1458,21 @@ private:
                 bool continueOnFailure,
                 bool strictTypes,
                 ValidationResults *results,
-                unsigned int *numValidated)
+                unsigned int *numValidated,
+                ValidationStats *stats)
           : m_target(target),
             m_context(context),
             m_continueOnSuccess(continueOnSuccess),
             m_continueOnFailure(continueOnFailure),
             m_strictTypes(strictTypes),
             m_results(results),
-            m_numValidated(numValidated) { }
+            m_numValidated(numValidated),
+            m_stats(stats) { }
 
         template<typename OtherValue>
         bool operator()(const OtherValue &value) const
         {
+            recordValueComparison(m_stats);
             if (value.equalTo(m_target, m_strictTypes)) {
                 if (m_numValidated) {
                     (*m_numValidated)++;
@@ -1309,6 +1496,7 @@ private:
         bool m_strictTypes;
         ValidationResults * const m_results;
         unsigned int * const m_numValidated;
+        ValidationStats * const m_stats;
     };
 
     /**
@@ -1322,25 +1510,28 @@ private:
                 bool continueOnSuccess,
                 bool continueOnFailure,
                 ValidationResults *results,
-                bool *validated)
+                bool *validated,
+                const ValidationState<RegexEngine> *state)
           : m_object(object),
             m_context(context),
             m_continueOnSuccess(continueOnSuccess),
             m_continueOnFailure(continueOnFailure),
             m_results(results),
-            m_validated(validated) { }
+            m_validated(validated),
+            m_state(state) { }
 
         template<typename StringType>
         bool operator()(const StringType &property) const
         {
-            if (m_object.find(property.c_str()) == m_object.end()) {
+            std::string localKey;
+            if (m_object.find(memberKey(property.c_str(), *m_state, localKey)) == m_object.end()) {
                 if (m_validated) {
                     *m_validated = false;
                 }
 
                 if (m_results) {
-                    m_results->pushError(m_context, "Missing required property '" +
-                            std::string(property.c_str()) + "'.");
+                    reportError(*m_results, *m_state, m_context, "Missing required property '", property.c_str(),
+                            "'.");
                 }
 
                 return m_continueOnFailure;
@@ -1356,6 +1547,7 @@ private:
         bool m_continueOnFailure;
         ValidationResults * const m_results;
         bool * const m_validated;
+        const ValidationState<RegexEngine> * const m_state;
     };
 
     /**
@@ -1367,29 +1559,31 @@ private:
                 const typename AdapterType::Object &object,
                 const std::vector<std::string> &context,
                 ValidationResults *results,
-                bool *validated)
+                bool *validated,
+                const ValidationState<RegexEngine> *state)
           : m_object(object),
             m_context(context),
             m_results(results),
-            m_validated(validated) { }
+            m_validated(validated),
+            m_state(state) { }
 
         template<typename StringType, typename ContainerType>
         bool operator()(const StringType &propertyName, const ContainerType &dependencyNames) const
         {
-            const std::string propertyNameKey(propertyName.c_str());
-            if (m_object.find(propertyNameKey) == m_object.end()) {
+            std::string localKey;
+            if (m_object.find(memberKey(propertyName.c_str(), *m_state, localKey)) == m_object.end()) {
                 return true;
             }
 
             typedef typename ContainerType::value_type ValueType;
             for (const ValueType &dependencyName : dependencyNames) {
-                const std::string dependencyNameKey(dependencyName.c_str());
-                if (m_object.find(dependencyNameKey) == m_object.end()) {
+                if (m_object.find(memberKey(dependencyName.c_str(), *m_state, localKey)) == m_object.end()) {
                     if (m_validated) {
                         *m_validated = false;
                     }
                     if (m_results) {
-                        m_results->pushError(m_context, "Missing dependency '" + dependencyNameKey + "'.");
+                        reportError(*m_results, *m_state, m_context, "Missing dependency '", dependencyName.c_str(),
+                                "'.");
                     } else {
                         return false;
                     }
@@ -1404,6 +1598,7 @@ private:
         const std::vector<std::string> &m_context;
         ValidationResults * const m_results;
         bool * const m_validated;
+        const ValidationState<RegexEngine> * const m_state;
     };
 
     /**
@@ -1420,7 +1615,7 @@ private:
                 ValidationResults *results,
                 unsigned int *numValidated,
                 bool *validated,
-                std::unordered_map<std::string, RegexEngine>& regexesCache)
+                ValidationState<RegexEngine> *state)
           : m_arr(arr),
             m_context(context),
             m_continueOnSuccess(continueOnSuccess),
@@ -1429,7 +1624,7 @@ private:
             m_results(results),
             m_numValidated(numValidated),
             m_validated(validated),
-            m_regexesCache(regexesCache) { }
+            m_state(state) { }
 
         bool operator()(unsigned int index, const Subschema *subschema) const
         {
@@ -1439,15 +1634,17 @@ private:
             }
 
             // Update context
-            std::vector<std::string> newContext = m_context;
-            newContext.push_back("[" + std::to_string(index) + "]");
+            std::vector<std::string> localContext;
+            const std::vector<std::string> &newContext = childContext(m_context, index, m_state->scratch,
+                    localContext);
+            recordNodeVisited(m_state->stats);
 
             // Find array item
             typename AdapterType::Array::const_iterator itr = m_arr.begin();
             itr.advance(index);
 
             // Validate current array item
-            ValidationVisitor validator(*itr, newContext, m_strictTypes, m_results, m_regexesCache);
+            ValidationVisitor validator(*itr, newContext, m_strictTypes, m_results, m_state);
             if (validator.validateSchema(*subschema)) {
                 if (m_numValidated) {
                     (*m_numValidated)++;
@@ -1461,8 +1658,8 @@ private:
             }
 
             if (m_results) {
-                m_results->pushError(newContext, "Failed to validate item #" + std::to_string(index) +
-                    " against corresponding item schema.");
+                reportError(*m_results, *m_state, newContext, "Failed to validate item #", index,
+                        " against corresponding item schema.");
             }
 
             return m_continueOnFailure;
@@ -1477,7 +1674,7 @@ private:
         ValidationResults * const m_results;
         unsigned int * const m_numValidated;
         bool * const m_validated;
-        std::unordered_map<std::string, RegexEngine>& m_regexesCache;
+        ValidationState<RegexEngine> * const m_state;
     };
 
     /**
@@ -1511,16 +1708,16 @@ private:
                 valid = m_target.isArray();
                 break;
             case TypeConstraint::kBoolean:
-                valid = m_target.isBool() || (!m_strictTypes && m_target.maybeBool());
+                valid = m_target.isBool() || (!useStrictTypes(m_strictTypes) && m_target.maybeBool());
                 break;
             case TypeConstraint::kInteger:
-                valid = m_target.isInteger() || (!m_strictTypes && m_target.maybeInteger());
+                valid = m_target.isInteger() || (!useStrictTypes(m_strictTypes) && m_target.maybeInteger());
                 break;
             case TypeConstraint::kNull:
-                valid = m_target.isNull() || (!m_strictTypes && m_target.maybeNull());
+                valid = m_target.isNull() || (!useStrictTypes(m_strictTypes) && m_target.maybeNull());
                 break;
             case TypeConstraint::kNumber:
-                valid = m_target.isNumber() || (!m_strictTypes && m_target.maybeDouble());
+                valid = m_target.isNumber() || (!useStrictTypes(m_strictTypes) && m_target.maybeDouble());
                 break;
             case TypeConstraint::kObject:
                 valid = m_target.isObject();
@@ -1561,9 +1758,9 @@ private:
                 bool continueIfUnmatched,
                 bool strictTypes,
                 ValidationResults *results,
-                std::set<std::string> *propertiesMatched,
+                PropertyNames *propertiesMatched,
                 bool *validated,
-                std::unordered_map<std::string, RegexEngine>& regexesCache)
+                ValidationState<RegexEngine> *state)
           : m_object(object),
             m_context(context),
             m_continueOnSuccess(continueOnSuccess),
@@ -1573,43 +1770,53 @@ private:
             m_results(results),
             m_propertiesMatched(propertiesMatched),
             m_validated(validated),
-            m_regexesCache(regexesCache) { }
+            m_state(state) { }
 
         template<typename StringType>
         bool operator()(const StringType &patternProperty, const Subschema *subschema) const
         {
-            const std::string patternPropertyStr(patternProperty.c_str());
-
             // It would be nice to store pre-allocated regex objects in the
             // PropertiesConstraint. does std::regex currently support
             // custom allocators? Anyway, this isn't an issue here, because Valijson's
             // JSON Scheme validator does not yet support custom allocators.
-            const std::regex r(patternPropertyStr);
+
+            std::string localKey;
+            std::regex compiled;
+            const std::regex &r = patternPropertyRegex(memberKey(patternProperty.c_str(), *m_state, localKey),
+                    *m_state, compiled);
 
             bool matchFound = false;
 
             // Recursively validate all matching properties
-            typedef const typename AdapterType::ObjectMember ObjectMember;
-            for (const ObjectMember m : m_object) {
-                if (std::regex_search(m.first, r)) {
+            typedef typename AdapterType::Object::const_iterator MemberIterator;
+            typedef adapters::ObjectMemberAccessor<MemberIterator> MemberAccessor;
+            for (MemberIterator itr = m_object.begin(); itr != m_object.end(); ++itr) {
+                const MemberAccessor member(itr);
+                const adapters::ObjectMemberKey name = member.key();
+                recordRegexSearch(m_state->stats);
+                if (std::regex_search(name.begin(), name.end(), r)) {
                     matchFound = true;
                     if (m_propertiesMatched) {
-                        m_propertiesMatched->insert(m.first);
+                        m_propertiesMatched->emplace_back(name.data(), name.size(),
+                                m_propertiesMatched->get_allocator());
                     }
 
                     // Update context
-                    std::vector<std::string> newContext = m_context;
-                    newContext.push_back("[" + m.first + "]");
+                    std::vector<std::string> localContext;
+                    const std::vector<std::string> &newContext = childContext(m_context, name, m_state->scratch,
+                            localContext);
+                    recordNodeVisited(m_state->stats);
 
                     // Recursively validate property's value
-                    ValidationVisitor validator(m.second, newContext, m_strictTypes, m_results, m_regexesCache);
+                    ValidationVisitor validator(member.value(), newContext, m_strictTypes, m_results, m_state);
                     if (validator.validateSchema(*subschema)) {
                         continue;
                     }
 
                     if (m_results) {
-                        m_results->pushError(m_context, "Failed to validate against schema associated with pattern '" +
-                                patternPropertyStr + "'.");
+                        reportError(*m_results, *m_state, m_context,
+                                "Failed to validate against schema associated with pattern '",
+                                patternProperty.c_str(), "'.");
                     }
 
                     if (m_validated) {
@@ -1638,9 +1845,9 @@ private:
         const bool m_continueIfUnmatched;
         const bool m_strictTypes;
         ValidationResults * const m_results;
-        std::set<std::string> * const m_propertiesMatched;
+        PropertyNames * const m_propertiesMatched;
         bool * const m_validated;
-        std::unordered_map<std::string, RegexEngine>& m_regexesCache;
+        ValidationState<RegexEngine> * const m_state;
     };
 
     /**
@@ -1657,9 +1864,9 @@ private:
                 bool continueIfUnmatched,
                 bool strictTypes,
                 ValidationResults *results,
-                std::set<std::string> *propertiesMatched,
+                PropertyNames *propertiesMatched,
                 bool *validated,
-                std::unordered_map<std::string, RegexEngine>& regexesCache)
+                ValidationState<RegexEngine> *state)
           : m_object(object),
             m_context(context),
             m_continueOnSuccess(continueOnSuccess),
@@ -1669,34 +1876,38 @@ private:
             m_results(results),
             m_propertiesMatched(propertiesMatched),
             m_validated(validated),
-            m_regexesCache(regexesCache) { }
+            m_state(state) { }
 
         template<typename StringType>
         bool operator()(const StringType &propertyName, const Subschema *subschema) const
         {
-            const std::string propertyNameKey(propertyName.c_str());
-            const typename AdapterType::Object::const_iterator itr = m_object.find(propertyNameKey);
+            std::string localKey;
+            const typename AdapterType::Object::const_iterator itr =
+                    m_object.find(memberKey(propertyName.c_str(), *m_state, localKey));
             if (itr == m_object.end()) {
                 return m_continueIfUnmatched;
             }
 
+            const adapters::ObjectMemberKey name(propertyName.c_str(), propertyName.size());
             if (m_propertiesMatched) {
-                m_propertiesMatched->insert(propertyNameKey);
+                m_propertiesMatched->emplace_back(name.data(), name.size(), m_propertiesMatched->get_allocator());
             }
 
             // Update context
-            std::vector<std::string> newContext = m_context;
-            newContext.push_back("[" + propertyNameKey + "]");
+            std::vector<std::string> localContext;
+            const std::vector<std::string> &newContext = childContext(m_context, name, m_state->scratch,
+                    localContext);
+            recordNodeVisited(m_state->stats);
 
             // Recursively validate property's value
-            ValidationVisitor validator(itr->second, newContext, m_strictTypes, m_results, m_regexesCache);
+            ValidationVisitor validator(itr->second, newContext, m_strictTypes, m_results, m_state);
             if (validator.validateSchema(*subschema)) {
                 return m_continueOnSuccess;
             }
 
             if (m_results) {
-                m_results->pushError(m_context, "Failed to validate against schema associated with property name '" +
-                        propertyNameKey + "'.");
+                reportError(*m_results, *m_state, m_context,
+                        "Failed to validate against schema associated with property name '", name, "'.");
             }
 
             if (m_validated) {
@@ -1714,9 +1925,9 @@ private:
         const bool m_continueIfUnmatched;
         const bool m_strictTypes;
         ValidationResults * const m_results;
-        std::set<std::string> * const m_propertiesMatched;
+        PropertyNames * const m_propertiesMatched;
         bool * const m_validated;
-        std::unordered_map<std::string, RegexEngine>& m_regexesCache;
+        ValidationState<RegexEngine> * const m_state;
     };
 
     /**
@@ -1739,8 +1950,9 @@ private:
         template<typename StringType>
         bool operator()(const StringType &propertyName, const Subschema *schemaDependency) const
         {
-            const std::string propertyNameKey(propertyName.c_str());
-            if (m_object.find(propertyNameKey) == m_object.end()) {
+            std::string localKey;
+            if (m_object.find(memberKey(propertyName.c_str(), *m_validationVisitor.m_state, localKey)) ==
+                    m_object.end()) {
                 return true;
             }
 
@@ -1816,8 +2028,8 @@ private:
             }
 
             if (m_results) {
-                m_results->pushError(m_context,
-                        "Failed to validate against child schema #" + std::to_string(index) + ".");
+                reportError(*m_results, *m_validationVisitor.m_state, m_context,
+                        "Failed to validate against child schema #", index, ".");
             }
 
             return m_continueOnFailure;
@@ -1834,6 +2046,677 @@ private:
         bool * const m_validated;
     };
 
+#if VALIJSON_USE_INSTRUMENTATION
+    /**
+     * @brief  Validate the target against a schema, notifying the observer
+     *         and recording statistics for each constraint that is evaluated.
+     *
+     * This mirrors validateSchema(), but wraps each constraint so that its
+     * latency and outcome can be reported.
+     */
+    bool validateSchemaInstrumented(const Subschema &subschema)
+    {
+        if (m_state->stats) {
+            // Child values are counted as they are visited, but the root
+            // value can only be identified by the absence of any nesting
+            if (internal::ValidationDepthTracker::enter(*m_state->stats)) {
+                m_state->stats->nodesVisited++;
+            }
+            m_state->stats->subschemasEntered++;
+        }
+
+        if (m_state->observer) {
+            m_state->observer->enterSubschema(subschema, m_context);
+        }
+
+        bool validated = false;
+        if (!subschema.getAlwaysInvalid()) {
+            Subschema::ApplyFunction fn([this, &subschema](const constraints::Constraint &constraint) {
+                return validateConstraintInstrumented(subschema, constraint);
+            });
+
+            validated = m_results == nullptr ? subschema.applyStrict(fn) : subschema.apply(fn);
+        }
+
+        if (m_state->observer) {
+            m_state->observer->exitSubschema(subschema, m_context, validated);
+        }
+
+        if (m_state->stats) {
+            internal::ValidationDepthTracker::exit(*m_state->stats);
+        }
+
+        return validated;
+    }
+
+    /**
+     * @brief  Validate the target against a single constraint, notifying the
+     *         observer and recording statistics as required.
+     */
+    bool validateConstraintInstrumented(const Subschema &subschema, const constraints::Constraint &constraint)
+    {
+        const constraints::ConstraintKind kind = constraints::getConstraintKind(constraint);
+        if (m_state->stats) {
+            m_state->stats->constraintsEvaluated[kind]++;
+        }
+
+        if (m_state->observer) {
+            m_state->observer->enterConstraint(subschema, constraint, kind, m_context);
+        }
+
+        const bool timed = m_state->instrumentation && m_state->instrumentation->isEnabled();
+        const Instrumentation::Clock::time_point start = timed ?
+                Instrumentation::Clock::now() : Instrumentation::Clock::time_point();
+
+        const bool validated = constraint.accept(*this);
+
+        if (timed) {
+            const Instrumentation::Clock::time_point end = Instrumentation::Clock::now();
+            m_state->instrumentation->record(subschema, kind, validated,
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+
+        if (m_state->observer) {
+            m_state->observer->exitConstraint(subschema, constraint, kind, m_context, validated);
+        }
+
+        return validated;
+    }
+#endif
+
+    /**
+     * @brief  Resolve the type checking mode, given the runtime setting
+     *
+     * When the mode is fixed by the Policy parameter, this is a compile-time
+     * constant, so branches for the other mode are eliminated.
+     */
+    static constexpr bool useStrictTypes(bool runtimeStrictTypes)
+    {
+        return Policy == kRuntimeTypeChecking ? runtimeStrictTypes : Policy == kStrongTypeChecking;
+    }
+
+    /**
+     * @brief  Return true if strict type comparison should be used
+     */
+    bool strictTypes() const
+    {
+        return useStrictTypes(m_strictTypes);
+    }
+
+    /**
+     * @brief  Return true if the target is an array, or may be interpreted as
+     *         an array when weak type checking is used
+     */
+    bool targetIsArray() const
+    {
+        return strictTypes() ? m_target.isArray() : m_target.maybeArray();
+    }
+
+    /**
+     * @brief  Return true if the target is a double, or may be interpreted as
+     *         a double when weak type checking is used
+     */
+    bool targetIsDouble() const
+    {
+        return strictTypes() ? m_target.isDouble() : m_target.maybeDouble();
+    }
+
+    /**
+     * @brief  Return true if the target is an integer, or may be interpreted
+     *         as an integer when weak type checking is used
+     */
+    bool targetIsInteger() const
+    {
+        return strictTypes() ? m_target.isInteger() : m_target.maybeInteger();
+    }
+
+    /**
+     * @brief  Return true if the target is a number, or may be interpreted as
+     *         a number when weak type checking is used
+     */
+    bool targetIsNumber() const
+    {
+        return strictTypes() ? m_target.isNumber() : m_target.maybeDouble();
+    }
+
+    /**
+     * @brief  Return true if the target is an object, or may be interpreted as
+     *         an object when weak type checking is used
+     */
+    bool targetIsObject() const
+    {
+        return strictTypes() ? m_target.isObject() : m_target.maybeObject();
+    }
+
+    /**
+     * @brief  Return true if the target is a string, or may be interpreted as
+     *         a string when weak type checking is used
+     */
+    bool targetIsString() const
+    {
+        return strictTypes() ? m_target.isString() : m_target.maybeString();
+    }
+
+    /**
+     * @brief  Return the compiled regular expression for a 'patternProperties'
+     *         pattern
+     *
+     * Compiled regexes are kept in scratch storage, when available, so that
+     * they can be reused by later validations. Otherwise, the pattern is
+     * compiled into \c local.
+     */
+    static const std::regex & patternPropertyRegex(const std::string &pattern,
+            const ValidationState<RegexEngine> &state, std::regex &local)
+    {
+        const std::regex *cached = state.findScratchRegex(pattern);
+        recordRegexLookup(state.stats, cached != nullptr);
+        if (cached) {
+            return *cached;
+        }
+
+        local = std::regex(pattern);
+        return state.scratch ? state.scratch->addRegex(pattern, std::move(local)) : local;
+    }
+
+    /**
+     * @brief  Validate the members of an object that match the 'properties'
+     *         and 'patternProperties' of a PropertiesConstraint, using
+     *         validateRange() so that large objects can be validated in
+     *         parallel
+     *
+     * Members are matched on this thread, in the order that they would be
+     * validated by ValidatePropertySubschemas and
+     * ValidatePatternPropertySubschemas, so that errors are reported in the
+     * same order.
+     *
+     * @param  constraint         constraint that the object must satisfy
+     * @param  object             object to be validated
+     * @param  propertiesMatched  names of matched members are appended here
+     *
+     * @returns  \c true if all matched members are valid; \c false otherwise
+     */
+    bool validateMatchedProperties(const PropertiesConstraint &constraint,
+            const typename AdapterType::Object &object, PropertyNames &propertiesMatched)
+    {
+        // Member that matches a property name or pattern; the name is an index
+        // into propertiesMatched, and the pattern is the one in the constraint
+        struct Match
+        {
+            AdapterType value;
+            size_t name;
+            const PropertiesConstraint::String *pattern;
+            const Subschema *subschema;
+        };
+
+        typedef std::vector<Match, internal::CustomAllocator<Match>> Matches;
+        typedef typename Matches::const_iterator MatchIterator;
+
+        Matches matches(m_state->template allocator<Match>());
+        constraint.applyToProperties([this, &object, &propertiesMatched, &matches](
+                const PropertiesConstraint::String &propertyName, const Subschema *subschema) {
+            std::string localKey;
+            const typename AdapterType::Object::const_iterator itr =
+                    object.find(memberKey(propertyName.c_str(), *m_state, localKey));
+            if (itr != object.end()) {
+                matches.push_back(Match{itr->second, propertiesMatched.size(), nullptr, subschema});
+                propertiesMatched.emplace_back(propertyName.c_str(), propertyName.size(),
+                        propertiesMatched.get_allocator());
+            }
+            return true;
+        });
+
+        bool validated = validateRange(matches.begin(), matches.end(), matches.size(),
+                [&propertiesMatched](ValidationVisitor &visitor, const MatchIterator &itr, size_t) -> bool {
+            const ValidationScratch::String &name = propertiesMatched[itr->name];
+            if (visitor.validateChild(itr->value, adapters::ObjectMemberKey(name.data(), name.size()),
+                    *itr->subschema)) {
+                return true;
+            }
+
+            if (visitor.m_results) {
+                reportError(*visitor.m_results, *visitor.m_state, visitor.m_context,
+                        "Failed to validate against schema associated with property name '", name, "'.");
+            }
+
+            return false;
+        });
+
+        if (!validated && !m_results) {
+            return false;
+        }
+
+        typedef typename AdapterType::Object::const_iterator MemberIterator;
+        typedef adapters::ObjectMemberAccessor<MemberIterator> MemberAccessor;
+
+        matches.clear();
+        constraint.applyToPatternProperties([this, &object, &propertiesMatched, &matches](
+                const PropertiesConstraint::String &patternProperty, const Subschema *subschema) {
+            std::string localKey;
+            std::regex compiled;
+            const std::regex &r = patternPropertyRegex(memberKey(patternProperty.c_str(), *m_state, localKey),
+                    *m_state, compiled);
+            for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+                const MemberAccessor member(itr);
+                const adapters::ObjectMemberKey name = member.key();
+                recordRegexSearch(m_state->stats);
+                if (std::regex_search(name.begin(), name.end(), r)) {
+                    matches.push_back(Match{member.value(), propertiesMatched.size(), &patternProperty, subschema});
+                    propertiesMatched.emplace_back(name.data(), name.size(), propertiesMatched.get_allocator());
+                }
+            }
+            return true;
+        });
+
+        const bool patternsValidated = validateRange(matches.begin(), matches.end(), matches.size(),
+                [&propertiesMatched](ValidationVisitor &visitor, const MatchIterator &itr, size_t) -> bool {
+            const ValidationScratch::String &name = propertiesMatched[itr->name];
+            if (visitor.validateChild(itr->value, adapters::ObjectMemberKey(name.data(), name.size()),
+                    *itr->subschema)) {
+                return true;
+            }
+
+            if (visitor.m_results) {
+                reportError(*visitor.m_results, *visitor.m_state, visitor.m_context,
+                        "Failed to validate against schema associated with pattern '", *itr->pattern, "'.");
+            }
+
+            return false;
+        });
+
+        return validated && patternsValidated;
+    }
+
+    /**
+     * @brief  Return true if a sorted list of property names contains the
+     *         name of an object member
+     */
+    static bool isPropertyMatched(const PropertyNames &propertiesMatched, const adapters::ObjectMemberKey &name)
+    {
+        const typename PropertyNames::const_iterator itr = std::lower_bound(
+                propertiesMatched.begin(), propertiesMatched.end(), name,
+                [](const ValidationScratch::String &matched, const adapters::ObjectMemberKey &key) {
+                    return key.compare(adapters::ObjectMemberKey(matched.data(), matched.size())) > 0;
+                });
+
+        return itr != propertiesMatched.end() &&
+                name == adapters::ObjectMemberKey(itr->data(), itr->size());
+    }
+
+    /**
+     * @brief  Return true if validation has been cancelled
+     */
+    bool isCancelled() const
+    {
+        return m_state->cancelled && m_state->cancelled->load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief  Return the context for a child of a value
+     *
+     * When scratch storage is available, the context is built in the buffer
+     * for its depth, which avoids allocating memory once the buffer has been
+     * used; otherwise it is built in \c local.
+     *
+     * @param  context  context of the parent value
+     * @param  name     name of the child, which is enclosed in brackets to
+     *                  make the last element of the context
+     * @param  scratch  optional pointer to ValidationScratch object
+     * @param  local    storage used when scratch storage is not available
+     */
+    static const std::vector<std::string> & childContext(const std::vector<std::string> &context,
+            const adapters::ObjectMemberKey &name, ValidationScratch *scratch, std::vector<std::string> &local)
+    {
+        std::vector<std::string> &newContext = scratch ? scratch->contextBuffer(context.size() + 1) : local;
+        newContext.resize(context.size() + 1);
+        std::copy(context.begin(), context.end(), newContext.begin());
+        std::string &element = newContext.back();
+        element.assign(1, '[');
+        element.append(name.data(), name.size());
+        element.push_back(']');
+        return newContext;
+    }
+
+    /**
+     * @brief  Return the context for an array item
+     *
+     * @see childContext(const std::vector<std::string> &, const adapters::ObjectMemberKey &,
+     *                   ValidationScratch *, std::vector<std::string> &)
+     */
+    static const std::vector<std::string> & childContext(const std::vector<std::string> &context,
+            size_t index, ValidationScratch *scratch, std::vector<std::string> &local)
+    {
+        const std::string name = std::to_string(index);
+        return childContext(context, adapters::ObjectMemberKey(name), scratch, local);
+    }
+
+    /**
+     * @brief  Validate a child of the target against a sub-schema
+     *
+     * @param  value     array item or object member value to validate
+     * @param  name      index of an array item, or name of an object member
+     * @param  schema    sub-schema that the child must validate against
+     *
+     * @returns  \c true if validation succeeds; \c false otherwise
+     */
+    template<typename Name>
+    bool validateChild(const AdapterType &value, const Name &name, const Subschema &schema)
+    {
+        std::vector<std::string> localContext;
+        const std::vector<std::string> &newContext = childContext(m_context, name, m_state->scratch, localContext);
+        recordNodeVisited(m_state->stats);
+
+        ValidationVisitor validator(value, newContext, strictTypes(), m_results, m_state);
+        return validator.validateSchema(schema);
+    }
+
+    /**
+     * @brief  Return a std::string holding the name of an object member, so
+     *         that it can be looked up in an object
+     *
+     * The name is copied into a buffer in scratch storage when it is
+     * available, which avoids allocating memory once the buffer is large
+     * enough, or into \c local otherwise. Either way, the result is only valid
+     * until the next call.
+     */
+    static const std::string & memberKey(const char *name, const ValidationState<RegexEngine> &state,
+            std::string &local)
+    {
+        std::string &key = state.scratch ? state.scratch->keyBuffer() : local;
+        key.assign(name);
+        return key;
+    }
+
+    /**
+     * @brief  Append a string, or a number formatted as by std::to_string(),
+     *         to an error description
+     */
+    static void appendDescription(ValidationScratch::String &description, const char *part)
+    {
+        description.append(part);
+    }
+
+    template<typename Allocator>
+    static void appendDescription(ValidationScratch::String &description,
+            const std::basic_string<char, std::char_traits<char>, Allocator> &part)
+    {
+        description.append(part.data(), part.size());
+    }
+
+    static void appendDescription(ValidationScratch::String &description, const adapters::ObjectMemberKey &part)
+    {
+        description.append(part.data(), part.size());
+    }
+
+    template<typename Number>
+    static typename std::enable_if<std::is_arithmetic<Number>::value>::type
+    appendDescription(ValidationScratch::String &description, Number part)
+    {
+        char buffer[std::numeric_limits<double>::max_exponent10 + 20];
+        if (std::is_floating_point<Number>::value) {
+            snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(part));
+        } else if (std::is_signed<Number>::value) {
+            snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(part));
+        } else {
+            snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(part));
+        }
+        description.append(buffer);
+    }
+
+    static void appendDescriptionParts(ValidationScratch::String &) { }
+
+    template<typename Part, typename... Parts>
+    static void appendDescriptionParts(ValidationScratch::String &description, const Part &part,
+            const Parts &... parts)
+    {
+        appendDescription(description, part);
+        appendDescriptionParts(description, parts...);
+    }
+
+    /**
+     * @brief  Add an error whose description is made by joining several parts
+     *
+     * The description is built in scratch storage when it is available, so
+     * that reporting an error does not allocate a temporary string once the
+     * buffer is large enough. Otherwise it is built using the allocator of
+     * the validation state.
+     *
+     * @param  results  results to add the error to
+     * @param  state    state of the validation
+     * @param  context  context of the error
+     * @param  parts    strings and numbers that make up the description
+     */
+    template<typename... Parts>
+    static void reportError(ValidationResults &results, const ValidationState<RegexEngine> &state,
+            const std::vector<std::string> &context, const Parts &... parts)
+    {
+        ValidationScratch::String local(state.template allocator<char>());
+        ValidationScratch::String &description = state.scratch ? state.scratch->descriptionBuffer() : local;
+        description.clear();
+        appendDescriptionParts(description, parts...);
+        results.pushError(context, description.data(), description.size());
+    }
+
+    /**
+     * @brief  Validate a range of array items or object members
+     *
+     * The function \c fn is called with a ValidationVisitor whose results,
+     * regex cache and stats should be used to validate an item, an iterator
+     * for the item, and the offset of the item in the range. It must return
+     * \c false if the item is invalid.
+     *
+     * When a thread pool has been provided and the range is large enough, the
+     * items are divided into tasks that are run in parallel. Errors are then
+     * reported in the same order that they would be by serial validation.
+     *
+     * @param  begin  iterator for the first item in the range
+     * @param  end    iterator one-past the last item in the range
+     * @param  size   number of items in the range
+     * @param  fn     function to validate a single item
+     *
+     * @returns  \c true if all items are valid; \c false otherwise
+     */
+    template<typename Iterator, typename Fn>
+    bool validateRange(const Iterator &begin, const Iterator &end, size_t size, const Fn &fn)
+    {
+        const size_t numTasks = parallelTasks(size);
+        if (numTasks > 0) {
+            return validateRangeInParallel(begin, size, numTasks, fn);
+        }
+
+        bool validated = true;
+        size_t offset = 0;
+        for (Iterator itr = begin; itr != end; ++itr) {
+            if (isCancelled()) {
+                return false;
+            }
+
+            if (!fn(*this, itr, offset)) {
+                if (!m_results) {
+                    return false;
+                }
+                validated = false;
+            }
+            offset++;
+        }
+
+        return validated;
+    }
+
+    /**
+     * @brief  Return the number of tasks that a range of items should be
+     *         divided into, or zero if it should be validated serially
+     *
+     * Observers and instrumentation are not thread-safe, so ranges are always
+     * validated serially while either is in use.
+     */
+    size_t parallelTasks(size_t size) const
+    {
+        if (!m_state->parallel || m_state->observer || (m_state->instrumentation && m_state->instrumentation->isEnabled())) {
+            return 0;
+        }
+
+        return m_state->parallel->numTasks(size);
+    }
+
+    /**
+     * @brief  Validate a range of items by running tasks on a thread pool
+     *
+     * Each task validates a contiguous part of the range, with its own
+     * ValidationResults, regex cache and ValidationStats. Tasks look up
+     * regexes in the caches of this visitor before compiling their own. Once
+     * all of the tasks are complete, their errors are appended to the results
+     * in order, their stats are added to the stats for this visitor, and the
+     * regexes that they compiled are kept for later use.
+     */
+    template<typename Iterator, typename Fn>
+    bool validateRangeInParallel(const Iterator &begin, size_t size, size_t numTasks, const Fn &fn)
+    {
+        struct TaskResult
+        {
+            TaskResult()
+              : validated(true) { }
+
+            bool validated;
+            ValidationResults results;
+            ValidationStats stats;
+            std::unordered_map<std::string, RegexEngine> regexesCache;
+            ValidationScratch scratch;
+        };
+
+        // Find the first item for each task, with any left over items given
+        // to the first few tasks
+        const size_t itemsPerTask = size / numTasks;
+        const size_t extraItems = size % numTasks;
+        std::vector<Iterator> firstItems;
+        firstItems.reserve(numTasks);
+        Iterator itr = begin;
+        for (size_t task = 0; task < numTasks; task++) {
+            firstItems.push_back(itr);
+            const size_t numItems = itemsPerTask + (task < extraItems ? 1 : 0);
+            for (size_t i = 0; i < numItems; i++) {
+                ++itr;
+            }
+        }
+
+        std::vector<TaskResult> taskResults(numTasks);
+        std::atomic<bool> failed(false);
+
+        m_state->parallel->pool->parallelFor(numTasks,
+                [this, &fn, &firstItems, &taskResults, &failed, itemsPerTask, extraItems](size_t task) {
+            TaskResult &taskResult = taskResults[task];
+            if (m_state->stats) {
+                internal::ValidationDepthTracker::inherit(taskResult.stats, *m_state->stats);
+            }
+
+            // Observers and instrumentation are never attached here, because
+            // ranges are only validated in parallel when neither is in use
+            ValidationState<RegexEngine> taskState(taskResult.regexesCache);
+            taskState.stats = m_state->stats ? &taskResult.stats : nullptr;
+            taskState.parallel = m_state->parallel;
+            taskState.cancelled = m_state->cancelled;
+            taskState.scratch = m_state->scratch ? &taskResult.scratch : nullptr;
+            taskState.parent = m_state;
+            ValidationVisitor visitor(m_target, m_context, strictTypes(), m_results ? &taskResult.results : nullptr,
+                    &taskState);
+
+            const size_t numItems = itemsPerTask + (task < extraItems ? 1 : 0);
+            const size_t firstOffset = task * itemsPerTask + std::min(task, extraItems);
+            Iterator taskItr = firstItems[task];
+            for (size_t i = 0; i < numItems; i++, ++taskItr) {
+                // Without results, there is no need to continue once any
+                // task has found an invalid item
+                if ((!m_results && failed.load(std::memory_order_relaxed)) || isCancelled()) {
+                    taskResult.validated = false;
+                    return;
+                }
+
+                if (!fn(visitor, taskItr, firstOffset + i)) {
+                    taskResult.validated = false;
+                    if (!m_results) {
+                        failed.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        });
+
+        bool validated = true;
+        for (TaskResult &taskResult : taskResults) {
+            validated = validated && taskResult.validated;
+            if (m_results) {
+                m_results->appendErrors(taskResult.results);
+            }
+            if (m_state->stats) {
+                m_state->stats->add(taskResult.stats);
+            }
+            for (auto &entry : taskResult.regexesCache) {
+                m_state->regexesCache.emplace(entry.first, std::move(entry.second));
+            }
+            if (m_state->scratch) {
+                m_state->scratch->mergeRegexes(taskResult.scratch);
+            }
+        }
+
+        return validated;
+    }
+
+    /**
+     * @brief  Count a child value that is about to be validated
+     */
+    static void recordNodeVisited(ValidationStats *stats)
+    {
+#if VALIJSON_USE_INSTRUMENTATION
+        if (stats) {
+            stats->nodesVisited++;
+        }
+#endif
+    }
+
+    /**
+     * @brief  Count a lookup of a compiled regular expression
+     *
+     * @param  stats     optional pointer to ValidationStats object
+     * @param  cacheHit  true if a compiled regular expression was reused
+     */
+    static void recordRegexLookup(ValidationStats *stats, bool cacheHit)
+    {
+#if VALIJSON_USE_INSTRUMENTATION
+        if (stats) {
+            if (cacheHit) {
+                stats->regexCacheHits++;
+            } else {
+                stats->regexCacheMisses++;
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief  Count a regular expression search
+     */
+    static void recordRegexSearch(ValidationStats *stats)
+    {
+#if VALIJSON_USE_INSTRUMENTATION
+        if (stats) {
+            stats->regexInvocations++;
+        }
+#endif
+    }
+
+    /**
+     * @brief  Count a comparison between two values
+     *
+     * @param  stats  optional pointer to ValidationStats object
+     */
+    static void recordValueComparison(ValidationStats *stats)
+    {
+#if VALIJSON_USE_INSTRUMENTATION
+        if (stats) {
+            stats->valueComparisons++;
+        }
+#endif
+    }
+
     /**
      * @brief  Callback function that passes a visitor to a constraint.
      *
@@ -1842,7 +2725,7 @@ private:
      *
      * @return  true if the visitor returns successfully, false otherwise.
      */
-    static bool validationCallback(const constraints::Constraint &constraint, ValidationVisitor<AdapterType, RegexEngine> &visitor)
+    static bool validationCallback(const constraints::Constraint &constraint, ValidationVisitor<AdapterType, RegexEngine, Policy> &visitor)
     {
         return constraint.accept(visitor);
     }
@@ -1892,7 +2775,7 @@ private:
     AdapterType m_target;
 
     /// Vector of strings describing the current object context
-    std::vector<std::string> m_context;
+    const std::vector<std::string> &m_context;
 
     /// Optional pointer to a ValidationResults object to be populated
     ValidationResults *m_results;
@@ -1900,8 +2783,8 @@ private:
     /// Option to use strict type comparison
     bool m_strictTypes;
 
-    /// Cached regex objects for pattern constraint
-    std::unordered_map<std::string, RegexEngine>& m_regexesCache;
+    /// State shared by all of the visitors for this validation
+    ValidationState<RegexEngine> * const m_state;
 };
 
 }  // namespace valijson
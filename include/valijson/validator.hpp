@@ -1,6 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+
+#include <valijson/exceptions.hpp>
+#include <valijson/instrumentation.hpp>
 #include <valijson/schema.hpp>
+#include <valijson/type_checking_policy.hpp>
+#include <valijson/validation_metrics.hpp>
+#include <valijson/validation_observer.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validation_thread_pool.hpp>
 #include <valijson/validation_visitor.hpp>
 
 namespace valijson {
@@ -13,9 +24,11 @@ class ValidationResults;
  * @brief   Class that provides validation functionality.
  *
  * @tparam  RegexEngine regular expression engine used for pattern constraint validation.
-
+ * @tparam  Policy      whether the type checking mode is chosen at runtime (the
+ *                      default), or fixed at compile time. When it is fixed, the
+ *                      TypeCheckingMode passed to the constructor is ignored.
  */
-template <typename RegexEngine>
+template <typename RegexEngine, TypeCheckingPolicy Policy = kRuntimeTypeChecking>
 class ValidatorT
 {
 public:
@@ -29,7 +42,12 @@ public:
      * @brief  Construct a Validator that uses strong type checking by default
      */
     ValidatorT()
-      : strictTypes(true) { }
+      : strictTypes(Policy != kWeakTypeChecking),
+        instrumentation(nullptr),
+        observer(nullptr),
+        metrics(nullptr),
+        cancellationFlag(nullptr),
+        scratch(nullptr) { }
 
     /**
      * @brief  Construct a Validator using a specific type checking mode
@@ -37,7 +55,178 @@ public:
      * @param  typeCheckingMode  choice of strong or weak type checking
      */
     ValidatorT(TypeCheckingMode typeCheckingMode)
-      : strictTypes(typeCheckingMode == kStrongTypes) { }
+      : strictTypes(Policy == kRuntimeTypeChecking ? typeCheckingMode == kStrongTypes :
+                Policy == kStrongTypeChecking),
+        instrumentation(nullptr),
+        observer(nullptr),
+        metrics(nullptr),
+        cancellationFlag(nullptr),
+        scratch(nullptr) { }
+
+    /**
+     * @brief  Attach an Instrumentation object to record per-constraint
+     *         statistics during subsequent calls to validate()
+     *
+     * The Instrumentation object is not owned by the Validator, and must
+     * outlive any validation that uses it. Pass nullptr to detach it.
+     *
+     * Using this function when VALIJSON_USE_INSTRUMENTATION is defined to 0
+     * is a compile error, since the hooks that record statistics have been
+     * removed.
+     *
+     * @param  newInstrumentation  pointer to Instrumentation object, or nullptr
+     */
+    void setInstrumentation(Instrumentation *newInstrumentation)
+    {
+#if !VALIJSON_USE_INSTRUMENTATION
+        // Depends on a template parameter, so only fails when this is used
+        static_assert(sizeof(RegexEngine) == 0,
+                "setInstrumentation() requires VALIJSON_USE_INSTRUMENTATION");
+#endif
+        instrumentation = newInstrumentation;
+    }
+
+    /**
+     * @brief  Attach a ValidationObserver to be notified as sub-schemas and
+     *         constraints are applied during subsequent calls to validate()
+     *
+     * The observer is not owned by the Validator, and must outlive any
+     * validation that uses it. Pass nullptr to detach it.
+     *
+     * Using this function when VALIJSON_USE_INSTRUMENTATION is defined to 0
+     * is a compile error, since the observer would never be notified.
+     *
+     * @param  newObserver  pointer to ValidationObserver, or nullptr
+     */
+    void setObserver(ValidationObserver *newObserver)
+    {
+#if !VALIJSON_USE_INSTRUMENTATION
+        // Depends on a template parameter, so only fails when this is used
+        static_assert(sizeof(RegexEngine) == 0,
+                "setObserver() requires VALIJSON_USE_INSTRUMENTATION");
+#endif
+        observer = newObserver;
+    }
+
+    /**
+     * @brief  Attach a ValidationMetrics object, to be updated after each
+     *         subsequent call to validate()
+     *
+     * The ValidationMetrics object is not owned by the Validator, and must
+     * outlive any validation that uses it. It may be shared by Validators that
+     * are used on different threads. Pass nullptr to detach it.
+     *
+     * ValidationStats counters are only collected when
+     * VALIJSON_USE_INSTRUMENTATION is enabled (the default), so attaching a
+     * ValidationMetrics object that collects them is a logic error when it
+     * has been defined to 0.
+     *
+     * @param  newMetrics  pointer to ValidationMetrics object, or nullptr
+     */
+    void setMetrics(ValidationMetrics *newMetrics)
+    {
+#if !VALIJSON_USE_INSTRUMENTATION
+        if (newMetrics && newMetrics->collectsStats()) {
+            throwLogicError("ValidationMetrics cannot collect stats when VALIJSON_USE_INSTRUMENTATION is 0");
+        }
+#endif
+        metrics = newMetrics;
+    }
+
+    /**
+     * @brief  Attach a ValidationThreadPool, to be used to validate large
+     *         arrays and objects in parallel during subsequent calls to
+     *         validate()
+     *
+     * Items from arrays (validated against 'items' or 'additionalItems') and
+     * members from objects (validated against 'properties',
+     * 'patternProperties' or 'additionalProperties') are divided into tasks
+     * of at least \c minItemsPerTask items each. This only happens when there
+     * are at least \c minItems of them, and enough for two or more tasks, so
+     * with the defaults an array needs 4096 items before it is split. The
+     * number of tasks is capped at four per thread, including the thread
+     * that called validate(). Errors are reported in the same order as they
+     * would be without a pool.
+     *
+     * The pool is not owned by the Validator, and must outlive any validation
+     * that uses it. It may be shared by Validators that are used on different
+     * threads. The document being validated must support concurrent reads.
+     * Parallel validation is not used while an observer or instrumentation is
+     * attached. Pass nullptr to detach the pool.
+     *
+     * @param  pool             pointer to ValidationThreadPool, or nullptr
+     * @param  minItems         minimum size of an array or object to be
+     *                          validated in parallel
+     * @param  minItemsPerTask  minimum number of items in each task; ranges
+     *                          with fewer than twice this many items are
+     *                          validated serially, whatever \c minItems is
+     */
+    void setThreadPool(ValidationThreadPool *pool,
+            size_t minItems = ParallelValidation::kDefaultMinItems,
+            size_t minItemsPerTask = ParallelValidation::kDefaultMinItemsPerTask)
+    {
+        parallel.pool = pool;
+        parallel.minItems = minItems;
+        parallel.minItemsPerTask = minItemsPerTask;
+    }
+
+    /**
+     * @brief  Attach a flag that can be set to cancel subsequent calls to
+     *         validate()
+     *
+     * The flag is checked before each sub-schema is applied, and may be set
+     * from another thread. Once it is set, validate() returns false as soon
+     * as possible, and any errors that it reported should be ignored. The
+     * flag is not owned by the Validator, and must outlive any validation
+     * that uses it. Pass nullptr to detach it.
+     *
+     * @param  flag  pointer to cancellation flag, or nullptr
+     */
+    void setCancellationFlag(const std::atomic<bool> *flag)
+    {
+        cancellationFlag = flag;
+    }
+
+    /**
+     * @brief  Attach a ValidationScratch object, whose storage will be reused
+     *         by subsequent calls to validate()
+     *
+     * The ValidationScratch object is not owned by the Validator, and must
+     * outlive any validation that uses it. It must not be used by more than
+     * one validation at a time, so a Validator that is to be used on other
+     * threads should be copied using concurrentCopy(). Pass nullptr to detach
+     * it. See also ValidationSession.
+     *
+     * @param  newScratch  pointer to ValidationScratch object, or nullptr
+     */
+    void setScratch(ValidationScratch *newScratch)
+    {
+        scratch = newScratch;
+    }
+
+    /**
+     * @brief  Return a copy of this Validator that may be used on another
+     *         thread at the same time as this one, and as other such copies
+     *
+     * The type checking mode, ValidationMetrics object, thread pool and
+     * cancellation flag are kept, because they can be shared between threads.
+     * Scratch storage is not kept; the copy may be given its own using
+     * setScratch(). Observers and Instrumentation objects are not thread-safe,
+     * so calling this function while either is attached is a logic error.
+     *
+     * @returns  copy of this Validator, without scratch storage
+     */
+    ValidatorT concurrentCopy() const
+    {
+        if (observer || instrumentation) {
+            throwLogicError("A Validator with an observer or instrumentation attached cannot be "
+                    "used on more than one thread");
+        }
+
+        ValidatorT copy(*this);
+        copy.scratch = nullptr;
+        return copy;
+    }
 
     /**
      * @brief  Validate a JSON document and optionally return the results.
@@ -56,26 +245,111 @@ public:
      * @param  results  An optional pointer to a ValidationResults instance that
      *                  will be used to report validation errors
      *
+     * @param  stats    An optional pointer to a ValidationStats instance that
+     *                  will be reset, then populated with counters describing
+     *                  the work performed during validation; passing one is
+     *                  a logic error when VALIJSON_USE_INSTRUMENTATION is 0
+     *
      * @returns  true if validation succeeds, false otherwise
      */
     template<typename AdapterType>
     bool validate(const Subschema &schema, const AdapterType &target,
-            ValidationResults *results)
+            ValidationResults *results, ValidationStats *stats = nullptr)
     {
+#if !VALIJSON_USE_INSTRUMENTATION
+        if (stats) {
+            throwLogicError("ValidationStats cannot be collected when VALIJSON_USE_INSTRUMENTATION is 0");
+        }
+#endif
+
+        if (metrics) {
+            return validateWithMetrics(schema, target, results, stats);
+        }
+
+        return validateRoot(schema, target, results, stats);
+    }
+
+private:
+
+    /**
+     * @brief  Validate a JSON document, starting from the root sub-schema
+     */
+    template<typename AdapterType>
+    bool validateRoot(const Subschema &schema, const AdapterType &target,
+            ValidationResults *results, ValidationStats *stats)
+    {
+        if (stats) {
+            stats->reset();
+        }
+
+        std::vector<std::string> localContext;
+        std::vector<std::string> &context = scratch ? scratch->contextBuffer(1) : localContext;
+        context.assign(1, "<root>");
+
+        ValidationState<RegexEngine> state(regexesCache);
+        state.instrumentation = instrumentation;
+        state.observer = observer;
+        state.stats = stats;
+        state.parallel = parallel.pool ? &parallel : nullptr;
+        state.cancelled = cancellationFlag;
+        state.scratch = scratch;
+
         // Construct a ValidationVisitor to perform validation at the root level
-        ValidationVisitor<AdapterType, RegexEngine> v(target,
-                std::vector<std::string>(1, "<root>"), strictTypes, results, regexesCache);
+        ValidationVisitor<AdapterType, RegexEngine, Policy> v(target,
+                context, strictTypes, results, &state);
 
         return v.validateSchema(schema);
     }
 
-private:
+    /**
+     * @brief  Validate a JSON document, and record the outcome in the attached
+     *         ValidationMetrics object
+     */
+    template<typename AdapterType>
+    bool validateWithMetrics(const Subschema &schema, const AdapterType &target,
+            ValidationResults *results, ValidationStats *stats)
+    {
+        ValidationStats localStats;
+        if (!stats && metrics->collectsStats()) {
+            stats = &localStats;
+        }
+
+        const size_t initialErrors = results ? results->numErrors() : 0;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool validated = validateRoot(schema, target, results, stats);
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        const size_t errors = results ? results->numErrors() - initialErrors : 0;
+        metrics->record(validated, errors,
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()),
+                stats);
+
+        return validated;
+    }
 
     /// Flag indicating that strict type comparisons should be used
     bool strictTypes;
 
     /// Cached regex objects for pattern constraint. Key - pattern.
     std::unordered_map<std::string, RegexEngine> regexesCache;
+
+    /// Optional pointer to an Instrumentation object to be populated
+    Instrumentation *instrumentation;
+
+    /// Optional pointer to a ValidationObserver to be notified of progress
+    ValidationObserver *observer;
+
+    /// Optional pointer to a ValidationMetrics object to be updated
+    ValidationMetrics *metrics;
+
+    /// Settings for parallel validation of large arrays and objects
+    ParallelValidation parallel;
+
+    /// Optional pointer to a flag that is set to cancel validation
+    const std::atomic<bool> *cancellationFlag;
+
+    /// Optional pointer to storage that is reused between validations
+    ValidationScratch *scratch;
 };
 
 /**
@@ -97,4 +371,8 @@ private:
 
 using Validator = ValidatorT<DefaultRegexEngine>;
 
+/// Validator that always uses strong type checking, with weak type checking
+/// compiled out
+using StrongTypesValidator = ValidatorT<DefaultRegexEngine, kStrongTypeChecking>;
+
 }  // namespace valijson
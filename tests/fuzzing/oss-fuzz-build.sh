@@ -30,3 +30,12 @@ find "${SRC}/valijson/thirdparty/JSON-Schema-Test-Suite/tests" -name "*.json" |
 done
 
 zip -j -r "${OUT}/fuzzer_seed_corpus.zip" seed_corpus
+
+# shellcheck disable=SC2086
+"$CXX" $CXXFLAGS "$LIB_FUZZING_ENGINE" \
+    -DVALIJSON_USE_EXCEPTIONS=1 \
+	-I/src/valijson/thirdparty/rapidjson/include \
+	-I/src/valijson/include \
+	perf_fuzzer.cpp -o "${OUT}/perf_fuzzer"
+
+zip -j -r "${OUT}/perf_fuzzer_seed_corpus.zip" seed_corpus slow_cases
@@ -0,0 +1,210 @@
+// Fuzz target that looks for inputs that are disproportionately expensive to
+// validate, rather than inputs that crash. Inputs use the same format as the
+// JSON-Schema-Test-Suite (and fuzzer.cpp). The cost of an input is the number
+// of constraints evaluated while validating every test in it. Inputs whose
+// cost or running time exceed a threshold are reported and the process is
+// aborted, so that the fuzzing engine saves (and can minimise) the input.
+//
+// Thresholds can be set using environment variables:
+//
+//   VALIJSON_PERF_FUZZ_COST_PER_BYTE   max constraint evaluations per input
+//                                      byte (default: 1000)
+//   VALIJSON_PERF_FUZZ_MILLISECONDS    max milliseconds per input
+//                                      (default: 250)
+//
+// When compiled with -DVALIJSON_PERF_FUZZ_DRIVER, a main() function is
+// provided that runs each file named on the command line, prints its cost,
+// and returns non-zero if any file exceeds a threshold. This can be used to
+// check a corpus of slow cases without a fuzzing engine.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <valijson/adapters/rapidjson_adapter.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationStats;
+using valijson::Validator;
+using valijson::adapters::AdapterTraits;
+using valijson::adapters::RapidJsonAdapter;
+using AdapterType = RapidJsonAdapter;
+
+namespace {
+
+struct Cost
+{
+    Cost()
+      : constraints(0),
+        milliseconds(0) { }
+
+    uint64_t constraints;
+    double milliseconds;
+};
+
+uint64_t maxCostPerByte = 1000;
+double maxMilliseconds = 250;
+
+void readThresholds()
+{
+    if (const char *value = std::getenv("VALIJSON_PERF_FUZZ_COST_PER_BYTE")) {
+        maxCostPerByte = std::strtoull(value, nullptr, 10);
+    }
+
+    if (const char *value = std::getenv("VALIJSON_PERF_FUZZ_MILLISECONDS")) {
+        maxMilliseconds = std::strtod(value, nullptr);
+    }
+}
+
+void runOneTest(const AdapterType &test, const Schema &schema,
+                Validator::TypeCheckingMode mode, Cost &cost)
+{
+    try {
+        if (!test.isObject()) {
+            return;
+        }
+
+        const AdapterType::Object testObject = test.getObject();
+        const auto dataItr = testObject.find("data");
+
+        if (dataItr == testObject.end()) {
+            return;
+        }
+
+        Validator validator(mode);
+        ValidationResults results;
+        ValidationStats stats;
+        validator.validate(schema, dataItr->second, &results, &stats);
+        cost.constraints += stats.totalConstraintsEvaluated();
+    } catch (const std::exception &) {
+    }
+}
+
+Cost measure(const uint8_t *data, size_t size)
+{
+    Cost cost;
+
+    AdapterTraits<AdapterType>::DocumentType document;
+    document.template Parse<rapidjson::kParseIterativeFlag>(reinterpret_cast<const char *>(data), size);
+
+    if (document.HasParseError() || !document.IsArray()) {
+        return cost;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto &testCase : AdapterType(document).getArray()) {
+        if (!testCase.isObject()) {
+            continue;
+        }
+
+        const AdapterType::Object object = testCase.getObject();
+        const auto schemaItr = object.find("schema");
+        const auto testsItr = object.find("tests");
+
+        if (schemaItr == object.end() || testsItr == object.end() ||
+            !testsItr->second.isArray()) {
+            continue;
+        }
+
+        Schema schema;
+        SchemaParser parser(size % 2 ? SchemaParser::kDraft4
+                                     : SchemaParser::kDraft7);
+
+        try {
+            parser.populateSchema(schemaItr->second, schema);
+        } catch (const std::exception &) {
+            continue;
+        }
+
+        const auto mode = testsItr->second.hasStrictTypes()
+                              ? Validator::kStrongTypes
+                              : Validator::kWeakTypes;
+
+        for (const AdapterType test : testsItr->second.getArray()) {
+            runOneTest(test, schema, mode, cost);
+        }
+    }
+
+    cost.milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+    return cost;
+}
+
+bool exceedsThresholds(const Cost &cost, size_t size)
+{
+    return cost.constraints > maxCostPerByte * (size > 0 ? size : 1) ||
+           cost.milliseconds > maxMilliseconds;
+}
+
+void report(const Cost &cost, size_t size, const char *name)
+{
+    std::fprintf(stderr, "%s: %llu constraint evaluations (%.1f per byte), %.3f ms, %zu bytes\n",
+                 name, static_cast<unsigned long long>(cost.constraints),
+                 size > 0 ? static_cast<double>(cost.constraints) / size : 0.0,
+                 cost.milliseconds, size);
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    readThresholds();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const Cost cost = measure(data, size);
+    if (exceedsThresholds(cost, size)) {
+        report(cost, size, "slow input");
+        std::abort();
+    }
+
+    return 0;
+}
+
+#ifdef VALIJSON_PERF_FUZZ_DRIVER
+
+int main(int argc, char *argv[])
+{
+    readThresholds();
+
+    int slow = 0;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::cerr << argv[i] << ": could not be opened" << std::endl;
+            return 2;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string input = buffer.str();
+
+        const Cost cost = measure(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+        report(cost, input.size(), argv[i]);
+        if (exceedsThresholds(cost, input.size())) {
+            slow++;
+        }
+    }
+
+    if (slow > 0) {
+        std::cerr << slow << " input(s) exceeded thresholds" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
@@ -9,12 +9,14 @@
 #include <gtest/gtest.h>
 
 #include <valijson/adapters/json11_adapter.hpp>
+#include <valijson/adapters/json_tape_adapter.hpp>
 #include <valijson/adapters/jsoncpp_adapter.hpp>
 #include <valijson/adapters/nlohmann_json_adapter.hpp>
 #include <valijson/adapters/picojson_adapter.hpp>
 #include <valijson/adapters/rapidjson_adapter.hpp>
 
 #include <valijson/utils/json11_utils.hpp>
+#include <valijson/utils/json_tape_utils.hpp>
 #include <valijson/utils/jsoncpp_utils.hpp>
 #include <valijson/utils/nlohmann_json_utils.hpp>
 #include <valijson/utils/picojson_utils.hpp>
@@ -467,6 +469,38 @@ TEST_F(TestAdapterComparison, NlohmannJsonVsPropertyTree)
 
 #endif // VALIJSON_BUILD_BOOST_PROPERTY_TREE_ADAPTER
 
+//
+// JsonTapeAdapter vs X
+// ------------------------------------------------------------------------------------------------
+
+TEST_F(TestAdapterComparison, JsonTapeVsJsonTape)
+{
+    testComparison<
+            valijson::adapters::JsonTapeAdapter,
+            valijson::adapters::JsonTapeAdapter>();
+}
+
+TEST_F(TestAdapterComparison, JsonTapeVsJsonCpp)
+{
+    testComparison<
+            valijson::adapters::JsonTapeAdapter,
+            valijson::adapters::JsonCppAdapter>();
+}
+
+TEST_F(TestAdapterComparison, JsonTapeVsNlohmannJson)
+{
+    testComparison<
+            valijson::adapters::JsonTapeAdapter,
+            valijson::adapters::NlohmannJsonAdapter>();
+}
+
+TEST_F(TestAdapterComparison, JsonTapeVsRapidJson)
+{
+    testComparison<
+            valijson::adapters::JsonTapeAdapter,
+            valijson::adapters::RapidJsonAdapter>();
+}
+
 //
 // QtJsonAdapter vs X
 // ------------------------------------------------------------------------------------------------
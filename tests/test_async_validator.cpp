@@ -0,0 +1,338 @@
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/async_validator.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_observer.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::AsyncValidationResult;
+using valijson::AsyncValidator;
+using valijson::CancellationToken;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::Subschema;
+using valijson::ValidationObserver;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace constraints = valijson::constraints;
+
+namespace {
+
+/**
+ * Executor that queues tasks until they are run explicitly, in the same way
+ * as an event loop
+ */
+class QueueExecutor
+{
+public:
+    AsyncValidator::Executor executor()
+    {
+        return [this](std::function<void()> task) {
+            m_tasks.push_back(std::move(task));
+        };
+    }
+
+    size_t runAll()
+    {
+        const size_t n = m_tasks.size();
+        std::vector<std::function<void()>> tasks;
+        tasks.swap(m_tasks);
+        for (const std::function<void()> &task : tasks) {
+            task();
+        }
+
+        return n;
+    }
+
+private:
+    std::vector<std::function<void()>> m_tasks;
+};
+
+/**
+ * Constraint that cancels a token once it has been validated a number of times
+ */
+class CancellingConstraint: public constraints::PolyConstraint
+{
+public:
+    CancellingConstraint(CancellationToken token, size_t limit, size_t *validated)
+      : m_token(std::move(token)),
+        m_limit(limit),
+        m_validated(validated) { }
+
+    Constraint * cloneInto(void *ptr) const override
+    {
+        return new (ptr) CancellingConstraint(m_token, m_limit, m_validated);
+    }
+
+    size_t sizeOf() const override
+    {
+        return sizeof(CancellingConstraint);
+    }
+
+    bool validate(const valijson::adapters::Adapter &, const std::vector<std::string> &,
+            valijson::ValidationResults *) const override
+    {
+        if (++*m_validated == m_limit) {
+            m_token.cancel();
+        }
+
+        return true;
+    }
+
+private:
+    mutable CancellationToken m_token;
+    const size_t m_limit;
+    size_t * const m_validated;
+};
+
+/**
+ * Observer that does nothing, used to check that observers are rejected
+ */
+class NullObserver: public ValidationObserver
+{
+public:
+    void enterSubschema(const Subschema &, const std::vector<std::string> &) override { }
+
+    void exitSubschema(const Subschema &, const std::vector<std::string> &, bool) override { }
+
+    void enterConstraint(const Subschema &, const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &) override { }
+
+    void exitConstraint(const Subschema &, const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &, bool) override { }
+};
+
+}  // end anonymous namespace
+
+class TestAsyncValidator : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "array",
+            "items": {
+                "type": "object",
+                "properties": {
+                    "id": { "type": "integer" },
+                    "name": { "type": "string" }
+                },
+                "required": ["id"]
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+
+        for (int i = 0; i < 100; i++) {
+            valid.push_back({{"id", i}, {"name", "item"}});
+        }
+
+        invalid = valid;
+        invalid[10]["id"] = "ten";
+    }
+
+    Schema schema;
+    nlohmann::json valid;
+    nlohmann::json invalid;
+};
+
+TEST_F(TestAsyncValidator, Future)
+{
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+
+    std::future<AsyncValidationResult> validResult = validator.validate(schema, NlohmannJsonAdapter(valid));
+    std::future<AsyncValidationResult> invalidResult = validator.validate(schema, NlohmannJsonAdapter(invalid));
+
+    // Nothing is validated until the executor runs the tasks
+    EXPECT_EQ(std::future_status::timeout, validResult.wait_for(std::chrono::seconds(0)));
+    EXPECT_EQ(2u, loop.runAll());
+
+    EXPECT_EQ(AsyncValidationResult::kValid, validResult.get().status);
+
+    const AsyncValidationResult result = invalidResult.get();
+    EXPECT_EQ(AsyncValidationResult::kInvalid, result.status);
+    EXPECT_GT(result.results.numErrors(), 0u);
+}
+
+TEST_F(TestAsyncValidator, Callback)
+{
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor(), Validator(), false);
+
+    std::vector<AsyncValidationResult::Status> statuses;
+    size_t numErrors = 0;
+    const AsyncValidator::Callback callback = [&statuses, &numErrors](AsyncValidationResult result) {
+        statuses.push_back(result.status);
+        numErrors += result.results.numErrors();
+    };
+
+    validator.validate(schema, NlohmannJsonAdapter(invalid), callback);
+    validator.validate(schema, NlohmannJsonAdapter(valid), callback);
+    EXPECT_TRUE(statuses.empty());
+    loop.runAll();
+
+    ASSERT_EQ(2u, statuses.size());
+    EXPECT_EQ(AsyncValidationResult::kInvalid, statuses[0]);
+    EXPECT_EQ(AsyncValidationResult::kValid, statuses[1]);
+
+    // Errors are not collected when results have been disabled
+    EXPECT_EQ(0u, numErrors);
+}
+
+TEST_F(TestAsyncValidator, CancelBeforeValidation)
+{
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+
+    CancellationToken token;
+    std::future<AsyncValidationResult> result = validator.validate(schema, NlohmannJsonAdapter(valid), token);
+    token.cancel();
+    loop.runAll();
+
+    EXPECT_EQ(AsyncValidationResult::kCancelled, result.get().status);
+}
+
+TEST_F(TestAsyncValidator, CancelDuringValidation)
+{
+    CancellationToken token;
+    size_t validated = 0;
+
+    // Each item is validated against a sub-schema that cancels the token once
+    // it has been applied 20 times
+    Schema cancellingSchema;
+    const Subschema *itemSubschema = cancellingSchema.createSubschema();
+    cancellingSchema.addConstraintToSubschema(CancellingConstraint(token, 20, &validated), itemSubschema);
+    constraints::SingularItemsConstraint itemsConstraint;
+    itemsConstraint.setItemsSubschema(itemSubschema);
+    cancellingSchema.addConstraint(itemsConstraint);
+
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+    std::future<AsyncValidationResult> result =
+            validator.validate(cancellingSchema, NlohmannJsonAdapter(valid), token);
+    loop.runAll();
+
+    const AsyncValidationResult cancelled = result.get();
+    EXPECT_EQ(AsyncValidationResult::kCancelled, cancelled.status);
+    EXPECT_EQ(0u, cancelled.results.numErrors());
+
+    // No more sub-schemas are applied once the token has been cancelled
+    EXPECT_EQ(20u, validated);
+}
+
+TEST_F(TestAsyncValidator, ReuseValidators)
+{
+    valijson::ValidationResults expected;
+    Validator().validate(schema, NlohmannJsonAdapter(invalid), &expected);
+
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+
+    // Validators, and their scratch storage, are reused by later validations,
+    // which report the same errors as a Validator that has not been used
+    for (int i = 0; i < 3; i++) {
+        std::future<AsyncValidationResult> validResult = validator.validate(schema, NlohmannJsonAdapter(valid));
+        std::future<AsyncValidationResult> invalidResult = validator.validate(schema, NlohmannJsonAdapter(invalid));
+        loop.runAll();
+
+        EXPECT_EQ(AsyncValidationResult::kValid, validResult.get().status);
+        const AsyncValidationResult result = invalidResult.get();
+        EXPECT_EQ(AsyncValidationResult::kInvalid, result.status);
+        EXPECT_EQ(expected.numErrors(), result.results.numErrors());
+    }
+}
+
+#if VALIJSON_USE_EXCEPTIONS
+TEST_F(TestAsyncValidator, Exceptions)
+{
+    // Patterns are not compiled until they are used
+    const nlohmann::json schemaDocument = nlohmann::json::parse(R"({ "pattern": "([a-z" })");
+    Schema badSchema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), badSchema);
+
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+    const nlohmann::json target = "text";
+    std::future<AsyncValidationResult> future = validator.validate(badSchema, NlohmannJsonAdapter(target));
+
+    AsyncValidationResult::Status status = AsyncValidationResult::kValid;
+    validator.validate(badSchema, NlohmannJsonAdapter(target), [&status](AsyncValidationResult result) {
+        status = result.status;
+    });
+
+    loop.runAll();
+    EXPECT_ANY_THROW(future.get());
+    EXPECT_EQ(AsyncValidationResult::kError, status);
+}
+
+TEST_F(TestAsyncValidator, RejectObserver)
+{
+    // Observers are not thread-safe, so cannot be used by validations that
+    // may run concurrently
+    NullObserver observer;
+    Validator prototype;
+    prototype.setObserver(&observer);
+
+    QueueExecutor loop;
+    EXPECT_THROW(AsyncValidator(loop.executor(), prototype), std::logic_error);
+}
+#endif
+
+#if VALIJSON_HAS_COROUTINES
+
+namespace {
+
+/// Minimal coroutine type that starts eagerly and is never awaited
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Task validateCoroutine(const AsyncValidator &validator, const Schema &schema, const nlohmann::json &document,
+        std::vector<AsyncValidationResult::Status> &statuses)
+{
+    const AsyncValidationResult result = co_await validator.validateAwaitable(schema, NlohmannJsonAdapter(document));
+    statuses.push_back(result.status);
+}
+
+}  // end anonymous namespace
+
+TEST_F(TestAsyncValidator, Coroutine)
+{
+    QueueExecutor loop;
+    const AsyncValidator validator(loop.executor());
+
+    std::vector<AsyncValidationResult::Status> statuses;
+    validateCoroutine(validator, schema, valid, statuses);
+    validateCoroutine(validator, schema, invalid, statuses);
+
+    // Coroutines are suspended until validation is complete
+    EXPECT_TRUE(statuses.empty());
+    loop.runAll();
+
+    ASSERT_EQ(2u, statuses.size());
+    EXPECT_EQ(AsyncValidationResult::kValid, statuses[0]);
+    EXPECT_EQ(AsyncValidationResult::kInvalid, statuses[1]);
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/binary_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/binary_document.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::CborDocument;
+using valijson::MsgPackDocument;
+using valijson::adapters::CborAdapter;
+using valijson::adapters::MsgPackAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace {
+
+std::string toString(const std::vector<uint8_t> &bytes)
+{
+    return std::string(bytes.begin(), bytes.end());
+}
+
+const char *documents[] = {
+    "null",
+    "[true, false, 0, 127, 128, -1, -32, -33, -129, 65536, -2147483649, 9223372036854775807]",
+    "[1.5, -0.25, 1e300, 3.0]",
+    R"({"a": "", "b": "short", "c": "a string that is longer than thirty one bytes", "d": {}})",
+    R"({"nested": [[1, [2, [3]]], {"x": {"y": {"z": null}}}], "last": "value"})"
+};
+
+}  // namespace
+
+class TestBinaryAdapter : public testing::Test
+{
+protected:
+    template<typename AdapterType>
+    static void testDocument(const std::string &bytes, const nlohmann::json &expected)
+    {
+        typename valijson::adapters::AdapterTraits<AdapterType>::DocumentType document;
+        ASSERT_TRUE( document.parse(bytes.data(), bytes.size()) ) << document.getError();
+
+        const AdapterType adapter(document);
+        EXPECT_TRUE( adapter.equalTo(NlohmannJsonAdapter(expected), true) ) << expected.dump();
+        EXPECT_TRUE( NlohmannJsonAdapter(expected).equalTo(adapter, true) ) << expected.dump();
+
+        valijson::adapters::FrozenValue *frozen = adapter.freeze();
+        EXPECT_TRUE( frozen->equalTo(NlohmannJsonAdapter(expected), true) ) << expected.dump();
+        delete frozen;
+    }
+};
+
+TEST_F(TestBinaryAdapter, MsgPackMatchesJson)
+{
+    for (const char *text : documents) {
+        const nlohmann::json expected = nlohmann::json::parse(text);
+        testDocument<MsgPackAdapter>(toString(nlohmann::json::to_msgpack(expected)), expected);
+    }
+}
+
+TEST_F(TestBinaryAdapter, CborMatchesJson)
+{
+    for (const char *text : documents) {
+        const nlohmann::json expected = nlohmann::json::parse(text);
+        testDocument<CborAdapter>(toString(nlohmann::json::to_cbor(expected)), expected);
+    }
+}
+
+TEST_F(TestBinaryAdapter, BasicObjectIteration)
+{
+    const unsigned int numElements = 20;
+
+    nlohmann::json object = nlohmann::json::object();
+    for (unsigned int i = 0; i < numElements; i++) {
+        object[std::to_string(i)] = { i, "padding" };
+    }
+
+    const std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(object);
+    MsgPackDocument document;
+    ASSERT_TRUE( document.parse(bytes.data(), bytes.size()) );
+
+    MsgPackAdapter adapter(document);
+#if VALIJSON_USE_EXCEPTIONS
+    ASSERT_NO_THROW( adapter.getObject() );
+    ASSERT_ANY_THROW( adapter.getArray() );
+    ASSERT_ANY_THROW( adapter.getBool() );
+    ASSERT_ANY_THROW( adapter.getDouble() );
+    ASSERT_ANY_THROW( adapter.getString() );
+#endif
+    EXPECT_EQ( numElements, adapter.getObject().size() );
+
+    unsigned int count = 0;
+    for (const MsgPackAdapter::ObjectMember member : adapter.getObject()) {
+        ASSERT_TRUE( member.second.isArray() );
+        EXPECT_EQ( object.at(member.first).at(0).get<int64_t>(),
+                member.second.getArray().begin()->getInteger() );
+        count++;
+    }
+    EXPECT_EQ( numElements, count );
+
+    const MsgPackAdapter::Object map = adapter.getObject();
+    ASSERT_NE( map.end(), map.find("19") );
+    EXPECT_EQ( 19, map.find("19")->second.getArray().begin()->getInteger() );
+    EXPECT_EQ( map.end(), map.find("20") );
+}
+
+TEST_F(TestBinaryAdapter, CborIndefiniteLengthsAndTags)
+{
+    // {_ "a": [_ 1, 2], "b": 0("2013-03-21T20:04:00Z"), "c": 1.5 (half)}
+    const unsigned char bytes[] = {
+        0xbf,
+            0x61, 'a', 0x9f, 0x01, 0x02, 0xff,
+            0x61, 'b', 0xc0, 0x74,
+                '2', '0', '1', '3', '-', '0', '3', '-', '2', '1',
+                'T', '2', '0', ':', '0', '4', ':', '0', '0', 'Z',
+            0x61, 'c', 0xf9, 0x3e, 0x00,
+        0xff
+    };
+
+    CborDocument document;
+    ASSERT_TRUE( document.parse(bytes, sizeof(bytes)) ) << document.getError();
+
+    const nlohmann::json expected = {{"a", {1, 2}}, {"b", "2013-03-21T20:04:00Z"}, {"c", 1.5}};
+    CborAdapter adapter(document);
+    EXPECT_TRUE( adapter.equalTo(NlohmannJsonAdapter(expected), true) );
+    EXPECT_EQ( 3u, adapter.getObject().size() );
+    EXPECT_EQ( 2u, adapter.getObject().find("a")->second.getArraySize() );
+}
+
+TEST_F(TestBinaryAdapter, ParseErrors)
+{
+    const std::vector<std::string> invalidMsgPack = {
+        "",
+        "\x92\x01",                 // array missing an element
+        "\x81\x01\x02",             // map key is not a string
+        "\xc4\x01\x00",             // binary
+        "\xd4\x01\x00",             // extension
+        "\xc1",                     // never used
+        std::string("\xdd\xff\xff\xff\xff", 5),
+        "\xa5" "abc",               // truncated string
+        std::string("\x01\x02", 2)  // trailing data
+    };
+
+    for (const std::string &bytes : invalidMsgPack) {
+        MsgPackDocument document;
+        EXPECT_FALSE( document.parse(bytes) );
+        EXPECT_FALSE( document.isValid() );
+        EXPECT_FALSE( document.getError().empty() );
+    }
+
+    const std::vector<std::string> invalidCbor = {
+        "\x9f\x01",                 // indefinite array missing break
+        "\xbf\x61" "a" "\xff",      // indefinite map missing a value
+        "\x42\x01\x02",             // byte string
+        "\x7f\x61" "a" "\xff",      // indefinite string
+        "\xf7",                     // undefined
+        "\xff",                     // unexpected break
+        "\x1c"                      // reserved additional information
+    };
+
+    for (const std::string &bytes : invalidCbor) {
+        CborDocument document;
+        EXPECT_FALSE( document.parse(bytes) );
+        EXPECT_FALSE( document.getError().empty() );
+    }
+}
+
+TEST_F(TestBinaryAdapter, Validation)
+{
+    const nlohmann::json schemaJson = nlohmann::json::parse(R"({
+        "type": "object",
+        "properties": { "id": { "type": "integer" }, "tags": { "items": { "enum": ["a", "b"] } } },
+        "required": ["id"]
+    })");
+
+    valijson::Schema schema;
+    valijson::SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaJson), schema);
+
+    valijson::Validator validator;
+
+    const nlohmann::json valid = {{"id", 7}, {"tags", {"a", "b"}}};
+    const nlohmann::json invalid = {{"id", 7.5}, {"tags", {"c"}}};
+
+    MsgPackDocument msgpack;
+    ASSERT_TRUE( msgpack.parse(toString(nlohmann::json::to_msgpack(valid))) );
+    EXPECT_TRUE( validator.validate(schema, MsgPackAdapter(msgpack), nullptr) );
+    ASSERT_TRUE( msgpack.parse(toString(nlohmann::json::to_msgpack(invalid))) );
+    EXPECT_FALSE( validator.validate(schema, MsgPackAdapter(msgpack), nullptr) );
+
+    CborDocument cbor;
+    ASSERT_TRUE( cbor.parse(toString(nlohmann::json::to_cbor(valid))) );
+    EXPECT_TRUE( validator.validate(schema, CborAdapter(cbor), nullptr) );
+    ASSERT_TRUE( cbor.parse(toString(nlohmann::json::to_cbor(invalid))) );
+    EXPECT_FALSE( validator.validate(schema, CborAdapter(cbor), nullptr) );
+}
@@ -0,0 +1,103 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/observers/coverage_observer.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::observers::CoverageObserver;
+
+namespace constraints = valijson::constraints;
+
+class TestCoverageObserver : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "anyOf": [
+                { "type": "string" },
+                { "type": "integer", "minimum": 0 }
+            ]
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    const CoverageObserver::Entry * findEntry(const std::vector<CoverageObserver::Entry> &entries,
+            const std::string &path)
+    {
+        for (const CoverageObserver::Entry &entry : entries) {
+            if (entry.path == path) {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestCoverageObserver, ReportsHitsAndDeadBranches)
+{
+    CoverageObserver observer;
+    Validator validator;
+    validator.setObserver(&observer);
+
+    const char *corpus[] = { "\"a\"", "\"b\"", "true" };
+    for (const char *text : corpus) {
+        const nlohmann::json document = nlohmann::json::parse(text);
+        validator.validate(schema, NlohmannJsonAdapter(document), nullptr);
+    }
+
+    EXPECT_EQ(3u, observer.documents());
+
+    const std::vector<CoverageObserver::Entry> entries = observer.report(schema);
+
+    // Root, anyOf, two branches, and three constraints in those branches
+    ASSERT_EQ(7u, entries.size());
+
+    const CoverageObserver::Entry *root = findEntry(entries, "#");
+    ASSERT_NE(nullptr, root);
+    EXPECT_EQ(nullptr, root->constraint);
+    EXPECT_EQ(3u, root->hits);
+    EXPECT_EQ(1u, root->failures);
+
+    const CoverageObserver::Entry *anyOf = findEntry(entries, "#/anyOf");
+    ASSERT_NE(nullptr, anyOf);
+    ASSERT_NE(nullptr, anyOf->constraint);
+    EXPECT_EQ(constraints::kAnyOf, anyOf->kind);
+    EXPECT_EQ(3u, anyOf->hits);
+
+    const CoverageObserver::Entry *stringType = findEntry(entries, "#/anyOf/0/type");
+    ASSERT_NE(nullptr, stringType);
+    EXPECT_EQ(3u, stringType->hits);
+    EXPECT_EQ(1u, stringType->failures);
+
+    // Only reached by the 'true' document, which fails the type check
+    const CoverageObserver::Entry *integerType = findEntry(entries, "#/anyOf/1/type");
+    ASSERT_NE(nullptr, integerType);
+    EXPECT_EQ(1u, integerType->hits);
+
+    const CoverageObserver::Entry *minimum = findEntry(entries, "#/anyOf/1/minimum");
+    ASSERT_NE(nullptr, minimum);
+    EXPECT_EQ(0u, minimum->hits);
+
+    std::stringstream ss;
+    observer.write(ss, schema);
+    EXPECT_NE(std::string::npos, ss.str().find("# covered: 6/7\n"));
+    EXPECT_NE(std::string::npos, ss.str().find("#/anyOf/1/minimum\t0\t0\tNEVER\n"));
+
+    observer.clear();
+    EXPECT_EQ(0u, observer.documents());
+    EXPECT_EQ(0u, observer.report(schema)[0].hits);
+}
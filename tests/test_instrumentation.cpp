@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/instrumentation.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Instrumentation;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace constraints = valijson::constraints;
+
+class TestInstrumentation : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "name": { "type": "string", "minLength": 3 },
+                "tags": { "type": "array", "items": { "type": "string" } }
+            },
+            "required": ["name"]
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestInstrumentation, CountsInvocationsAndFailures)
+{
+    Instrumentation instrumentation;
+    Validator validator;
+    validator.setInstrumentation(&instrumentation);
+
+    const nlohmann::json valid = nlohmann::json::parse(R"({"name": "abcd", "tags": ["a", "b"]})");
+    const nlohmann::json invalid = nlohmann::json::parse(R"({"name": "ab"})");
+
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(valid), nullptr));
+    ValidationResults results;
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalid), &results));
+
+    // Root, name, tags and two items on the first pass; root and name on the second
+    const Instrumentation::ConstraintStats types = instrumentation.totalsForKind(constraints::kType);
+    EXPECT_EQ(7u, types.invocations);
+    EXPECT_EQ(0u, types.failures);
+
+    const Instrumentation::ConstraintStats minLength = instrumentation.totalsForKind(constraints::kMinLength);
+    EXPECT_EQ(2u, minLength.invocations);
+    EXPECT_EQ(1u, minLength.failures);
+
+    // Failure in a nested schema propagates to the 'properties' constraint
+    const Instrumentation::ConstraintStats properties = instrumentation.totalsForKind(constraints::kProperties);
+    EXPECT_EQ(2u, properties.invocations);
+    EXPECT_EQ(1u, properties.failures);
+
+    uint64_t histogramTotal = 0;
+    for (size_t i = 0; i < Instrumentation::kNumHistogramBuckets; i++) {
+        histogramTotal += minLength.histogram[i];
+    }
+    EXPECT_EQ(minLength.invocations, histogramTotal);
+    EXPECT_GE(minLength.totalNanoseconds, minLength.maxNanoseconds);
+}
+
+TEST_F(TestInstrumentation, ReportIsKeyedBySubschema)
+{
+    Instrumentation instrumentation;
+    Validator validator;
+    validator.setInstrumentation(&instrumentation);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"name": "abcd", "tags": ["a"]})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+
+    const std::vector<Instrumentation::ReportEntry> report = instrumentation.report();
+    ASSERT_FALSE(report.empty());
+
+    size_t typeEntries = 0;
+    for (const Instrumentation::ReportEntry &entry : report) {
+        ASSERT_NE(nullptr, entry.subschema);
+        if (entry.kind == constraints::kType) {
+            typeEntries++;
+        }
+    }
+
+    // One entry each for the root, 'name', 'tags' and 'tags' items sub-schemas
+    EXPECT_EQ(4u, typeEntries);
+
+    for (size_t i = 1; i < report.size(); i++) {
+        EXPECT_GE(report[i - 1].stats.totalNanoseconds, report[i].stats.totalNanoseconds);
+    }
+}
+
+TEST_F(TestInstrumentation, DisabledOrDetachedRecordsNothing)
+{
+    Instrumentation instrumentation;
+    Validator validator;
+    const nlohmann::json document = nlohmann::json::parse(R"({"name": "abcd"})");
+
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+    EXPECT_TRUE(instrumentation.report().empty());
+
+    validator.setInstrumentation(&instrumentation);
+    instrumentation.setEnabled(false);
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+    EXPECT_TRUE(instrumentation.report().empty());
+
+    instrumentation.setEnabled(true);
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+    EXPECT_FALSE(instrumentation.report().empty());
+
+    instrumentation.reset();
+    EXPECT_TRUE(instrumentation.report().empty());
+}
+
+TEST_F(TestInstrumentation, BucketIndex)
+{
+    EXPECT_EQ(0u, Instrumentation::bucketIndex(0));
+    EXPECT_EQ(1u, Instrumentation::bucketIndex(1));
+    EXPECT_EQ(2u, Instrumentation::bucketIndex(2));
+    EXPECT_EQ(2u, Instrumentation::bucketIndex(3));
+    EXPECT_EQ(11u, Instrumentation::bucketIndex(1024));
+    EXPECT_EQ(Instrumentation::kNumHistogramBuckets - 1u, Instrumentation::bucketIndex(UINT64_MAX));
+}
@@ -0,0 +1,273 @@
+#include <clocale>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/json_tape_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/json_tape.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::JsonTape;
+using valijson::adapters::JsonTapeAdapter;
+
+class TestJsonTapeAdapter : public testing::Test
+{
+
+};
+
+TEST_F(TestJsonTapeAdapter, BasicArrayIteration)
+{
+    const unsigned int numElements = 10;
+
+    // Create a JSON document that consists of an array of numbers
+    std::string text = "[";
+    for (unsigned int i = 0; i < numElements; i++) {
+        text += (i > 0 ? ", " : "") + std::to_string(i) + ".5";
+    }
+    text += "]";
+
+    JsonTape document;
+    ASSERT_TRUE( document.parse(text.data(), text.size()) );
+
+    // Ensure that wrapping the document preserves the array and does not allow
+    // it to be cast to other types
+    JsonTapeAdapter adapter(document);
+#if VALIJSON_USE_EXCEPTIONS
+    ASSERT_NO_THROW( adapter.getArray() );
+    ASSERT_ANY_THROW( adapter.getBool() );
+    ASSERT_ANY_THROW( adapter.getDouble() );
+    ASSERT_ANY_THROW( adapter.getObject() );
+    ASSERT_ANY_THROW( adapter.getString() );
+#endif
+    // Ensure that the array contains the expected number of elements
+    EXPECT_EQ( numElements, adapter.getArray().size() );
+
+    // Ensure that the elements are returned in the order they were inserted
+    unsigned int expectedValue = 0;
+    for (const JsonTapeAdapter value : adapter.getArray()) {
+        ASSERT_TRUE( value.isNumber() );
+        EXPECT_EQ( double(expectedValue) + 0.5, value.getDouble() );
+        expectedValue++;
+    }
+
+    // Ensure that the correct number of elements were iterated over
+    EXPECT_EQ(numElements, expectedValue);
+}
+
+TEST_F(TestJsonTapeAdapter, BasicObjectIteration)
+{
+    const unsigned int numElements = 10;
+
+    // Create a JSON document that consists of an object that maps numeric
+    // strings their corresponding numeric values
+    std::string text = "{";
+    for (unsigned int i = 0; i < numElements; i++) {
+        text += (i > 0 ? ", \"" : "\"") + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    text += "}";
+
+    JsonTape document;
+    ASSERT_TRUE( document.parse(text) );
+
+    // Ensure that wrapping the document preserves the object and does not
+    // allow it to be cast to other types
+    JsonTapeAdapter adapter(document);
+#if VALIJSON_USE_EXCEPTIONS
+    ASSERT_NO_THROW( adapter.getObject() );
+    ASSERT_ANY_THROW( adapter.getArray() );
+    ASSERT_ANY_THROW( adapter.getBool() );
+    ASSERT_ANY_THROW( adapter.getDouble() );
+    ASSERT_ANY_THROW( adapter.getString() );
+#endif
+    // Ensure that the object contains the expected number of members
+    EXPECT_EQ( numElements, adapter.getObject().size() );
+
+    // Ensure that the members are returned in the order they were inserted
+    unsigned int expectedValue = 0;
+    for (const JsonTapeAdapter::ObjectMember member : adapter.getObject()) {
+        ASSERT_TRUE( member.second.isInteger() );
+        EXPECT_EQ( std::to_string(expectedValue), member.first );
+        EXPECT_EQ( int64_t(expectedValue), member.second.getInteger() );
+        expectedValue++;
+    }
+
+    // Ensure that the correct number of elements were iterated over
+    EXPECT_EQ( numElements, expectedValue );
+}
+
+TEST_F(TestJsonTapeAdapter, NestedValuesAreSkipped)
+{
+    const std::string text = R"({"a": [1, [2, {"x": 3}], {}], "b": {"c": {"d": []}}, "e": "last"})";
+
+    JsonTape document;
+    ASSERT_TRUE( document.parse(text.data(), text.size()) );
+
+    JsonTapeAdapter adapter(document);
+    const JsonTapeAdapter::Object object = adapter.getObject();
+    EXPECT_EQ( 3u, object.size() );
+
+    JsonTapeAdapter::Object::const_iterator itr = object.find("e");
+    ASSERT_NE( object.end(), itr );
+    EXPECT_EQ( "last", itr->second.getString() );
+    EXPECT_EQ( object.end(), object.find("x") );
+    EXPECT_EQ( object.end(), object.find("") );
+
+    itr = object.find("a");
+    ASSERT_NE( object.end(), itr );
+    const JsonTapeAdapter::Array array = itr->second.getArray();
+    EXPECT_EQ( 3u, array.size() );
+
+    JsonTapeAdapter::Array::const_iterator element = array.begin();
+    element.advance(2);
+    ASSERT_NE( array.end(), element );
+    EXPECT_TRUE( element->isObject() );
+    EXPECT_EQ( 0u, element->getObjectSize() );
+    ++element;
+    EXPECT_EQ( array.end(), element );
+}
+
+TEST_F(TestJsonTapeAdapter, StringsAndNumbers)
+{
+    const std::string text =
+            R"(["plain", "esc\"aped\n", "\u00e9\ud83d\ude00", 0, -9223372036854775808, )"
+            R"(18446744073709551616, 1.0, 2.5e3, true, false, null])";
+
+    JsonTape document;
+    ASSERT_TRUE( document.parse(text.data(), text.size()) ) << document.getError();
+
+    JsonTapeAdapter adapter(document);
+    const JsonTapeAdapter::Array array = adapter.getArray();
+    JsonTapeAdapter::Array::const_iterator itr = array.begin();
+
+    EXPECT_EQ( "plain", (itr++)->getString() );
+    EXPECT_EQ( "esc\"aped\n", (itr++)->getString() );
+    EXPECT_EQ( "\xc3\xa9\xf0\x9f\x98\x80", (itr++)->getString() );
+    EXPECT_EQ( 0, (itr++)->getInteger() );
+    EXPECT_EQ( INT64_MIN, (itr++)->getInteger() );
+
+    // Integers that do not fit in 64 bits, and numbers with a fractional part
+    // or exponent, are stored as doubles
+    EXPECT_TRUE( itr->isDouble() );
+    EXPECT_DOUBLE_EQ( 18446744073709551616.0, (itr++)->getDouble() );
+    EXPECT_TRUE( itr->isDouble() );
+    EXPECT_FALSE( itr->isInteger() );
+    EXPECT_EQ( 1.0, (itr++)->getDouble() );
+    EXPECT_EQ( 2500.0, (itr++)->getDouble() );
+
+    EXPECT_TRUE( (itr++)->getBool() );
+    EXPECT_FALSE( (itr++)->getBool() );
+    EXPECT_TRUE( (itr++)->isNull() );
+    EXPECT_EQ( array.end(), itr );
+}
+
+TEST_F(TestJsonTapeAdapter, NumbersIgnoreLocale)
+{
+    // Find a locale that uses a comma as its decimal point
+    const std::string previous = std::setlocale(LC_NUMERIC, nullptr);
+    const char *locales[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR" };
+    bool found = false;
+    for (const char *locale : locales) {
+        if (std::setlocale(LC_NUMERIC, locale) && std::string(std::localeconv()->decimal_point) == ",") {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        std::setlocale(LC_NUMERIC, previous.c_str());
+        GTEST_SKIP() << "Skipping: no locale with a comma as its decimal point is installed";
+    }
+
+    const std::string text = "[1.5, -2.25e2]";
+    JsonTape document;
+    const bool parsed = document.parse(text.data(), text.size());
+    std::setlocale(LC_NUMERIC, previous.c_str());
+    ASSERT_TRUE( parsed ) << document.getError();
+
+    JsonTapeAdapter adapter(document);
+    const JsonTapeAdapter::Array array = adapter.getArray();
+    JsonTapeAdapter::Array::const_iterator itr = array.begin();
+    EXPECT_EQ( 1.5, (itr++)->getDouble() );
+    EXPECT_EQ( -225.0, (itr++)->getDouble() );
+}
+
+TEST_F(TestJsonTapeAdapter, ParseErrors)
+{
+    const char *invalid[] = {
+        "",
+        "[1, 2",
+        "[1 2]",
+        "{\"a\" 1}",
+        "{\"a\": 1,}",
+        "{1: 2}",
+        "01",
+        "1.",
+        "-",
+        "1e400",
+        "tru",
+        "\"unterminated",
+        "\"bad \\x escape\"",
+        "\"\\ud800\"",
+        "\"tab\tinside\"",
+        "[] []"
+    };
+
+    for (const char *text : invalid) {
+        JsonTape document;
+        EXPECT_FALSE( document.parse(std::string(text)) ) << text;
+        EXPECT_FALSE( document.isValid() ) << text;
+        EXPECT_FALSE( document.getError().empty() ) << text;
+    }
+
+    JsonTape document;
+    EXPECT_FALSE( document.parse(std::string(1100, '[') + std::string(1100, ']')) );
+
+    EXPECT_TRUE( document.parse(std::string(" \r\n\t{ } ")) );
+    EXPECT_TRUE( document.isValid() );
+}
+
+TEST_F(TestJsonTapeAdapter, FrozenValuesOutliveDocument)
+{
+    nlohmann::json expected = nlohmann::json::parse(R"({"a": ["x\ty", 1, 2.5, null]})");
+
+    valijson::adapters::FrozenValue *frozen = nullptr;
+    {
+        std::string text = R"({"a": ["x\ty", 1, 2.5, null]})";
+        JsonTape document;
+        ASSERT_TRUE( document.parse(text.data(), text.size()) );
+        frozen = JsonTapeAdapter(document).freeze();
+        text.assign(text.size(), ' ');
+    }
+
+    EXPECT_TRUE( frozen->equalTo(valijson::adapters::NlohmannJsonAdapter(expected), true) );
+    delete frozen;
+}
+
+TEST_F(TestJsonTapeAdapter, Validation)
+{
+    const std::string schemaText = R"({
+        "type": "object",
+        "properties": { "id": { "type": "integer" }, "tags": { "items": { "enum": ["a", "b"] } } },
+        "required": ["id"]
+    })";
+
+    JsonTape schemaDocument;
+    ASSERT_TRUE( schemaDocument.parse(schemaText.data(), schemaText.size()) );
+
+    valijson::Schema schema;
+    valijson::SchemaParser parser;
+    parser.populateSchema(JsonTapeAdapter(schemaDocument), schema);
+
+    valijson::Validator validator;
+
+    JsonTape valid;
+    ASSERT_TRUE( valid.parse(std::string(R"({"id": 7, "tags": ["a", "b", "a"]})")) );
+    EXPECT_TRUE( validator.validate(schema, JsonTapeAdapter(valid), nullptr) );
+
+    JsonTape invalid;
+    ASSERT_TRUE( invalid.parse(std::string(R"({"id": 7.5, "tags": ["c"]})")) );
+    EXPECT_FALSE( validator.validate(schema, JsonTapeAdapter(invalid), nullptr) );
+}
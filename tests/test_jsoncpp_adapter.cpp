@@ -81,3 +81,38 @@ TEST_F(TestJsonCppAdapter, BasicObjectIteration)
     // Ensure that the correct number of elements were iterated over
     EXPECT_EQ( numElements, expectedValue );
 }
+
+TEST_F(TestJsonCppAdapter, FindObjectMember)
+{
+    Json::Value document(Json::objectValue);
+    document["a"] = Json::Value(1);
+    document["b"] = Json::Value(2);
+    document["c"] = Json::Value(3);
+
+    valijson::adapters::JsonCppAdapter adapter(document);
+    const valijson::adapters::JsonCppAdapter::Object object = adapter.getObject();
+
+    EXPECT_EQ( object.end(), object.find("d") );
+    EXPECT_EQ( object.end(), object.find("") );
+
+    // Ensure that an iterator returned by find() compares equal to the same
+    // member when reached by iteration, and can be used to continue iterating
+    valijson::adapters::JsonCppAdapter::Object::const_iterator itr = object.find("b");
+    ASSERT_NE( object.end(), itr );
+    EXPECT_EQ( "b", itr->first );
+    EXPECT_EQ( 2, itr->second.getInteger() );
+    EXPECT_EQ( ++object.begin(), itr );
+    EXPECT_NE( object.begin(), itr );
+    EXPECT_EQ( object.find("b"), itr );
+    EXPECT_NE( object.find("c"), itr );
+
+    ++itr;
+    ASSERT_NE( object.end(), itr );
+    EXPECT_EQ( "c", itr->first );
+    ++itr;
+    EXPECT_EQ( object.end(), itr );
+
+    itr = object.find("c");
+    ++itr;
+    EXPECT_EQ( object.end(), itr );
+}
@@ -0,0 +1,472 @@
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/memory_resource.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_session.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::Subschema;
+using valijson::ValidationResults;
+using valijson::ValidationSession;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace {
+
+const char *kSchema = R"({
+    "type": "object",
+    "properties": {
+        "name": { "type": "string", "minLength": 1 },
+        "tags": { "type": "array", "items": { "type": "string" }, "uniqueItems": true },
+        "kind": { "enum": ["a", "b", "c"] }
+    },
+    "required": ["name"],
+    "patternProperties": { "^x-": { "type": "integer" } },
+    "additionalProperties": false
+})";
+
+size_t numAllocations = 0;
+size_t numFrees = 0;
+
+void * countingAlloc(size_t size)
+{
+    numAllocations++;
+    return std::malloc(size);
+}
+
+void countingFree(void *ptr)
+{
+    numFrees++;
+    std::free(ptr);
+}
+
+}  // end anonymous namespace
+
+class TestMemoryResource : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        schemaDocument = nlohmann::json::parse(kSchema);
+        validDocument = nlohmann::json::parse(R"({"name": "n", "tags": ["a", "b"], "kind": "a", "x-1": 1})");
+        invalidDocument = nlohmann::json::parse(R"({"tags": ["a", "a"], "kind": "d", "x-1": "one", "z": 1})");
+    }
+
+    /// Return the number of errors reported for the invalid document
+    size_t expectValidation(const Schema &schema) const
+    {
+        Validator validator;
+        EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(validDocument), nullptr));
+
+        ValidationResults results;
+        EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalidDocument), &results));
+        return results.numErrors();
+    }
+
+    nlohmann::json schemaDocument;
+    nlohmann::json validDocument;
+    nlohmann::json invalidDocument;
+};
+
+TEST_F(TestMemoryResource, SubschemasUseSchemaAllocationFunctions)
+{
+    numAllocations = 0;
+    numFrees = 0;
+
+    {
+        Schema schema(countingAlloc, countingFree);
+        const Subschema *subschema = schema.createSubschema();
+        const size_t before = numAllocations;
+
+        valijson::constraints::TypeConstraint typeConstraint;
+        typeConstraint.addNamedType(valijson::constraints::TypeConstraint::kString);
+        schema.addConstraintToSubschema(typeConstraint, subschema);
+
+        // Constraints, and the containers that they own, are copied into
+        // memory allocated using the functions passed to the root schema,
+        // including those for other sub-schemas
+        EXPECT_EQ(before + 2, numAllocations);
+    }
+
+    EXPECT_GT(numAllocations, 0u);
+    EXPECT_EQ(numAllocations, numFrees);
+}
+
+#if VALIJSON_HAS_MEMORY_RESOURCE
+
+namespace {
+
+/// Memory resource that counts outstanding allocations
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    CountingResource()
+      : allocations(0),
+        outstanding(0) { }
+
+    size_t allocations;
+    size_t outstanding;
+
+private:
+    void * do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        outstanding++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        outstanding--;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/// Whether operator new should count allocations made on this thread
+thread_local bool countGlobalAllocations = false;
+
+/// Number of allocations counted by operator new
+thread_local size_t numGlobalAllocations = 0;
+
+}  // end anonymous namespace
+
+void * operator new(size_t size)
+{
+    if (countGlobalAllocations) {
+        numGlobalAllocations++;
+    }
+
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST_F(TestMemoryResource, ScopedMemoryResource)
+{
+    const size_t expectedErrors = [this]() {
+        Schema schema;
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+        return expectValidation(schema);
+    }();
+
+    CountingResource resource;
+    {
+        std::unique_ptr<Schema> schema;
+        {
+            valijson::ScopedMemoryResource scope(&resource);
+            EXPECT_EQ(&resource, valijson::currentMemoryResource());
+
+            schema.reset(new Schema());
+            SchemaParser parser;
+            parser.populateSchema(NlohmannJsonAdapter(schemaDocument), *schema);
+        }
+
+        EXPECT_EQ(std::pmr::get_default_resource(), valijson::currentMemoryResource());
+
+        // Sub-schemas, constraints and the containers owned by constraints
+        // are allocated from the resource
+        EXPECT_GT(resource.allocations, 20u);
+        EXPECT_GT(resource.outstanding, 0u);
+
+        // The schema can be used, and destroyed, after the scope has ended
+        const size_t allocations = resource.allocations;
+        EXPECT_EQ(expectedErrors, expectValidation(*schema));
+        EXPECT_EQ(allocations, resource.allocations);
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+}
+
+TEST_F(TestMemoryResource, SchemaKeepsItsResource)
+{
+    CountingResource resource;
+    CountingResource other;
+    {
+        std::unique_ptr<Schema> schema;
+        {
+            valijson::ScopedMemoryResource scope(&resource);
+            schema.reset(new Schema());
+        }
+
+        // Sub-schemas and constraints added after the scope has ended, or
+        // while another scope is active, use the schema's resource
+        const size_t allocations = resource.allocations;
+        valijson::constraints::TypeConstraint typeConstraint;
+        typeConstraint.addNamedType(valijson::constraints::TypeConstraint::kString);
+        schema->addConstraintToSubschema(typeConstraint, schema->createSubschema());
+        EXPECT_GT(resource.allocations, allocations);
+
+        valijson::ScopedMemoryResource otherScope(&other);
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), *schema);
+        EXPECT_GT(resource.allocations, allocations + 20);
+
+        // Only temporary constraints created by the parser use the other
+        // resource
+        EXPECT_EQ(0u, other.outstanding);
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+    EXPECT_EQ(0u, other.outstanding);
+}
+
+TEST_F(TestMemoryResource, ContainersKeepTheirResource)
+{
+    typedef std::vector<int, valijson::internal::CustomAllocator<int>> Vector;
+
+    CountingResource resource;
+    CountingResource other;
+    {
+        std::unique_ptr<Vector> values;
+        {
+            valijson::ScopedMemoryResource scope(&resource);
+            values.reset(new Vector());
+        }
+
+        // Containers owned by constraints allocate from the resource that was
+        // current when they were constructed, not the one current when they grow
+        values->resize(100);
+        EXPECT_GT(resource.allocations, 0u);
+
+        const size_t allocations = resource.allocations;
+        valijson::ScopedMemoryResource otherScope(&other);
+        values->resize(1000);
+        EXPECT_GT(resource.allocations, allocations);
+        EXPECT_EQ(0u, other.allocations);
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+}
+
+TEST_F(TestMemoryResource, AllocatorsCompareTheirResources)
+{
+    typedef valijson::internal::CustomAllocator<int> Allocator;
+    typedef std::vector<int, Allocator> Vector;
+
+    CountingResource resource;
+    CountingResource other;
+    {
+        const Allocator allocator(valijson::internal::memoryResourceFunctions(&resource));
+        const Allocator otherAllocator(valijson::internal::memoryResourceFunctions(&other));
+        EXPECT_TRUE(allocator == Allocator(valijson::internal::memoryResourceFunctions(&resource)));
+        EXPECT_FALSE(allocator == otherAllocator);
+
+        // Move assignment between containers bound to different resources
+        // copies the items, rather than adopting the other resource's storage
+        Vector values(100, 1, allocator);
+        Vector otherValues(otherAllocator);
+        const size_t allocations = other.allocations;
+        otherValues = std::move(values);
+        EXPECT_GT(other.allocations, allocations);
+        EXPECT_TRUE(otherValues.get_allocator() == otherAllocator);
+
+        // Allocators given explicit functions ignore the current scope
+        valijson::ScopedMemoryResource scope(&resource);
+        numAllocations = 0;
+        const size_t resourceAllocations = resource.allocations;
+        Vector counted(Allocator(countingAlloc, countingFree));
+        counted.resize(100);
+        EXPECT_GT(numAllocations, 0u);
+        EXPECT_EQ(resourceAllocations, resource.allocations);
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+    EXPECT_EQ(0u, other.outstanding);
+}
+
+TEST_F(TestMemoryResource, NestedScopes)
+{
+    CountingResource outer;
+    CountingResource inner;
+    {
+        valijson::ScopedMemoryResource outerScope(&outer);
+        {
+            valijson::ScopedMemoryResource innerScope(&inner);
+            Schema schema;
+            SchemaParser parser;
+            parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+            EXPECT_EQ(0u, outer.allocations);
+            EXPECT_GT(inner.allocations, 0u);
+        }
+
+        EXPECT_EQ(&outer, valijson::currentMemoryResource());
+        Schema schema;
+        schema.createSubschema();
+        EXPECT_GT(outer.allocations, 0u);
+    }
+
+    EXPECT_EQ(0u, outer.outstanding);
+    EXPECT_EQ(0u, inner.outstanding);
+
+    // Once all scopes have ended, schemas use the global heap again
+    const size_t allocations = outer.allocations;
+    Schema schema;
+    schema.createSubschema();
+    EXPECT_EQ(allocations, outer.allocations);
+}
+
+TEST_F(TestMemoryResource, MonotonicBuffer)
+{
+    alignas(std::max_align_t) static char buffer[256 * 1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    valijson::ScopedMemoryResource scope(&arena);
+    Schema schema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+
+    EXPECT_GT(expectValidation(schema), 0u);
+}
+
+TEST_F(TestMemoryResource, ValidationSessionUsesItsResource)
+{
+    Schema schema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+
+    Validator validator;
+    ValidationResults expected;
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalidDocument), &expected));
+
+    CountingResource resource;
+    {
+        ValidationSession session(&resource);
+        EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(validDocument)));
+        EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(invalidDocument)));
+        EXPECT_GT(resource.allocations, 0u);
+
+        // Errors are the same as those reported by a Validator, whichever
+        // way they are allocated
+        ASSERT_EQ(expected.numErrors(), session.results().numErrors());
+        ValidationResults::const_iterator actual = session.results().begin();
+        for (const ValidationResults::Error &error : expected) {
+            EXPECT_EQ(error.context, actual->context);
+            EXPECT_EQ(error.description, actual->description);
+            ++actual;
+        }
+
+        EXPECT_TRUE(actual == session.results().end());
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+}
+
+TEST_F(TestMemoryResource, WarmValidationSessionAvoidsGlobalHeap)
+{
+    // Patterns are left out, since std::regex allocates its search state
+    // from the global heap
+    nlohmann::json document = nlohmann::json::parse(kSchema);
+    document.erase("patternProperties");
+    const nlohmann::json valid = nlohmann::json::parse(R"({"name": "n", "tags": ["a", "b"], "kind": "a"})");
+    Schema schema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(document), schema);
+
+    std::pmr::unsynchronized_pool_resource pool;
+    ValidationSession session(&pool);
+    EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(valid)));
+    EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(invalidDocument)));
+    const size_t numErrors = session.results().numErrors();
+
+    numGlobalAllocations = 0;
+    countGlobalAllocations = true;
+    const bool validated = session.validate(schema, NlohmannJsonAdapter(valid));
+    const bool invalidated = !session.validate(schema, NlohmannJsonAdapter(invalidDocument));
+    countGlobalAllocations = false;
+
+    EXPECT_TRUE(validated);
+    EXPECT_TRUE(invalidated);
+    EXPECT_EQ(numErrors, session.results().numErrors());
+    EXPECT_EQ(0u, numGlobalAllocations);
+}
+
+TEST_F(TestMemoryResource, ValidationResultsUseTheirResource)
+{
+    CountingResource resource;
+    {
+        ValidationResults results(&resource);
+        results.pushError({"<root>", "[a]"}, "first");
+        EXPECT_GT(resource.outstanding, 0u);
+
+        ValidationResults other(&resource);
+        other.pushError({"<root>"}, "second");
+        other.pushError({"<root>", "[b]"}, "third");
+        results.appendErrors(other);
+        EXPECT_EQ(0u, other.numErrors());
+        EXPECT_EQ(3u, results.numErrors());
+
+        // Copies allocate from the global heap, and are unaffected by changes
+        // to the original
+        const size_t allocations = resource.allocations;
+        ValidationResults copy(results);
+        EXPECT_EQ(allocations, resource.allocations);
+
+        ValidationResults::Error error;
+        ASSERT_TRUE(results.popError(error));
+        EXPECT_EQ(std::vector<std::string>({"<root>", "[a]"}), error.context);
+        EXPECT_EQ("first", error.description);
+        ASSERT_TRUE(results.popError(error));
+        EXPECT_EQ(std::vector<std::string>({"<root>"}), error.context);
+        EXPECT_EQ("second", error.description);
+        ASSERT_TRUE(results.popError(error));
+        EXPECT_EQ(std::vector<std::string>({"<root>", "[b]"}), error.context);
+        EXPECT_EQ("third", error.description);
+        EXPECT_FALSE(results.popError(error));
+
+        EXPECT_EQ(3u, copy.numErrors());
+        EXPECT_EQ("third", (++++copy.begin())->description);
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+}
+
+TEST_F(TestMemoryResource, ExplicitAllocationFunctions)
+{
+    CountingResource resource;
+    {
+        valijson::ScopedMemoryResource scope(&resource);
+        Schema schema(valijson::allocateFromMemoryResource, valijson::freeToMemoryResource);
+        schema.createSubschema();
+        EXPECT_GT(resource.outstanding, 0u);
+
+#if VALIJSON_USE_EXCEPTIONS
+        // Allocation failures are reported as a null pointer
+        std::pmr::monotonic_buffer_resource empty(std::pmr::null_memory_resource());
+        valijson::ScopedMemoryResource emptyScope(&empty);
+        EXPECT_EQ(nullptr, valijson::allocateFromMemoryResource(16));
+#endif
+    }
+
+    EXPECT_EQ(0u, resource.outstanding);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include <map>
+#include <string>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/jsoncpp_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/internal/object_member_key.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::adapters::JsonCppAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::adapters::ObjectMemberAccessor;
+using valijson::adapters::ObjectMemberKey;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::Validator;
+
+class TestObjectMemberKey : public testing::Test
+{
+protected:
+
+    template<typename AdapterType>
+    static void checkMembers(const AdapterType &adapter)
+    {
+        typedef typename AdapterType::Object::const_iterator MemberIterator;
+
+        const typename AdapterType::Object object = adapter.asObject();
+        size_t count = 0;
+        for (MemberIterator itr = object.begin(); itr != object.end(); ++itr) {
+            const ObjectMemberAccessor<MemberIterator> member(itr);
+            static_assert(!std::is_reference<decltype(member.value())>::value,
+                    "Iterator should provide key() and value()");
+
+            const typename AdapterType::ObjectMember expected = *itr;
+            EXPECT_TRUE(member.key() == expected.first);
+            EXPECT_EQ(expected.first, member.key().str());
+            EXPECT_TRUE(member.value().equalTo(expected.second, true));
+            count++;
+        }
+
+        EXPECT_EQ(object.size(), count);
+    }
+};
+
+TEST_F(TestObjectMemberKey, Compare)
+{
+    const char *names[] = { "", "a", "ab", "abc", "b", "\xC3\xA9", "\xFF" };
+    const size_t numNames = sizeof(names) / sizeof(names[0]);
+
+    // Ordering should be consistent with std::string, including bytes with
+    // the most significant bit set
+    for (size_t i = 0; i < numNames; i++) {
+        const std::string lhs(names[i]);
+        const ObjectMemberKey key(lhs.data(), lhs.size());
+        for (size_t j = 0; j < numNames; j++) {
+            const std::string rhs(names[j]);
+            const int result = key.compare(rhs);
+            EXPECT_EQ(lhs.compare(rhs) < 0, result < 0) << lhs << " " << rhs;
+            EXPECT_EQ(lhs == rhs, result == 0) << lhs << " " << rhs;
+            EXPECT_EQ(lhs == rhs, key == rhs);
+        }
+    }
+
+    // Names may contain null characters
+    const std::string withNull("a\0b", 3);
+    EXPECT_TRUE(ObjectMemberKey(withNull) == withNull);
+    EXPECT_FALSE(ObjectMemberKey(withNull) == std::string("a"));
+}
+
+TEST_F(TestObjectMemberKey, IteratorsWithKeyViews)
+{
+    Json::Value jsonCppDocument(Json::objectValue);
+    jsonCppDocument["first"] = 1;
+    jsonCppDocument["second"] = "two";
+    jsonCppDocument[std::string("th\0ird", 6)] = true;
+    checkMembers(JsonCppAdapter(jsonCppDocument));
+
+    const nlohmann::json nlohmannDocument = {{"first", 1}, {"second", "two"}, {"third", true}};
+    checkMembers(NlohmannJsonAdapter(nlohmannDocument));
+}
+
+TEST_F(TestObjectMemberKey, IteratorsWithoutKeyViews)
+{
+    // Iterators that do not provide key() and value() are dereferenced once
+    typedef std::map<std::string, int>::const_iterator MapIterator;
+
+    std::map<std::string, int> members;
+    members["first"] = 1;
+    members["second"] = 2;
+
+    for (MapIterator itr = members.begin(); itr != members.end(); ++itr) {
+        const ObjectMemberAccessor<MapIterator> member(itr);
+        EXPECT_TRUE(member.key() == itr->first);
+        EXPECT_NE(itr->first.data(), member.key().data());
+        EXPECT_EQ(itr->second, member.value());
+    }
+}
+
+TEST_F(TestObjectMemberKey, ValidateMembers)
+{
+    Json::Value schemaDocument;
+    Json::Reader reader;
+    ASSERT_TRUE(reader.parse(
+            "{"
+            "  \"properties\": { \"a\": { \"type\": \"integer\" } },"
+            "  \"patternProperties\": { \"^x-\": { \"type\": \"string\" } },"
+            "  \"additionalProperties\": { \"type\": \"boolean\" },"
+            "  \"propertyNames\": { \"maxLength\": 8 }"
+            "}", schemaDocument));
+
+    Schema schema;
+    SchemaParser parser(SchemaParser::kDraft7);
+    parser.populateSchema(JsonCppAdapter(schemaDocument), schema);
+
+    Json::Value valid(Json::objectValue);
+    valid["a"] = 1;
+    valid["x-a"] = "text";
+    valid["zzz"] = true;
+
+    Validator validator;
+    EXPECT_TRUE(validator.validate(schema, JsonCppAdapter(valid), nullptr));
+
+    // The additional property should be reported by name
+    Json::Value invalid = valid;
+    invalid["other"] = 1;
+    ValidationResults results;
+    EXPECT_FALSE(validator.validate(schema, JsonCppAdapter(invalid), &results));
+
+    ValidationResults::Error error;
+    bool found = false;
+    while (results.popError(error)) {
+        if (!error.context.empty() && error.context.back() == "[other]") {
+            found = true;
+        }
+    }
+
+    EXPECT_TRUE(found);
+
+    // Property names are checked against the propertyNames schema
+    Json::Value longName = valid;
+    longName["x-very-long-name"] = "text";
+    EXPECT_FALSE(validator.validate(schema, JsonCppAdapter(longName), nullptr));
+}
@@ -0,0 +1,246 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/jsoncpp_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/adapters/packed_value_adapter.hpp>
+#include <valijson/adapters/yaml_cpp_adapter.hpp>
+#include <valijson/internal/packed_value_store.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::adapters::FrozenValue;
+using valijson::adapters::JsonCppAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::adapters::PackedAdapter;
+using valijson::adapters::PackedFrozenValue;
+using valijson::adapters::PackedValueStore;
+using valijson::adapters::YamlCppAdapter;
+
+namespace {
+
+size_t numAllocations = 0;
+size_t numFrees = 0;
+
+void * countingAlloc(size_t size)
+{
+    numAllocations++;
+    return std::malloc(size);
+}
+
+void countingFree(void *ptr)
+{
+    numFrees++;
+    std::free(ptr);
+}
+
+}  // end anonymous namespace
+
+class TestPackedValueAdapter : public testing::Test
+{
+
+};
+
+TEST_F(TestPackedValueAdapter, BasicArrayIteration)
+{
+    const unsigned int numElements = 10;
+
+    nlohmann::json document = nlohmann::json::array();
+    for (unsigned int i = 0; i < numElements; i++) {
+        document.push_back({double(i) + 0.5, {{"nested", i}}});
+    }
+
+    PackedValueStore store;
+    const uint32_t index = store.add(NlohmannJsonAdapter(document));
+    const PackedAdapter adapter(store, index);
+#if VALIJSON_USE_EXCEPTIONS
+    ASSERT_NO_THROW( adapter.getArray() );
+    ASSERT_ANY_THROW( adapter.getBool() );
+    ASSERT_ANY_THROW( adapter.getObject() );
+#endif
+    EXPECT_EQ( numElements, adapter.getArray().size() );
+
+    // Nested values are skipped when moving to the next element
+    unsigned int expectedValue = 0;
+    for (const PackedAdapter value : adapter.getArray()) {
+        ASSERT_TRUE( value.isArray() );
+        EXPECT_EQ( double(expectedValue) + 0.5, value.getArray().begin()->getDouble() );
+        expectedValue++;
+    }
+
+    EXPECT_EQ(numElements, expectedValue);
+    EXPECT_TRUE( adapter.equalTo(NlohmannJsonAdapter(document), true) );
+}
+
+TEST_F(TestPackedValueAdapter, ObjectMembersAreSorted)
+{
+    const nlohmann::json document = nlohmann::json::parse(
+            R"({"b": 2, "a": {"y": [1], "x": "text"}, "": null, "c": true})");
+
+    // yaml-cpp preserves the original order of the members
+    const YAML::Node yamlDocument = YAML::Load("{b: 2, a: {y: [1], x: text}, c: true}");
+
+    PackedValueStore store;
+    const PackedAdapter adapter(store, store.add(NlohmannJsonAdapter(document)));
+    const PackedAdapter yamlAdapter(store, store.add(YamlCppAdapter(yamlDocument)));
+
+    const char *expectedNames[] = { "", "a", "b", "c" };
+    size_t i = 0;
+    for (const PackedAdapter::ObjectMember member : adapter.getObject()) {
+        ASSERT_LT(i, sizeof(expectedNames) / sizeof(expectedNames[0]));
+        EXPECT_EQ(expectedNames[i], member.first);
+        i++;
+    }
+
+    EXPECT_EQ(4u, i);
+
+    const PackedAdapter::Object object = adapter.getObject();
+    EXPECT_TRUE( object.find("a") != object.end() );
+    EXPECT_TRUE( object.find("") != object.end() );
+    EXPECT_TRUE( object.find("d") == object.end() );
+    EXPECT_TRUE( object.find("aa") == object.end() );
+    EXPECT_EQ( "text", object.find("a")->second.getObject().find("x")->second.getString() );
+
+    // Packed values behave in the same way as the values they were copied
+    // from, including the weaker types reported by yaml-cpp
+    EXPECT_TRUE( adapter.equalTo(NlohmannJsonAdapter(document), true) );
+    EXPECT_TRUE( NlohmannJsonAdapter(document).equalTo(adapter, true) );
+    EXPECT_TRUE( yamlAdapter.getObject().find("b")->second.isString() );
+    EXPECT_TRUE( yamlAdapter.equalTo(YamlCppAdapter(yamlDocument), true) );
+    EXPECT_EQ( YamlCppAdapter(yamlDocument).hash(), yamlAdapter.hash() );
+    EXPECT_EQ( NlohmannJsonAdapter(document).hash(), adapter.hash() );
+}
+
+TEST_F(TestPackedValueAdapter, StringsAreInterned)
+{
+    const nlohmann::json first = nlohmann::json::parse(
+            R"({"name": "shared", "values": ["shared", "other"]})");
+    const nlohmann::json second = nlohmann::json::parse(
+            R"([{"name": "other"}, "shared"])");
+
+    PackedValueStore store;
+    const uint32_t firstIndex = store.add(NlohmannJsonAdapter(first));
+    EXPECT_EQ(std::string("name" "shared" "values" "other").size(), store.stringPoolSize());
+
+    // Strings that have been seen before are not stored again
+    const uint32_t secondIndex = store.add(NlohmannJsonAdapter(second));
+    EXPECT_EQ(std::string("name" "shared" "values" "other").size(), store.stringPoolSize());
+
+    EXPECT_TRUE( PackedAdapter(store, firstIndex).equalTo(NlohmannJsonAdapter(first), true) );
+    EXPECT_TRUE( PackedAdapter(store, secondIndex).equalTo(NlohmannJsonAdapter(second), true) );
+    EXPECT_FALSE( PackedAdapter(store, firstIndex).equalTo(PackedAdapter(store, secondIndex), false) );
+}
+
+TEST_F(TestPackedValueAdapter, InternTableIsReleased)
+{
+    const nlohmann::json document = nlohmann::json::parse(
+            R"({"name": "shared", "values": ["shared", "other"]})");
+
+    numAllocations = 0;
+    numFrees = 0;
+
+    {
+        PackedValueStore store(countingAlloc, countingFree);
+        const uint32_t index = store.add(NlohmannJsonAdapter(document));
+        EXPECT_EQ(4u, store.internTableSize());
+        EXPECT_GT(numAllocations, 0u);
+
+        // Copies do not include the intern table. Like other containers,
+        // they use the default allocation functions, which Subschema sets to
+        // its own while it copies a constraint
+        const size_t allocations = numAllocations;
+        const valijson::internal::ScopedAllocationFunctions scope({ countingAlloc, countingFree, nullptr, nullptr });
+        const PackedValueStore copy(store);
+        EXPECT_EQ(0u, copy.internTableSize());
+        EXPECT_GT(numAllocations, allocations);
+        EXPECT_TRUE( PackedAdapter(copy, index).equalTo(NlohmannJsonAdapter(document), true) );
+
+        store.compact();
+        EXPECT_EQ(0u, store.internTableSize());
+        EXPECT_TRUE( PackedAdapter(store, index).equalTo(NlohmannJsonAdapter(document), true) );
+
+        // Values can still be added after compaction
+        const uint32_t secondIndex = store.add(NlohmannJsonAdapter(document));
+        EXPECT_TRUE( PackedAdapter(store, secondIndex).equalTo(NlohmannJsonAdapter(document), true) );
+    }
+
+    EXPECT_EQ(numAllocations, numFrees);
+}
+
+TEST_F(TestPackedValueAdapter, FrozenValues)
+{
+    std::unique_ptr<FrozenValue> frozen;
+    std::unique_ptr<FrozenValue> clone;
+    {
+        Json::Value document(Json::objectValue);
+        document["key"] = Json::Value(Json::arrayValue);
+        document["key"].append(1);
+        document["key"].append("two");
+
+        frozen.reset(new PackedFrozenValue(JsonCppAdapter(document)));
+        EXPECT_EQ(JsonCppAdapter(document).hash(), frozen->hash());
+        clone.reset(frozen->clone());
+    }
+
+    // Frozen values do not depend on the original document
+    const nlohmann::json expected = nlohmann::json::parse(R"({"key": [1.0, "two"]})");
+    EXPECT_TRUE( frozen->equalTo(NlohmannJsonAdapter(expected), true) );
+    frozen.reset();
+    EXPECT_TRUE( clone->equalTo(NlohmannJsonAdapter(expected), true) );
+
+    // Values in a store that is owned by something else are copied
+    std::unique_ptr<FrozenValue> copy;
+    {
+        PackedValueStore store;
+        const uint32_t index = store.add(NlohmannJsonAdapter(expected));
+        const PackedFrozenValue view(store, index, PackedAdapter(store, index).hash());
+        copy.reset(view.clone());
+    }
+
+    EXPECT_TRUE( copy->equalTo(NlohmannJsonAdapter(expected), true) );
+    EXPECT_EQ( NlohmannJsonAdapter(expected).hash(), copy->hash() );
+}
+
+TEST_F(TestPackedValueAdapter, EnumAndConstValues)
+{
+    // Enum and const values should not depend on the schema document
+    valijson::Schema schema;
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "properties": {
+                "colour": { "enum": ["red", "green", {"rgb": [0, 0, 255]}] },
+                "version": { "const": {"major": 1, "tags": ["a", "b"]} }
+            }
+        })");
+
+        valijson::SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    valijson::Validator validator;
+    const char *valid[] = {
+        R"({"colour": "red"})",
+        R"({"colour": {"rgb": [0, 0, 255]}})",
+        R"({"version": {"tags": ["a", "b"], "major": 1}})"
+    };
+
+    for (const char *text : valid) {
+        const nlohmann::json document = nlohmann::json::parse(text);
+        EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr)) << text;
+    }
+
+    const char *invalid[] = {
+        R"({"colour": "blue"})",
+        R"({"colour": {"rgb": [0, 255, 0]}})",
+        R"({"version": {"tags": ["b", "a"], "major": 1}})"
+    };
+
+    for (const char *text : invalid) {
+        const nlohmann::json document = nlohmann::json::parse(text);
+        EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr)) << text;
+    }
+}
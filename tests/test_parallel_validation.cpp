@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/constraint_builder.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_scratch.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validation_thread_pool.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationScratch;
+using valijson::ValidationStats;
+using valijson::ValidationThreadPool;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+/**
+ * @brief  Set of the threads that have validated a ThreadRecordingConstraint
+ */
+class ThreadRecorder
+{
+public:
+    void record()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threads.insert(std::this_thread::get_id());
+        }
+
+        // Give idle workers time to steal tasks from the validating thread
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    size_t numThreads()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_threads.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threads.clear();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::set<std::thread::id> m_threads;
+};
+
+/**
+ * @brief  Constraint that always passes, and records the thread that
+ *         validated it
+ */
+class ThreadRecordingConstraint: public valijson::constraints::PolyConstraint
+{
+public:
+    explicit ThreadRecordingConstraint(ThreadRecorder *recorder)
+      : m_recorder(recorder) { }
+
+    Constraint * cloneInto(void *ptr) const override
+    {
+        return new (ptr) ThreadRecordingConstraint(m_recorder);
+    }
+
+    size_t sizeOf() const override
+    {
+        return sizeof(ThreadRecordingConstraint);
+    }
+
+    bool validate(const valijson::adapters::Adapter &, const std::vector<std::string> &,
+            ValidationResults *) const override
+    {
+        m_recorder->record();
+        return true;
+    }
+
+private:
+    ThreadRecorder * const m_recorder;
+};
+
+class ThreadRecordingConstraintBuilder: public valijson::ConstraintBuilder
+{
+public:
+    explicit ThreadRecordingConstraintBuilder(ThreadRecorder *recorder)
+      : m_recorder(recorder) { }
+
+    valijson::constraints::Constraint * make(const valijson::adapters::Adapter &) const override
+    {
+        return new ThreadRecordingConstraint(m_recorder);
+    }
+
+private:
+    ThreadRecorder * const m_recorder;
+};
+
+class TestParallelValidation : public testing::Test
+{
+protected:
+    TestParallelValidation()
+      : pool(3) { }
+
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "records": {
+                    "type": "array",
+                    "items": {
+                        "type": "object",
+                        "properties": {
+                            "id": { "type": "integer" },
+                            "name": { "type": "string", "pattern": "^[a-z]+$" },
+                            "tags": { "type": "array", "items": { "type": "string" } }
+                        },
+                        "required": ["id", "name"]
+                    }
+                },
+                "tuple": {
+                    "items": [{ "type": "string" }],
+                    "additionalItems": { "type": "integer" }
+                },
+                "index": {
+                    "type": "object",
+                    "additionalProperties": { "type": "integer", "minimum": 0 }
+                }
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    static nlohmann::json makeDocument(size_t numRecords, size_t invalidEvery)
+    {
+        nlohmann::json document;
+        nlohmann::json &records = document["records"];
+        nlohmann::json &tuple = document["tuple"];
+        nlohmann::json &index = document["index"];
+        records = nlohmann::json::array();
+        tuple = nlohmann::json::array({"header"});
+        index = nlohmann::json::object();
+        for (size_t i = 0; i < numRecords; i++) {
+            const bool invalid = invalidEvery > 0 && i % invalidEvery == 0;
+            nlohmann::json record;
+            record["id"] = i;
+            record["name"] = invalid ? "Invalid" : "valid";
+            record["tags"] = nlohmann::json::array();
+            for (size_t j = 0; j < i % 5; j++) {
+                record["tags"].push_back(invalid && j == 0 ? nlohmann::json(j) : nlohmann::json("tag"));
+            }
+            records.push_back(record);
+            tuple.push_back(invalid ? nlohmann::json("x") : nlohmann::json(i));
+            index["key" + std::to_string(i)] = invalid ? -1 : static_cast<int>(i);
+        }
+
+        return document;
+    }
+
+    static std::vector<std::string> describe(const ValidationResults &results)
+    {
+        std::vector<std::string> descriptions;
+        for (const ValidationResults::Error &error : results) {
+            std::string description;
+            for (const std::string &element : error.context) {
+                description += element;
+            }
+            descriptions.push_back(description + ": " + error.description);
+        }
+
+        return descriptions;
+    }
+
+    Schema schema;
+    ValidationThreadPool pool;
+};
+
+TEST_F(TestParallelValidation, ErrorsMatchSerialValidation)
+{
+    const nlohmann::json document = makeDocument(2000, 97);
+    const NlohmannJsonAdapter adapter(document);
+
+    Validator serialValidator;
+    ValidationResults serialResults;
+    EXPECT_FALSE(serialValidator.validate(schema, adapter, &serialResults));
+
+    Validator parallelValidator;
+    parallelValidator.setThreadPool(&pool, 64);
+    ValidationResults parallelResults;
+    EXPECT_FALSE(parallelValidator.validate(schema, adapter, &parallelResults));
+
+    ASSERT_GT(serialResults.numErrors(), 0u);
+    EXPECT_EQ(describe(serialResults), describe(parallelResults));
+
+    // Validators without results stop at the first error
+    EXPECT_FALSE(parallelValidator.validate(schema, adapter, nullptr));
+}
+
+TEST_F(TestParallelValidation, PropertiesMatchSerialValidation)
+{
+    // Members matching 'properties' and 'patternProperties' are validated in
+    // parallel when there are enough of them
+    nlohmann::json schemaDocument;
+    nlohmann::json document;
+    for (int i = 0; i < 200; i++) {
+        const std::string suffix = std::to_string(i);
+        schemaDocument["properties"]["p" + suffix] = {{"type", "integer"}, {"minimum", 0}, {"recordThread", true}};
+        document["p" + suffix] = i % 37 == 0 ? -1 : i;
+        document["q" + suffix] = i % 41 == 0 ? nlohmann::json(i) : nlohmann::json("text");
+    }
+    schemaDocument["patternProperties"]["^q"] = {{"type", "string"}, {"recordThread", true}};
+    schemaDocument["additionalProperties"] = false;
+
+    ThreadRecorder recorder;
+    Schema propertiesSchema;
+    SchemaParser parser;
+    parser.addConstraintBuilder("recordThread", new ThreadRecordingConstraintBuilder(&recorder));
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), propertiesSchema);
+    const NlohmannJsonAdapter adapter(document);
+
+    Validator serialValidator;
+    ValidationResults serialResults;
+    EXPECT_FALSE(serialValidator.validate(propertiesSchema, adapter, &serialResults));
+    EXPECT_EQ(1u, recorder.numThreads());
+
+    // The 400 matched members are divided into tasks of at least 16 members,
+    // which are shared out between the threads of the pool
+    Validator parallelValidator;
+    parallelValidator.setThreadPool(&pool, 64, 16);
+    ValidationResults parallelResults;
+    recorder.clear();
+    EXPECT_FALSE(parallelValidator.validate(propertiesSchema, adapter, &parallelResults));
+    EXPECT_GT(recorder.numThreads(), 1u);
+
+    // Every invalid member is reported, for patterns as well as properties
+    const std::vector<std::string> descriptions = describe(serialResults);
+    EXPECT_EQ(6, std::count_if(descriptions.begin(), descriptions.end(), [](const std::string &description) {
+        return description.find("associated with property name") != std::string::npos;
+    }));
+    EXPECT_EQ(5, std::count_if(descriptions.begin(), descriptions.end(), [](const std::string &description) {
+        return description.find("associated with pattern") != std::string::npos;
+    }));
+    EXPECT_EQ(descriptions, describe(parallelResults));
+    EXPECT_FALSE(parallelValidator.validate(propertiesSchema, adapter, nullptr));
+
+    // The same members are matched, so additionalProperties is satisfied
+    for (int i = 0; i < 200; i++) {
+        document["p" + std::to_string(i)] = i;
+        document["q" + std::to_string(i)] = "text";
+    }
+    EXPECT_TRUE(parallelValidator.validate(propertiesSchema, NlohmannJsonAdapter(document), nullptr));
+    document["z"] = 1;
+    EXPECT_FALSE(parallelValidator.validate(propertiesSchema, NlohmannJsonAdapter(document), nullptr));
+}
+
+TEST_F(TestParallelValidation, ValidDocument)
+{
+    const nlohmann::json document = makeDocument(5000, 0);
+    const NlohmannJsonAdapter adapter(document);
+
+    Validator validator;
+    validator.setThreadPool(&pool, 64);
+    ValidationResults results;
+    EXPECT_TRUE(validator.validate(schema, adapter, &results));
+    EXPECT_EQ(0u, results.numErrors());
+    EXPECT_TRUE(validator.validate(schema, adapter, nullptr));
+
+    // A single invalid item should be found without results
+    nlohmann::json invalid = document;
+    invalid["records"][4321]["id"] = "text";
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalid), nullptr));
+}
+
+TEST_F(TestParallelValidation, StatsMatchSerialValidation)
+{
+    const nlohmann::json document = makeDocument(1000, 0);
+    const NlohmannJsonAdapter adapter(document);
+
+    Validator serialValidator;
+    ValidationStats serialStats;
+    EXPECT_TRUE(serialValidator.validate(schema, adapter, nullptr, &serialStats));
+
+    Validator parallelValidator;
+    parallelValidator.setThreadPool(&pool, 64);
+    ValidationStats parallelStats;
+    EXPECT_TRUE(parallelValidator.validate(schema, adapter, nullptr, &parallelStats));
+
+    EXPECT_EQ(serialStats.nodesVisited, parallelStats.nodesVisited);
+    EXPECT_EQ(serialStats.subschemasEntered, parallelStats.subschemasEntered);
+    EXPECT_EQ(serialStats.totalConstraintsEvaluated(), parallelStats.totalConstraintsEvaluated());
+    EXPECT_EQ(serialStats.peakDepth, parallelStats.peakDepth);
+}
+
+#if VALIJSON_USE_INSTRUMENTATION
+TEST_F(TestParallelValidation, TasksShareCompiledRegexes)
+{
+    const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+        "items": {
+            "properties": { "name": { "pattern": "^[a-z]+$" } },
+            "patternProperties": { "^x": { "type": "integer" } }
+        }
+    })");
+    Schema itemsSchema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), itemsSchema);
+
+    nlohmann::json document = nlohmann::json::array();
+    for (int i = 0; i < 2000; i++) {
+        document.push_back({{"name", "valid"}, {"x" + std::to_string(i % 3), i}});
+    }
+    const NlohmannJsonAdapter adapter(document);
+
+    Validator validator;
+    ValidationScratch scratch;
+    validator.setScratch(&scratch);
+    validator.setThreadPool(&pool, 64, 16);
+    ValidationStats stats;
+    EXPECT_TRUE(validator.validate(itemsSchema, adapter, nullptr, &stats));
+    EXPECT_GE(stats.regexCacheMisses, 2u);
+
+    // Regexes compiled by the tasks are kept, and later tasks look them up in
+    // the caches of the validator rather than compiling them again
+    EXPECT_TRUE(validator.validate(itemsSchema, adapter, nullptr, &stats));
+    EXPECT_EQ(0u, stats.regexCacheMisses);
+    EXPECT_EQ(4000u, stats.regexCacheHits);
+}
+#endif
+
+TEST_F(TestParallelValidation, SharedPool)
+{
+    const nlohmann::json valid = makeDocument(3000, 0);
+    const nlohmann::json invalid = makeDocument(3000, 1000);
+
+    // Validators on several threads may share a pool
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([this, &valid, &invalid, &failures, i]() {
+            Validator validator;
+            validator.setThreadPool(&pool, 64);
+            const bool expected = i % 2 == 0;
+            ValidationResults results;
+            if (validator.validate(schema, NlohmannJsonAdapter(expected ? valid : invalid), &results) != expected) {
+                failures++;
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(0, failures.load());
+}
+
+TEST_F(TestParallelValidation, ParallelFor)
+{
+    std::vector<std::atomic<int>> calls(1000);
+    for (std::atomic<int> &count : calls) {
+        count = 0;
+    }
+
+    // Nested loops should not deadlock, even when they outnumber the threads
+    pool.parallelFor(10, [this, &calls](size_t i) {
+        pool.parallelFor(100, [&calls, i](size_t j) {
+            calls[i * 100 + j]++;
+        });
+    });
+
+    for (const std::atomic<int> &count : calls) {
+        EXPECT_EQ(1, count.load());
+    }
+
+    // Pools without worker threads run tasks on the calling thread
+    ValidationThreadPool emptyPool(0);
+    int total = 0;
+    emptyPool.parallelFor(10, [&total](size_t i) {
+        total += static_cast<int>(i);
+    });
+    EXPECT_EQ(45, total);
+}
+
+#if VALIJSON_USE_EXCEPTIONS
+TEST_F(TestParallelValidation, ParallelForRethrowsExceptions)
+{
+    std::atomic<int> calls(0);
+    EXPECT_THROW(pool.parallelFor(20, [&calls](size_t i) {
+        calls++;
+        if (i == 7) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+
+    // The remaining tasks are still run
+    EXPECT_EQ(20, calls.load());
+}
+#endif
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
 
 #include <valijson/adapters/rapidjson_adapter.hpp>
 #include <valijson/schema.hpp>
@@ -51,6 +53,57 @@ public:
     }
 };
 
+struct ValidationCounts
+{
+    ValidationCounts()
+      : typed(0),
+        erased(0) { }
+
+    size_t typed;
+    size_t erased;
+};
+
+/// Accepts strings that consist of three upper case letters
+template<typename... AdapterTypes>
+class CurrencyCodeConstraint : public valijson::constraints::PolyConstraintT<
+        CurrencyCodeConstraint<AdapterTypes...>, AdapterTypes...>
+{
+    ValidationCounts *m_counts;
+
+public:
+    explicit CurrencyCodeConstraint(ValidationCounts *counts)
+      : m_counts(counts) { }
+
+    template<typename AdapterType>
+    bool validateTarget(
+            const AdapterType &target,
+            const std::vector<std::string> &context,
+            ValidationResults *results) const
+    {
+        if (std::is_same<AdapterType, Adapter>::value) {
+            m_counts->erased++;
+        } else {
+            m_counts->typed++;
+        }
+
+        if (!target.isString()) {
+            return true;
+        }
+
+        const std::string code = target.asString();
+        if (code.size() == 3 && std::all_of(code.begin(), code.end(),
+                [](char c) { return c >= 'A' && c <= 'Z'; })) {
+            return true;
+        }
+
+        if (results) {
+            results->pushError(context, "Invalid currency code");
+        }
+
+        return false;
+    }
+};
+
 }  // end anonymous namespace
 
 class TestPolyConstraint : public testing::Test
@@ -95,3 +148,52 @@ TEST_F(TestPolyConstraint, ValidationCanFail)
     EXPECT_TRUE(results.popError(error));
     EXPECT_STREQ("StubPolyConstraint intentionally failed validation", error.description.c_str());
 }
+
+TEST_F(TestPolyConstraint, TemplatedConstraintUsesAdapterType)
+{
+    ValidationCounts counts;
+    CurrencyCodeConstraint<RapidJsonAdapter> constraint(&counts);
+
+    Schema schema;
+    schema.addConstraintToSubschema(constraint, schema.root());
+
+    rapidjson::Document valid;
+    valid.SetString("AUD");
+
+    rapidjson::Document invalid;
+    invalid.SetString("dollars");
+
+    Validator validator;
+    EXPECT_TRUE(validator.validate(schema, RapidJsonAdapter(valid), nullptr));
+
+    ValidationResults results;
+    EXPECT_FALSE(validator.validate(schema, RapidJsonAdapter(invalid), &results));
+    EXPECT_EQ(size_t(1), results.numErrors());
+
+    EXPECT_EQ(size_t(2), counts.typed);
+    EXPECT_EQ(size_t(0), counts.erased);
+}
+
+TEST_F(TestPolyConstraint, TemplatedConstraintFallsBackToTypeErasure)
+{
+    // Values of adapter types that are not listed are validated using the
+    // type-erased validate() function
+    ValidationCounts counts;
+    CurrencyCodeConstraint<> constraint(&counts);
+
+    Schema schema;
+    schema.addConstraintToSubschema(constraint, schema.root());
+
+    rapidjson::Document valid;
+    valid.SetString("AUD");
+
+    rapidjson::Document invalid;
+    invalid.SetString("dollars");
+
+    Validator validator;
+    EXPECT_TRUE(validator.validate(schema, RapidJsonAdapter(valid), nullptr));
+    EXPECT_FALSE(validator.validate(schema, RapidJsonAdapter(invalid), nullptr));
+
+    EXPECT_EQ(size_t(0), counts.typed);
+    EXPECT_EQ(size_t(2), counts.erased);
+}
@@ -82,3 +82,72 @@ TEST_F(TestQtJsonAdapter, BasicObjectIteration)
     // Ensure that the correct number of elements were iterated over
     EXPECT_EQ( numElements, expectedValue );
 }
+
+TEST_F(TestQtJsonAdapter, StringLength)
+{
+    // "a", U+00E9, U+1F600 (a surrogate pair) and an unpaired high surrogate
+    const QChar chars[] = { QChar(0x0061), QChar(0x00E9), QChar(0xD83D), QChar(0xDE00), QChar(0xD83D) };
+    const QJsonValue value(QString(chars, 5));
+
+    const valijson::adapters::QtJsonAdapter adapter(value);
+    EXPECT_EQ( 4u, adapter.asStringLength() );
+
+    // The length of a string should agree with the length of its UTF-8 form
+    const QJsonValue utf8Value(QString::fromUtf8("caf\xC3\xA9 \xF0\x9F\x98\x80"));
+    const valijson::adapters::QtJsonAdapter utf8Adapter(utf8Value);
+    EXPECT_EQ( 6u, utf8Adapter.asStringLength() );
+    EXPECT_EQ( valijson::utils::u8_strlen(utf8Adapter.asString().c_str()), utf8Adapter.asStringLength() );
+
+    // Other values are measured using their string representation
+    const valijson::adapters::QtJsonAdapter boolAdapter((QJsonValue(true)));
+    EXPECT_EQ( 4u, boolAdapter.asStringLength() );
+}
+
+TEST_F(TestQtJsonAdapter, FindObjectMember)
+{
+    QJsonObject object;
+    object["ascii"] = QJsonValue(1.0);
+    object[QString::fromUtf8("caf\xC3\xA9")] = QJsonValue(2.0);
+    const QJsonValue document(object);
+
+    const valijson::adapters::QtJsonAdapter adapter(document);
+    const valijson::adapters::QtJsonAdapter::Object members = adapter.getObject();
+
+    const valijson::adapters::QtJsonObject::const_iterator ascii = members.find("ascii");
+    ASSERT_TRUE( ascii != members.end() );
+    EXPECT_EQ( 1.0, ascii->second.getDouble() );
+
+    const valijson::adapters::QtJsonObject::const_iterator utf8 = members.find("caf\xC3\xA9");
+    ASSERT_TRUE( utf8 != members.end() );
+    EXPECT_EQ( 2.0, utf8->second.getDouble() );
+
+    EXPECT_TRUE( members.find("missing") == members.end() );
+    EXPECT_TRUE( members.find("caf") == members.end() );
+}
+
+TEST_F(TestQtJsonAdapter, ObjectMemberKeys)
+{
+    QJsonObject object;
+    object["ascii"] = QJsonValue(1.0);
+    object[QString::fromUtf8("caf\xC3\xA9 \xF0\x9F\x98\x80")] = QJsonValue(2.0);
+    const QJsonValue document(object);
+
+    const valijson::adapters::QtJsonAdapter adapter(document);
+    const valijson::adapters::QtJsonAdapter::Object members = adapter.getObject();
+
+    // Keys should match the names returned when members are dereferenced
+    unsigned int count = 0;
+    for (valijson::adapters::QtJsonObject::const_iterator itr = members.begin(); itr != members.end(); ++itr) {
+        const valijson::adapters::ObjectMemberKey key = itr.key();
+        EXPECT_EQ( itr->first, key.str() );
+        EXPECT_TRUE( key == itr->first );
+        EXPECT_EQ( itr->second.getDouble(), itr.value().getDouble() );
+        count++;
+    }
+
+    EXPECT_EQ( 2u, count );
+
+    const valijson::adapters::QtJsonObject::const_iterator utf8 = members.find("caf\xC3\xA9 \xF0\x9F\x98\x80");
+    ASSERT_TRUE( utf8 != members.end() );
+    EXPECT_TRUE( utf8.key() == std::string("caf\xC3\xA9 \xF0\x9F\x98\x80") );
+}
@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_analyser.hpp>
+#include <valijson/schema_parser.hpp>
+
+using valijson::Schema;
+using valijson::SchemaAnalyser;
+using valijson::SchemaParser;
+using valijson::adapters::NlohmannJsonAdapter;
+
+class TestSchemaAnalyser : public testing::Test
+{
+protected:
+    static SchemaAnalyser::Report analyse(const std::string &text,
+            const SchemaAnalyser::Limits &limits = SchemaAnalyser::Limits())
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(text);
+
+        Schema schema;
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+
+        return SchemaAnalyser(limits).analyse(schema);
+    }
+
+    static const SchemaAnalyser::Hazard * findHazard(const SchemaAnalyser::Report &report,
+            SchemaAnalyser::HazardKind kind)
+    {
+        for (const SchemaAnalyser::Hazard &hazard : report.hazards) {
+            if (hazard.kind == kind) {
+                return &hazard;
+            }
+        }
+
+        return nullptr;
+    }
+};
+
+TEST_F(TestSchemaAnalyser, SimpleSchemaHasNoHazards)
+{
+    const SchemaAnalyser::Report report = analyse(R"({
+        "type": "object",
+        "properties": {
+            "name": { "type": "string", "maxLength": 10 },
+            "tags": { "type": "array", "uniqueItems": true, "maxItems": 4 }
+        }
+    })");
+
+    EXPECT_TRUE(report.hazards.empty());
+    EXPECT_FALSE(report.hasCriticalHazards());
+    ASSERT_EQ(3u, report.costs.size());
+
+    // Ordered by path
+    EXPECT_EQ("#", report.costs[0].path);
+    EXPECT_EQ(2u, report.costs[0].cost);
+    EXPECT_EQ("#/properties/name", report.costs[1].path);
+    EXPECT_EQ("#/properties/tags", report.costs[2].path);
+
+    // Three constraints, plus six pairwise comparisons for 'uniqueItems'
+    EXPECT_EQ(9u, report.costs[2].cost);
+}
+
+TEST_F(TestSchemaAnalyser, CombinatorFanOut)
+{
+    SchemaAnalyser::Limits limits;
+    limits.maxFanOut = 5;
+
+    const SchemaAnalyser::Report report = analyse(R"({
+        "oneOf": [
+            { "anyOf": [ { "type": "string" }, { "type": "integer" } ] },
+            { "anyOf": [ { "type": "string" }, { "type": "integer" } ] }
+        ]
+    })", limits);
+
+    ASSERT_EQ(1u, report.hazards.size());
+    EXPECT_EQ(SchemaAnalyser::kCombinatorFanOut, report.hazards[0].kind);
+    EXPECT_EQ(SchemaAnalyser::kWarning, report.hazards[0].severity);
+    EXPECT_EQ("#/oneOf", report.hazards[0].path);
+
+    EXPECT_EQ("#", report.costs[0].path);
+    EXPECT_EQ(7u, report.costs[0].fanOut);
+}
+
+TEST_F(TestSchemaAnalyser, LargeEnum)
+{
+    SchemaAnalyser::Limits limits;
+    limits.maxEnumValues = 3;
+
+    const SchemaAnalyser::Report report = analyse(R"({ "enum": [1, 2, 3, 4] })", limits);
+
+    const SchemaAnalyser::Hazard *hazard = findHazard(report, SchemaAnalyser::kLargeEnum);
+    ASSERT_NE(nullptr, hazard);
+    EXPECT_EQ("#/enum", hazard->path);
+    EXPECT_EQ(4u, report.costs[0].cost);
+}
+
+TEST_F(TestSchemaAnalyser, UnboundedUniqueItems)
+{
+    const SchemaAnalyser::Report report = analyse(R"({ "type": "array", "uniqueItems": true })");
+
+    const SchemaAnalyser::Hazard *hazard = findHazard(report, SchemaAnalyser::kUnboundedUniqueItems);
+    ASSERT_NE(nullptr, hazard);
+    EXPECT_EQ("#/uniqueItems", hazard->path);
+}
+
+TEST_F(TestSchemaAnalyser, CostsSaturate)
+{
+    const SchemaAnalyser::Report report = analyse(R"({
+        "allOf": [
+            { "type": "array", "uniqueItems": true, "maxItems": 10000000000 },
+            { "type": "array", "uniqueItems": true, "maxItems": 10000000000 }
+        ]
+    })");
+
+    // Pairwise comparisons, and the sum over both branches, would otherwise
+    // wrap around
+    ASSERT_EQ(3u, report.costs.size());
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), report.costs[0].cost);
+    EXPECT_EQ(3u, report.costs[0].fanOut);
+}
+
+TEST_F(TestSchemaAnalyser, BacktrackingPatterns)
+{
+    EXPECT_TRUE(SchemaAnalyser::isBacktrackingProne("^(a+)+$"));
+    EXPECT_TRUE(SchemaAnalyser::isBacktrackingProne("(\\w*)*x"));
+    EXPECT_TRUE(SchemaAnalyser::isBacktrackingProne("^(a|ab)*c$"));
+    EXPECT_TRUE(SchemaAnalyser::isBacktrackingProne("((ab)+c?){2,}"));
+
+    EXPECT_FALSE(SchemaAnalyser::isBacktrackingProne("^[a-z]+$"));
+    EXPECT_FALSE(SchemaAnalyser::isBacktrackingProne("^(ab)+$"));
+    EXPECT_FALSE(SchemaAnalyser::isBacktrackingProne("^(a+){2}$"));
+    EXPECT_FALSE(SchemaAnalyser::isBacktrackingProne("^\\(a+\\)+$"));
+    EXPECT_FALSE(SchemaAnalyser::isBacktrackingProne("^[(a+)]+$"));
+
+    const SchemaAnalyser::Report report = analyse(R"({
+        "properties": { "id": { "pattern": "^(a+)+$" } },
+        "patternProperties": { "^(x|xy)*$": {} }
+    })");
+
+    ASSERT_EQ(2u, report.hazards.size());
+    EXPECT_EQ(SchemaAnalyser::kBacktrackingPattern, report.hazards[0].kind);
+    EXPECT_EQ("#/properties", report.hazards[0].path);
+    EXPECT_EQ(SchemaAnalyser::kBacktrackingPattern, report.hazards[1].kind);
+    EXPECT_EQ("#/properties/id/pattern", report.hazards[1].path);
+}
+
+TEST_F(TestSchemaAnalyser, Recursion)
+{
+    const SchemaAnalyser::Report bounded = analyse(R"({
+        "type": "object",
+        "properties": { "child": { "$ref": "#" } }
+    })");
+
+    ASSERT_EQ(1u, bounded.hazards.size());
+    EXPECT_EQ(SchemaAnalyser::kUnboundedRecursion, bounded.hazards[0].kind);
+    EXPECT_FALSE(bounded.hasCriticalHazards());
+
+    const SchemaAnalyser::Report infinite = analyse(R"({
+        "allOf": [ { "$ref": "#" } ]
+    })");
+
+    ASSERT_EQ(1u, infinite.hazards.size());
+    EXPECT_EQ(SchemaAnalyser::kInfiniteRecursion, infinite.hazards[0].kind);
+    EXPECT_TRUE(infinite.hasCriticalHazards());
+
+    std::stringstream ss;
+    infinite.write(ss);
+    EXPECT_EQ(0u, ss.str().find("# hazards: 1\nCRITICAL\t#\t"));
+}
+
+TEST_F(TestSchemaAnalyser, RecursionOfEachKindIsReported)
+{
+    // The cycle through 'items' is found first, and must not hide the cycle
+    // through 'not', which re-applies the root schema to the same value
+    const SchemaAnalyser::Report report = analyse(R"({
+        "items": { "$ref": "#" },
+        "not": { "$ref": "#" }
+    })");
+
+    ASSERT_EQ(2u, report.hazards.size());
+    EXPECT_NE(nullptr, findHazard(report, SchemaAnalyser::kUnboundedRecursion));
+    EXPECT_NE(nullptr, findHazard(report, SchemaAnalyser::kInfiniteRecursion));
+    EXPECT_TRUE(report.hasCriticalHazards());
+}
@@ -0,0 +1,92 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/utils/nlohmann_json_utils.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validator.hpp>
+
+#define SLOW_CASES_DIR "../tests/fuzzing/slow_cases/"
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationStats;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+/**
+ * Each file in the slow case corpus uses the same format as the
+ * JSON-Schema-Test-Suite, so that it can be used as a seed for perf_fuzzer.
+ * Each test also records the maximum number of constraint evaluations, and
+ * the maximum number of comparisons between values, that it is expected to
+ * require. Constraint evaluations catch changes that apply more sub-schemas,
+ * while value comparisons catch work done within a single constraint, such
+ * as a 'uniqueItems' check that becomes quadratic.
+ */
+class TestSlowCases : public ::testing::Test
+{
+protected:
+    static void processSlowCaseFile(const std::string &file)
+    {
+        nlohmann::json document;
+        ASSERT_TRUE(valijson::utils::loadDocument(std::string(SLOW_CASES_DIR) + file, document));
+        ASSERT_TRUE(document.is_array());
+
+        for (const nlohmann::json &testCase : document) {
+            Schema schema;
+            SchemaParser parser(SchemaParser::kDraft7);
+            parser.populateSchema(NlohmannJsonAdapter(testCase.at("schema")), schema);
+
+            for (const nlohmann::json &test : testCase.at("tests")) {
+                const std::string description = test.at("description").get<std::string>();
+                const uint64_t budget = test.at("maxConstraintsEvaluated").get<uint64_t>();
+                const uint64_t comparisonBudget = test.at("maxValueComparisons").get<uint64_t>();
+
+                Validator validator;
+                ValidationResults results;
+                ValidationStats stats;
+                EXPECT_EQ(test.at("valid").get<bool>(),
+                        validator.validate(schema, NlohmannJsonAdapter(test.at("data")), &results, &stats))
+                        << description;
+
+#if VALIJSON_USE_INSTRUMENTATION
+                EXPECT_LE(stats.totalConstraintsEvaluated(), budget) << description;
+                EXPECT_LE(stats.valueComparisons, comparisonBudget) << description;
+#else
+                (void) budget;
+                (void) comparisonBudget;
+#endif
+            }
+        }
+    }
+};
+
+TEST_F(TestSlowCases, AnyOfFanOut)
+{
+    processSlowCaseFile("any_of_fan_out.json");
+}
+
+TEST_F(TestSlowCases, Enum)
+{
+    processSlowCaseFile("enum.json");
+}
+
+TEST_F(TestSlowCases, NestedOneOf)
+{
+    processSlowCaseFile("nested_one_of.json");
+}
+
+TEST_F(TestSlowCases, PatternProperties)
+{
+    processSlowCaseFile("pattern_properties.json");
+}
+
+TEST_F(TestSlowCases, UniqueItems)
+{
+    processSlowCaseFile("unique_items.json");
+}
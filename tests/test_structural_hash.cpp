@@ -0,0 +1,238 @@
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/jsoncpp_adapter.hpp>
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/adapters/std_string_adapter.hpp>
+#include <valijson/adapters/yaml_cpp_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::adapters::FrozenValue;
+using valijson::adapters::JsonCppAdapter;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::adapters::ObjectMembersSorted;
+using valijson::adapters::StdStringAdapter;
+using valijson::adapters::YamlCppAdapter;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::Validator;
+
+namespace {
+
+/// FrozenValue that does not override hash(), like one defined outside the
+/// library before structural hashes were added
+class UnhashedFrozenValue : public FrozenValue
+{
+public:
+    explicit UnhashedFrozenValue(FrozenValue *value)
+      : m_value(value) { }
+
+    FrozenValue * clone() const override
+    {
+        return new UnhashedFrozenValue(m_value->clone());
+    }
+
+    bool equalTo(const valijson::adapters::Adapter &adapter, bool strict) const override
+    {
+        return m_value->equalTo(adapter, strict);
+    }
+
+private:
+    const std::unique_ptr<FrozenValue> m_value;
+};
+
+}  // end anonymous namespace
+
+class TestStructuralHash : public testing::Test
+{
+protected:
+
+    static Json::Value parseJson(const std::string &text)
+    {
+        Json::Value document;
+        Json::Reader reader;
+        EXPECT_TRUE(reader.parse(text, document)) << text;
+        return document;
+    }
+};
+
+TEST_F(TestStructuralHash, EqualValuesHaveEqualHashes)
+{
+    const Json::Value jsonCppDocument = parseJson(
+            "{\"a\": [1, 2.5, null, true, \"text\"], \"b\": {\"c\": -0.0}}");
+    const nlohmann::json nlohmannDocument = nlohmann::json::parse(
+            "{\"b\": {\"c\": 0}, \"a\": [1.0, 2.5, null, true, \"text\"]}");
+
+    const JsonCppAdapter jsonCppAdapter(jsonCppDocument);
+    const NlohmannJsonAdapter nlohmannAdapter(nlohmannDocument);
+    ASSERT_TRUE(jsonCppAdapter.equalTo(nlohmannAdapter, true));
+    EXPECT_EQ(jsonCppAdapter.hash(), nlohmannAdapter.hash());
+
+    // Strings are hashed the same way regardless of the Adapter
+    const Json::Value jsonCppString("text");
+    const std::string stdString("text");
+    EXPECT_EQ(JsonCppAdapter(jsonCppString).hash(), StdStringAdapter(stdString).hash());
+
+    // Frozen values produce the same hash as the original value
+    const std::unique_ptr<FrozenValue> frozen(nlohmannAdapter.freeze());
+    EXPECT_EQ(nlohmannAdapter.hash(), frozen->hash());
+}
+
+TEST_F(TestStructuralHash, DefaultImplementations)
+{
+    const Json::Value jsonCppDocument = parseJson(
+            "{\"a\": [1, 2.5, null, true, \"text\"], \"b\": {\"c\": -0.0, \"d\": {}}}");
+    const YAML::Node yamlDocument = YAML::Load("{a: [x, {y: z}], b: ''}");
+
+    // The default Adapter::hash() walks the value through the Adapter
+    // interface, and matches the overrides
+    const JsonCppAdapter jsonCppAdapter(jsonCppDocument);
+    const YamlCppAdapter yamlAdapter(yamlDocument);
+    EXPECT_EQ(jsonCppAdapter.hash(), jsonCppAdapter.Adapter::hash());
+    EXPECT_EQ(yamlAdapter.hash(), yamlAdapter.Adapter::hash());
+
+    // Enum values without a structural hash are compared with every target
+    const Json::Value value = parseJson("{\"b\": [1, 2]}");
+    const std::unique_ptr<FrozenValue> frozen(JsonCppAdapter(value).freeze());
+    const UnhashedFrozenValue unhashed(frozen->clone());
+    EXPECT_EQ(FrozenValue::unknownHash(), unhashed.hash());
+
+    valijson::constraints::EnumConstraint enumConstraint;
+    enumConstraint.addValue(unhashed);
+    Schema schema;
+    schema.addConstraint(enumConstraint);
+
+    Validator validator(Validator::kStrongTypes);
+    const Json::Value equal = parseJson("{\"b\": [1.0, 2]}");
+    const Json::Value different = parseJson("{\"b\": [2, 1]}");
+    EXPECT_TRUE(validator.validate(schema, JsonCppAdapter(equal), nullptr));
+    EXPECT_FALSE(validator.validate(schema, JsonCppAdapter(different), nullptr));
+}
+
+TEST_F(TestStructuralHash, ObjectMemberOrder)
+{
+    // yaml-cpp preserves the order in which object members appear
+    const YAML::Node first = YAML::Load("{a: x, b: y, c: z}");
+    const YAML::Node second = YAML::Load("{c: z, a: x, b: y}");
+    EXPECT_TRUE(YamlCppAdapter(first).equalTo(YamlCppAdapter(second), true));
+    EXPECT_EQ(YamlCppAdapter(first).hash(), YamlCppAdapter(second).hash());
+
+    // Swapping values between members should change the hash
+    const YAML::Node swapped = YAML::Load("{a: y, b: x, c: z}");
+    EXPECT_FALSE(YamlCppAdapter(first).equalTo(YamlCppAdapter(swapped), true));
+    EXPECT_NE(YamlCppAdapter(first).hash(), YamlCppAdapter(swapped).hash());
+}
+
+TEST_F(TestStructuralHash, DifferentValuesHaveDifferentHashes)
+{
+    const char *values[] = {
+        "null", "true", "false", "0", "1", "1.5", "\"\"", "\"1\"", "\"true\"",
+        "[]", "{}", "[1, 2]", "[2, 1]", "[[1], 2]", "[1, [2]]",
+        "{\"a\": 1}", "{\"b\": 1}", "{\"a\": 2}", "{\"a\": [1]}", "{\"a\": 1, \"b\": 1}"
+    };
+
+    const size_t numValues = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < numValues; i++) {
+        const Json::Value lhs = parseJson(values[i]);
+        for (size_t j = i + 1; j < numValues; j++) {
+            const Json::Value rhs = parseJson(values[j]);
+            EXPECT_NE(JsonCppAdapter(lhs).hash(), JsonCppAdapter(rhs).hash())
+                    << values[i] << " " << values[j];
+        }
+    }
+}
+
+TEST_F(TestStructuralHash, SameAdapterEquality)
+{
+    EXPECT_TRUE(ObjectMembersSorted<JsonCppAdapter::Object>::value());
+    EXPECT_TRUE(ObjectMembersSorted<NlohmannJsonAdapter::Object>::value());
+    EXPECT_FALSE(ObjectMembersSorted<YamlCppAdapter::Object>::value());
+
+    const Json::Value document = parseJson("{\"a\": {\"x\": [1, {\"y\": null}]}, \"b\": \"2\"}");
+    const Json::Value same = parseJson("{\"b\": \"2\", \"a\": {\"x\": [1.0, {\"y\": null}]}}");
+    const Json::Value otherName = parseJson("{\"a\": {\"x\": [1, {\"z\": null}]}, \"b\": \"2\"}");
+    const Json::Value otherValue = parseJson("{\"a\": {\"x\": [1, {\"y\": null}]}, \"b\": 2}");
+    const Json::Value shorter = parseJson("{\"a\": {\"x\": [1]}, \"b\": \"2\"}");
+
+    const JsonCppAdapter adapter(document);
+    EXPECT_TRUE(adapter.equalTo(JsonCppAdapter(same), true));
+    EXPECT_FALSE(adapter.equalTo(JsonCppAdapter(otherName), true));
+    EXPECT_FALSE(adapter.equalTo(JsonCppAdapter(otherValue), true));
+    EXPECT_FALSE(adapter.equalTo(JsonCppAdapter(shorter), true));
+
+    // Weak comparison still allows strings to match numbers
+    EXPECT_TRUE(adapter.equalTo(JsonCppAdapter(otherValue), false));
+
+    // The result should not depend on whether the other value is accessed
+    // through the Adapter interface
+    const valijson::adapters::Adapter &erased = JsonCppAdapter(same);
+    EXPECT_TRUE(adapter.equalTo(erased, true));
+
+    const YAML::Node yamlDocument = YAML::Load("{b: '2', a: {x: [1, {y: ~}]}}");
+    EXPECT_TRUE(YamlCppAdapter(yamlDocument).equalTo(YamlCppAdapter(yamlDocument), true));
+}
+
+TEST_F(TestStructuralHash, EnumAndUniqueItems)
+{
+    const Json::Value schemaDocument = parseJson(
+            "{"
+            "  \"properties\": {"
+            "    \"choice\": { \"enum\": [{\"a\": [1, 2]}, {\"a\": [2, 1]}, \"x\"] },"
+            "    \"items\": { \"uniqueItems\": true }"
+            "  }"
+            "}");
+
+    Schema schema;
+    SchemaParser parser;
+    parser.populateSchema(JsonCppAdapter(schemaDocument), schema);
+
+    Validator strictValidator(Validator::kStrongTypes);
+    Validator weakValidator(Validator::kWeakTypes);
+
+    const Json::Value matching = parseJson("{\"choice\": {\"a\": [2.0, 1]}}");
+    EXPECT_TRUE(strictValidator.validate(schema, JsonCppAdapter(matching), nullptr));
+    EXPECT_TRUE(weakValidator.validate(schema, JsonCppAdapter(matching), nullptr));
+
+    const Json::Value notMatching = parseJson("{\"choice\": {\"a\": [1, 2, 3]}}");
+    EXPECT_FALSE(strictValidator.validate(schema, JsonCppAdapter(notMatching), nullptr));
+
+    // Weak comparison is not restricted to values with matching hashes
+    const Json::Value weakMatch = parseJson("{\"choice\": {\"a\": [\"1\", \"2\"]}}");
+    EXPECT_FALSE(strictValidator.validate(schema, JsonCppAdapter(weakMatch), nullptr));
+    EXPECT_TRUE(weakValidator.validate(schema, JsonCppAdapter(weakMatch), nullptr));
+
+    // Duplicates are reported in the order that they appear in the array
+    const Json::Value duplicates = parseJson(
+            "{\"items\": [{\"b\": 1}, 3, [1], {\"b\": 1.0}, 3.0, [1], {\"b\": 1}]}");
+    ValidationResults results;
+    EXPECT_FALSE(strictValidator.validate(schema, JsonCppAdapter(duplicates), &results));
+
+    const char *expected[] = {
+        "Elements at indexes #0 and #3 violate uniqueness constraint.",
+        "Elements at indexes #0 and #6 violate uniqueness constraint.",
+        "Elements at indexes #1 and #4 violate uniqueness constraint.",
+        "Elements at indexes #2 and #5 violate uniqueness constraint.",
+        "Elements at indexes #3 and #6 violate uniqueness constraint."
+    };
+
+    ValidationResults::Error error;
+    size_t numErrors = 0;
+    while (results.popError(error)) {
+        if (error.description.find("uniqueness") != std::string::npos) {
+            ASSERT_LT(numErrors, sizeof(expected) / sizeof(expected[0]));
+            EXPECT_EQ(expected[numErrors], error.description);
+            numErrors++;
+        }
+    }
+
+    EXPECT_EQ(sizeof(expected) / sizeof(expected[0]), numErrors);
+
+    const Json::Value unique = parseJson("{\"items\": [{\"b\": 1}, {\"b\": 2}, [1], [[1]], 1, \"1\"]}");
+    EXPECT_TRUE(strictValidator.validate(schema, JsonCppAdapter(unique), nullptr));
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::DefaultRegexEngine;
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::StrongTypesValidator;
+using valijson::ValidationResults;
+using valijson::Validator;
+using valijson::ValidatorT;
+using valijson::adapters::NlohmannJsonAdapter;
+
+using WeakTypesValidator = ValidatorT<DefaultRegexEngine, valijson::kWeakTypeChecking>;
+
+class TestTypeCheckingPolicy : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "count": { "type": "integer", "minimum": 10 },
+                "enabled": { "type": "boolean" },
+                "items": { "maxItems": 1 }
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestTypeCheckingPolicy, MatchesRuntimeMode)
+{
+    const nlohmann::json strings = nlohmann::json::parse(R"({"count": "12", "enabled": "true", "items": {}})");
+    const nlohmann::json typed = nlohmann::json::parse(R"({"count": 12, "enabled": true, "items": [1]})");
+    const nlohmann::json invalid = nlohmann::json::parse(R"({"count": 2, "enabled": true, "items": [1, 2]})");
+
+    Validator strong(Validator::kStrongTypes);
+    StrongTypesValidator compiledStrong;
+    EXPECT_FALSE(strong.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+    EXPECT_FALSE(compiledStrong.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+    EXPECT_TRUE(strong.validate(schema, NlohmannJsonAdapter(typed), nullptr));
+    EXPECT_TRUE(compiledStrong.validate(schema, NlohmannJsonAdapter(typed), nullptr));
+
+    Validator weak(Validator::kWeakTypes);
+    WeakTypesValidator compiledWeak;
+    EXPECT_TRUE(weak.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+    EXPECT_TRUE(compiledWeak.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+    EXPECT_TRUE(weak.validate(schema, NlohmannJsonAdapter(typed), nullptr));
+    EXPECT_TRUE(compiledWeak.validate(schema, NlohmannJsonAdapter(typed), nullptr));
+
+    ValidationResults strongResults;
+    ValidationResults compiledStrongResults;
+    EXPECT_FALSE(strong.validate(schema, NlohmannJsonAdapter(invalid), &strongResults));
+    EXPECT_FALSE(compiledStrong.validate(schema, NlohmannJsonAdapter(invalid), &compiledStrongResults));
+    EXPECT_EQ(strongResults.numErrors(), compiledStrongResults.numErrors());
+}
+
+TEST_F(TestTypeCheckingPolicy, IgnoresRuntimeMode)
+{
+    const nlohmann::json strings = nlohmann::json::parse(R"({"count": "12"})");
+
+    // The policy takes precedence over the mode passed to the constructor
+    StrongTypesValidator strong(StrongTypesValidator::kWeakTypes);
+    EXPECT_FALSE(strong.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+
+    WeakTypesValidator weak(WeakTypesValidator::kStrongTypes);
+    EXPECT_TRUE(weak.validate(schema, NlohmannJsonAdapter(strings), nullptr));
+}
+
+TEST_F(TestTypeCheckingPolicy, FormatAndMultipleOfIgnoreOtherTypes)
+{
+    const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+        "properties": {
+            "date": { "format": "date" },
+            "even": { "multipleOf": 2 },
+            "half": { "multipleOf": 0.5 }
+        }
+    })");
+
+    Schema typedSchema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), typedSchema);
+
+    // With strict types, 'format' only applies to strings and 'multipleOf'
+    // only applies to numbers
+    const nlohmann::json document = nlohmann::json::parse(R"({"date": 5, "even": "7", "half": "0.3"})");
+
+    Validator strong(Validator::kStrongTypes);
+    StrongTypesValidator compiledStrong;
+    EXPECT_TRUE(strong.validate(typedSchema, NlohmannJsonAdapter(document), nullptr));
+    EXPECT_TRUE(compiledStrong.validate(typedSchema, NlohmannJsonAdapter(document), nullptr));
+
+    Validator weak(Validator::kWeakTypes);
+    WeakTypesValidator compiledWeak;
+    ValidationResults weakResults;
+    ValidationResults compiledWeakResults;
+    EXPECT_FALSE(weak.validate(typedSchema, NlohmannJsonAdapter(document), &weakResults));
+    EXPECT_FALSE(compiledWeak.validate(typedSchema, NlohmannJsonAdapter(document), &compiledWeakResults));
+    EXPECT_EQ(weakResults.numErrors(), compiledWeakResults.numErrors());
+}
@@ -0,0 +1,142 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_metrics.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationMetrics;
+using valijson::ValidationResults;
+using valijson::ValidationStats;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace constraints = valijson::constraints;
+
+class TestValidationMetrics : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "a": { "type": "string", "pattern": "^x" },
+                "b": { "type": "integer" }
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestValidationMetrics, RecordsEachValidation)
+{
+    ValidationMetrics metrics("valijson", true);
+    Validator validator;
+    validator.setMetrics(&metrics);
+
+    const nlohmann::json valid = nlohmann::json::parse(R"({"a": "xy", "b": 1})");
+    const nlohmann::json invalid = nlohmann::json::parse(R"({"a": "yy", "b": "1"})");
+
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(valid), nullptr));
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalid), nullptr));
+
+    ValidationResults results;
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(invalid), &results));
+
+    const ValidationMetrics::Snapshot snapshot = metrics.snapshot();
+    EXPECT_EQ(3u, snapshot.validations);
+    EXPECT_EQ(2u, snapshot.failures);
+    EXPECT_EQ(results.numErrors(), snapshot.errors);
+
+    uint64_t histogramTotal = 0;
+    for (size_t i = 0; i <= ValidationMetrics::kNumLatencyBuckets; i++) {
+        histogramTotal += snapshot.latencyBuckets[i];
+    }
+    EXPECT_EQ(3u, histogramTotal);
+
+    EXPECT_EQ(2u, snapshot.stats.regexCacheHits);
+    EXPECT_EQ(1u, snapshot.stats.regexCacheMisses);
+    EXPECT_LT(0u, snapshot.stats.constraintsEvaluated[constraints::kType]);
+
+    metrics.reset();
+    EXPECT_EQ(0u, metrics.snapshot().validations);
+}
+
+TEST_F(TestValidationMetrics, SharedAcrossThreads)
+{
+    ValidationMetrics metrics("valijson", true);
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "xy", "b": 1})");
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.push_back(std::thread([&]() {
+            // Validators are not thread-safe, but metrics may be shared
+            Validator validator;
+            validator.setMetrics(&metrics);
+            for (int j = 0; j < 100; j++) {
+                validator.validate(schema, NlohmannJsonAdapter(document), nullptr);
+            }
+        }));
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    const ValidationMetrics::Snapshot snapshot = metrics.snapshot();
+    EXPECT_EQ(400u, snapshot.validations);
+    EXPECT_EQ(0u, snapshot.failures);
+    EXPECT_EQ(1200u, snapshot.stats.nodesVisited);
+}
+
+TEST_F(TestValidationMetrics, PrometheusTextFormat)
+{
+    ValidationMetrics metrics("sidecar", true);
+    Validator validator;
+    validator.setMetrics(&metrics);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "xy"})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+
+    const std::string text = metrics.render();
+    EXPECT_NE(std::string::npos, text.find("# TYPE sidecar_validations_total counter\nsidecar_validations_total 1\n"));
+    EXPECT_NE(std::string::npos, text.find("# TYPE sidecar_validation_duration_seconds histogram\n"));
+    EXPECT_NE(std::string::npos, text.find("sidecar_validation_duration_seconds_bucket{le=\"+Inf\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("sidecar_validation_duration_seconds_count 1\n"));
+    EXPECT_NE(std::string::npos, text.find("sidecar_constraints_evaluated_total{kind=\"Type\"} 2\n"));
+    EXPECT_NE(std::string::npos, text.find("sidecar_regex_cache_misses_total 1\n"));
+    EXPECT_NE(std::string::npos, text.find("sidecar_peak_depth 2\n"));
+}
+
+TEST_F(TestValidationMetrics, WithoutStats)
+{
+    ValidationMetrics metrics;
+    Validator validator;
+    validator.setMetrics(&metrics);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "xy"})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+
+    const std::string text = metrics.render();
+    EXPECT_NE(std::string::npos, text.find("valijson_validations_total 1\n"));
+    EXPECT_EQ(std::string::npos, text.find("valijson_nodes_visited_total"));
+
+    // Counters are still recorded for callers that ask for them
+    ValidationStats stats;
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr, &stats));
+    EXPECT_EQ(stats.nodesVisited, metrics.snapshot().stats.nodesVisited);
+    EXPECT_LT(0u, metrics.snapshot().stats.nodesVisited);
+}
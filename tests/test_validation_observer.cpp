@@ -0,0 +1,174 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/observers/chrome_trace_observer.hpp>
+#include <valijson/observers/collapsed_stack_observer.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_observer.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::Subschema;
+using valijson::ValidationObserver;
+using valijson::ValidationResults;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::observers::ChromeTraceObserver;
+using valijson::observers::CollapsedStackObserver;
+
+namespace constraints = valijson::constraints;
+
+namespace {
+
+class RecordingObserver : public ValidationObserver
+{
+public:
+    void enterSubschema(const Subschema &subschema,
+            const std::vector<std::string> &context) override
+    {
+        events.push_back("enter " + describeSubschema(subschema) + " @" + documentPath(context));
+    }
+
+    void exitSubschema(const Subschema &subschema,
+            const std::vector<std::string> &, bool validated) override
+    {
+        events.push_back("exit " + describeSubschema(subschema) + (validated ? " ok" : " fail"));
+    }
+
+    void enterConstraint(const Subschema &subschema,
+            const constraints::Constraint &, constraints::ConstraintKind kind,
+            const std::vector<std::string> &context) override
+    {
+        events.push_back("enter " + describeConstraint(subschema, kind) + " @" + documentPath(context));
+    }
+
+    void exitConstraint(const Subschema &subschema,
+            const constraints::Constraint &, constraints::ConstraintKind kind,
+            const std::vector<std::string> &, bool validated) override
+    {
+        events.push_back("exit " + describeConstraint(subschema, kind) + (validated ? " ok" : " fail"));
+    }
+
+    std::vector<std::string> events;
+};
+
+}  // end anonymous namespace
+
+class TestValidationObserver : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "definitions": {
+                "tag": { "type": "string" }
+            },
+            "properties": {
+                "a/b": { "type": "array", "items": { "$ref": "#/definitions/tag" } }
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestValidationObserver, EventsAreNestedAndCarryPaths)
+{
+    RecordingObserver observer;
+    Validator validator;
+    validator.setObserver(&observer);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a/b": [1]})");
+    ValidationResults results;
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(document), &results));
+
+    const std::vector<std::string> expected = {
+        "enter # @",
+        "enter #/properties @",
+        "enter #/properties/a/b @/a~1b",
+        "enter #/properties/a/b/type @/a~1b",
+        "exit #/properties/a/b/type ok",
+        "enter #/properties/a/b/items @/a~1b",
+        "enter #/definitions/tag @/a~1b/0",
+        "enter #/definitions/tag/type @/a~1b/0",
+        "exit #/definitions/tag/type fail",
+        "exit #/definitions/tag fail",
+        "exit #/properties/a/b/items fail",
+        "exit #/properties/a/b fail",
+        "exit #/properties fail",
+        "exit # fail"
+    };
+
+    EXPECT_EQ(expected, observer.events);
+}
+
+TEST_F(TestValidationObserver, DocumentPath)
+{
+    EXPECT_EQ("", ValidationObserver::documentPath({"<root>"}));
+    EXPECT_EQ("/a/0/~0~1", ValidationObserver::documentPath({"<root>", "[a]", "[0]", "[~/]"}));
+}
+
+TEST_F(TestValidationObserver, ChromeTraceIsValidJson)
+{
+    ChromeTraceObserver observer;
+    Validator validator;
+    validator.setObserver(&observer);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a/b": ["x", "y"]})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+
+    std::stringstream ss;
+    observer.write(ss);
+
+    const nlohmann::json trace = nlohmann::json::parse(ss.str());
+    const nlohmann::json &events = trace["traceEvents"];
+    ASSERT_EQ(observer.size(), events.size());
+
+    // Each begin event is matched by an end event
+    size_t begins = 0;
+    size_t ends = 0;
+    for (const nlohmann::json &event : events) {
+        if (event["ph"] == "B") {
+            begins++;
+        } else if (event["ph"] == "E") {
+            ends++;
+        }
+    }
+    EXPECT_EQ(begins, ends);
+
+    EXPECT_EQ("#", events[0]["name"]);
+    EXPECT_EQ("subschema", events[0]["cat"]);
+    EXPECT_EQ("", events[0]["args"]["document"]);
+
+    observer.clear();
+    EXPECT_EQ(0u, observer.size());
+}
+
+TEST_F(TestValidationObserver, CollapsedStacks)
+{
+    CollapsedStackObserver observer;
+    Validator validator;
+    validator.setObserver(&observer);
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a/b": ["x", "y"]})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr));
+
+    const std::map<std::string, uint64_t> &stacks = observer.stacks();
+    EXPECT_EQ(1u, stacks.count("#;properties;#/properties/a/b;items;#/definitions/tag;type"));
+    EXPECT_EQ(1u, stacks.count("#;properties;#/properties/a/b;type"));
+
+    std::stringstream ss;
+    observer.write(ss);
+    EXPECT_NE(std::string::npos, ss.str().find("#;properties "));
+
+    observer.clear();
+    EXPECT_TRUE(observer.stacks().empty());
+}
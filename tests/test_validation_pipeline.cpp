@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/internal/bounded_queue.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/utils/nlohmann_json_utils.hpp>
+#include <valijson/validation_observer.hpp>
+#include <valijson/validation_pipeline.hpp>
+
+#define TEST_DATA_DIR "../tests/data"
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationPipeline;
+using valijson::adapters::NlohmannJsonAdapter;
+using valijson::internal::BoundedQueue;
+
+typedef ValidationPipeline<nlohmann::json, NlohmannJsonAdapter> NlohmannJsonPipeline;
+
+namespace constraints = valijson::constraints;
+
+namespace {
+
+/**
+ * Observer that does nothing, used to check that observers are rejected
+ */
+class NullObserver: public valijson::ValidationObserver
+{
+public:
+    void enterSubschema(const valijson::Subschema &, const std::vector<std::string> &) override { }
+
+    void exitSubschema(const valijson::Subschema &, const std::vector<std::string> &, bool) override { }
+
+    void enterConstraint(const valijson::Subschema &, const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &) override { }
+
+    void exitConstraint(const valijson::Subschema &, const constraints::Constraint &, constraints::ConstraintKind,
+            const std::vector<std::string> &, bool) override { }
+};
+
+}  // end anonymous namespace
+
+class TestValidationPipeline : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "array",
+            "items": { "type": "integer" }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    static bool parseText(const std::string &text, nlohmann::json &document)
+    {
+        document = nlohmann::json::parse(text, nullptr, false);
+        return !document.is_discarded();
+    }
+
+    /// Return a Source that reads from a vector of strings
+    static NlohmannJsonPipeline::Source sourceFor(const std::vector<std::string> &inputs, size_t &numRead)
+    {
+        numRead = 0;
+        return [&inputs, &numRead](std::string &input) {
+            if (numRead == inputs.size()) {
+                return false;
+            }
+            input = inputs[numRead++];
+            return true;
+        };
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestValidationPipeline, ResultsAreDeliveredInOrder)
+{
+    std::vector<std::string> inputs;
+    for (int i = 0; i < 500; i++) {
+        if (i % 50 == 7) {
+            inputs.push_back("[1, 2, \"three\"]");
+        } else if (i % 50 == 13) {
+            inputs.push_back("[1, 2");
+        } else {
+            inputs.push_back("[" + std::to_string(i) + ", 1, 2]");
+        }
+    }
+
+    NlohmannJsonPipeline pipeline(schema, parseText);
+    pipeline.setParseThreads(2);
+    pipeline.setValidateThreads(3);
+    pipeline.setCapacity(8);
+
+    size_t numRead = 0;
+    size_t numResults = 0;
+    size_t maxInFlight = 0;
+    const bool valid = pipeline.validate(sourceFor(inputs, numRead),
+            [&numRead, &numResults, &maxInFlight](const NlohmannJsonPipeline::Result &result) {
+        maxInFlight = std::max(maxInFlight, numRead - numResults);
+        EXPECT_EQ(numResults, result.index);
+        const int i = static_cast<int>(result.index);
+        EXPECT_EQ(i % 50 != 13, result.parsed) << i;
+        EXPECT_EQ(i % 50 != 13 && i % 50 != 7, result.valid) << i;
+        EXPECT_EQ(i % 50 == 7 ? 2u : 0u, result.results.numErrors()) << i;
+        EXPECT_EQ(i % 50 == 13, !result.error.empty()) << i;
+        numResults++;
+    });
+
+    EXPECT_FALSE(valid);
+    EXPECT_EQ(inputs.size(), numResults);
+
+    // The source is not read while the pipeline is full
+    EXPECT_LE(maxInFlight, 8u);
+}
+
+TEST_F(TestValidationPipeline, EmptyAndValidStreams)
+{
+    NlohmannJsonPipeline pipeline(schema, parseText);
+    pipeline.setCollectResults(false);
+
+    size_t numRead = 0;
+    size_t numResults = 0;
+    const NlohmannJsonPipeline::Sink sink = [&numResults](const NlohmannJsonPipeline::Result &) {
+        numResults++;
+    };
+
+    const std::vector<std::string> empty;
+    EXPECT_TRUE(pipeline.validate(sourceFor(empty, numRead), sink));
+    EXPECT_EQ(0u, numResults);
+
+    const std::vector<std::string> inputs(100, "[1, 2, 3]");
+    EXPECT_TRUE(pipeline.validate(sourceFor(inputs, numRead), sink));
+    EXPECT_EQ(100u, numResults);
+}
+
+TEST_F(TestValidationPipeline, IdleWorkersWake)
+{
+    // A slow source leaves the worker threads idle for long enough that they
+    // block, so each document must wake them again
+    const std::vector<std::string> inputs = {"[1]", "[2, \"x\"]", "[3]", "[4]", "[5"};
+    size_t numRead = 0;
+    const NlohmannJsonPipeline::Source source = sourceFor(inputs, numRead);
+    const NlohmannJsonPipeline::Source slowSource = [&source](std::string &input) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return source(input);
+    };
+
+    NlohmannJsonPipeline pipeline(schema, parseText);
+    pipeline.setParseThreads(2);
+    pipeline.setValidateThreads(2);
+
+    std::vector<bool> results;
+    EXPECT_FALSE(pipeline.validate(slowSource, [&results](const NlohmannJsonPipeline::Result &result) {
+        results.push_back(result.valid);
+    }));
+
+    EXPECT_EQ(std::vector<bool>({true, false, true, true, false}), results);
+}
+
+TEST_F(TestValidationPipeline, LoadDocument)
+{
+    // Functions from the utils headers can be used when the source produces
+    // file paths
+    const std::vector<std::string> paths = {
+        TEST_DATA_DIR "/documents/array_integers_1_2_3.json",
+        TEST_DATA_DIR "/documents/array_doubles_1_2_3.json",
+        TEST_DATA_DIR "/documents/array_empty.json"
+    };
+
+    NlohmannJsonPipeline pipeline(schema, valijson::utils::loadDocument);
+    std::vector<bool> results;
+    size_t numRead = 0;
+    pipeline.validate(sourceFor(paths, numRead), [&results](const NlohmannJsonPipeline::Result &result) {
+        EXPECT_TRUE(result.parsed);
+        results.push_back(result.valid);
+    });
+
+    EXPECT_EQ(std::vector<bool>({true, false, true}), results);
+}
+
+#if VALIJSON_USE_EXCEPTIONS
+TEST_F(TestValidationPipeline, ParserExceptions)
+{
+    NlohmannJsonPipeline pipeline(schema, [](const std::string &text, nlohmann::json &document) {
+        document = nlohmann::json::parse(text);
+        return true;
+    });
+
+    const std::vector<std::string> inputs = {"[1]", "{", "[2]"};
+    std::vector<std::string> errors;
+    size_t numRead = 0;
+    EXPECT_FALSE(pipeline.validate(sourceFor(inputs, numRead), [&errors](const NlohmannJsonPipeline::Result &result) {
+        errors.push_back(result.error);
+    }));
+
+    ASSERT_EQ(3u, errors.size());
+    EXPECT_TRUE(errors[0].empty());
+    EXPECT_FALSE(errors[1].empty());
+    EXPECT_TRUE(errors[2].empty());
+}
+TEST_F(TestValidationPipeline, RejectObserver)
+{
+    // Observers are not thread-safe, so cannot be shared by validation threads
+    NullObserver observer;
+    valijson::Validator prototype;
+    prototype.setObserver(&observer);
+
+    EXPECT_THROW(NlohmannJsonPipeline(schema, parseText, prototype), std::logic_error);
+}
+#endif
+
+TEST_F(TestValidationPipeline, BoundedQueue)
+{
+    BoundedQueue<int> queue(3);
+    EXPECT_EQ(4u, queue.capacity());
+
+    for (int i = 0; i < 4; i++) {
+        int value = i;
+        EXPECT_TRUE(queue.tryPush(value));
+    }
+
+    int value = 4;
+    EXPECT_FALSE(queue.tryPush(value));
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(i, value);
+    }
+
+    EXPECT_FALSE(queue.tryPop(value));
+}
@@ -0,0 +1,176 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_session.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validation_thread_pool.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationSession;
+using valijson::ValidationStats;
+using valijson::ValidationThreadPool;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+class TestValidationSession : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "id": { "anyOf": [ { "type": "integer" }, { "type": "string", "pattern": "^[a-z]+$" } ] },
+                "tags": { "type": "array", "items": { "type": "string" }, "maxItems": 3 },
+                "pair": { "type": "array", "items": [ { "type": "integer" }, { "type": "boolean" } ] },
+                "shape": {
+                    "oneOf": [
+                        { "properties": { "radius": { "type": "number" } }, "required": ["radius"] },
+                        { "properties": { "width": { "type": "number" } }, "required": ["width"] }
+                    ]
+                },
+                "kind": {
+                    "if": { "type": "string" },
+                    "then": { "enum": ["a", "b"] },
+                    "else": { "type": "integer", "minimum": 0 }
+                }
+            },
+            "patternProperties": {
+                "^x-": { "type": "string" }
+            },
+            "additionalProperties": { "type": "number" }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+
+        documents.push_back(nlohmann::json::parse(R"({"id": 1, "tags": ["a"], "shape": {"radius": 1}})"));
+        documents.push_back(nlohmann::json::parse(R"({
+            "id": "ABC",
+            "tags": ["a", 2, "c", "d"],
+            "pair": [1, 2],
+            "shape": {"radius": "big", "width": 1},
+            "kind": "c",
+            "x-note": 5,
+            "extra": "text"
+        })"));
+        documents.push_back(nlohmann::json::parse(R"({"id": "abc", "kind": 3, "x-note": "n", "extra": 1.5})"));
+        documents.push_back(nlohmann::json::parse(R"({"shape": {"radius": 1, "width": 2}, "kind": -1})"));
+    }
+
+    /// Return the errors reported by a validator, in a comparable form
+    static std::vector<std::string> errors(const ValidationResults &results)
+    {
+        std::vector<std::string> errors;
+        for (const ValidationResults::Error &error : results) {
+            std::string text;
+            for (const std::string &element : error.context) {
+                text += element;
+            }
+            errors.push_back(text + ": " + error.description);
+        }
+
+        return errors;
+    }
+
+    Schema schema;
+    std::vector<nlohmann::json> documents;
+};
+
+TEST_F(TestValidationSession, MatchesValidator)
+{
+    ValidationSession session;
+
+    // Storage is reused by later calls, which must not be affected by the
+    // contexts and results left over from earlier ones
+    for (int pass = 0; pass < 3; pass++) {
+        for (const nlohmann::json &document : documents) {
+            Validator validator;
+            ValidationResults expected;
+            const bool valid = validator.validate(schema, NlohmannJsonAdapter(document), &expected);
+
+            EXPECT_EQ(valid, session.validate(schema, NlohmannJsonAdapter(document)));
+            EXPECT_EQ(errors(expected), errors(session.results()));
+        }
+    }
+
+    EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(documents[0])));
+    EXPECT_EQ(0u, session.results().numErrors());
+}
+
+TEST_F(TestValidationSession, WithoutResults)
+{
+    ValidationSession session(Validator(), false);
+
+    for (int pass = 0; pass < 2; pass++) {
+        EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(documents[0])));
+        EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(documents[1])));
+        EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(documents[2])));
+        EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(documents[3])));
+        EXPECT_EQ(0u, session.results().numErrors());
+    }
+}
+
+TEST_F(TestValidationSession, ResetAndReleaseMemory)
+{
+    ValidationSession session;
+    EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(documents[1])));
+    const size_t numErrors = session.results().numErrors();
+    EXPECT_GT(numErrors, 0u);
+
+    session.reset();
+    EXPECT_EQ(0u, session.results().numErrors());
+
+    session.releaseMemory();
+    EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(documents[1])));
+    EXPECT_EQ(numErrors, session.results().numErrors());
+}
+
+#if VALIJSON_USE_INSTRUMENTATION
+TEST_F(TestValidationSession, PatternPropertiesRegexesAreReused)
+{
+    ValidationSession session(Validator(), false);
+    ValidationStats stats;
+
+    EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(documents[2]), &stats));
+    EXPECT_EQ(0u, stats.regexCacheHits);
+    EXPECT_EQ(2u, stats.regexCacheMisses);
+
+    // Both the 'pattern' and 'patternProperties' regexes are kept
+    EXPECT_TRUE(session.validate(schema, NlohmannJsonAdapter(documents[2]), &stats));
+    EXPECT_EQ(2u, stats.regexCacheHits);
+    EXPECT_EQ(0u, stats.regexCacheMisses);
+}
+#endif
+
+TEST_F(TestValidationSession, ParallelValidation)
+{
+    nlohmann::json document = {{"id", 1}};
+    for (int i = 0; i < 1000; i++) {
+        document["tags"].push_back(i % 100 == 0 ? nlohmann::json(i) : nlohmann::json("tag"));
+        document["m" + std::to_string(i)] = i % 250 == 0 ? nlohmann::json("text") : nlohmann::json(i);
+    }
+
+    Validator serial;
+    ValidationResults expected;
+    EXPECT_FALSE(serial.validate(schema, NlohmannJsonAdapter(document), &expected));
+
+    ValidationThreadPool pool(2);
+    Validator prototype;
+    prototype.setThreadPool(&pool, 16);
+    ValidationSession session(prototype);
+
+    for (int pass = 0; pass < 2; pass++) {
+        EXPECT_FALSE(session.validate(schema, NlohmannJsonAdapter(document)));
+        EXPECT_EQ(errors(expected), errors(session.results()));
+    }
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/nlohmann_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validation_results.hpp>
+#include <valijson/validation_stats.hpp>
+#include <valijson/validator.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::ValidationResults;
+using valijson::ValidationStats;
+using valijson::Validator;
+using valijson::adapters::NlohmannJsonAdapter;
+
+namespace constraints = valijson::constraints;
+
+class TestValidationStats : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+            "type": "object",
+            "properties": {
+                "a": { "type": "string", "pattern": "^x" },
+                "b": { "type": "array", "items": { "type": "integer" } }
+            },
+            "patternProperties": {
+                "^c": { "type": "integer" }
+            }
+        })");
+
+        SchemaParser parser;
+        parser.populateSchema(NlohmannJsonAdapter(schemaDocument), schema);
+    }
+
+    Schema schema;
+};
+
+TEST_F(TestValidationStats, CountsWork)
+{
+    Validator validator;
+    ValidationStats stats;
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "xy", "b": [1, 2], "c1": 3})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr, &stats));
+
+    EXPECT_EQ(6u, stats.nodesVisited);
+    EXPECT_EQ(6u, stats.subschemasEntered);
+    EXPECT_EQ(6u, stats.constraintsEvaluated[constraints::kType]);
+    EXPECT_EQ(1u, stats.constraintsEvaluated[constraints::kPattern]);
+    EXPECT_EQ(1u, stats.constraintsEvaluated[constraints::kProperties]);
+    EXPECT_EQ(1u, stats.constraintsEvaluated[constraints::kSingularItems]);
+    EXPECT_EQ(9u, stats.totalConstraintsEvaluated());
+    EXPECT_EQ(3u, stats.peakDepth);
+    EXPECT_EQ(0u, valijson::internal::ValidationDepthTracker::depth(stats));
+
+    // One search for 'pattern', and one per property for 'patternProperties'
+    EXPECT_EQ(4u, stats.regexInvocations);
+    EXPECT_EQ(0u, stats.regexCacheHits);
+    EXPECT_EQ(2u, stats.regexCacheMisses);
+}
+
+TEST_F(TestValidationStats, ResetOnEachCall)
+{
+    Validator validator;
+    ValidationStats stats;
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "xy"})");
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr, &stats));
+    EXPECT_EQ(2u, stats.regexCacheMisses);
+
+    // The compiled 'pattern' regex is now cached by the validator, but the
+    // 'patternProperties' regex is compiled on every call
+    EXPECT_TRUE(validator.validate(schema, NlohmannJsonAdapter(document), nullptr, &stats));
+    EXPECT_EQ(2u, stats.nodesVisited);
+    EXPECT_EQ(1u, stats.regexCacheHits);
+    EXPECT_EQ(1u, stats.regexCacheMisses);
+
+    ValidationStats totals;
+    totals.add(stats);
+    totals.add(stats);
+    EXPECT_EQ(4u, totals.nodesVisited);
+    EXPECT_EQ(2u, totals.peakDepth);
+}
+
+TEST_F(TestValidationStats, CountsWithResults)
+{
+    Validator validator;
+    ValidationStats stats;
+    ValidationResults results;
+
+    const nlohmann::json document = nlohmann::json::parse(R"({"a": "y", "b": ["x", "y"]})");
+    EXPECT_FALSE(validator.validate(schema, NlohmannJsonAdapter(document), &results, &stats));
+
+    // All items are visited when collecting results
+    EXPECT_EQ(5u, stats.nodesVisited);
+    EXPECT_EQ(5u, stats.constraintsEvaluated[constraints::kType]);
+}
+
+TEST_F(TestValidationStats, CountsValueComparisons)
+{
+    const nlohmann::json schemaDocument = nlohmann::json::parse(R"({
+        "properties": {
+            "const": { "const": [1, 2] },
+            "enum": { "enum": ["a", "b", "c"] },
+            "unique": { "uniqueItems": true }
+        }
+    })");
+
+    Schema comparisonSchema;
+    SchemaParser parser;
+    parser.populateSchema(NlohmannJsonAdapter(schemaDocument), comparisonSchema);
+
+    Validator validator;
+    ValidationStats stats;
+    ValidationResults results;
+
+    // Only enum values and array items with the same hash as one another
+    // are compared
+    const nlohmann::json document = nlohmann::json::parse(R"({"const": [1, 2], "enum": "c", "unique": [1, 2, 3, 1]})");
+    EXPECT_FALSE(validator.validate(comparisonSchema, NlohmannJsonAdapter(document), &results, &stats));
+    EXPECT_EQ(3u, stats.valueComparisons);
+}
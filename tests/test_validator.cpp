@@ -12,11 +12,13 @@
 #include <gtest/gtest.h>
 
 #include <valijson/adapters/json11_adapter.hpp>
+#include <valijson/adapters/json_tape_adapter.hpp>
 #include <valijson/adapters/jsoncpp_adapter.hpp>
 #include <valijson/adapters/rapidjson_adapter.hpp>
 #include <valijson/adapters/picojson_adapter.hpp>
 #include <valijson/adapters/nlohmann_json_adapter.hpp>
 #include <valijson/utils/json11_utils.hpp>
+#include <valijson/utils/json_tape_utils.hpp>
 #include <valijson/utils/jsoncpp_utils.hpp>
 #include <valijson/utils/picojson_utils.hpp>
 #include <valijson/utils/rapidjson_utils.hpp>
@@ -175,6 +177,7 @@ protected:
                          const SchemaParser::Version version)
     {
         processTestFile<valijson::adapters::Json11Adapter>(testFile, version);
+        processTestFile<valijson::adapters::JsonTapeAdapter>(testFile, version);
         processTestFile<valijson::adapters::JsonCppAdapter>(testFile, version);
         processTestFile<valijson::adapters::RapidJsonAdapter>(testFile, version);
         processTestFile<valijson::adapters::PicoJsonAdapter>(testFile, version);
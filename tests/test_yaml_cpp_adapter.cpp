@@ -108,3 +108,39 @@ TEST_F(TestYamlCppAdapter, BasicObjectMemberAccess)
     const auto result12 = adapterObject.find("12");
     EXPECT_EQ(result12, adapterObject.end());
 }
+
+TEST_F(TestYamlCppAdapter, ScalarConversions)
+{
+    const YAML::Node document = YAML::Load(
+        "integer: 42\n"
+        "signed: +7\n"
+        "overflow: 9223372036854775808\n"
+        "hex: 0x10\n"
+        "double: 2.5\n"
+        "boolean: true\n"
+        "text: hello\n");
+
+    valijson::adapters::YamlCppAdapter adapter(document);
+    const auto object = adapter.asObject();
+
+    EXPECT_TRUE(object.find("integer")->second.maybeInteger());
+    EXPECT_EQ(42, object.find("integer")->second.asInteger());
+    EXPECT_EQ(7, object.find("signed")->second.asInteger());
+    EXPECT_FALSE(object.find("overflow")->second.maybeInteger());
+    EXPECT_TRUE(object.find("overflow")->second.maybeDouble());
+    EXPECT_FALSE(object.find("hex")->second.maybeInteger());
+    EXPECT_FALSE(object.find("double")->second.maybeInteger());
+    EXPECT_EQ(2.5, object.find("double")->second.asDouble());
+    EXPECT_TRUE(object.find("boolean")->second.asBool());
+    EXPECT_FALSE(object.find("text")->second.maybeDouble());
+    EXPECT_EQ("hello", object.find("text")->second.asString());
+
+    // Typed accessors convert scalars, and fail rather than throwing when a
+    // scalar cannot be converted
+    double d = 0;
+    EXPECT_TRUE(object.find("double")->second.getDouble(d));
+    EXPECT_EQ(2.5, d);
+    EXPECT_FALSE(object.find("text")->second.getDouble(d));
+    int64_t i = 0;
+    EXPECT_FALSE(object.find("text")->second.getInteger(i));
+}
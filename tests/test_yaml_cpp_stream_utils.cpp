@@ -0,0 +1,278 @@
+#include <sstream>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <valijson/adapters/yaml_cpp_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/utils/yaml_cpp_stream_utils.hpp>
+
+using valijson::Schema;
+using valijson::SchemaParser;
+using valijson::adapters::YamlCppAdapter;
+using valijson::utils::YamlDocumentReader;
+using valijson::utils::YamlStreamValidator;
+
+namespace {
+
+/**
+ * Constraint that throws an exception when it is used to validate the integer
+ * 13, so that an exception can be raised on a worker thread
+ */
+class ThrowingConstraint: public valijson::constraints::PolyConstraint
+{
+public:
+    Constraint * cloneInto(void *ptr) const override
+    {
+        return new (ptr) ThrowingConstraint();
+    }
+
+    size_t sizeOf() const override
+    {
+        return sizeof(ThrowingConstraint);
+    }
+
+    bool validate(const valijson::adapters::Adapter &target, const std::vector<std::string> &,
+            valijson::ValidationResults *) const override
+    {
+        int64_t value;
+        if (target.maybeInteger() && target.asInteger(value) && value == 13) {
+            throw std::runtime_error("unlucky document");
+        }
+
+        return true;
+    }
+};
+
+}  // end anonymous namespace
+
+class TestYamlCppStreamUtils : public testing::Test
+{
+protected:
+
+    static void parseSchema(const std::string &text, Schema &schema)
+    {
+        const YAML::Node document = YAML::Load(text);
+        SchemaParser parser;
+        parser.populateSchema(YamlCppAdapter(document), schema);
+    }
+};
+
+TEST_F(TestYamlCppStreamUtils, ReadDocuments)
+{
+    std::istringstream input(
+        "# leading comment\n"
+        "a: 1\n"
+        "---\n"
+        "b: 2\n"
+        "--- [1, 2]\n"
+        "...\n"
+        "%YAML 1.2\n"
+        "---\n"
+        "c: 3\n"
+        "---\n");
+
+    YamlDocumentReader reader(input);
+    YAML::Node document;
+
+    ASSERT_TRUE(reader.next(document));
+    EXPECT_EQ(2u, reader.documentLine());
+    EXPECT_EQ(1, document["a"].as<int>());
+
+    ASSERT_TRUE(reader.next(document));
+    EXPECT_EQ(3u, reader.documentLine());
+    EXPECT_EQ(2, document["b"].as<int>());
+
+    ASSERT_TRUE(reader.next(document));
+    EXPECT_EQ(5u, reader.documentLine());
+    ASSERT_TRUE(document.IsSequence());
+    EXPECT_EQ(2u, document.size());
+
+    ASSERT_TRUE(reader.next(document));
+    EXPECT_EQ(8u, reader.documentLine());
+    EXPECT_EQ(3, document["c"].as<int>());
+
+    // A trailing document start marker introduces an empty document
+    ASSERT_TRUE(reader.next(document));
+    EXPECT_EQ(10u, reader.documentLine());
+    EXPECT_TRUE(document.IsNull());
+
+    EXPECT_FALSE(reader.next(document));
+}
+
+TEST_F(TestYamlCppStreamUtils, ReadEmptyStream)
+{
+    std::istringstream input("# nothing to see here\n\n");
+    YamlDocumentReader reader(input);
+    std::string text;
+    EXPECT_FALSE(reader.nextText(text));
+}
+
+TEST_F(TestYamlCppStreamUtils, ValidateWithSingleSchema)
+{
+    Schema schema;
+    parseSchema("type: object\nrequired: [name]\n", schema);
+
+    std::istringstream input(
+        "name: first\n"
+        "---\n"
+        "other: second\n"
+        "---\n"
+        "name: [unterminated\n"
+        "---\n"
+        "name: fourth\n");
+
+    std::vector<YamlStreamValidator::Result> results;
+    YamlStreamValidator validator(schema);
+    EXPECT_FALSE(validator.validate(input, results));
+
+    ASSERT_EQ(4u, results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        EXPECT_EQ(i, results[i].index);
+    }
+
+    EXPECT_TRUE(results[0].valid);
+    EXPECT_EQ(0u, results[0].results.numErrors());
+
+    EXPECT_TRUE(results[1].parsed);
+    EXPECT_FALSE(results[1].valid);
+    EXPECT_LT(0u, results[1].results.numErrors());
+
+    // A document that cannot be parsed does not stop later documents from
+    // being validated
+    EXPECT_FALSE(results[2].parsed);
+    EXPECT_FALSE(results[2].valid);
+    EXPECT_FALSE(results[2].error.empty());
+    EXPECT_EQ(4u, results[2].line);
+
+    EXPECT_TRUE(results[3].valid);
+    EXPECT_EQ(6u, results[3].line);
+}
+
+TEST_F(TestYamlCppStreamUtils, SelectByDiscriminator)
+{
+    Schema deployment;
+    parseSchema("required: [spec]\n", deployment);
+
+    Schema service;
+    parseSchema("required: [ports]\n", service);
+
+    std::map<std::string, const valijson::Subschema *> schemas;
+    schemas["apps/v1/Deployment"] = &deployment;
+    schemas["v1/Service"] = &service;
+
+    std::istringstream input(
+        "apiVersion: apps/v1\n"
+        "kind: Deployment\n"
+        "spec: {}\n"
+        "---\n"
+        "apiVersion: v1\n"
+        "kind: Service\n"
+        "spec: {}\n"
+        "---\n"
+        "apiVersion: v1\n"
+        "kind: ConfigMap\n");
+
+    std::vector<YamlStreamValidator::Result> results;
+    YamlStreamValidator validator(YamlStreamValidator::selectByDiscriminator(schemas));
+    EXPECT_FALSE(validator.validate(input, results));
+
+    ASSERT_EQ(3u, results.size());
+    EXPECT_EQ(&deployment, results[0].schema);
+    EXPECT_TRUE(results[0].valid);
+    EXPECT_EQ(&service, results[1].schema);
+    EXPECT_FALSE(results[1].valid);
+
+    // Documents without a matching schema are reported, not validated
+    EXPECT_TRUE(results[2].parsed);
+    EXPECT_EQ(nullptr, results[2].schema);
+    EXPECT_FALSE(results[2].valid);
+    EXPECT_FALSE(results[2].error.empty());
+}
+
+TEST_F(TestYamlCppStreamUtils, ValidateInParallel)
+{
+    Schema schema;
+    parseSchema("properties:\n  id:\n    type: integer\n    multipleOf: 3\n", schema);
+
+    std::ostringstream stream;
+    const size_t numDocuments = 100;
+    for (size_t i = 0; i < numDocuments; i++) {
+        stream << "---\nid: " << i << "\n";
+    }
+
+    std::istringstream sequentialInput(stream.str());
+    std::vector<YamlStreamValidator::Result> sequential;
+    YamlStreamValidator sequentialValidator(schema);
+    EXPECT_FALSE(sequentialValidator.validate(sequentialInput, sequential));
+
+    std::istringstream parallelInput(stream.str());
+    std::vector<YamlStreamValidator::Result> parallel;
+    YamlStreamValidator parallelValidator(schema);
+    parallelValidator.setThreads(4);
+    EXPECT_FALSE(parallelValidator.validate(parallelInput, parallel));
+
+    ASSERT_EQ(numDocuments, sequential.size());
+    ASSERT_EQ(numDocuments, parallel.size());
+    for (size_t i = 0; i < numDocuments; i++) {
+        EXPECT_EQ(i, parallel[i].index);
+        EXPECT_EQ(i % 3 == 0, parallel[i].valid);
+        EXPECT_EQ(sequential[i].valid, parallel[i].valid);
+        EXPECT_EQ(sequential[i].results.numErrors(), parallel[i].results.numErrors());
+    }
+}
+
+TEST_F(TestYamlCppStreamUtils, ValidateInParallelRethrows)
+{
+    Schema schema;
+    schema.addConstraintToSubschema(ThrowingConstraint(), schema.root());
+
+    std::ostringstream stream;
+    for (size_t i = 0; i < 100; i++) {
+        stream << "--- " << i << "\n";
+    }
+
+    // An exception thrown on a worker thread is rethrown by validate()
+    std::istringstream input(stream.str());
+    std::vector<YamlStreamValidator::Result> results;
+    YamlStreamValidator validator(schema);
+    validator.setThreads(4);
+    EXPECT_THROW(validator.validate(input, results), std::runtime_error);
+    EXPECT_GE(13u, results.size());
+
+    // The same threads can then be used to validate another stream
+    std::istringstream validInput("--- 1\n--- 2\n--- 3\n");
+    results.clear();
+    EXPECT_TRUE(validator.validate(validInput, results));
+    EXPECT_EQ(3u, results.size());
+}
+
+TEST_F(TestYamlCppStreamUtils, ValidatorPrototype)
+{
+    Schema schema;
+    parseSchema("type: integer\n", schema);
+
+    // yaml-cpp reports every scalar as a string, so an integer only matches
+    // with weak type checking, which is the default
+    std::istringstream weakInput("--- 3\n");
+    std::vector<YamlStreamValidator::Result> results;
+    YamlStreamValidator weakValidator(schema);
+    EXPECT_TRUE(weakValidator.validate(weakInput, results));
+
+    std::istringstream strongInput("--- 3\n");
+    results.clear();
+    YamlStreamValidator strongValidator(schema, valijson::Validator::kStrongTypes);
+    EXPECT_FALSE(strongValidator.validate(strongInput, results));
+
+    // The regex engine and type checking policy can be chosen at compile time
+    typedef valijson::utils::YamlStreamValidatorT<valijson::DefaultRegexEngine,
+            valijson::kStrongTypeChecking> StrongYamlStreamValidator;
+    std::istringstream policyInput("--- 3\n");
+    std::vector<StrongYamlStreamValidator::Result> policyResults;
+    StrongYamlStreamValidator policyValidator(schema, valijson::StrongTypesValidator());
+    policyValidator.setThreads(2);
+    EXPECT_FALSE(policyValidator.validate(policyInput, policyResults));
+    ASSERT_EQ(1u, policyResults.size());
+    EXPECT_LT(0u, policyResults[0].results.numErrors());
+}